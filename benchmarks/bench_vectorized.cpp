@@ -1,11 +1,130 @@
 #include <benchmark/benchmark.h>
+#include "lyradb/simd_kernels.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/table.h"
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace lyradb {
+namespace benchmark_impl {
+
+constexpr size_t kRows = 1 << 20;
+
+template <typename T>
+std::vector<T> uniform_values(size_t n) {
+    std::vector<T> values(n);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int32_t> dist(0, 999);
+    for (auto& v : values) {
+        v = static_cast<T>(dist(rng));
+    }
+    return values;
+}
+
+// Raw kernels: compare one array against a constant (~10% selectivity)
+template <typename T>
+static void BenchCompareKernel(benchmark::State& state) {
+    auto isa = static_cast<simd::InstructionSet>(state.range(0));
+    if (isa != simd::InstructionSet::SCALAR && simd::detect_instruction_set() < isa) {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+    auto values = uniform_values<T>(kRows);
+    std::vector<uint64_t> mask(simd::mask_words(kRows));
+
+    for (auto _ : state) {
+        simd::compare(values.data(), values.size(), simd::CompareOp::LT,
+                      static_cast<T>(100), static_cast<T>(0), mask.data(), isa);
+        benchmark::DoNotOptimize(mask.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kRows);
+    state.SetLabel(simd::instruction_set_name(isa));
+}
+BENCHMARK_TEMPLATE(BenchCompareKernel, int32_t)->DenseRange(0, 2);
+BENCHMARK_TEMPLATE(BenchCompareKernel, int64_t)->DenseRange(0, 2);
+BENCHMARK_TEMPLATE(BenchCompareKernel, double)->DenseRange(0, 2);
+
+static void BenchBetweenKernel(benchmark::State& state) {
+    auto isa = static_cast<simd::InstructionSet>(state.range(0));
+    if (isa != simd::InstructionSet::SCALAR && simd::detect_instruction_set() < isa) {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+    auto values = uniform_values<int32_t>(kRows);
+    std::vector<uint64_t> mask(simd::mask_words(kRows));
 
-// TODO: Implement vectorized operation benchmarks
-static void BM_VectorFilter(benchmark::State& state) {
     for (auto _ : state) {
-        // Benchmark code here
+        simd::compare(values.data(), values.size(), simd::CompareOp::BETWEEN,
+                      250, 750, mask.data(), isa);
+        benchmark::DoNotOptimize(mask.data());
     }
+    state.SetItemsProcessed(state.iterations() * kRows);
+    state.SetLabel(simd::instruction_set_name(isa));
 }
+BENCHMARK(BenchBetweenKernel)->DenseRange(0, 2);
+
+// End to end: QueryExecutor::filter_table with SIMD on (1) and off (0)
+class FilterTableFixture : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State&) override {
+        if (table_) {
+            return;
+        }
+        Schema schema({
+            ColumnDef("id", DataType::INT32),
+            ColumnDef("qty", DataType::INT32),
+            ColumnDef("price", DataType::FLOAT64)
+        });
+        table_ = std::make_unique<Table>("items", schema);
+        auto qty = uniform_values<int32_t>(kRows);
+        auto price = uniform_values<double>(kRows);
+        for (size_t i = 0; i < kRows; ++i) {
+            int32_t id = static_cast<int32_t>(i);
+            table_->insert_row(std::vector<void*>{&id, &qty[i], &price[i]});
+        }
+    }
+
+    size_t run(bool simd_enabled, const char* where) {
+        auto stmt = parser_.parse_select_statement(std::string("SELECT * FROM items WHERE ") + where);
+        QueryExecutor executor;
+        executor.set_simd_enabled(simd_enabled);
+        return executor.filter_table(*table_, stmt->where_clause.get(), row_ids_);
+    }
+
+protected:
+    static std::unique_ptr<Table> table_;
+    query::SqlParser parser_;
+    std::vector<size_t> row_ids_;
+};
+std::unique_ptr<Table> FilterTableFixture::table_;
+
+BENCHMARK_DEFINE_F(FilterTableFixture, IntCompare)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(run(state.range(0) != 0, "qty < 100"));
+    }
+    state.SetItemsProcessed(state.iterations() * kRows);
+}
+BENCHMARK_REGISTER_F(FilterTableFixture, IntCompare)->Arg(0)->Arg(1);
+
+BENCHMARK_DEFINE_F(FilterTableFixture, DoubleRange)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(run(state.range(0) != 0, "price >= 250 AND price <= 750"));
+    }
+    state.SetItemsProcessed(state.iterations() * kRows);
+}
+BENCHMARK_REGISTER_F(FilterTableFixture, DoubleRange)->Arg(0)->Arg(1);
+
+BENCHMARK_DEFINE_F(FilterTableFixture, Conjunction)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(run(state.range(0) != 0, "qty < 500 AND price > 900"));
+    }
+    state.SetItemsProcessed(state.iterations() * kRows);
+}
+BENCHMARK_REGISTER_F(FilterTableFixture, Conjunction)->Arg(0)->Arg(1);
+
+} // namespace benchmark_impl
+} // namespace lyradb
 
-BENCHMARK(BM_VectorFilter);
 BENCHMARK_MAIN();
@@ -17,9 +17,42 @@ namespace compression {
  * Format:
  * - Header: [bit_width (1 byte)] [num_values (4 bytes)] [min_value (8 bytes)]
  * - Data: Packed bits containing (value - min_value)
+ *
+ * Widths up to 32 bits are packed in blocks of kBlockValues values in the
+ * SIMD-BP style: value i of a block goes to lane i % 8 of eight 32-bit
+ * lanes, each lane holding its 32 values back to back, and word k of
+ * lane l is stored at word k * 8 + l. A block is 32 * bit_width bytes and
+ * one AVX2 register unpacks eight consecutive values at a time. The last
+ * count % kBlockValues values, and all values of wider widths, are packed
+ * one after another, least significant bit first. Kernels are compiled
+ * per bit width; the AVX2 ones are picked at runtime.
  */
 class BitpackingCompressor {
 public:
+    /// Values per packed block
+    static constexpr size_t kBlockValues = 256;
+    
+    /**
+     * @brief Pack one block of values below 2^bit_width (bit_width <= 32)
+     * @param in kBlockValues values
+     * @param out 8 * bit_width words
+     */
+    static void pack_block(const uint32_t* in, uint8_t bit_width, uint32_t* out);
+    
+    /**
+     * @brief Unpack one block packed by pack_block()
+     * @param out kBlockValues values
+     */
+    static void unpack_block(const uint32_t* in, uint8_t bit_width, uint32_t* out);
+    
+    /**
+     * @brief Unpack one block, adding a frame of reference to every value
+     * @param out kBlockValues values base + packed value
+     */
+    static void unpack_block(const uint32_t* in, uint8_t bit_width, int64_t base, int64_t* out);
+    static void unpack_block(const uint32_t* in, uint8_t bit_width, int32_t base, int32_t* out);
+    
+
     /**
      * @brief Compress integer array using bitpacking
      * @param values Array of int64 values
@@ -35,6 +68,24 @@ public:
         const uint8_t* data, 
         size_t length);
     
+    /**
+     * @brief Number of values in bitpacked data (0 if malformed)
+     */
+    static size_t value_count(const uint8_t* data, size_t length);
+    
+    /**
+     * @brief Decompress straight into a caller buffer
+     * @param out value_count() values
+     * @return Number of values written
+     */
+    static size_t decompress_into(const uint8_t* data, size_t length, int64_t* out);
+    
+    /**
+     * @brief Decompress into int32 values; the data must have been
+     * compressed from values that fit in int32
+     */
+    static size_t decompress_into(const uint8_t* data, size_t length, int32_t* out);
+    
     /**
      * @brief Estimate compression ratio
      * Returns compression ratio (< 1.0 means beneficial)
@@ -57,6 +108,16 @@ private:
         static constexpr size_t SIZE = 1 + 4 + 8;  // 13 bytes
     };
     
+    /**
+     * @brief Bytes of packed data for count values at bit_width
+     */
+    static size_t packed_bytes(size_t count, uint8_t bit_width) {
+        return (count * bit_width + 7) / 8;
+    }
+    
+    template <typename T>
+    static size_t decode(const uint8_t* data, size_t length, T* out);
+    
     /**
      * @brief Write value to bit buffer at specific bit position
      */
@@ -1,32 +1,83 @@
 #pragma once
 
 #include <cstdint>
+#include <fstream>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
-#include <map>
-#include <set>
+#include "config.h"
 #include "lru2.h"
 
 namespace lyradb {
 
-using PageId = uint32_t;
+/**
+ * @brief Page identifier: file id in the high 32 bits, page number in
+ * the low 32 bits (the page starts at page number * page size)
+ */
+using PageId = uint64_t;
+
+class BufferManager;
 
 /**
- * @brief Page handle for safe page access
+ * @brief Pinned reference to a buffered page
+ *
+ * The page stays resident (and data() valid) until the handle is
+ * released or destroyed.
  */
 class PageHandle {
 public:
-    explicit PageHandle(void* data) : data_(data) {}
-    
-    void* data() const { return data_; }
-    
+    PageHandle() = default;
+    PageHandle(BufferManager* owner, PageId page_id, uint8_t* data)
+        : owner_(owner), page_id_(page_id), data_(data) {}
+    PageHandle(PageHandle&& other) noexcept { *this = std::move(other); }
+    PageHandle& operator=(PageHandle&& other) noexcept;
+    PageHandle(const PageHandle&) = delete;
+    PageHandle& operator=(const PageHandle&) = delete;
+    ~PageHandle() { release(); }
+
+    uint8_t* data() const { return data_; }
+    PageId page_id() const { return page_id_; }
+    bool valid() const { return data_ != nullptr; }
+
+    /**
+     * @brief Mark the page as modified (written back on flush/eviction)
+     */
+    void mark_dirty();
+
+    /**
+     * @brief Drop the pin early
+     */
+    void release();
+
 private:
-    void* data_;
+    BufferManager* owner_ = nullptr;
+    PageId page_id_ = 0;
+    uint8_t* data_ = nullptr;
+};
+
+/**
+ * @brief Buffer pool counters
+ */
+struct BufferStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t writebacks = 0;
 };
 
 /**
  * @brief Buffer Manager with LRU2 replacement policy
  * Manages in-memory page buffer for columnar data
+ *
+ * The pool is a fixed array of page-sized frames. Pages of registered
+ * files (.lycol column files) are read into a free frame on first
+ * access; when none is free, the least recently used unpinned page is
+ * evicted, after writing it back if dirty. Pinned pages are never
+ * evicted, so memory stays bounded by the pool size no matter how large
+ * the files are. Write-back writes whole pages, so a file grows to a
+ * multiple of the page size once its last page is written. Thread-safe.
  */
 class BufferManager {
 public:
@@ -35,50 +86,103 @@ public:
      * @param pool_size Total size in bytes
      * @param page_size Default page size (default 64KB)
      */
-    BufferManager(size_t pool_size, size_t page_size = 65536);
-    
+    BufferManager(size_t pool_size, size_t page_size = LYRADB_DEFAULT_PAGE_SIZE);
+    ~BufferManager();
+
+    BufferManager(const BufferManager&) = delete;
+    BufferManager& operator=(const BufferManager&) = delete;
+
+    static PageId make_page_id(uint32_t file_id, uint32_t page_no) {
+        return (static_cast<PageId>(file_id) << 32) | page_no;
+    }
+    static uint32_t file_of(PageId page_id) { return static_cast<uint32_t>(page_id >> 32); }
+    static uint32_t page_of(PageId page_id) { return static_cast<uint32_t>(page_id); }
+
+    /**
+     * @brief Register a file (created if missing)
+     * @return File id for make_page_id(); the same path returns the same id
+     */
+    uint32_t open_file(const std::string& path);
+
+    /**
+     * @brief Number of pages in a file, including appended ones not yet flushed
+     */
+    uint32_t page_count(uint32_t file_id) const;
+
+    /**
+     * @brief Append a zeroed page to a file and return it pinned and dirty
+     */
+    PageHandle allocate_page(uint32_t file_id);
+
     /**
      * @brief Get page from buffer (loads from disk if needed)
+     * @return Pinned handle; the page cannot be evicted while it lives
      */
     PageHandle get_page(PageId page_id);
-    
+
     /**
-     * @brief Pin a page in memory (prevent eviction)
+     * @brief Pin a page in memory (prevent eviction), loading it if needed
      */
     void pin_page(PageId page_id);
-    
+
     /**
      * @brief Unpin a page
      */
     void unpin_page(PageId page_id);
-    
+
     /**
      * @brief Check if page is pinned
      */
     bool is_pinned(PageId page_id) const;
-    
+
     /**
      * @brief Mark page as modified
+     * @throws std::runtime_error if the page is not resident
      */
     void mark_dirty(PageId page_id);
-    
+
     /**
      * @brief Write all dirty pages to disk
      */
     void flush_all();
-    
+
     size_t pool_size() const { return pool_size_; }
     size_t page_size() const { return page_size_; }
-    size_t num_pages() const { return page_map_.size(); }
-    
+    size_t frame_count() const { return frames_.size(); }
+    size_t num_pages() const;
+    BufferStats stats() const;
+
 private:
+    struct Frame {
+        PageId page_id = 0;
+        uint32_t pin_count = 0;
+        bool dirty = false;
+    };
+
+    struct File {
+        std::string path;
+        std::fstream stream;
+        uint64_t disk_size = 0;     // Bytes currently on disk
+        uint32_t page_count = 0;    // Including appended pages
+    };
+
     size_t pool_size_;
     size_t page_size_;
     std::vector<uint8_t> buffer_pool_;
-    std::map<PageId, void*> page_map_;
-    std::map<PageId, uint32_t> pin_count_;
-    std::set<PageId> dirty_pages_;
+    std::vector<Frame> frames_;
+    std::vector<size_t> free_frames_;
+    std::unordered_map<PageId, size_t> page_map_;   // Resident page -> frame
+    std::vector<std::unique_ptr<File>> files_;
     LRU2<PageId> lru2_;
+    BufferStats stats_;
+    mutable std::mutex mutex_;
+
+    size_t fetch_frame(PageId page_id, bool load);
+    size_t take_frame();
+    void read_page(PageId page_id, uint8_t* data);
+    void write_page(const Frame& frame, const uint8_t* data);
+    File& file(uint32_t file_id) const;
+    uint8_t* frame_data(size_t frame) { return buffer_pool_.data() + frame * page_size_; }
 };
 
 } // namespace lyradb
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "data_types.h"
+#include "zone_map.h"
 #include <vector>
 #include <memory>
+#include <string>
 #include <cstdint>
 
 namespace lyradb {
@@ -10,6 +12,27 @@ namespace lyradb {
 /**
  * @brief LyColumn Storage Format
  * Columnar storage with compression, indexing, and metadata
+ *
+ * Values live in a single contiguous native array per column:
+ * - INT32/DATE32 as int32_t, INT64/TIMESTAMP as int64_t
+ * - FLOAT32 as float, FLOAT64 as double, BOOL as uint8_t
+ * - STRING/DECIMAL as std::string (variable width)
+ * NULLs are tracked in a separate bitmap; the native slot of a NULL
+ * value is zero-filled so kernels can scan the array without branching.
+ *
+ * Pages are logical row ranges over the contiguous array. A page is
+ * sealed automatically once it holds LYRADB_DEFAULT_PAGE_SIZE bytes of
+ * fixed-width data (or kStringPageRows strings), or on finalize_page().
+ * Each page, including the open tail, has a zone in zone_map() with its
+ * min/max and NULL count so scans can skip pages a predicate cannot match.
+ *
+ * encode() switches a loaded column to a compressed in-memory form that
+ * filters evaluate without expanding: a low-cardinality string column
+ * becomes codes into a sorted dictionary (a comparison with a constant is
+ * one dictionary lookup, then an integer compare over the codes), and a
+ * fixed-width column with long runs of equal values gets a run index
+ * (a predicate is evaluated once per run). Appends that fit the encoding
+ * keep it; any other modification reverts to the plain form.
  */
 class Column {
 public:
@@ -21,7 +44,7 @@ public:
         uint32_t data_size;
         uint32_t compressed_size;
     };
-    
+
     struct ColumnStats {
         int64_t min_value = 0;
         int64_t max_value = 0;
@@ -29,37 +52,167 @@ public:
         uint32_t distinct_count = 0;
         bool has_bloom_filter = false;
     };
-    
+
+    static constexpr size_t kStringPageRows = 4096;
+
     explicit Column(const std::string& name, DataType type, size_t initial_capacity = 4096);
-    
+
     // Data manipulation
     void append_value(const void* value);
     void append_null();
+
+    /**
+     * @brief Parse a textual value into the column's native type and append it
+     * @param text Value text; empty string (or NULL) appends a NULL
+     * @throws std::runtime_error if text is not a valid value for the column type
+     */
+    void append_string(const std::string& text);
+
+    /**
+     * @brief Overwrite a value from its textual representation
+     * @throws std::out_of_range / std::runtime_error on bad row or value
+     */
+    void set_string(size_t row, const std::string& text);
+
+    /**
+     * @brief Physically remove rows (ascending, unique indices) in one pass
+     */
+    void erase_rows(const std::vector<size_t>& sorted_rows);
+
+    /**
+     * @brief Drop trailing values so the column holds num_values rows
+     */
+    void truncate(size_t num_values);
+
     void finalize_page();
-    
+
     // Getters
     const std::string& name() const { return name_; }
     DataType type() const { return type_; }
     size_t num_values() const { return num_values_; }
-    size_t num_pages() const { return pages_.size(); }
-    
+    size_t num_pages() const { return page_headers_.size(); }
+    size_t null_count() const { return null_count_; }
+
     const ColumnStats& get_stats() const { return stats_; }
-    const std::vector<uint8_t>& get_page(size_t page_idx) const;
-    
-    // Serialization
+    const indexes::ZoneMapIndex& zone_map() const { return zone_map_; }
+    std::vector<uint8_t> get_page(size_t page_idx) const;
+
+    // Typed access
+    bool is_fixed_width() const { return value_size_ > 0; }
+    size_t value_size() const { return value_size_; }
+
+    /**
+     * @brief Raw pointer to the contiguous native array (fixed-width types only)
+     */
+    template <typename T>
+    const T* data() const { return reinterpret_cast<const T*>(values_.data()); }
+
+    const std::string& string_at(size_t row) const {
+        return dictionary_encoded_ ? dictionary_[codes_[row]] : strings_[row];
+    }
+
+    /**
+     * @brief Switch to the compressed in-memory form where it pays off
+     *
+     * Strings are dictionary-encoded when under 10% of them are distinct;
+     * fixed-width values get a run index when runs average at least
+     * kMinRunLength rows. No-op otherwise, or when already encoded.
+     */
+    void encode();
+
+    /**
+     * @brief Return to the plain form (modifications do this implicitly)
+     */
+    void decode();
+
+    bool is_dictionary_encoded() const { return dictionary_encoded_; }
+
+    /**
+     * @brief Sorted distinct values of a dictionary-encoded column
+     */
+    const std::vector<std::string>& dictionary() const { return dictionary_; }
+
+    /**
+     * @brief Dictionary code of each row (dictionary-encoded columns only);
+     * codes compare like the strings they stand for
+     */
+    const uint32_t* codes() const { return codes_.data(); }
+
+    /**
+     * @brief End row (exclusive) of each run of equal values, ascending;
+     * empty when the column has no run index
+     */
+    const std::vector<uint32_t>& run_ends() const { return run_ends_; }
+
+    /// Average run length from which encode() builds a run index
+    static constexpr size_t kMinRunLength = 16;
+
+    bool is_null(size_t row) const {
+        return null_count_ != 0 && nulls_.is_null(row);
+    }
+
+    /**
+     * @brief Format a value as text (NULL formats as empty string)
+     */
+    std::string get_string(size_t row) const;
+
+    /**
+     * @brief Text get_string() would return for a value of a column of
+     * the given type appended from text
+     * @throws std::runtime_error if text is not a valid value for the type
+     */
+    static std::string canonical_string(DataType type, const std::string& column,
+                                        const std::string& text);
+
+    // Serialization (.lycol column image, zone map included)
     std::vector<uint8_t> serialize() const;
     static Column deserialize(const std::vector<uint8_t>& data);
-    
+
+    /**
+     * @brief Encode rows [begin, end) as a self-contained segment
+     *
+     * Layout: u32 row count, u32 NULL count, the NULL bitmap of the range
+     * (only when it has NULLs), then the values. One segment is one row
+     * group page of a .lycol file.
+     */
+    std::vector<uint8_t> serialize_rows(size_t begin, size_t end) const;
+
+    /**
+     * @brief Append the rows of a serialize_rows() segment
+     * @throws std::runtime_error if the segment is malformed
+     */
+    void append_rows(const uint8_t* data, size_t size);
+
 private:
     std::string name_;
     DataType type_;
+    size_t value_size_ = 0;
     size_t num_values_ = 0;
-    std::vector<uint8_t> current_page_;
-    std::vector<std::vector<uint8_t>> pages_;
+    size_t null_count_ = 0;
+    std::vector<uint8_t> values_;        // Contiguous fixed-width values
+    std::vector<std::string> strings_;   // Variable-width values (empty while encoded)
+    NullBitmap nulls_;
+
+    bool dictionary_encoded_ = false;
+    std::vector<std::string> dictionary_;   // Sorted distinct strings
+    std::vector<uint32_t> codes_;           // Dictionary code per row
+    std::vector<uint32_t> run_ends_;        // Run index of fixed-width values
+
+    size_t sealed_values_ = 0;           // Rows covered by sealed pages
+    std::vector<size_t> page_starts_;    // First row of each sealed page
     std::vector<PageHeader> page_headers_;
     ColumnStats stats_;
-    std::vector<uint8_t> null_bitmap_;
-    
+    indexes::ZoneMapIndex zone_map_;
+
+    void after_append();
+    bool append_code(const std::string& text);
+    void extend_runs();
+    void seal_page(size_t end_row);
+    void rebuild_pages();
+    void rebuild_zone_map(size_t first_page);
+    static void parse_into(DataType type, const std::string& column, const std::string& text,
+                           uint8_t* slot);
+    static std::string format_slot(DataType type, const uint8_t* slot);
     void update_stats();
     std::vector<uint8_t> compress_page(const std::vector<uint8_t>& data);
 };
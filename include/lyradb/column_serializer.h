@@ -1,19 +1,56 @@
 #pragma once
 
 #include "lyradb/storage_format.h"
+#include <fstream>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace lyradb {
 namespace storage {
 
+class MappedFile;
+
 /**
  * @brief File-based column storage writer
  * Serializes column data to .lycol format
+ *
+ * Layout: file header (magic, version, column id, data type, table
+ * metadata block), then one PageHeader + payload per page, then a footer
+ * holding the page index, its offset and the magic again. Pages are
+ * compressed independently and carry a CRC32 of their payload.
+ *
+ * Files are append-only: a writer reopened on a finalized file adds new
+ * pages and a new footer after the old one, whose index may keep
+ * referring to pages written earlier. A reader opened at an older
+ * committed size still sees the older version.
  */
 class ColumnWriter {
 public:
+    /**
+     * @brief A compressed page ready to be appended
+     */
+    struct EncodedPage {
+        std::vector<uint8_t> payload;
+        uint8_t compression_algo = 0;   // Algorithm actually applied
+        uint64_t original_size = 0;
+        uint32_t crc32 = 0;             // CRC32 of payload
+    };
+    
+    /**
+     * @brief Compress one page (thread-safe; does no I/O)
+     *
+     * RLE (8-byte words) and ZSTD apply to raw page bytes. PFOR codes
+     * the values of a Column::serialize_rows() segment of 4- or 8-byte
+     * integers, DICTIONARY those of a string segment (order-preserving
+     * dictionary) and FSST those of a string segment with a trained
+     * symbol table; each falls back to ZSTD for any other page, as do
+     * bit-packing and delta. A page that does not shrink is stored
+     * uncompressed (algorithm 0).
+     */
+    static EncodedPage encode_page(const uint8_t* data, size_t size, uint8_t compression_algo);
+    
     /**
      * @brief Create a new column file writer
      * @param filepath Path to .lycol file to write
@@ -22,8 +59,22 @@ public:
      */
     ColumnWriter(const std::string& filepath, uint32_t column_id, uint8_t data_type);
     
+    /**
+     * @brief Reopen a finalized column file to append to it
+     *
+     * Bytes past committed_size (left by an interrupted write) are cut
+     * off. The page index starts empty; use add_page() to keep pages.
+     * @param committed_size File size recorded by the last finalize()
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    ColumnWriter(const std::string& filepath, uint32_t column_id, uint8_t data_type,
+                 uint64_t committed_size);
+    
+    ~ColumnWriter();
+    
     /**
      * @brief Write table metadata header
+     * @throws std::runtime_error if pages were already written
      */
     void write_table_metadata(const TableMetadata& metadata);
     
@@ -40,9 +91,24 @@ public:
         uint32_t row_count,
         uint8_t compression_algo);
     
+    /**
+     * @brief Append a page produced by encode_page()
+     */
+    void write_encoded_page(const EncodedPage& page, uint32_t row_count);
+    
+    /**
+     * @brief Append a page under an explicit page id
+     */
+    void write_encoded_page(const EncodedPage& page, uint32_t row_count, uint64_t page_id);
+    
+    /**
+     * @brief Keep a page already in the file in the new page index
+     */
+    void add_page(const PageMetadata& page);
+    
     /**
      * @brief Finalize and close file
-     * Writes index and checksum
+     * Writes the page index (ordered by page id) and footer
      */
     void finalize();
     
@@ -63,24 +129,33 @@ private:
     uint64_t page_count_;
     uint64_t bytes_written_;
     std::vector<PageMetadata> page_index_;
+    std::ofstream file_;
+    bool header_written_ = false;
+    bool finalized_ = false;
     
-    /**
-     * @brief Calculate CRC32 checksum
-     */
-    uint32_t calculate_crc32(const uint8_t* data, size_t size);
+    void write_header(const TableMetadata* metadata);
+    void write_bytes(const void* data, size_t size);
 };
 
 /**
  * @brief File-based column storage reader
  * Reads column data from .lycol format
+ *
+ * The file is memory-mapped on open and only the header and page index
+ * are parsed; page payloads are checked and decompressed when
+ * read_page() asks for them.
  */
 class ColumnReader {
 public:
     /**
      * @brief Open an existing .lycol file
      * @param filepath Path to .lycol file to read
+     * @param committed_size Size the file had when the wanted version was
+     *        finalized (0 = the whole file)
+     * @throws std::runtime_error if the file is missing or not a .lycol file
      */
-    explicit ColumnReader(const std::string& filepath);
+    explicit ColumnReader(const std::string& filepath, uint64_t committed_size = 0);
+    ~ColumnReader();
     
     /**
      * @brief Read table metadata header
@@ -88,9 +163,10 @@ public:
     TableMetadata read_table_metadata();
     
     /**
-     * @brief Read a specific page
+     * @brief Read a specific page (thread-safe, no locking)
      * @param page_index Which page to read (0-based)
      * @return Decompressed page data
+     * @throws std::runtime_error on a CRC mismatch or corrupt page
      */
     std::vector<uint8_t> read_page(uint32_t page_index);
     
@@ -110,6 +186,13 @@ public:
      */
     uint32_t page_count() const;
     
+    /**
+     * @brief Column id and data type from the file header
+     */
+    uint32_t column_id() const { return column_id_; }
+    uint8_t data_type() const { return data_type_; }
+    const std::string& path() const { return filepath_; }
+    
     /**
      * @brief Validate file integrity
      */
@@ -119,7 +202,11 @@ private:
     std::string filepath_;
     TableMetadata metadata_;
     std::vector<PageMetadata> page_index_;
+    uint64_t committed_size_;
     bool is_valid_;
+    uint32_t column_id_ = 0;
+    uint8_t data_type_ = 0;
+    std::unique_ptr<MappedFile> map_;   // Whole file, mapped read-only
     
     /**
      * @brief Load file index
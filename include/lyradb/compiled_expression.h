@@ -0,0 +1,246 @@
+#pragma once
+
+#include "data_types.h"
+#include "expression_evaluator.h"
+#include "vector_batch.h"
+#include "simd_kernels.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace lyradb {
+
+// Forward declarations
+class Schema;
+namespace query {
+    class Expression;
+}
+
+/**
+ * @brief Static value kind of a program register
+ */
+enum class ValueKind : uint8_t {
+    NULL_VALUE,
+    INT,
+    DOUBLE,
+    STRING,
+    BOOL
+};
+
+/**
+ * @brief Opcodes of the flat expression program
+ *
+ * Every opcode is fully typed: the compiler inserts explicit casts so the
+ * evaluation loop never inspects operand kinds at runtime.
+ */
+enum class OpCode : uint8_t {
+    LOAD_COLUMN, LOAD_CONST,
+    INT_TO_DBL, STR_TO_DBL, TO_BOOL,
+    ADD_INT, SUB_INT, MUL_INT, MOD_INT, NEG_INT, ABS_INT,
+    ADD_DBL, SUB_DBL, MUL_DBL, DIV_DBL, NEG_DBL, ABS_DBL,
+    EQ_INT, NE_INT, LT_INT, LE_INT, GT_INT, GE_INT,
+    EQ_DBL, NE_DBL, LT_DBL, LE_DBL, GT_DBL, GE_DBL,
+    EQ_STR, NE_STR, LT_STR, LE_STR, GT_STR, GE_STR,
+    AND, OR, NOT,
+    CONCAT, LIKE, UPPER, LOWER, LENGTH
+};
+
+/**
+ * @brief Single instruction: dst = op(a, b)
+ * For LOAD_COLUMN `a` is the column ordinal, for LOAD_CONST the constant
+ * index. `kind` carries the operand kind for LOAD_CONST and TO_BOOL.
+ */
+struct Instruction {
+    OpCode op;
+    ValueKind kind;
+    uint16_t dst;
+    uint16_t a;
+    uint16_t b;
+};
+
+/**
+ * @brief Expression compiled against a fixed column layout
+ *
+ * Column names are resolved to ordinals and operator implementations are
+ * selected once at compile time. Evaluation walks a flat instruction array
+ * over a preallocated register file, so it performs no hashing, no
+ * dynamic_cast and no allocation per row.
+ *
+ * A CompiledExpression keeps its register file between calls and must not
+ * be evaluated concurrently; copy it to get an independent instance.
+ */
+class CompiledExpression {
+public:
+    /**
+     * @brief Evaluate for one row read directly from typed table columns
+     */
+    ExpressionValue evaluate(const Table& table, size_t row) const;
+
+    /**
+     * @brief Evaluate for one row given as strings (e.g. joined rows)
+     */
+    ExpressionValue evaluate(const std::vector<std::string>& row) const;
+
+    /**
+     * @brief Evaluate as a WHERE predicate (NULL counts as false)
+     */
+    bool matches(const Table& table, size_t row) const;
+    bool matches(const std::vector<std::string>& row) const;
+
+    /**
+     * @brief Evaluate column-at-a-time for the selected rows of a batch
+     * @param batch Column vectors (ordinals must match the compiled layout)
+     * @param selection Rows to evaluate
+     * @param out One value per selection entry
+     */
+    void evaluate_batch(const VectorBatch& batch, const SelectionVector& selection,
+                        std::vector<ExpressionValue>& out) const;
+
+    /**
+     * @brief Narrow a selection to the rows where the predicate is true
+     * @param batch Column vectors (ordinals must match the compiled layout)
+     * @param selection In: candidate rows; out: surviving rows
+     * @param isa Instruction set for column predicate kernels
+     * @return Number of surviving rows
+     */
+    size_t filter_batch(const VectorBatch& batch, SelectionVector& selection,
+                        simd::InstructionSet isa = simd::detect_instruction_set()) const;
+
+    /**
+     * @brief True if the program is a single column comparison
+     *
+     * Recognised shapes are `column <op> constant`, `column <op> column` and
+     * `column >= lo AND column <= hi` (a BETWEEN range). They run as one
+     * kernel over the native column arrays instead of the generic program.
+     */
+    bool is_column_predicate() const { return column_predicate_.valid; }
+
+    /**
+     * @brief Column whose zone map can prune this program, or -1
+     * Only column-vs-constant predicates qualify.
+     */
+    int pruning_column() const;
+
+    /**
+     * @brief Whether a zone of the pruning column may hold matching rows
+     */
+    bool may_match(const indexes::ZoneMapIndex& zone_map,
+                   const indexes::ZoneMapIndex::Zone& zone) const;
+
+    ValueKind result_kind() const { return result_kind_; }
+    size_t instruction_count() const { return program_.size(); }
+    const std::vector<Instruction>& instructions() const { return program_; }
+
+    /**
+     * @brief Column ordinals referenced by the program (deduplicated)
+     */
+    std::vector<size_t> referenced_columns() const;
+
+private:
+    friend class ExpressionCompiler;
+
+    struct Register {
+        bool null = true;
+        int64_t i = 0;
+        double d = 0.0;
+        const std::string* s = nullptr;
+    };
+
+    /**
+     * @brief One register widened to a whole batch (structure of arrays)
+     */
+    struct VectorRegister {
+        std::vector<uint8_t> null;
+        std::vector<int64_t> i;
+        std::vector<double> d;
+        std::vector<const std::string*> s;
+        std::vector<std::string> owned;  // Strings produced by the program
+    };
+
+    /**
+     * @brief Single column comparison recognised at compile time
+     */
+    struct ColumnPredicate {
+        bool valid = false;
+        uint16_t column = 0;
+        simd::CompareOp op = simd::CompareOp::EQ;  // Column on the left
+        ValueKind domain = ValueKind::INT;         // INT, DOUBLE or STRING comparison
+        bool column_rhs = false;                   // Right side is rhs_column
+        uint16_t rhs_column = 0;
+        Register low;                              // Constant (lower bound for BETWEEN)
+        Register high;                             // Upper bound for BETWEEN
+    };
+
+    std::vector<Instruction> program_;
+    std::vector<Register> constants_;
+    std::vector<std::string> string_pool_;   // Backing storage for string constants
+    std::vector<DataType> column_types_;
+    ValueKind result_kind_ = ValueKind::NULL_VALUE;
+    uint16_t result_register_ = 0;
+    ColumnPredicate column_predicate_;
+
+    mutable std::vector<Register> registers_;
+    mutable std::vector<std::string> scratch_;  // Per-register string results
+    mutable std::vector<VectorRegister> vectors_;
+    mutable std::vector<uint64_t> mask_;         // Kernel output bitmask
+
+    template <typename Loader>
+    const Register& run(const Loader& load) const;
+
+    const VectorRegister& run_batch(const VectorBatch& batch, const SelectionVector& selection) const;
+    size_t filter_column_predicate(const VectorBatch& batch, SelectionVector& selection,
+                                   simd::InstructionSet isa) const;
+    bool filter_simd(const VectorBatch& batch, SelectionVector& selection,
+                     simd::InstructionSet isa) const;
+    void detect_column_predicate();
+
+    ExpressionValue to_value(const Register& reg) const;
+    bool to_predicate(const Register& reg) const;
+};
+
+/**
+ * @brief Compiles query::Expression trees into CompiledExpression programs
+ *
+ * Unsupported constructs (aggregates, IN, unknown functions, mixed types
+ * with no well-defined coercion) make compile() return nullptr; callers
+ * fall back to ExpressionEvaluator in that case.
+ */
+class ExpressionCompiler {
+public:
+    /**
+     * @brief Compile against an explicit column layout
+     * @param expr Expression tree
+     * @param column_names Column name per ordinal (first match wins)
+     * @param column_types Column type per ordinal
+     * @return Program, or nullptr if the expression is not compilable
+     */
+    std::unique_ptr<CompiledExpression> compile(
+        const query::Expression* expr,
+        const std::vector<std::string>& column_names,
+        const std::vector<DataType>& column_types);
+
+    /**
+     * @brief Compile against a table schema (ordinals = schema positions)
+     */
+    std::unique_ptr<CompiledExpression> compile(
+        const query::Expression* expr,
+        const Schema& schema);
+
+    const std::string& get_last_error() const { return last_error_; }
+
+private:
+    std::string last_error_;
+    const std::vector<std::string>* names_ = nullptr;
+    CompiledExpression* out_ = nullptr;
+    std::vector<ValueKind> kinds_;
+
+    bool emit(const query::Expression* expr, uint16_t& reg);
+    uint16_t new_register(ValueKind kind);
+    uint16_t emit_op(OpCode op, ValueKind kind, uint16_t a, uint16_t b = 0,
+                     ValueKind operand_kind = ValueKind::NULL_VALUE);
+    bool coerce_numeric(uint16_t& left, uint16_t& right, bool& as_double);
+    uint16_t coerce_bool(uint16_t reg);
+};
+
+} // namespace lyradb
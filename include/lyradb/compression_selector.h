@@ -17,7 +17,9 @@ enum class CompressionAlgorithm {
     DICTIONARY = 2,
     BITPACKING = 3,
     DELTA = 4,
-    ZSTD = 5
+    ZSTD = 5,
+    PFOR = 6,
+    FSST = 7
 };
 
 /**
@@ -54,6 +56,8 @@ public:
     
     /**
      * @brief Select best compression for string data
+     * Dictionary for low cardinality, FSST for long distinct strings with
+     * shared substrings (URLs, e-mail addresses, log lines), else ZSTD
      * @param values Vector of string values
      * @param min_compression_ratio Minimum compression benefit to apply compression
      * @return Selected algorithm
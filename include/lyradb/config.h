@@ -14,6 +14,8 @@
 #define LYRADB_DEFAULT_PAGE_SIZE (65536)        // 64 KB
 #define LYRADB_DEFAULT_BATCH_SIZE (1024)        // Vector batch size
 #define LYRADB_BUFFER_POOL_SIZE (1073741824)    // 1 GB
+#define LYRADB_DEFAULT_MORSEL_SIZE (65536)      // Rows per parallel scan task
+#define LYRADB_JOIN_PARTITION_SIZE (262144)     // Target bytes per join build partition
 
 // Constants
 #define LYRADB_MAX_COLUMNS (1024)
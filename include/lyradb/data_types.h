@@ -60,6 +60,11 @@ public:
     void set_null(size_t idx, bool is_null);
     bool is_null(size_t idx) const;
     
+    /**
+     * @brief Grow or shrink to hold capacity values (new bits are not-null)
+     */
+    void resize(size_t capacity);
+    
     const uint8_t* data() const { return bitmap_.data(); }
     size_t byte_size() const { return bitmap_.size(); }
     
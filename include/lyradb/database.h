@@ -4,9 +4,16 @@
 #include "query_result.h"
 #include "query_cache.h"
 #include "index_manager.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <string>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace lyradb {
@@ -14,10 +21,50 @@ namespace lyradb {
 // Forward declarations
 class Table;
 class QueryExecutionEngine;
+class WriteAheadLog;
+struct WalRecord;
+struct WalTransaction;
+
+namespace query {
+class Statement;
+}
 
 /**
  * @brief Main database entry point
  * Embeddable analytical database engine
+ *
+ * Writes through execute() (CREATE TABLE, INSERT, UPDATE, DELETE, DROP
+ * TABLE) run in a transaction: an explicit one opened with
+ * begin_transaction(), or else one per statement. One transaction
+ * writes at a time; other writers wait in begin_transaction() (or their
+ * next write statement) until it ends. With a write-ahead log attached,
+ * commit() logs the transaction's redo records and returns once they
+ * are on disk; the writer slot is released before that wait, so commits
+ * of concurrent writers share one fsync (group commit). A commit only
+ * becomes visible to readers once it is durable. If the log write fails
+ * it is rolled back, together with the later commits that were built on
+ * it. Direct calls such as create_table() or Table::insert_row() bypass
+ * transactions.
+ *
+ * Reads are snapshot-isolated (MVCC): a SELECT sees the committed
+ * version of every table it reads, all taken together when it starts,
+ * and neither waits for writers nor stalls them. Before a transaction
+ * first writes a table it keeps the table's committed version for
+ * readers (see Table::snapshot(); columns are copy-on-write), and
+ * commit makes the written versions current. Old versions are freed
+ * with their last reader. A writer's own reads see its uncommitted
+ * changes.
+ *
+ * checkpoint() lets the owner persist the tables (see DatabaseFile) at a
+ * point no transaction is open and then empties the log, so recovery
+ * only has to replay work committed since the last checkpoint.
+ *
+ * DELETE only marks rows in the table's deletion vectors, so row ids and
+ * the indexes keyed by them stay valid. When a commit leaves enough of a
+ * table deleted (see set_purge_threshold()), a background thread purges
+ * it: deleted rows are removed in its own transaction and indexes
+ * renumbered. Row ids of a table may therefore change between
+ * transactions.
  */
 class Database {
 public:
@@ -34,11 +81,28 @@ public:
      */
     void create_table(const std::string& name, const Schema& schema);
     
+    /**
+     * @brief Register an already built table (e.g. loaded from disk)
+     * @throws std::runtime_error if a table with that name exists
+     */
+    void attach_table(std::shared_ptr<Table> table);
+    
     /**
      * @brief Get existing table
+     *
+     * This is the live table, with any uncommitted changes of the open
+     * transaction; use get_table_snapshot() to read from another thread.
      */
     std::shared_ptr<Table> get_table(const std::string& name);
     
+    /**
+     * @brief Frozen committed version of a table
+     *
+     * Later writes, committed or not, do not show in it.
+     * @throws std::runtime_error if no committed table has that name
+     */
+    std::shared_ptr<const Table> get_table_snapshot(const std::string& name);
+    
     /**
      * @brief Execute SQL query
      */
@@ -74,6 +138,96 @@ public:
      */
     std::unique_ptr<QueryResult> execute(const std::string& sql);
     
+    /**
+     * @brief Attach a write-ahead log, first replaying the committed
+     * transactions it already holds
+     *
+     * Replay applies DDL in log order; the DML between two DDL records
+     * is replayed in parallel, one task per table.
+     * @param wal_path Log file (created if missing)
+     * @param commit_delay Group commit window (see WriteAheadLog)
+     * @param checkpoint_lsn LSN the loaded tables already include
+     */
+    void open_wal(const std::string& wal_path,
+                  std::chrono::microseconds commit_delay = std::chrono::microseconds(0),
+                  uint64_t checkpoint_lsn = 0);
+    
+    /**
+     * @brief Detach the write-ahead log (pending commits are synced first)
+     */
+    void close_wal();
+    
+    /**
+     * @brief Attached write-ahead log, or nullptr
+     */
+    WriteAheadLog* wal() { return wal_.get(); }
+    
+    /**
+     * @brief Run persist at a transaction boundary, then empty the log
+     *
+     * Waits for the writer slot, so no transaction is open while persist
+     * runs, and for every commit to be durable. persist receives the last
+     * committed LSN; it may swap the log with close_wal()/open_wal().
+     * If persist throws, the log is kept.
+     * @return The LSN the checkpoint covers
+     * @throws std::runtime_error if the calling thread has a transaction
+     */
+    uint64_t checkpoint(const std::function<void(uint64_t lsn)>& persist);
+    
+    /**
+     * @brief Start an explicit transaction on the calling thread
+     * Waits while another thread's transaction is active
+     * @throws std::runtime_error if this thread already has one
+     */
+    void begin_transaction();
+    
+    /**
+     * @brief Commit the calling thread's transaction (durable on return
+     * when a write-ahead log is attached)
+     * @throws std::runtime_error if this thread has no transaction, or
+     *         if the log write fails; the transaction is rolled back then
+     */
+    void commit();
+    
+    /**
+     * @brief Undo the calling thread's transaction
+     * @throws std::runtime_error if this thread has no transaction
+     */
+    void rollback();
+    
+    /**
+     * @brief Whether the calling thread has an open transaction
+     */
+    bool in_transaction() const;
+    
+    /**
+     * @brief Physically remove a table's deleted rows now
+     *
+     * Runs as a transaction of its own and is logged, so replay renumbers
+     * rows the same way. Indexes are renumbered; snapshots are unchanged.
+     * @return Rows removed
+     * @throws std::runtime_error if the table does not exist or the
+     * calling thread has a transaction open
+     */
+    size_t purge_deleted(const std::string& table_name);
+    
+    /**
+     * @brief Deleted fraction of a table at which a commit schedules a
+     * background purge of it
+     *
+     * A table is only purged once at least Table::kRowGroupRows of its
+     * rows are deleted. 0 disables background purging.
+     */
+    void set_purge_threshold(double fraction) { purge_threshold_ = fraction; }
+    double get_purge_threshold() const { return purge_threshold_; }
+    
+    /**
+     * @brief Degree of parallelism for queries on this database
+     * @param dop Threads per query (0 = all cores, 1 = single-threaded)
+     */
+    void set_parallelism(size_t dop) { parallelism_ = dop; }
+    size_t get_parallelism() const { return parallelism_; }
+    
     // Properties
     const std::string& path() const { return path_; }
     bool is_open() const { return is_open_; }
@@ -81,10 +235,64 @@ public:
 private:
     std::string path_;
     bool is_open_ = false;
-    std::map<std::string, std::shared_ptr<Table>> tables_;
+    size_t parallelism_ = 0;  // 0 = use every core
+    using TableMap = std::map<std::string, std::shared_ptr<Table>>;
+    
+    // Catalog: live tables plus, for each table the open transaction has
+    // written, its committed version (nullptr: the transaction created it)
+    mutable std::mutex catalog_mutex_;
+    TableMap tables_;
+    TableMap checked_out_;
+    uint64_t commit_version_ = 0;   // Bumped on every commit that wrote
     std::unique_ptr<QueryExecutionEngine> engine_;
     QueryCache query_cache_;  // LRU query result cache
     index::IndexManager index_manager_;  // Index management for Phase 4
+    
+    // Transactions: a single writer slot owned by one thread at a time
+    struct Transaction;
+    std::unique_ptr<WriteAheadLog> wal_;
+    std::unique_ptr<Transaction> txn_;
+    std::thread::id txn_owner_;
+    mutable std::mutex txn_mutex_;
+    std::condition_variable txn_cv_;
+    
+    // Commits appended to the log but not yet durable, oldest first.
+    // Readers keep the versions they replaced until a sync covers them.
+    // Guarded by catalog_mutex_
+    struct UnpublishedCommit {
+        uint64_t lsn = 0;
+        TableMap checked_out;
+        std::unique_ptr<Transaction> txn;   // For its undo entries
+    };
+    std::deque<UnpublishedCommit> unpublished_;
+    
+    // Background purge of deleted rows, started on first use
+    std::atomic<double> purge_threshold_{0.25};
+    std::thread purge_thread_;
+    std::mutex purge_mutex_;
+    std::condition_variable purge_cv_;
+    std::deque<std::string> purge_queue_;
+    std::atomic<bool> purge_stop_{false};
+    
+    std::unique_ptr<QueryResult> execute_statement(query::Statement* statement,
+                                                   const TableMap* snapshot = nullptr);
+    TableMap committed_tables(const std::vector<std::string>& names) const;
+    void check_out(const std::string& name);
+    void publish();
+    void publish_durable();
+    void abort_unpublished();
+    void discard_checkouts();
+    bool acquire_write_slot(bool explicit_begin);
+    void release_write_slot();
+    void check_txn_owner() const;
+    void undo_to(Transaction& txn, size_t undo_mark, size_t redo_mark);
+    size_t purge_in_slot(const std::string& table_name);
+    std::vector<std::string> tables_to_purge() const;
+    void schedule_purge(const std::vector<std::string>& tables);
+    void purge_loop();
+    void stop_purge();
+    void replay(const std::vector<WalTransaction>& txns);
+    void apply_redo(const WalRecord& record);
 };
 
 } // namespace lyradb
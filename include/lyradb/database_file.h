@@ -3,18 +3,80 @@
 #include "database.h"
 #include "table.h"
 #include "schema.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <filesystem>
 
 namespace lyradb {
 
+class IoThrottle;
+
+/**
+ * @brief When and how fast the background compactor works
+ *
+ * A table is rewritten once both dead-byte thresholds are met. Dead
+ * bytes are the part of its column files no longer referenced by the
+ * current version: pages superseded by later checkpoints, such as the
+ * tail row group re-appended by every save under trickle inserts.
+ */
+struct CompactionOptions {
+    std::chrono::milliseconds interval{1000};   // Pause between passes
+    double min_deleted_ratio = 0.1;   // Deleted share of rows that triggers a purge
+    double min_dead_ratio = 0.5;      // Dead share of a table's column file bytes
+    uint64_t min_dead_bytes = 1 << 20;
+    uint64_t bytes_per_second = 32ull << 20;   // Rewrite rate (0 = unthrottled)
+};
+
+/**
+ * @brief Work done by the compactor
+ */
+struct CompactionStats {
+    uint64_t passes = 0;
+    uint64_t tables_purged = 0;
+    uint64_t rows_purged = 0;
+    uint64_t tables_rewritten = 0;
+    uint64_t bytes_written = 0;   // Compressed page bytes of rewrites
+};
+
 /**
  * @brief DatabaseFile - File-based database persistence
  * 
  * This class provides file-based persistence for LyraDB databases.
  * Databases are saved as .db files that can be loaded later.
+ *
+ * The .db file is a small catalog (magic, version, timestamp, checkpoint
+ * LSN, table manifest paths). Table data lives next to it in
+ * "<file>.tables/", one directory per table holding .lyta manifests and
+ * one compressed .lycol file per column, stored in row groups (see
+ * storage::TableWriter). Committed transactions go to "<file>.wal".
+ *
+ * save() is a checkpoint: it appends only the row groups written since
+ * the last one to the column files, writes a new manifest for each
+ * changed table and then replaces the catalog, which is the single
+ * commit point. The log is emptied afterwards. Opening after a crash
+ * loads the last checkpoint and replays the log tail, so recovery time
+ * is bounded by the log size rather than the database size. Superseded
+ * pages stay in the column files until compaction.
+ *
+ * compact() rewrites every table while holding off writers.
+ * start_compaction() instead runs compact_step() on a background thread:
+ * it purges deleted rows, then rewrites tables whose files are mostly
+ * dead pages from a snapshot, with the writes throttled and no lock
+ * held. Row groups changed meanwhile are appended on top of the new
+ * files at the checkpoint that switches the table over, so writers and
+ * scans only ever wait for a normal checkpoint.
+ *
+ * Opening is lazy: only the catalog, the manifests and the page indexes
+ * of the memory-mapped column files are read, so startup time does not
+ * grow with row count. Each column is decoded on its first access.
  * 
  * Usage:
  *   DatabaseFile db("mydata.db");
@@ -26,15 +88,21 @@ namespace lyradb {
 class DatabaseFile {
 public:
     /**
-     * @brief Create a new in-memory database with file persistence
+     * @brief Create a new in-memory database with file persistence, or
+     * open the one at filepath if it exists
      * @param filepath Path to .db file (will be created on save())
+     * @throws std::runtime_error if an existing catalog, table or log
+     *         cannot be loaded (the files are left untouched)
      */
     explicit DatabaseFile(const std::string& filepath);
 
+    DatabaseFile(DatabaseFile&& other) noexcept;
+    DatabaseFile& operator=(DatabaseFile&& other) noexcept;
+
     /**
      * @brief Open an existing .db file
      * @param filepath Path to existing .db file
-     * @return DatabaseFile instance with loaded data
+     * @return DatabaseFile instance; table columns load on first access
      * @throws std::runtime_error if file cannot be opened
      */
     static DatabaseFile open(const std::string& filepath);
@@ -47,8 +115,10 @@ public:
     std::shared_ptr<QueryResult> execute(const std::string& sql);
 
     /**
-     * @brief Save database to .db file
-     * @throws std::runtime_error if save fails
+     * @brief Checkpoint: persist the row groups changed since the last
+     * save and empty the write-ahead log
+     * @throws std::runtime_error if save fails (the last checkpoint and
+     *         the log stay valid)
      */
     void save();
 
@@ -95,16 +165,60 @@ public:
     size_t get_total_rows() const;
 
     /**
-     * @brief Compact the database file (remove deleted space)
+     * @brief Purge deleted rows and checkpoint with every table
+     * rewritten into fresh files, dropping superseded pages
      */
     void compact();
 
     /**
-     * @brief Create backup of current .db file
+     * @brief One online compaction pass (what the background compactor
+     * runs every interval)
+     *
+     * Purges tables whose deleted share reaches min_deleted_ratio, then
+     * rewrites tables over the dead-byte thresholds. Each rewritten
+     * table gets full row group pages with freshly selected compression.
+     * @return What this pass did
+     * @throws std::runtime_error if the database is closed or the
+     *         calling thread has a transaction open
+     */
+    CompactionStats compact_step(const CompactionOptions& options = CompactionOptions());
+
+    /**
+     * @brief Run compact_step() on a background thread every
+     * options.interval (restarts a running compactor)
+     *
+     * close(), save_as() to a new path and moving the object stop it.
+     */
+    void start_compaction(const CompactionOptions& options = CompactionOptions());
+
+    /**
+     * @brief Stop the background compactor, waiting for a running pass
+     */
+    void stop_compaction();
+
+    /**
+     * @brief Totals of every compact_step() so far
+     */
+    CompactionStats compaction_stats() const;
+
+    /**
+     * @brief Copy the catalog, table files and log
+     *
+     * The copy opens like the original would after a crash.
      * @param backup_path Path for backup file
      */
     void backup(const std::string& backup_path);
 
+    /**
+     * @brief Directory holding the table files of a .db file
+     */
+    static std::string data_dir(const std::string& filepath);
+
+    /**
+     * @brief Write-ahead log of a .db file
+     */
+    static std::string wal_path(const std::string& filepath);
+
     ~DatabaseFile();
 
 private:
@@ -113,13 +227,76 @@ private:
     bool is_open_;
     bool modified_;
 
+    // What the last checkpoint holds for each table
+    struct StoredTable {
+        std::string manifest;          // Relative to the data directory
+        std::weak_ptr<Table> table;    // In-memory table it was written from
+        uint64_t file_bytes = 0;       // Size of its column files
+        uint64_t page_bytes = 0;       // Of which pages of this version
+    };
+    std::map<std::string, StoredTable> stored_;
+    uint64_t checkpoint_id_ = 0;
+    uint64_t checkpoint_lsn_ = 0;
+    uint64_t next_table_id_ = 0;   // Names table directories
+
+    // A table compact_step() rewrites off the writer slot
+    struct CompactedTable {
+        std::string name;
+        std::string dir;                       // Relative to the data directory
+        std::weak_ptr<Table> table;            // Live table, clean when snapshotted
+        std::shared_ptr<const Table> version;  // What gets rewritten
+        uint64_t checkpoint_id = 0;            // Checkpoint it was snapshotted at
+        bool applied = false;                  // A checkpoint switched to dir
+    };
+
+    // Background compactor. The mutex also guards stored_ against the
+    // compactor's reads outside the writer slot
+    struct Compactor {
+        mutable std::mutex mutex;
+        std::condition_variable wake;
+        std::thread thread;
+        bool stop = false;
+        CompactionOptions options;
+        CompactionStats stats;
+    };
+    std::unique_ptr<Compactor> compactor_;
+
+    DatabaseFile(const std::string& filepath, bool load_existing);
+
+    /**
+     * @brief Checkpoint through Database::checkpoint()
+     * @param rewrite_all Write every table into a new directory
+     * @param compacted Rewritten tables to switch over where still valid
+     * @param then Runs after the checkpoint, still in the writer slot
+     */
+    void checkpoint(bool rewrite_all, std::vector<CompactedTable>* compacted = nullptr,
+                    const std::function<void()>& then = nullptr);
+
+    /**
+     * @brief Write changed tables and commit a new catalog (runs with
+     * no transaction open)
+     */
+    void write_checkpoint(uint64_t lsn, bool rewrite_all,
+                          std::vector<CompactedTable>* compacted);
+
+    /**
+     * @brief Whether a stored table has enough dead bytes to rewrite
+     */
+    static bool worth_rewriting(const StoredTable& stored, const CompactionOptions& options);
+
+    /**
+     * @brief Write a snapshot into its fresh directory, throttled
+     * @return Compressed page bytes written
+     */
+    uint64_t rewrite_table(const CompactedTable& job, IoThrottle& throttle);
+
     /**
-     * @brief Serialize database to binary format and write to file
+     * @brief Background compactor body
      */
-    void write_to_file();
+    void compaction_loop();
 
     /**
-     * @brief Read database from binary file and deserialize
+     * @brief Load the catalog, attach tables lazily and replay the log
      */
     void read_from_file();
 
@@ -127,7 +304,7 @@ private:
      * @brief Get .db file header magic number
      */
     static constexpr uint32_t DB_MAGIC = 0x4C594244;  // "LYDB" in hex
-    static constexpr uint32_t DB_VERSION = 1;
+    static constexpr uint32_t DB_VERSION = 3;   // 3: checkpoint LSN + row group tables
 };
 
 } // namespace lyradb
@@ -12,19 +12,37 @@ namespace compression {
  * @brief Dictionary Compression
  * Optimal for string data or categorical data with limited unique values
  * 
+ * The dictionary is built with one hash lookup per value, and each value
+ * is stored as a bit-packed code of ceil(log2(num_entries)) bits (the
+ * BitpackingCompressor format, so codes unpack through its block kernels).
+ * An order-preserving dictionary is sorted, so codes compare exactly like
+ * the strings they stand for: range predicates and ORDER BY can run on
+ * the codes without looking at the strings.
+ * 
  * Format: 
- * - Dictionary header: [num_entries (4 bytes)]
- * - Dictionary entries: [key_len (2)] [key_bytes] [value_id (4)]
- * - Compressed data: [value_id (4)] for each value
+ * - Dictionary header: [num_entries (4 bytes)] [flags (1 byte, bit 0 = sorted)]
+ * - Dictionary entries: [key_len (4)] [key_bytes], in code order
+ * - Compressed data: BitpackingCompressor data of one code per value
  */
 class DictionaryCompressor {
 public:
+    /**
+     * @brief Dictionary-encoded values
+     */
+    struct Decoded {
+        std::vector<std::string> dictionary;   // Entry for each code
+        std::vector<uint32_t> codes;           // Code for each value
+        bool sorted = false;                   // Code order is string order
+    };
+    
     /**
      * @brief Compress data using dictionary encoding
      * Builds dictionary of unique values and replaces with IDs
+     * @param order_preserving Sort the dictionary so codes keep string order
      */
     static std::vector<uint8_t> compress(
-        const std::vector<std::string>& values);
+        const std::vector<std::string>& values,
+        bool order_preserving = false);
     
     /**
      * @brief Decompress dictionary-encoded data
@@ -33,6 +51,21 @@ public:
         const uint8_t* data, 
         size_t length);
     
+    /**
+     * @brief Decode the dictionary and the codes without expanding values
+     * @throws std::runtime_error on malformed data
+     */
+    static Decoded decode(
+        const uint8_t* data,
+        size_t length);
+    
+    /**
+     * @brief Build the dictionary and codes of a value array
+     */
+    static Decoded encode(
+        const std::vector<std::string>& values,
+        bool order_preserving = false);
+    
     /**
      * @brief Estimate compression benefit
      * Returns compression ratio (< 1.0 means beneficial)
@@ -49,21 +82,8 @@ public:
         double cardinality_threshold = 0.1);
 
 private:
-    /**
-     * @brief Dictionary entry in memory
-     */
-    struct DictEntry {
-        std::string key;
-        uint32_t id;
-        uint32_t frequency;  // For optimization
-    };
-    
-    /**
-     * @brief Build optimal dictionary
-     * Sorts entries by frequency for better compression
-     */
-    static std::vector<DictEntry> build_dictionary(
-        const std::vector<std::string>& values);
+    static constexpr uint8_t kSortedFlag = 0x01;
+    static constexpr size_t kHeaderSize = 4 + 1;
 };
 
 } // namespace compression
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "simd_kernels.h"
+#include "data_types.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -10,6 +12,13 @@
 namespace lyradb {
 
 // Forward declarations
+class Column;
+class Table;
+class Schema;
+class CompiledExpression;
+struct VectorBatch;
+struct RowRange;
+using SelectionVector = std::vector<uint32_t>;
 namespace query {
     class Expression;
     class BinaryExpr;
@@ -50,8 +59,8 @@ using RowData = std::unordered_map<std::string, ExpressionValue>;
  */
 class ExpressionEvaluator {
 public:
-    ExpressionEvaluator() = default;
-    ~ExpressionEvaluator() = default;
+    ExpressionEvaluator();
+    ~ExpressionEvaluator();
     
     /**
      * @brief Evaluate an expression for a single row
@@ -71,6 +80,71 @@ public:
         const query::Expression* expr,
         const std::vector<RowData>& rows);
     
+    /**
+     * @brief Evaluate an expression over typed column vectors
+     * @param expr The expression to evaluate
+     * @param batch Column vectors for one batch of rows
+     * @param selection Rows of the batch to evaluate
+     * @return One value per selection entry
+     */
+    std::vector<ExpressionValue> evaluate_batch(
+        const query::Expression* expr,
+        const VectorBatch& batch,
+        const SelectionVector& selection);
+    
+    /**
+     * @brief Filter a batch of typed column vectors with a predicate
+     * 
+     * Top-level AND conjuncts are applied one after another, each looking
+     * only at the rows that survived the previous one. Column-vs-constant
+     * comparisons run first since they are the cheapest to apply, and use
+     * the SIMD kernels selected by set_instruction_set().
+     * Conjuncts that cannot be compiled are interpreted row by row.
+     * 
+     * @param expr Predicate expression
+     * @param batch Column vectors for one batch of rows
+     * @param selection In: candidate rows; out: rows where expr is true
+     * @return Number of surviving rows
+     */
+    size_t filter_batch(
+        const query::Expression* expr,
+        const VectorBatch& batch,
+        SelectionVector& selection);
+    
+    /**
+     * @brief Row ranges that may satisfy a predicate, judged by zone maps
+     * 
+     * Each column-vs-constant conjunct is checked against the zone map of
+     * its column; pages whose min/max (or all-NULL state) rule the
+     * conjunct out are removed. Other conjuncts never prune anything.
+     * 
+     * @param expr Predicate expression
+     * @param batch Batch covering the rows to consider
+     * @param ranges Output: ascending, non-overlapping candidate ranges
+     */
+    void candidate_ranges(
+        const query::Expression* expr,
+        const VectorBatch& batch,
+        std::vector<RowRange>& ranges);
+    
+    /**
+     * @brief Candidate ranges of a predicate over a whole table: those of
+     * each stored row group, plus every row of the table's delta store
+     * (see add_delta_rows()). Judged by Table::zone_map(), so a lazy
+     * table loads no column
+     */
+    void candidate_ranges(
+        const query::Expression* expr,
+        const Table& table,
+        std::vector<RowRange>& ranges);
+    
+    /**
+     * @brief Choose the instruction set used by filter_batch kernels
+     * Defaults to the widest one the CPU supports; SCALAR disables SIMD.
+     */
+    void set_instruction_set(simd::InstructionSet isa) { instruction_set_ = isa; }
+    simd::InstructionSet get_instruction_set() const { return instruction_set_; }
+    
     /**
      * @brief Set context row for evaluation
      * @param row Row data to use as evaluation context
@@ -86,6 +160,26 @@ public:
 private:
     RowData context_row_;
     mutable std::string last_error_;
+    simd::InstructionSet instruction_set_;
+    
+    // Programs compiled for the last batch layout, reused across batches;
+    // columns a batch leaves unbound have no name, so nothing resolves to them
+    struct BatchPlan {
+        const query::Expression* expr = nullptr;
+        std::vector<std::string> names;                              // Column names and types the
+        std::vector<DataType> types;                                 // programs were compiled for
+        std::vector<const query::Expression*> conjuncts;
+        std::vector<std::unique_ptr<CompiledExpression>> programs;  // nullptr = interpreted
+    };
+    BatchPlan filter_plan_;
+    BatchPlan value_plan_;
+    
+    void prepare_batch_plan(BatchPlan& plan, const query::Expression* expr,
+                            const VectorBatch& batch, bool split_conjuncts);
+    void prepare_batch_plan(BatchPlan& plan, const query::Expression* expr,
+                            const Schema& schema, bool split_conjuncts);
+    void compile_batch_plan(BatchPlan& plan, bool split_conjuncts);
+    void load_batch_row(const VectorBatch& batch, size_t row, RowData& out) const;
     
     // Recursive evaluation methods
     ExpressionValue eval_binary(const query::BinaryExpr* expr, const RowData& row);
@@ -134,4 +228,24 @@ private:
     ExpressionValue func_coalesce(const std::vector<ExpressionValue>& args) const;
 };
 
+/**
+ * @brief Mark the columns an expression may read
+ * 
+ * Names are matched unqualified, so every column of that name is kept; the
+ * compiled and interpreted evaluators then resolve them as they would on
+ * whole rows.
+ * 
+ * @param col_names Column names by ordinal
+ * @param used In/out: set for each column read
+ */
+void collect_columns(const query::Expression* expr,
+                     const std::vector<std::string>& col_names,
+                     std::vector<bool>& used);
+
+/**
+ * @brief Columns of a table an expression may read, by ordinal
+ * (none for nullptr)
+ */
+std::vector<bool> referenced_columns(const query::Expression* expr, const Table& table);
+
 } // namespace lyradb
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace compression {
+
+/**
+ * @brief FSST (Fast Static Symbol Table) Compression
+ * Optimal for high-cardinality strings built from recurring substrings
+ * (URLs, e-mail addresses, log lines)
+ *
+ * A table of up to 255 symbols of 1-8 bytes is trained on a sample of the
+ * values, and every value is encoded on its own as one-byte codes for
+ * symbols; bytes no symbol covers are escaped (kEscape, then the literal
+ * byte). Unlike ZSTD, any single value decodes without touching the rest
+ * of the page: its codes are found through an offset array, and decoding
+ * is one table lookup and one 8-byte store per code.
+ *
+ * Training follows FSST: a few generations of encoding the sample with
+ * the current table, counting how often each symbol and each pair of
+ * adjacent symbols occurs, and keeping the 255 candidates with the
+ * highest gain (occurrences x length).
+ *
+ * Format:
+ * - Header: [num_values (4 bytes)] [num_symbols (1 byte)]
+ * - Symbol table: [length (1 byte)] per symbol, then the symbol bytes
+ * - Offsets: num_values + 1 x [code offset (4 bytes)]
+ * - Codes: the encoded values back to back
+ */
+class FsstCompressor {
+public:
+    /**
+     * @brief Random access over FSST data (does not copy it)
+     */
+    class Decoder {
+    public:
+        /**
+         * @throws std::runtime_error on malformed data
+         */
+        Decoder(const uint8_t* data, size_t length);
+
+        size_t size() const { return count_; }
+
+        /**
+         * @brief Decoded length of value index
+         */
+        size_t value_length(size_t index) const;
+
+        /**
+         * @brief Decode value index into out
+         * @param length value_length(index); out holds that many bytes
+         */
+        void decode_into(size_t index, char* out, size_t length) const;
+
+        std::string value(size_t index) const;
+
+    private:
+        uint64_t symbols_[256] = {0};   // Symbol bytes, little-endian
+        uint8_t lengths_[256] = {0};
+        const uint8_t* offsets_ = nullptr;
+        const uint8_t* codes_ = nullptr;
+        size_t codes_size_ = 0;
+        size_t count_ = 0;
+
+        void code_range(size_t index, size_t& begin, size_t& end) const;
+    };
+
+    /**
+     * @brief Train a symbol table on the values and encode each of them
+     */
+    static std::vector<uint8_t> compress(const std::vector<std::string>& values);
+
+    /**
+     * @brief Decompress all values
+     */
+    static std::vector<std::string> decompress(
+        const uint8_t* data,
+        size_t length);
+
+    /**
+     * @brief Estimate compression ratio from a trained sample
+     * Returns compression ratio (< 1.0 means beneficial)
+     */
+    static double estimate_compression_ratio(const std::vector<std::string>& values);
+
+    /**
+     * @brief Check if values are long enough for symbols to pay off
+     */
+    static bool is_suitable(const std::vector<std::string>& values);
+
+    static constexpr uint8_t kEscape = 255;
+
+private:
+    static constexpr size_t kMaxSymbols = 255;
+    static constexpr size_t kMaxSymbolLength = 8;
+    static constexpr size_t kSampleBytes = 16 * 1024;
+    static constexpr size_t kGenerations = 5;
+    static constexpr size_t kMinAverageLength = 8;
+
+    /**
+     * @brief Symbols in code order, indexed by first byte for encoding
+     */
+    struct SymbolTable {
+        std::vector<std::string> symbols;
+        uint64_t words[256] = {0};
+        std::vector<uint8_t> by_first[256];   // Codes, longest symbol first
+
+        explicit SymbolTable(std::vector<std::string> symbols);
+
+        /**
+         * @brief Longest symbol at p (rest bytes left); 0 if none matches
+         */
+        size_t match(const char* p, size_t rest, uint8_t& code) const;
+        void encode(const std::string& value, std::vector<uint8_t>& out) const;
+        size_t serialized_size() const;
+    };
+
+    static std::vector<const std::string*> sample(const std::vector<std::string>& values);
+    static SymbolTable train(const std::vector<const std::string*>& sample);
+};
+
+} // namespace compression
+} // namespace lyradb
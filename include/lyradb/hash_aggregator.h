@@ -0,0 +1,111 @@
+#pragma once
+
+#include "aggregation_functions.h"
+#include "expression_evaluator.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lyradb {
+
+class Table;
+class QueryExecutor;
+namespace query {
+    class Expression;
+}
+
+/**
+ * @brief One aggregate computed per group
+ */
+struct AggregateSpec {
+    AggregationFunction function = AggregationFunction::COUNT;
+    const query::Expression* argument = nullptr;  // nullptr for COUNT(*)
+};
+
+/**
+ * @brief Hash aggregation operator for GROUP BY and plain aggregates
+ *
+ * Rows are read straight from the typed table columns. Each row's group
+ * key is packed into a compact byte string (type tag + native value per
+ * key expression) and looked up in an open-addressed, linear-probing
+ * table; each group owns one fixed-size accumulator per aggregate that is
+ * updated in place, so input rows are never buffered per group.
+ *
+ * Aggregation is morsel-parallel: every participant slot builds a partial
+ * table over its morsels, and the partials are merged at the end. COUNT
+ * DISTINCT keeps its (group, value) pairs in a hash set of its own, which
+ * is merged the same way.
+ *
+ * Groups come out in order of their first input row, independent of the
+ * degree of parallelism. With no key expressions there is exactly one
+ * group, even for empty input (COUNT = 0, other aggregates NULL).
+ */
+class HashAggregator {
+public:
+    /**
+     * @brief Create an aggregation over a table
+     * @param table Source table (must outlive the aggregator)
+     * @param keys GROUP BY expressions
+     * @param aggregates Aggregates to compute per group
+     */
+    HashAggregator(const Table& table,
+                   std::vector<const query::Expression*> keys,
+                   std::vector<AggregateSpec> aggregates);
+    ~HashAggregator();
+
+    HashAggregator(const HashAggregator&) = delete;
+    HashAggregator& operator=(const HashAggregator&) = delete;
+
+    /**
+     * @brief Aggregate the given rows
+     * @param row_ids Input rows, ascending
+     * @param executor Supplies morsel size, parallelism and the scheduler
+     */
+    void consume(const std::vector<size_t>& row_ids, QueryExecutor& executor);
+
+    /**
+     * @brief Number of groups produced by consume()
+     */
+    size_t group_count() const { return group_count_; }
+
+    /**
+     * @brief Value of key expression k for a group
+     */
+    const ExpressionValue& key_value(size_t group, size_t k) const {
+        return key_values_[group * keys_.size() + k];
+    }
+
+    /**
+     * @brief Final value of aggregate a for a group
+     *
+     * COUNT and COUNT DISTINCT give int64; SUM gives int64 over integer
+     * input (double once any input is floating point or the sum
+     * overflows); AVG gives double; MIN/MAX keep the input type. Apart
+     * from the counts, aggregates over no non-NULL input are NULL.
+     */
+    const ExpressionValue& aggregate_value(size_t group, size_t a) const {
+        return aggregate_values_[group * aggregates_.size() + a];
+    }
+
+private:
+    struct Input;
+    struct Partial;
+
+    const Table& table_;
+    std::vector<const query::Expression*> keys_;
+    std::vector<AggregateSpec> aggregates_;
+    std::vector<Input> key_inputs_;
+    std::vector<Input> argument_inputs_;   // One per aggregate
+
+    size_t group_count_ = 0;
+    std::vector<ExpressionValue> key_values_;        // group-major
+    std::vector<ExpressionValue> aggregate_values_;  // group-major
+
+    void consume_rows(Partial& partial, const std::vector<size_t>& row_ids,
+                      size_t begin, size_t end);
+    void merge(Partial& into, Partial& from) const;
+    void finish(Partial& result);
+};
+
+} // namespace lyradb
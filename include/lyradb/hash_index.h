@@ -149,6 +149,37 @@ public:
         return removed;
     }
     
+    /**
+     * @brief Rewrite or drop every value in one pass over the table
+     * @param fn Called as fn(ValueType& value); returns false to drop it
+     * @return Number of values dropped
+     */
+    template <typename Fn>
+    size_t rewrite_values(Fn fn) {
+        size_t dropped = 0;
+        
+        for (auto& entry : table_) {
+            if (entry.values.empty() || entry.tombstone) {
+                continue;
+            }
+            size_t kept = 0;
+            for (size_t i = 0; i < entry.values.size(); ++i) {
+                if (fn(entry.values[i])) {
+                    entry.values[kept++] = std::move(entry.values[i]);
+                }
+            }
+            dropped += entry.values.size() - kept;
+            entry.values.erase(entry.values.begin() + kept, entry.values.end());
+            
+            if (entry.values.empty()) {
+                entry.tombstone = true;
+                size_--;
+            }
+        }
+        
+        return dropped;
+    }
+    
     /**
      * @brief Get all entries in the index
      * @return Vector of all (key, values) pairs
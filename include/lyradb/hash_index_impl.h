@@ -58,12 +58,39 @@ void remove_from_table_indexes(
     const std::string& table_name,
     const std::vector<size_t>& row_ids);
 
+/**
+ * @brief Renumber rows in all indexes on a table after Table::purge_deleted()
+ * @param table_name Table name
+ * @param remap Old row id -> new row id (Table::kPurgedRow drops the entry)
+ */
+void remap_table_indexes(
+    const std::string& table_name,
+    const std::vector<size_t>& remap);
+
 /**
  * @brief Clear all hash indexes for a table
  * @param table_name Table name
  */
 void clear_table_indexes(const std::string& table_name);
 
+/**
+ * @brief Hash and composite indexes taken off a table by detach_table_indexes()
+ */
+struct DetachedIndexes;
+
+/**
+ * @brief Remove all hash and composite indexes for a table, keeping them
+ * @param table_name Table name
+ * @return The removed indexes, for restore_table_indexes()
+ */
+std::shared_ptr<DetachedIndexes> detach_table_indexes(const std::string& table_name);
+
+/**
+ * @brief Put indexes removed by detach_table_indexes() back
+ * @param detached The removed indexes (may be null)
+ */
+void restore_table_indexes(const std::shared_ptr<DetachedIndexes>& detached);
+
 /**
  * @brief Build a multi-column (composite) hash index
  * @param index_name Index identifier
@@ -111,6 +138,16 @@ void remove_from_composite_table_indexes(
     const std::string& table_name,
     const std::vector<size_t>& row_ids);
 
+/**
+ * @brief Renumber rows in all composite indexes on a table after
+ * Table::purge_deleted()
+ * @param table_name Table name
+ * @param remap Old row id -> new row id (Table::kPurgedRow drops the entry)
+ */
+void remap_composite_table_indexes(
+    const std::string& table_name,
+    const std::vector<size_t>& remap);
+
 /**
  * @brief Clear all composite indexes for a table
  * @param table_name Table name
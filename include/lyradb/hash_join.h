@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace lyradb {
+
+class Table;
+class QueryExecutor;
+
+/**
+ * @brief Join flavours supported by HashJoin
+ *
+ * SEMI keeps left rows with at least one match, ANTI keeps left rows
+ * with none; both emit each left row at most once and no right side.
+ */
+enum class JoinKind {
+    INNER, LEFT, SEMI, ANTI
+};
+
+/**
+ * @brief Matching row pairs produced by a join
+ *
+ * Entries are positions in the left/right row lists passed to
+ * HashJoin::execute(), not table row ids. Pairs are ordered by left
+ * position, then right position. right is empty for SEMI/ANTI.
+ */
+struct JoinOutput {
+    std::vector<size_t> left;
+    std::vector<size_t> right;   // HashJoin::kNoMatch pads unmatched LEFT rows
+};
+
+/**
+ * @brief Radix-partitioned equi-join over typed table columns
+ *
+ * Both inputs are hashed on their key columns (typed: integer keys hash
+ * their int64 value, floats their normalized bits, strings their bytes)
+ * and scattered into 2^bits partitions by the top hash bits, with enough
+ * partitions that each build partition's hash table stays cache-resident.
+ * Partition pairs are then joined independently on the task scheduler:
+ * a chained table is built over the build partition and probed with the
+ * matching probe partition. Hashing and scattering are morsel-parallel.
+ *
+ * The smaller input is always the build side. When that is the left
+ * input, LEFT/SEMI/ANTI results come from per-row match flags on the
+ * build side instead of from the probe loop.
+ *
+ * NULL keys never match (SQL semantics), so such left rows only show up
+ * in LEFT and ANTI results.
+ */
+class HashJoin {
+public:
+    static constexpr size_t kNoMatch = std::numeric_limits<size_t>::max();
+
+    /**
+     * @brief Describe a join of left and right on pairwise-equal key columns
+     * @param left Left table
+     * @param left_keys Key column ordinals in the left table
+     * @param right Right table
+     * @param right_keys Key column ordinals in the right table (same count)
+     * @param kind Join flavour
+     */
+    HashJoin(const Table& left, std::vector<size_t> left_keys,
+             const Table& right, std::vector<size_t> right_keys,
+             JoinKind kind = JoinKind::INNER);
+    ~HashJoin();
+
+    /**
+     * @brief Join two row lists
+     * @param left_rows Left table row ids (kNoMatch counts as a NULL row)
+     * @param right_rows Right table row ids
+     * @param executor Supplies morsel size, parallelism and the scheduler
+     * @param output Matching position pairs
+     * @return Number of output rows
+     */
+    size_t execute(const std::vector<size_t>& left_rows,
+                   const std::vector<size_t>& right_rows,
+                   QueryExecutor& executor,
+                   JoinOutput& output);
+
+    // Statistics of the last execute()
+    bool built_on_left() const { return build_left_; }
+    size_t partition_count() const { return partition_count_; }
+
+private:
+    struct KeyColumn;
+    struct Side;
+
+    const Table& left_;
+    const Table& right_;
+    std::vector<KeyColumn> keys_;
+    JoinKind kind_;
+    bool build_left_ = false;
+    size_t partition_count_ = 0;
+
+    void partition(Side& side, size_t bits, QueryExecutor& executor) const;
+    bool hash_row(bool left_side, size_t row, uint64_t& hash) const;
+    bool keys_equal(size_t left_row, size_t right_row) const;
+};
+
+} // namespace lyradb
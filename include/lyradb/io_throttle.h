@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace lyradb {
+
+/**
+ * @brief Paces background writes to a byte rate
+ *
+ * Each acquire() reserves the next slot on a shared timeline, advancing
+ * it by bytes / rate, and sleeps until its slot starts. Writers sharing
+ * one throttle therefore get the rate between them, not each. A writer
+ * that has been idle does not bank credit beyond one second's worth, so
+ * a burst after a pause is still bounded. Thread-safe.
+ */
+class IoThrottle {
+public:
+    /**
+     * @param bytes_per_second Rate to hold (0 = unlimited)
+     */
+    explicit IoThrottle(uint64_t bytes_per_second = 0);
+
+    IoThrottle(const IoThrottle&) = delete;
+    IoThrottle& operator=(const IoThrottle&) = delete;
+
+    /**
+     * @brief Block until bytes may be written
+     */
+    void acquire(size_t bytes);
+
+    uint64_t bytes_per_second() const { return bytes_per_second_; }
+
+    /**
+     * @brief Bytes passed through acquire() so far
+     */
+    uint64_t bytes_acquired() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const uint64_t bytes_per_second_;
+    mutable std::mutex mutex_;
+    Clock::time_point next_;      // Start of the next free slot
+    uint64_t bytes_acquired_ = 0;
+};
+
+} // namespace lyradb
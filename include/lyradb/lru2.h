@@ -62,6 +62,36 @@ public:
         }
     }
     
+    /**
+     * @brief Oldest key accepted by can_evict (probation list first)
+     * @return false if no key qualifies
+     */
+    template<typename Predicate>
+    bool find_victim(Predicate can_evict, Key& victim) const {
+        for (const ListType* list : {&probation_, &protected_}) {
+            for (auto it = list->rbegin(); it != list->rend(); ++it) {
+                if (can_evict(*it)) {
+                    victim = *it;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    /**
+     * @brief Stop tracking a key
+     */
+    void erase(const Key& key) {
+        auto it = key_location_.find(key);
+        if (it == key_location_.end()) {
+            return;
+        }
+        auto [level, iter] = it->second;
+        (level == ProbationList ? probation_ : protected_).erase(iter);
+        key_location_.erase(it);
+    }
+    
     void clear() {
         probation_.clear();
         protected_.clear();
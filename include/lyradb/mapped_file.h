@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lyradb {
+namespace storage {
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Pages of the file are brought in by the OS on first touch, so mapping
+ * a large .lycol file costs nothing until its pages are read. The
+ * mapping is immutable and may be read from any thread.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Map a file read-only
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& filepath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& path() const { return filepath_; }
+
+private:
+    std::string filepath_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace storage
+} // namespace lyradb
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lyradb {
+namespace compression {
+
+/**
+ * @brief Patched Frame of Reference (PFOR) Compression
+ * Optimal for integer columns that are narrow except for rare outliers
+ *
+ * Plain bitpacking sizes every value for the widest one, so a single
+ * large ID or amount in a page widens the whole page. PFOR packs the low
+ * bit_width bits of every offset from a frame of reference and stores
+ * the few values that do not fit as exceptions: their positions and
+ * their high bits, patched in after the packed values are unpacked. The
+ * frame is the minimum, or a low quantile when a few small outliers
+ * would otherwise widen every value (offsets below it wrap around and
+ * become exceptions). The width is the one that minimizes the total
+ * size, so data without outliers simply gets no exceptions.
+ *
+ * PFOR-delta applies the same scheme to the differences between
+ * consecutive values (sorted IDs, timestamps); the encoder tries both and
+ * keeps the smaller.
+ *
+ * Format:
+ * - Header: [bit_width (1 byte)] [flags (1 byte, bit 0 = delta)]
+ *   [num_values (4 bytes)] [first_value (8 bytes)]
+ *   [packed_bytes (4 bytes)] [positions_bytes (4 bytes)]
+ * - Packed values: BitpackingCompressor data of base + low bits
+ *   (num_values - 1 deltas in delta mode, the first value is in the header)
+ * - Exception positions: BitpackingCompressor data
+ * - Exception high bits (value offset >> bit_width): BitpackingCompressor data
+ */
+class PforCompressor {
+public:
+    /**
+     * @brief Compress integer array using PFOR or PFOR-delta
+     * @param values Array of int64 values
+     */
+    static std::vector<uint8_t> compress(
+        const int64_t* values,
+        size_t count);
+
+    /**
+     * @brief Decompress PFOR data
+     */
+    static std::vector<int64_t> decompress(
+        const uint8_t* data,
+        size_t length);
+
+    /**
+     * @brief Number of values in PFOR data (0 if malformed)
+     */
+    static size_t value_count(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Decompress straight into a caller buffer
+     * @param out value_count() values
+     * @return Number of values written
+     */
+    static size_t decompress_into(const uint8_t* data, size_t length, int64_t* out);
+
+    /**
+     * @brief Estimate compression ratio
+     * Returns compression ratio (< 1.0 means beneficial)
+     */
+    static double estimate_compression_ratio(
+        const int64_t* values,
+        size_t count);
+
+private:
+    struct PforHeader {
+        uint8_t bit_width;          // Bits packed per value
+        uint8_t flags;              // kDeltaFlag
+        uint32_t num_values;        // Number of values
+        int64_t first_value;        // First value (delta mode)
+        uint32_t packed_bytes;      // Size of the packed values
+        uint32_t positions_bytes;   // Size of the exception positions
+
+        static constexpr size_t SIZE = 1 + 1 + 4 + 8 + 4 + 4;  // 22 bytes
+    };
+
+    static constexpr uint8_t kDeltaFlag = 0x01;
+
+    /// The alternative frame leaves the lowest 1/kExceptionQuantile values below it
+    static constexpr size_t kExceptionQuantile = 128;
+
+    /**
+     * @brief Encoding chosen for a value array
+     */
+    struct Plan {
+        bool delta = false;
+        int64_t base = 0;           // Frame of reference
+        uint8_t bit_width = 0;
+        size_t bytes = 0;           // Estimated encoded size
+    };
+
+    static Plan plan(const int64_t* values, size_t count);
+    static Plan plan_mode(const int64_t* values, size_t count, bool delta);
+    static Plan plan_frame(const int64_t* values, size_t count, bool delta, int64_t base);
+};
+
+} // namespace compression
+} // namespace lyradb
@@ -6,6 +6,7 @@
 #include <string>
 #include <chrono>
 #include <functional>
+#include <mutex>
 #include <set>
 
 namespace lyradb {
@@ -21,6 +22,7 @@ namespace lyradb {
  * - LRU eviction when cache is full
  * - Statistics tracking (hit ratio, evictions, memory usage)
  * - Selective invalidation on data mutations
+ * - Thread-safe
  * 
  * Usage:
  *   QueryCache cache(max_entries=1000, ttl_seconds=300);
@@ -152,6 +154,7 @@ private:
     void remove_expired_entries();
     
     // Cache storage
+    mutable std::mutex mutex_;
     CacheMap cache_data_;
     AccessOrder access_order_;  // For LRU tracking
     
@@ -5,6 +5,7 @@
 #include <string>
 #include <cstdint>
 #include <functional>
+#include <unordered_map>
 
 namespace lyradb {
 
@@ -13,6 +14,13 @@ class QueryResult;
 class QueryPlan;
 class Database;
 class Table;
+class ExpressionEvaluator;
+class TaskScheduler;
+struct VectorBatch;
+struct RowRange;
+namespace query {
+    class Expression;
+}
 namespace plan {
     class PlanNode;
 }
@@ -44,6 +52,74 @@ public:
      */
     void execute(const QueryPlan& plan);
     
+    /**
+     * @brief Vectorized filter over a whole table
+     * 
+     * Pages ruled out by the zone maps of the predicate's columns are
+     * skipped entirely. The rest is cut into morsels that run in parallel
+     * (see set_parallelism()), each scanned in batches of batch_size_
+     * rows. Each batch is a zero-copy view of the typed columns; the
+     * predicate narrows a selection vector conjunct by conjunct (see
+     * ExpressionEvaluator::filter_batch). Deleted rows never match.
+     * 
+     * @param table Table to scan
+     * @param predicate WHERE expression (nullptr = every live row)
+     * @param row_ids Output: ids of matching rows, ascending
+     * @return Number of matching rows
+     */
+    size_t filter_table(const Table& table,
+                        const query::Expression* predicate,
+                        std::vector<size_t>& row_ids);
+    
+    /**
+     * @brief Materialize table rows as strings, morsel-parallel
+     * @param table Source table
+     * @param row_ids Rows to project, in output order
+     * @param rows Output: rows[i] holds row row_ids[i]
+     */
+    void materialize_rows(const Table& table,
+                          const std::vector<size_t>& row_ids,
+                          std::vector<std::vector<std::string>>& rows);
+    
+    /**
+     * @brief Cut row ranges into morsels of morsel_size_ rows
+     */
+    std::vector<RowRange> make_morsels(const std::vector<RowRange>& ranges) const;
+    
+    /**
+     * @brief Run a task per morsel on the shared scheduler
+     * 
+     * fn(morsel, slot) is called once per morsel index; slot is below
+     * parallelism() and unique among concurrently running tasks, so it
+     * can index per-thread state such as evaluators or partial results.
+     * 
+     * @param num_morsels Number of morsels
+     * @param fn Task body
+     */
+    void run_morsels(size_t num_morsels,
+                     const std::function<void(size_t morsel, size_t slot)>& fn);
+    
+    /**
+     * @brief Set the degree of parallelism for this query
+     * @param dop Threads per operator (0 = all cores, 1 = single-threaded)
+     */
+    void set_parallelism(size_t dop);
+    
+    /**
+     * @brief Effective number of threads (upper bound on slot ids)
+     */
+    size_t parallelism() const;
+    
+    /**
+     * @brief Set rows per morsel (default: LYRADB_DEFAULT_MORSEL_SIZE)
+     */
+    void set_morsel_size(size_t rows);
+    
+    /**
+     * @brief Run morsels on a specific scheduler (default: TaskScheduler::global())
+     */
+    void set_scheduler(TaskScheduler* scheduler);
+    
     /**
      * @brief Set batch size for vectorized processing
      * @param size Number of rows per batch (default: 1024)
@@ -67,6 +143,10 @@ private:
     bool simd_enabled_;           // SIMD acceleration flag
     uint64_t rows_processed_;     // Total rows processed
     uint64_t batches_processed_;  // Total batches processed
+    uint64_t rows_pruned_;        // Rows skipped via zone maps
+    size_t parallelism_;          // Requested degree of parallelism (0 = all)
+    size_t morsel_size_;          // Rows per parallel task
+    TaskScheduler* scheduler_;    // Shared work-stealing pool
     Database* database_;          // Reference to database for table access
     
     // Execution context
@@ -167,13 +247,21 @@ private:
     
     /**
      * @brief PHASE 4.3: SIMD-optimized filter implementation
-     * @param data Input batch data
+     * 
+     * Narrows the selection of one batch. With SIMD enabled, column
+     * comparisons run on AVX-512 or AVX2 kernels picked by cpuid at
+     * runtime; otherwise the same predicate runs on scalar loops.
+     * 
+     * @param evaluator Evaluator holding the compiled predicate
+     * @param batch Column vectors for one batch of rows
      * @param predicate Filter condition
-     * @return Output batch with filtered rows
+     * @param selection In: candidate rows; out: matching rows
+     * @return Number of matching rows
      */
-    std::vector<std::vector<uint8_t>> simd_filter(
-        const std::vector<std::vector<uint8_t>>& data,
-        const std::string& predicate);
+    size_t simd_filter(ExpressionEvaluator& evaluator,
+                       const VectorBatch& batch,
+                       const query::Expression* predicate,
+                       std::vector<uint32_t>& selection);
     
     /**
      * @brief Vectorized sort implementation
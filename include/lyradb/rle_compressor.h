@@ -41,7 +41,9 @@ public:
         size_t length, 
         size_t value_size);
     
-private:
+    /**
+     * @brief One run of equal values
+     */
     struct RLESegment {
         uint32_t run_count;
         const uint8_t* value;
@@ -51,6 +53,9 @@ private:
         }
     };
     
+    /**
+     * @brief Split uncompressed data into its runs (values point into data)
+     */
     static std::vector<RLESegment> analyze_runs(
         const uint8_t* data, 
         size_t length, 
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lyradb {
+namespace simd {
+
+/**
+ * @brief Comparison evaluated by the filter kernels
+ * BETWEEN is inclusive on both ends: lo <= v && v <= hi.
+ */
+enum class CompareOp : uint8_t {
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    BETWEEN
+};
+
+/**
+ * @brief Instruction set a kernel runs on
+ */
+enum class InstructionSet : uint8_t {
+    SCALAR,
+    AVX2,
+    AVX512
+};
+
+/**
+ * @brief Widest instruction set supported by the CPU and the OS
+ *
+ * Probed once with cpuid/xgetbv and cached. Always SCALAR on non-x86
+ * targets or when LYRADB_ENABLE_SIMD is 0.
+ */
+InstructionSet detect_instruction_set();
+
+const char* instruction_set_name(InstructionSet isa);
+
+/**
+ * @brief Number of 64-bit mask words needed for n rows
+ */
+inline size_t mask_words(size_t n) { return (n + 63) / 64; }
+
+/**
+ * @brief Compare a value array against constants, producing a bitmask
+ *
+ * Bit i of the mask (word i / 64, bit i % 64) is set when values[i]
+ * satisfies the predicate; bits past n in the last word are cleared.
+ * `hi` is only used for BETWEEN. An instruction set the CPU does not
+ * support falls back to the best supported one.
+ *
+ * @param values Input values
+ * @param n Number of values
+ * @param op Comparison
+ * @param lo Constant (lower bound for BETWEEN)
+ * @param hi Upper bound for BETWEEN
+ * @param mask Output, mask_words(n) words
+ * @param isa Instruction set to use
+ */
+void compare(const int32_t* values, size_t n, CompareOp op, int32_t lo, int32_t hi,
+             uint64_t* mask, InstructionSet isa);
+void compare(const int64_t* values, size_t n, CompareOp op, int64_t lo, int64_t hi,
+             uint64_t* mask, InstructionSet isa);
+void compare(const float* values, size_t n, CompareOp op, float lo, float hi,
+             uint64_t* mask, InstructionSet isa);
+void compare(const double* values, size_t n, CompareOp op, double lo, double hi,
+             uint64_t* mask, InstructionSet isa);
+
+/**
+ * @brief Compare two value arrays element-wise: bit i = left[i] <op> right[i]
+ * @throws std::invalid_argument for BETWEEN
+ */
+void compare_columns(const int32_t* left, const int32_t* right, size_t n, CompareOp op,
+                     uint64_t* mask, InstructionSet isa);
+void compare_columns(const int64_t* left, const int64_t* right, size_t n, CompareOp op,
+                     uint64_t* mask, InstructionSet isa);
+void compare_columns(const float* left, const float* right, size_t n, CompareOp op,
+                     uint64_t* mask, InstructionSet isa);
+void compare_columns(const double* left, const double* right, size_t n, CompareOp op,
+                     uint64_t* mask, InstructionSet isa);
+
+/**
+ * @brief Expand a bitmask into ascending row positions
+ * @param mask Bitmask over n rows
+ * @param n Number of rows covered by the mask
+ * @param out Output positions (room for n entries)
+ * @return Number of positions written
+ */
+size_t mask_to_selection(const uint64_t* mask, size_t n, uint32_t* out);
+
+} // namespace simd
+} // namespace lyradb
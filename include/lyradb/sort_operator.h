@@ -0,0 +1,76 @@
+#pragma once
+
+#include "data_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+
+class QueryExecutor;
+namespace query {
+    class Expression;
+}
+
+/**
+ * @brief One ORDER BY key
+ */
+struct SortKeySpec {
+    const query::Expression* expression = nullptr;
+    bool descending = false;
+};
+
+/**
+ * @brief Builds memcmp-comparable sort keys
+ *
+ * Each value becomes a byte string whose unsigned lexicographic order is
+ * the SQL order of the values: a class byte (numbers, then strings, then
+ * NULL, so NULLs sort last ascending and first descending), followed by
+ * big-endian integers with the sign bit flipped, doubles mapped to
+ * order-preserving bits, or strings with 0x00 escaped as 0x00 0xFF and a
+ * 0x00 0x00 terminator. DESC keys are the bitwise complement. Keys of
+ * several columns are simply concatenated.
+ */
+class SortKeyEncoder {
+public:
+    static void encode_null(bool descending, std::string& out);
+    static void encode_int(int64_t value, bool descending, std::string& out);
+    static void encode_double(double value, bool descending, std::string& out);
+    static void encode_string(const std::string& value, bool descending, std::string& out);
+};
+
+/**
+ * @brief ORDER BY operator over materialized rows
+ *
+ * Sort expressions are evaluated once per row (morsel-parallel) and
+ * encoded into normalized keys; rows are then ordered by comparing an
+ * 8-byte key prefix, falling back to memcmp on ties. A full sort sorts
+ * one run per thread and merges runs pairwise in parallel; with a limit,
+ * every thread keeps a bounded heap of its best rows instead (Top-N).
+ * Equal keys keep their input order.
+ */
+class SortOperator {
+public:
+    explicit SortOperator(std::vector<SortKeySpec> keys);
+
+    /**
+     * @brief Compute the sorted order of rows
+     * @param rows Rows as strings ("" is NULL)
+     * @param col_names Column names of the rows
+     * @param col_types Column types, used to compare values natively
+     * @param limit Number of leading rows needed (0 = all)
+     * @param executor Supplies morsel size, parallelism and the scheduler
+     * @return Row indices in sorted order (at most limit of them)
+     */
+    std::vector<size_t> sort(const std::vector<std::vector<std::string>>& rows,
+                             const std::vector<std::string>& col_names,
+                             const std::vector<DataType>& col_types,
+                             size_t limit,
+                             QueryExecutor& executor) const;
+
+private:
+    std::vector<SortKeySpec> keys_;
+};
+
+} // namespace lyradb
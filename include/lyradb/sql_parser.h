@@ -146,13 +146,15 @@ public:
  */
 class AggregateExpr : public Expression {
 public:
-    AggregateExpr(AggregateFunc func, std::unique_ptr<Expression> arg = nullptr)
-        : aggregate_func(func), argument(std::move(arg)) {}
+    AggregateExpr(AggregateFunc func, std::unique_ptr<Expression> arg = nullptr,
+                  bool is_distinct = false)
+        : aggregate_func(func), argument(std::move(arg)), distinct(is_distinct) {}
     
     std::string to_string() const override;
     
     AggregateFunc aggregate_func;
     std::unique_ptr<Expression> argument;  // nullptr for COUNT(*)
+    bool distinct;                         // COUNT(DISTINCT x) etc.
 };
 
 /**
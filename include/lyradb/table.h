@@ -2,7 +2,12 @@
 
 #include "schema.h"
 #include "column.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include <variant>
@@ -11,12 +16,125 @@
 namespace lyradb {
 
 /**
- * @brief In-memory table representation with row storage
+ * @brief In-memory table representation with columnar storage
+ *
+ * Each column is held as native arrays (see Column), one per row group
+ * of kRowGroupRows rows; rows are only materialized as strings at the
+ * API boundary (scan_all/get_rows). Operators read the row groups in
+ * place through TableScan instead.
+ *
+ * snapshot() returns a frozen version sharing the row groups. They are
+ * copy-on-write one at a time: a write copies only the groups of the
+ * columns it changes that a snapshot still shares, so snapshots can be
+ * read from other threads while this table is written, and a version
+ * costs a pointer per row group. A version is freed with its last
+ * snapshot.
+ *
+ * A table opened from disk may be lazy: each column then starts as a
+ * loader and is decoded on its first access (thread-safe). Merging the
+ * delta store (below) into the row groups loads every remaining column.
+ *
+ * Row groups are also the unit of storage. Every write marks the groups
+ * it touched dirty, so a checkpoint only rewrites those (see
+ * DatabaseFile::save()). Tables built over existing columns, lazy or
+ * not, start clean.
+ *
+ * Deleting a row only sets its bit in the deletion vector of its row
+ * group: row ids stay stable (indexes keyed by row id remain valid) and
+ * scans skip deleted rows. row_count() is the physical row count, the
+ * bound of every row id. purge_deleted() later removes deleted rows and
+ * returns how surviving row ids moved.
+ *
+ * Writes are absorbed by a small row-oriented delta store in front of
+ * the row groups: inserted rows are appended to it in chunks of
+ * kDeltaChunkRows, updates of stored rows recorded per row group. Chunks
+ * and groups of updates are copy-on-write like the row groups, so a
+ * point write copies no row group and at most kDeltaChunkRows delta
+ * rows; a row group's updates are written into it once they reach
+ * kDeltaChunkRows. Row accessors (get_row,
+ * get_value, scan_all, get_rows) read the union directly, and so do
+ * scans (VectorBatch::scan_table): they read the stored row groups in
+ * place and copy only the batches the delta holds rows of. Column
+ * accessors see a merged contiguous column, built once per version on
+ * first access. The delta is merged once it holds kDeltaRows rows, and
+ * before purges and truncation: inserted rows fill the last row group
+ * and then new ones, updates are written into the groups they hit.
  */
 class Table {
 public:
+    /**
+     * @brief A column split into row groups, one Column per group; every
+     * group but the last holds kRowGroupRows rows
+     */
+    using RowGroups = std::vector<std::shared_ptr<Column>>;
+    
+    /**
+     * @brief Produces the row groups of a column of a lazy table on
+     * first access
+     */
+    using ColumnLoader = std::function<RowGroups()>;
+    
+    /**
+     * @brief Rows per storage row group (one .lycol page per column)
+     */
+    static constexpr size_t kRowGroupRows = 8192;
+    
+    /**
+     * @brief purge_deleted() mapping of a row that was removed
+     */
+    static constexpr size_t kPurgedRow = static_cast<size_t>(-1);
+    
+    /**
+     * @brief Delta store size (inserted plus updated rows) at which a
+     * write merges it into the row groups
+     */
+    static constexpr size_t kDeltaRows = 2048;
+    
+    /**
+     * @brief Inserted rows per delta store chunk, and updates of a row
+     * group kept in the delta store at most
+     */
+    static constexpr size_t kDeltaChunkRows = 64;
+    
     Table(const std::string& name, const Schema& schema);
     
+    /**
+     * @brief Build a table over existing columns (e.g. loaded from disk),
+     * split into row groups
+     * @throws std::runtime_error if the columns do not match the schema
+     * or have different lengths
+     */
+    Table(const std::string& name, const Schema& schema,
+          std::vector<std::shared_ptr<Column>> columns);
+    
+    /**
+     * @brief Build a lazy table whose columns are loaded on first access
+     * @param row_count Row count every loaded column must have
+     * @param loaders One loader per schema column
+     * @param zone_maps Per column, the zone map of each row group as
+     * stored, served by zone_map() until the column loads (empty = none)
+     */
+    Table(const std::string& name, const Schema& schema, size_t row_count,
+          std::vector<ColumnLoader> loaders,
+          std::vector<std::vector<indexes::ZoneMapIndex>> zone_maps = {});
+    
+    Table& operator=(const Table&) = delete;
+    
+    /**
+     * @brief Frozen copy of the current version (shares columns; lazy
+     * columns still load on first access)
+     *
+     * Taking a snapshot must not race with writes to this table; reading
+     * the snapshot afterwards may.
+     */
+    std::shared_ptr<Table> snapshot() const;
+    
+    /**
+     * @brief Make an earlier snapshot of this table current again (undo
+     * of purge_deleted()); every row group is marked dirty
+     */
+    void restore(const Table& version);
+    
     // Data manipulation
     void insert_row(const std::vector<void*>& values);
     void insert_row(const std::vector<std::string>& values);  // String-based insertion
@@ -25,20 +143,58 @@ public:
      * @brief Update a specific row with new values
      * @param row_index Zero-based index of the row to update
      * @param values New values for all columns in the row
-     * @throws std::runtime_error if row_index is out of bounds or values size mismatch
+     * @throws std::runtime_error if row_index is out of bounds, values size
+     * mismatch or a value is invalid (the row is then unchanged)
      */
     void update_row(size_t row_index, const std::vector<std::string>& values);
     
     /**
-     * @brief Delete rows by their indices
-     * @param row_indices Vector of row indices to delete (0-based)
-     * Indices are sorted in descending order to avoid index shifting issues
+     * @brief Fold the delta store into the row groups now
+     */
+    void merge_delta();
+    
+    /**
+     * @brief Rows inserted or updated in the delta store
+     */
+    size_t delta_row_count() const;
+    
+    /**
+     * @brief Mark rows deleted in their row groups' deletion vectors
+     * @param row_indices Row ids to delete; duplicates, out-of-range and
+     * already deleted ids are ignored
+     * @return Number of rows newly deleted
+     * Linear in the number of ids; columns are neither touched nor loaded
      */
-    void delete_rows(const std::vector<size_t>& row_indices);
+    size_t delete_rows(const std::vector<size_t>& row_indices);
     
+    /**
+     * @brief Clear the deleted mark of rows (undo of delete_rows)
+     */
+    void undelete_rows(const std::vector<size_t>& row_ids);
+    
+    /**
+     * @brief Physically remove deleted rows in one pass over the row
+     * groups of each column from the first deleted row on
+     * @return Old row id -> new row id (kPurgedRow for removed rows), one
+     * entry per row before the purge; empty if nothing was deleted
+     */
+    std::vector<size_t> purge_deleted();
+    
+    /**
+     * @brief Drop every row from row_count on (undo of inserts)
+     */
+    void truncate(size_t row_count);
+    
+    /**
+     * @brief Merge the delta, seal open pages and encode columns for scans
+     */
     void finalize();
     
     // Query operations
+    /**
+     * @brief Copy of every live row as strings (see TableScan for a lazy,
+     * zero-copy scan)
+     */
     std::vector<std::vector<std::string>> scan_all() const;
     std::vector<size_t> scan_with_filter(const std::string& column, 
                                          const std::string& op, 
@@ -49,22 +205,194 @@ public:
     const std::string& name() const { return name_; }
     const Schema& get_schema() const;
     std::shared_ptr<Column> get_column(const std::string& name);
-    std::shared_ptr<Column> get_column(size_t idx) { return columns_[idx]; }
+    std::shared_ptr<Column> get_column(size_t idx) { return loaded_column(idx); }
+    const Column& column(size_t idx) const { return *loaded_column(idx); }
+    
+    /**
+     * @brief Whether a column is in memory (always true for eager tables)
+     */
+    bool is_column_loaded(size_t idx) const;
     
-    size_t row_count() const { return rows_.size(); }
+    size_t row_count() const { return row_count_; }
     size_t column_count() const { return columns_.size(); }
     
+    // Stored row groups, without the delta store
+    /**
+     * @brief Rows held by the stored row groups; the rest are delta rows
+     */
+    size_t stored_row_count() const { return column_rows_; }
+    
+    /**
+     * @brief Row groups of stored_row_count() rows; the row group past
+     * them, if any, holds delta rows only
+     */
+    size_t stored_group_count() const {
+        return (column_rows_ + kRowGroupRows - 1) / kRowGroupRows;
+    }
+    
+    /**
+     * @brief A row group of a column as stored (its row r is table row
+     * group * kRowGroupRows + r), stale for the updated_rows()
+     */
+    const Column& stored(size_t idx, size_t group) const {
+        return *stored_groups(idx)[group];
+    }
+    
+    /**
+     * @brief Zone map of a stored row group, as stored(idx, group) has
+     * it; a lazy table answers from the zone maps it was opened with
+     * while the column is not loaded
+     */
+    const indexes::ZoneMapIndex& zone_map(size_t idx, size_t group) const;
+    
+    /**
+     * @brief Stored rows the delta store updates, ascending
+     */
+    std::vector<size_t> updated_rows() const;
+    
+    /**
+     * @brief Whether the delta store inserted or updated a row of [begin, end)
+     */
+    bool delta_overlaps(size_t begin, size_t end) const;
+    
+    /**
+     * @brief Rows [begin, end) of every column with the delta store
+     * applied, copied into columns of their own (row begin at index 0)
+     * @param bind Ordinals to copy (nullptr = all); the others are null
+     */
+    std::vector<std::shared_ptr<const Column>> delta_columns(
+        size_t begin, size_t end, const std::vector<bool>* bind = nullptr) const;
+    
+    /**
+     * @brief A row group of every column as scans read it: the stored
+     * groups, or their delta_columns() if the delta store holds one of
+     * their rows
+     */
+    std::vector<std::shared_ptr<const Column>> row_group(size_t group) const;
+    
+    // Deletion vectors
+    size_t deleted_count() const { return deleted_count_; }
+    size_t live_row_count() const { return row_count_ - deleted_count_; }
+    bool is_deleted(size_t row_id) const {
+        size_t group = row_id / kRowGroupRows;
+        if (group >= deletes_.size() || !deletes_[group]) {
+            return false;
+        }
+        size_t bit = row_id % kRowGroupRows;
+        return (deletes_[group]->bits[bit / 64] >> (bit % 64)) & 1;
+    }
+    
+    /**
+     * @brief Deletion vector of a row group (kRowGroupRows / 64 words,
+     * bit r set if row r of the group is deleted), or nullptr if the
+     * group has no deleted rows
+     */
+    const uint64_t* deleted_bits(size_t group) const;
+    
+    // Row groups
+    size_t row_group_count() const {
+        return (row_count_ + kRowGroupRows - 1) / kRowGroupRows;
+    }
+    
+    /**
+     * @brief Row groups written since the last clear_dirty(), ascending
+     *
+     * Deletes do not dirty a group's pages, only the table (the deletion
+     * vectors live in the manifest).
+     */
+    std::vector<size_t> dirty_row_groups() const;
+    bool is_dirty() const;
+    
+    /**
+     * @brief Forget dirty groups once they have been persisted
+     */
+    void clear_dirty() {
+        dirty_.clear();
+        deletes_dirty_ = false;
+    }
+    
     // Row accessors
-    const std::vector<std::vector<std::string>>& get_all_rows() const { return rows_; }
+    std::vector<std::vector<std::string>> get_all_rows() const { return scan_all(); }
+    std::vector<std::string> get_row(size_t row_id) const;
+    
+    /**
+     * @brief One value of a row as a string ("" is NULL); loads only that column
+     */
+    std::string get_value(size_t row_id, size_t col) const;
     
 private:
     std::string name_;
     Schema schema_;
-    std::vector<std::shared_ptr<Column>> columns_;
-    std::vector<std::vector<std::string>> rows_;  // In-memory row storage
+    std::vector<RowGroups> columns_;   // Slots of a lazy table stay empty
+    size_t row_count_ = 0;
+    size_t column_rows_ = 0;   // Rows held by the row groups; the rest are in the delta
+    
+    // Lazy tables: one slot per column holding its row groups, shared
+    // with snapshots. Also the merged columns of a version (no loader)
+    struct LazyColumn {
+        std::once_flag once;
+        std::atomic<bool> loaded{false};
+        ColumnLoader loader;
+        RowGroups groups;
+        std::vector<indexes::ZoneMapIndex> zones;   // Stored zone maps, per row group
+        std::shared_ptr<Column> column;   // Merged slots only
+    };
+    std::shared_ptr<LazyColumn[]> lazy_;
+    
+    // Rows written since the last merge, as canonical text (see
+    // Column::canonical_string()); chunks and row groups of updates are
+    // copy-on-write
+    using Row = std::vector<std::string>;
+    using DeltaChunk = std::vector<Row>;   // Up to kDeltaChunkRows rows
+    using DeltaUpdates = std::map<size_t, Row>;   // Stored row id -> row, ascending
+    std::vector<std::shared_ptr<DeltaChunk>> inserted_;   // Row ids from column_rows_ on
+    std::vector<std::shared_ptr<DeltaUpdates>> updates_;   // Per row group; null = none
+    size_t updated_count_ = 0;
+    
+    // Contiguous columns of this version, for the column accessors of a
+    // table with a delta or several row groups. Every write starts a new
+    // version with fresh slots; readers only fill them, so the writer and
+    // snapshot() callers may read a live table at the same time
+    std::shared_ptr<LazyColumn[]> merged_;
+    
+    std::vector<bool> dirty_;   // Per row group; groups past the end are clean
+    
+    // Per row group, copy-on-write like the columns; null = nothing deleted
+    struct DeletionVector {
+        std::vector<uint64_t> bits = std::vector<uint64_t>(kRowGroupRows / 64, 0);
+        size_t count = 0;
+    };
+    std::vector<std::shared_ptr<DeletionVector>> deletes_;
+    size_t deleted_count_ = 0;
+    bool deletes_dirty_ = false;
+    
+    Table(const Table&) = default;   // snapshot() only
+    
+    bool has_delta() const { return row_count_ > column_rows_ || updated_count_ > 0; }
+    bool needs_merge() const;
+    const std::shared_ptr<Column>& loaded_column(size_t idx) const;
+    const RowGroups& stored_groups(size_t idx) const;
+    std::shared_ptr<Column> merged_column(size_t idx) const;
+    Column& writable_group(size_t idx, size_t group);
+    Column& append_group(size_t idx);
+    DeltaChunk& writable_chunk(size_t chunk);
+    DeltaUpdates& writable_updates(size_t group);
+    const Row* delta_row(size_t row_id) const;
+    const Row& inserted_row(size_t row_id) const {
+        size_t k = row_id - column_rows_;
+        return (*inserted_[k / kDeltaChunkRows])[k % kDeltaChunkRows];
+    }
+    std::vector<std::string> canonical_row(const std::vector<std::string>& values) const;
+    void begin_write();
+    void fold_delta();
+    void fold_updates(size_t group);
+    void merge_if_full();
+    DeletionVector& writable_deletes(size_t group);
+    void clear_deleted(size_t first_row);
+    void load_all_columns();
+    void mark_dirty(size_t first_row, size_t end_row);
     
     // Helper methods
-    std::string convert_to_string(void* value, DataType type) const;
     bool matches_filter(const std::string& value, 
                        const std::string& op, 
                        const std::string& filter_value) const;
@@ -4,13 +4,16 @@
 #include <string>
 #include <vector>
 #include "storage_format.h"
+#include "zone_map.h"
 
 namespace lyradb {
 namespace storage {
 
 // Table file format constants
 constexpr uint32_t LYTA_MAGIC = 0x4154594C;  // "LYTA" in little-endian
-constexpr uint32_t LYTA_VERSION = 1;
+constexpr uint32_t LYTA_VERSION = 4;   // 2: schema block after column metadata
+                                       // 3: deletion vectors after the schema
+                                       // 4: zone maps after the deletion vectors
 
 // Table file header (32 bytes)
 struct TableFileHeader {
@@ -66,6 +69,9 @@ struct TableStatistics {
 struct TableManifest {
     TableFileHeader header;
     std::vector<TableColumnMetadata> column_metadata;
+    std::vector<uint64_t> deleted_rows;    // Row ids marked deleted, ascending
+    std::vector<std::vector<indexes::ZoneMapIndex>> zone_maps;   // Per column, one per row group;
+                                                                 // empty before version 4
     TableStatistics statistics;
     bool valid;
 };
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "expression_evaluator.h"
+#include "vector_batch.h"
+#include <cstddef>
+#include <vector>
+
+namespace lyradb {
+
+class Column;
+class Table;
+namespace query {
+    class Expression;
+}
+
+/**
+ * @brief Lazy cursor over the live rows of a table
+ *
+ * Each next() yields a zero-copy VectorBatch over the next run of rows
+ * together with the selection of rows in it that are live and satisfy
+ * the predicate. Nothing is materialized, and rows past the last batch
+ * pulled are never read, so a consumer that stops early (LIMIT) pays
+ * only for what it looked at. Pages the zone maps rule out are skipped
+ * as in QueryExecutor::filter_table.
+ *
+ * The table's delta store is never merged: batches read the stored row
+ * groups (a batch never spans two), except those covering a delta row,
+ * which read a copy of their own rows (see VectorBatch::scan_table).
+ *
+ * Batches bind the columns the predicate reads plus those the consumer
+ * asks for; on a lazily opened table no other column is loaded.
+ *
+ * The scan reads the table in place: the table must outlive it and must
+ * not be modified while it is open (scan a snapshot when writers run).
+ */
+class TableScan {
+public:
+    static constexpr size_t kBatchSize = 1024;
+
+    /**
+     * @param table Table to scan
+     * @param predicate Filter (nullptr = every live row)
+     * @param batch_size Rows covered per batch
+     * @param columns Ordinals the consumer reads from the batches
+     * (nullptr = all)
+     */
+    explicit TableScan(const Table& table,
+                       const query::Expression* predicate = nullptr,
+                       size_t batch_size = kBatchSize,
+                       const std::vector<bool>* columns = nullptr);
+
+    TableScan(const TableScan&) = delete;
+    TableScan& operator=(const TableScan&) = delete;
+
+    /**
+     * @brief Advance to the next batch with at least one selected row
+     * @param batch Output: view of the rows covered
+     * @param selection Output: selected offsets within the batch, ascending
+     * @return false once the table is exhausted
+     */
+    bool next(VectorBatch& batch, SelectionVector& selection);
+
+    /**
+     * @brief Rows covered by the batches produced so far
+     */
+    size_t rows_scanned() const { return rows_scanned_; }
+
+private:
+    const Table& table_;
+    const query::Expression* predicate_;
+    size_t batch_size_;
+    bool has_deletes_;
+    bool bind_all_;
+    std::vector<bool> bind_;               // Columns batches bind unless bind_all_
+    std::vector<const Column*> columns_;   // Stored row group group_
+    size_t group_ = static_cast<size_t>(-1);
+    std::vector<RowRange> ranges_;   // Zone-map candidates, ascending
+    size_t range_ = 0;               // Current entry of ranges_
+    size_t position_ = 0;            // Next row to scan
+    size_t rows_scanned_ = 0;
+    ExpressionEvaluator evaluator_;
+};
+
+} // namespace lyradb
@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <utility>
 #include "table_format.h"
 #include "column_serializer.h"
 #include "schema.h"
@@ -12,17 +14,35 @@ namespace lyradb {
 
 // Forward declarations
 class Table;
+class Column;
+class TaskScheduler;
+class IoThrottle;
 namespace storage {
 
 // Forward declarations
 class ColumnWriter;
 class ColumnReader;
+class TableReader;
 
 /**
  * @brief Writes a complete multi-column table to disk
  * 
  * Manages coordination between multiple ColumnWriter instances
  * and writes table-level manifest and metadata.
+ *
+ * Manifest (.lyta) layout: TableFileHeader, one TableColumnMetadata per
+ * column, a schema block (per column: name, type, nullable flag and the
+ * .lycol path relative to the manifest), the deletion vectors (u32 count
+ * of row groups with deleted rows, then per group its u32 index and
+ * Table::kRowGroupRows / 64 u64 words), the zone maps (per column, a u32
+ * row group count, then per group a u32 size and
+ * ZoneMapIndex::serialize() of its pages), then TableStatistics. Deleted
+ * rows stay in the column pages. Each
+ * column's column_file_size is the size of its .lycol file when this
+ * manifest was written, which pins the version the manifest refers to.
+ *
+ * Tables are stored in row groups of Table::kRowGroupRows rows: page g of
+ * every column file holds group g (Column::serialize_rows()).
  */
 class TableWriter {
 public:
@@ -36,6 +56,17 @@ public:
                 const Schema& schema,
                 const std::string& base_path = ".");
 
+    /**
+     * @brief Write a new version of a table already on disk
+     *
+     * The column files of base are appended to, so the new manifest must
+     * sit beside the base manifest. Row groups that write_row_groups()
+     * does not rewrite keep their existing pages.
+     * @param filepath Path of the new manifest (.lyta)
+     * @param base Reader over the previous version
+     */
+    TableWriter(const std::string& filepath, const TableReader& base);
+
     ~TableWriter();
 
     /**
@@ -52,6 +83,36 @@ public:
         uint64_t row_count,
         uint8_t compression_type);
 
+    /**
+     * @brief Write every row group of a table
+     *
+     * Pages are encoded (algorithm picked per page by CompressionSelector)
+     * and column files written in parallel.
+     *
+     * @param table Table to persist (schema must match)
+     * @param scheduler Pool to run on
+     */
+    void write_table(const Table& table, TaskScheduler& scheduler);
+
+    /**
+     * @brief Write the given row groups; carry the rest over from the base
+     *
+     * Groups the base does not have are always written and base groups
+     * past the table's end are dropped. Without a base every group is
+     * written.
+     * @param row_groups Groups that changed since the base was written
+     * @throws std::runtime_error if a carried group's row count changed
+     */
+    void write_row_groups(const Table& table, const std::vector<size_t>& row_groups,
+                          TaskScheduler& scheduler);
+
+    /**
+     * @brief Pace page writes through a throttle (nullptr = unthrottled)
+     *
+     * The throttle must outlive the writes.
+     */
+    void set_throttle(IoThrottle* throttle) { throttle_ = throttle; }
+
     /**
      * @brief Finalize table write
      * 
@@ -81,10 +142,18 @@ private:
     uint64_t total_rows_;
     bool finalized_;
     std::vector<TableColumnMetadata> column_metadata_;
+    std::mutex stats_mutex_;   // Guards total_rows_ during parallel writes
+    std::vector<std::vector<PageMetadata>> base_pages_;   // Per column, one per row group
+    std::vector<std::pair<uint32_t, std::vector<uint64_t>>> deletion_vectors_;   // Per group with deletes
+    std::vector<std::vector<indexes::ZoneMapIndex>> zone_maps_;   // Per column, one per row group
+    IoThrottle* throttle_ = nullptr;
 
     // Helper methods
     void initialize_column_writers();
     void write_table_manifest();
+    void record_column(uint32_t column_id, uint64_t row_count, uint32_t page_count,
+                       uint64_t original_bytes, uint64_t compressed_bytes,
+                       uint8_t compression_type);
     std::string get_column_filepath(uint32_t column_id) const;
 };
 
@@ -118,6 +187,37 @@ public:
     std::vector<std::vector<uint8_t>> read_column_pages(
         uint32_t column_id);
 
+    /**
+     * @brief Read one column written by TableWriter::write_table()
+     */
+    Column read_column(uint32_t column_id);
+
+    /**
+     * @brief Read the whole table, decoding columns in parallel
+     * @param scheduler Pool to run on
+     */
+    std::shared_ptr<Table> read_table(TaskScheduler& scheduler);
+
+    /**
+     * @brief Open the table lazily
+     *
+     * Only the manifest and page indexes have been read; each column is
+     * decoded from its mapped .lycol file on first access. Until then
+     * Table::zone_map() answers from the manifest's zone maps. The table
+     * stays valid after this reader is destroyed.
+     */
+    std::shared_ptr<Table> open_table();
+
+    /**
+     * @brief Reader of one column file, positioned at this version
+     */
+    const ColumnReader& column_reader(uint32_t column_id) const { return *readers_.at(column_id); }
+
+    /**
+     * @brief Table name recorded in the manifest statistics
+     */
+    const std::string& table_name() const { return statistics_.table_name; }
+
     /**
      * @brief Read rows by range
      * @param start_row Starting row index (0-based)
@@ -168,15 +268,20 @@ public:
 private:
     std::string filepath_;
     Schema schema_;
-    std::vector<std::unique_ptr<ColumnReader>> readers_;
+    std::vector<std::shared_ptr<ColumnReader>> readers_;
     TableManifest manifest_;
     TableStatistics statistics_;
     bool loaded_;
+    std::vector<std::string> column_files_;   // Relative to the manifest
 
     // Helper methods
     void load_table_manifest();
     void initialize_column_readers();
     std::string get_column_filepath(uint32_t column_id) const;
+    static Column decode_column(ColumnReader& reader, const ColumnDef& def);
+    static std::vector<std::shared_ptr<Column>> decode_row_groups(ColumnReader& reader,
+                                                                  const ColumnDef& def);
+    void apply_deletes(Table& table) const;
 };
 
 }  // namespace storage
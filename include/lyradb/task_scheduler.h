@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lyradb {
+
+/**
+ * @brief Shared work-stealing scheduler for intra-query parallelism
+ *
+ * A parallel_for() call is one job made of independent tasks (typically
+ * scan morsels). The tasks are dealt out in contiguous blocks to up to
+ * `dop` participants: the calling thread plus idle pool workers. Each
+ * participant drains its own block front to back and, once empty,
+ * steals from the back of the busiest remaining block, so skewed tasks
+ * still spread across all participants.
+ *
+ * The caller always participates, which keeps nested or concurrent
+ * parallel_for() calls deadlock-free even when every worker is busy:
+ * in the worst case the caller runs all of its tasks itself.
+ */
+class TaskScheduler {
+public:
+    /**
+     * @brief Task body: task index and participant slot in [0, dop)
+     *
+     * The slot is stable for the duration of the call and unique among
+     * concurrently running tasks, so it can index per-thread state.
+     */
+    using TaskFn = std::function<void(size_t task, size_t slot)>;
+
+    /**
+     * @brief Start a pool
+     * @param num_threads Worker threads (0 = hardware concurrency - 1)
+     */
+    explicit TaskScheduler(size_t num_threads = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * @brief Process-wide scheduler shared by all queries
+     */
+    static TaskScheduler& global();
+
+    /**
+     * @brief Number of threads that can run tasks (workers + caller)
+     */
+    size_t max_parallelism() const { return workers_.size() + 1; }
+
+    /**
+     * @brief Run fn for every task in [0, num_tasks) and wait for all of them
+     *
+     * The first exception thrown by a task is rethrown here once all
+     * running tasks have finished; remaining tasks are skipped.
+     *
+     * @param num_tasks Number of tasks
+     * @param dop Maximum participants (0 = max_parallelism())
+     * @param fn Task body
+     * @return Number of participant slots used (slots are < this value)
+     */
+    size_t parallel_for(size_t num_tasks, size_t dop, const TaskFn& fn);
+
+    /**
+     * @brief Tasks taken from another participant's block so far
+     */
+    size_t steal_count() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Job;
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::vector<Job*> jobs_;          // Jobs with free participant slots
+    bool stopping_ = false;
+    std::atomic<size_t> steals_{0};
+
+    void worker_loop();
+    void participate(Job& job, size_t slot);
+};
+
+} // namespace lyradb
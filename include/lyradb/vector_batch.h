@@ -0,0 +1,167 @@
+#pragma once
+
+#include "table.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace lyradb {
+
+/**
+ * @brief Row positions within a batch that are still live
+ * Entries are offsets relative to VectorBatch::offset, in ascending order.
+ */
+using SelectionVector = std::vector<uint32_t>;
+
+/**
+ * @brief Half-open run of table rows [begin, end)
+ */
+struct RowRange {
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+/**
+ * @brief Cut row ranges into morsels of at most morsel_rows rows
+ * Morsels are the unit of work handed to parallel scan tasks.
+ */
+inline std::vector<RowRange> split_morsels(const std::vector<RowRange>& ranges,
+                                           size_t morsel_rows) {
+    std::vector<RowRange> morsels;
+    for (const RowRange& range : ranges) {
+        for (size_t begin = range.begin; begin < range.end; begin += morsel_rows) {
+            size_t end = range.end - begin > morsel_rows ? begin + morsel_rows : range.end;
+            morsels.push_back(RowRange{begin, end});
+        }
+    }
+    return morsels;
+}
+
+/**
+ * @brief Zero-copy view of a run of consecutive rows across table columns
+ *
+ * A batch does not copy values: kernels read the native column arrays
+ * directly at positions offset - base + selection[k]. The one exception
+ * is a scan batch over rows of a table's delta store, which owns a copy
+ * of just its rows (base = offset).
+ *
+ * Scan batches may bind only the columns their reader needs; the others
+ * are null, so a lazily opened table never loads them.
+ */
+struct VectorBatch {
+    std::vector<const Column*> columns;  // Column per ordinal; null = not bound
+    size_t offset = 0;                   // First table row covered by the batch
+    size_t size = 0;                     // Number of rows covered
+    size_t base = 0;                     // Table row at index 0 of the columns
+    std::vector<std::shared_ptr<const Column>> owned;   // Columns of a delta batch
+
+    /**
+     * @brief Index of the first covered row in the columns
+     */
+    size_t position() const { return offset - base; }
+
+    /**
+     * @brief View rows [offset, offset + size) of every column of a table
+     * (merges the table's delta store; scans use scan_table())
+     */
+    static VectorBatch from_table(const Table& table, size_t offset, size_t size) {
+        VectorBatch batch;
+        batch.columns.reserve(table.column_count());
+        for (size_t i = 0; i < table.column_count(); ++i) {
+            batch.columns.push_back(&table.column(i));
+        }
+        batch.offset = offset;
+        batch.size = size;
+        return batch;
+    }
+
+    /**
+     * @brief View a stored row group of a table, the rows of the group
+     * below stored_row_count()
+     * Their zone maps are stale for updated rows (see add_delta_rows())
+     * @param bind Ordinals to bind (nullptr = all)
+     */
+    static VectorBatch from_stored(const Table& table, size_t group,
+                                   const std::vector<bool>* bind = nullptr) {
+        VectorBatch batch;
+        batch.columns.reserve(table.column_count());
+        for (size_t i = 0; i < table.column_count(); ++i) {
+            batch.columns.push_back(!bind || (*bind)[i] ? &table.stored(i, group) : nullptr);
+        }
+        batch.base = group * Table::kRowGroupRows;
+        batch.offset = batch.base;
+        batch.size = std::min(Table::kRowGroupRows, table.stored_row_count() - batch.base);
+        return batch;
+    }
+
+    /**
+     * @brief Rows [offset, offset + size) of a table as a scan reads them,
+     * cut short at the end of the row group of offset
+     *
+     * The stored row group is read in place unless the delta store holds
+     * one of the rows; the batch then owns a copy of these rows with the
+     * delta applied. The table's columns are never merged.
+     * @param bind Ordinals to bind (nullptr = all)
+     */
+    static VectorBatch scan_table(const Table& table, size_t offset, size_t size,
+                                  const std::vector<bool>* bind = nullptr) {
+        size = std::min(size, Table::kRowGroupRows - offset % Table::kRowGroupRows);
+        if (!table.delta_overlaps(offset, offset + size)) {
+            VectorBatch batch = from_stored(table, offset / Table::kRowGroupRows, bind);
+            batch.offset = offset;
+            batch.size = size;
+            return batch;
+        }
+        VectorBatch batch;
+        batch.owned = table.delta_columns(offset, offset + size, bind);
+        for (const auto& column : batch.owned) {
+            batch.columns.push_back(column.get());
+        }
+        batch.offset = offset;
+        batch.size = size;
+        batch.base = offset;
+        return batch;
+    }
+};
+
+/**
+ * @brief Add the rows of a table's delta store to zone-map candidates
+ * computed over its stored columns, which do not cover those rows
+ * @param ranges Ascending, non-overlapping; stays so
+ */
+inline void add_delta_rows(const Table& table, std::vector<RowRange>& ranges) {
+    size_t before = ranges.size();
+    for (size_t row : table.updated_rows()) {
+        ranges.push_back(RowRange{row, row + 1});
+    }
+    if (table.row_count() > table.stored_row_count()) {
+        ranges.push_back(RowRange{table.stored_row_count(), table.row_count()});
+    }
+    if (ranges.size() == before) {
+        return;
+    }
+    std::inplace_merge(ranges.begin(), ranges.begin() + before, ranges.end(),
+                       [](const RowRange& a, const RowRange& b) { return a.begin < b.begin; });
+    size_t out = 0;
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        if (ranges[i].begin <= ranges[out].end) {
+            ranges[out].end = std::max(ranges[out].end, ranges[i].end);
+        } else {
+            ranges[++out] = ranges[i];
+        }
+    }
+    ranges.resize(out + 1);
+}
+
+/**
+ * @brief Fill a selection vector with every row of a batch
+ */
+inline void select_all(SelectionVector& selection, size_t size) {
+    selection.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        selection[i] = static_cast<uint32_t>(i);
+    }
+}
+
+} // namespace lyradb
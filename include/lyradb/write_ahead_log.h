@@ -0,0 +1,161 @@
+#pragma once
+
+#include "schema.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+
+/**
+ * @brief Logical redo operation kinds
+ */
+enum class WalOp : uint8_t {
+    CREATE_TABLE = 1,
+    DROP_TABLE = 2,
+    INSERT = 3,
+    UPDATE = 4,
+    DELETE = 5,
+    PURGE = 6
+};
+
+/**
+ * @brief One logical redo record
+ *
+ * Fields used per op:
+ *   CREATE_TABLE  table, schema
+ *   DROP_TABLE    table
+ *   INSERT        table, values
+ *   UPDATE        table, row_ids[0], values (the full new row)
+ *   DELETE        table, row_ids (sorted, unique)
+ *   PURGE         table (deleted rows removed, later row ids renumbered)
+ */
+struct WalRecord {
+    WalOp op = WalOp::INSERT;
+    std::string table;
+    Schema schema;
+    std::vector<uint64_t> row_ids;
+    std::vector<std::string> values;
+};
+
+/**
+ * @brief A committed transaction read back from the log
+ */
+struct WalTransaction {
+    uint64_t lsn = 0;
+    std::vector<WalRecord> records;
+};
+
+/**
+ * @brief Write-ahead log counters
+ */
+struct WalStats {
+    uint64_t commits = 0;        // Transactions appended
+    uint64_t syncs = 0;          // fsync calls
+    uint64_t bytes_written = 0;
+};
+
+/**
+ * @brief Append-only redo log with group commit
+ *
+ * Each committed transaction is one frame: u32 payload length, u32 CRC32
+ * (over LSN and payload), u64 LSN, then the encoded records. Only
+ * committed work reaches the log, so recovery is redo-only.
+ *
+ * append() buffers a frame and returns its LSN; wait_durable() blocks
+ * until that LSN is on disk. The first waiter becomes the leader and
+ * writes and fsyncs everything buffered so far, including frames of
+ * transactions that arrived while it was waiting; the others sleep
+ * until a sync covers them. Many concurrent commits therefore share one
+ * fsync. Thread-safe.
+ *
+ * After a checkpoint has persisted everything up to some LSN the log is
+ * reset() to empty; LSNs keep counting from the checkpoint, which the
+ * owner passes back as base_lsn when it reopens the log.
+ */
+class WriteAheadLog {
+public:
+    /**
+     * @brief Open or create a log and read back its committed frames
+     *
+     * A torn or corrupt tail (crash during a write) is cut off.
+     * @param filepath Log file path
+     * @param commit_delay How long a leader waits for more commits to
+     *        join its sync (0 = sync immediately)
+     * @param base_lsn LSN covered by the last checkpoint: older frames
+     *        (left by a crash before reset()) are skipped
+     * @throws std::runtime_error if the file cannot be opened or is not a log
+     */
+    explicit WriteAheadLog(const std::string& filepath,
+                           std::chrono::microseconds commit_delay = std::chrono::microseconds(0),
+                           uint64_t base_lsn = 0);
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief Committed transactions found on open (moved out, call once)
+     */
+    std::vector<WalTransaction> take_recovered();
+
+    /**
+     * @brief Buffer a transaction's records
+     * @return LSN of the transaction
+     */
+    uint64_t append(const std::vector<WalRecord>& records);
+
+    /**
+     * @brief Block until every transaction up to lsn is on disk
+     * @throws std::runtime_error if a log write failed
+     */
+    void wait_durable(uint64_t lsn);
+
+    /**
+     * @brief append() + wait_durable()
+     */
+    uint64_t commit(const std::vector<WalRecord>& records);
+
+    /**
+     * @brief Empty the log once a checkpoint covers all of it
+     * @param checkpoint_lsn LSN the checkpoint covers; must be the last
+     *        appended LSN, and durable
+     * @throws std::runtime_error if commits past the checkpoint exist
+     */
+    void reset(uint64_t checkpoint_lsn);
+
+    uint64_t durable_lsn() const;
+    uint64_t last_lsn() const;
+    WalStats stats() const;
+    const std::string& path() const { return filepath_; }
+
+private:
+    std::string filepath_;
+    int fd_ = -1;
+    std::chrono::microseconds commit_delay_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable flushed_cv_;
+    std::vector<uint8_t> pending_;      // Frames not yet written
+    uint64_t appended_lsn_ = 0;
+    uint64_t durable_lsn_ = 0;
+    bool flushing_ = false;             // A leader is writing
+    std::string error_;                 // Set once a write fails
+    WalStats stats_;
+    std::vector<WalTransaction> recovered_;
+
+    void recover(uint64_t base_lsn);
+    void write_and_sync(const std::vector<uint8_t>& bytes);
+};
+
+/**
+ * @brief Flush a file to stable storage (on POSIX a directory also
+ * works, making renames inside it durable)
+ * @throws std::runtime_error if the file cannot be opened or synced
+ */
+void sync_file(const std::string& path);
+
+} // namespace lyradb
@@ -1,19 +1,99 @@
 #pragma once
 
+#include "data_types.h"
+#include "simd_kernels.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
 namespace lyradb {
 namespace indexes {
 
 /**
  * @brief Zone Map Index
  * Min/max values per page for range filtering
+ *
+ * One zone covers one column page: the sealed pages plus the open tail
+ * that is still receiving appends. Zones are maintained by Column as
+ * values are appended, updated or removed, and are persisted with the
+ * column so they need not be rebuilt on load.
+ *
+ * Bounds are kept in the comparison domain of the column type:
+ * integer types (and BOOL) as int64, FLOAT32/FLOAT64 as double, STRING
+ * as the lexicographic min/max. DECIMAL zones only track NULLs.
+ * Bounds stay conservative after updates (they may be wider than the
+ * values actually present), so pruning never drops a matching row.
  */
 class ZoneMapIndex {
 public:
+    struct Zone {
+        uint64_t first_row = 0;
+        uint32_t row_count = 0;
+        uint32_t null_count = 0;
+        bool has_values = false;   // At least one non-NULL, non-NaN value
+        bool has_nan = false;      // Floating point columns only
+        int64_t min_int = 0;
+        int64_t max_int = 0;
+        double min_double = 0.0;
+        double max_double = 0.0;
+        std::string min_string;
+        std::string max_string;
+    };
+
     ZoneMapIndex() = default;
-    
-    // TODO: Implement zone map functionality
-    // - Track min/max per page
-    // - Enable range predicate pushdown
+    explicit ZoneMapIndex(DataType type);
+
+    // Maintenance: values go to the open zone until seal() closes it
+    void add_value(const void* slot);          // Native fixed-width slot
+    void add_string(const std::string& value);
+    void add_null();
+    void seal();
+    void clear();
+
+    /**
+     * @brief Keep only the first count zones (all sealed)
+     */
+    void truncate(size_t count);
+
+    /**
+     * @brief Widen the zone holding row to include a new value
+     */
+    void widen(size_t row, const void* slot);
+    void widen_string(size_t row, const std::string& value);
+
+    /**
+     * @brief Account for row switching between NULL and non-NULL
+     */
+    void set_null(size_t row, bool is_null);
+
+    // Lookup
+    DataType type() const { return type_; }
+    size_t zone_count() const { return zones_.size(); }
+    const Zone& zone(size_t idx) const { return zones_[idx]; }
+    const std::vector<Zone>& zones() const { return zones_; }
+    size_t find_zone(uint64_t row) const;
+
+    /**
+     * @brief Whether any row of a zone could satisfy `column <op> lo`
+     * (lo <= column <= hi for BETWEEN). NULLs never match.
+     */
+    bool may_match(const Zone& zone, simd::CompareOp op, int64_t lo, int64_t hi) const;
+    bool may_match(const Zone& zone, simd::CompareOp op, double lo, double hi) const;
+    bool may_match(const Zone& zone, simd::CompareOp op,
+                   const std::string& lo, const std::string& hi) const;
+
+    // Serialization
+    std::vector<uint8_t> serialize() const;
+    static ZoneMapIndex deserialize(const uint8_t* data, size_t size);
+
+private:
+    DataType type_ = DataType::INT32;
+    std::vector<Zone> zones_;
+    bool open_ = false;    // zones_.back() is still receiving appends
+
+    Zone& open_zone();
+    void include(Zone& zone, const void* slot);
+    void include_string(Zone& zone, const std::string& value);
 };
 
 } // namespace indexes
@@ -307,11 +307,18 @@ lyra_errcode_t lyra_drop_index(lyra_db_t db, const char* index_name, char** errm
 
 /**
  * TRANSACTIONS
+ *
+ * Statements outside an explicit transaction commit individually.
+ * Committed transactions are written to "<path>.wal" and replayed by
+ * lyra_open; concurrent commits share one fsync. lyra_checkpoint saves
+ * the tables and empties the log.
  */
 
 /**
  * Begin transaction
  * 
+ * Blocks while another thread's transaction is active.
+ * 
  * @param db Database handle
  * @return LYRA_OK on success
  */
@@ -320,6 +327,8 @@ lyra_errcode_t lyra_begin(lyra_db_t db);
 /**
  * Commit transaction
  * 
+ * Returns once the transaction is durable in the write-ahead log.
+ * 
  * @param db Database handle
  * @return LYRA_OK on success
  */
@@ -333,6 +342,18 @@ lyra_errcode_t lyra_commit(lyra_db_t db);
  */
 lyra_errcode_t lyra_rollback(lyra_db_t db);
 
+/**
+ * Checkpoint: save the tables next to the database file and empty the
+ * write-ahead log, so the next lyra_open replays only later commits
+ * 
+ * Waits for the active transaction of another thread to finish; fails
+ * if the calling thread has one open.
+ * 
+ * @param db Database handle
+ * @return LYRA_OK on success
+ */
+lyra_errcode_t lyra_checkpoint(lyra_db_t db);
+
 /**
  * PREPARED STATEMENTS
  */
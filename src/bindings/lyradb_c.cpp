@@ -1,6 +1,8 @@
 #include "lyradb_c.h"
 #include "lyradb/database.h"
+#include "lyradb/database_file.h"
 #include "lyradb/query_execution_engine.h"
+#include "lyradb/write_ahead_log.h"
 #include <cstring>
 #include <map>
 #include <memory>
@@ -8,7 +10,8 @@
 
 // Handle management
 struct lyra_db_handle {
-    std::shared_ptr<lyradb::Database> db;
+    std::shared_ptr<lyradb::DatabaseFile> file;
+    std::shared_ptr<lyradb::Database> db;      // Owned by file
     std::string last_error;
 };
 
@@ -32,8 +35,12 @@ thread_local std::string g_last_error;
 
 lyra_db_t lyra_open(const char* path, char** errmsg) {
     try {
+        // Loads the last checkpoint, then replays the transactions
+        // committed to "<path>.wal" since
+        auto file = std::make_shared<lyradb::DatabaseFile>(path);
         auto handle = new lyra_db_handle();
-        handle->db = std::make_shared<lyradb::Database>(path);
+        handle->db = std::shared_ptr<lyradb::Database>(file, &file->get_database());
+        handle->file = std::move(file);
         return handle;
     } catch (const std::exception& e) {
         if (errmsg) {
@@ -476,30 +483,48 @@ lyra_errcode_t lyra_drop_index(lyra_db_t db, const char* index_name, char** errm
 
 lyra_errcode_t lyra_begin(lyra_db_t db) {
     if (!db) return LYRA_ERROR;
+    auto handle = static_cast<lyra_db_handle*>(db);
     try {
-        // TODO: Implement begin
+        handle->db->begin_transaction();
         return LYRA_OK;
-    } catch (...) {
+    } catch (const std::exception& e) {
+        handle->last_error = e.what();
         return LYRA_ERROR;
     }
 }
 
 lyra_errcode_t lyra_commit(lyra_db_t db) {
     if (!db) return LYRA_ERROR;
+    auto handle = static_cast<lyra_db_handle*>(db);
     try {
-        // TODO: Implement commit
+        handle->db->commit();
         return LYRA_OK;
-    } catch (...) {
+    } catch (const std::exception& e) {
+        handle->last_error = e.what();
         return LYRA_ERROR;
     }
 }
 
 lyra_errcode_t lyra_rollback(lyra_db_t db) {
     if (!db) return LYRA_ERROR;
+    auto handle = static_cast<lyra_db_handle*>(db);
     try {
-        // TODO: Implement rollback
+        handle->db->rollback();
         return LYRA_OK;
-    } catch (...) {
+    } catch (const std::exception& e) {
+        handle->last_error = e.what();
+        return LYRA_ERROR;
+    }
+}
+
+lyra_errcode_t lyra_checkpoint(lyra_db_t db) {
+    if (!db) return LYRA_ERROR;
+    auto handle = static_cast<lyra_db_handle*>(db);
+    try {
+        handle->file->save();
+        return LYRA_OK;
+    } catch (const std::exception& e) {
+        handle->last_error = e.what();
         return LYRA_ERROR;
     }
 }
@@ -1,55 +1,257 @@
 #include "lyradb/buffer_manager.h"
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 namespace lyradb {
 
+// ============================================================================
+// PageHandle
+// ============================================================================
+
+PageHandle& PageHandle::operator=(PageHandle&& other) noexcept {
+    if (this != &other) {
+        release();
+        owner_ = other.owner_;
+        page_id_ = other.page_id_;
+        data_ = other.data_;
+        other.owner_ = nullptr;
+        other.data_ = nullptr;
+    }
+    return *this;
+}
+
+void PageHandle::mark_dirty() {
+    if (owner_ && data_) {
+        owner_->mark_dirty(page_id_);
+    }
+}
+
+void PageHandle::release() {
+    if (owner_ && data_) {
+        owner_->unpin_page(page_id_);
+    }
+    owner_ = nullptr;
+    data_ = nullptr;
+}
+
+// ============================================================================
+// BufferManager
+// ============================================================================
+
 BufferManager::BufferManager(size_t pool_size, size_t page_size)
-    : pool_size_(pool_size), page_size_(page_size), lru2_(pool_size) {
-    buffer_pool_.resize(pool_size);
+    : pool_size_(pool_size), page_size_(page_size),
+      lru2_(std::max<size_t>(pool_size / std::max<size_t>(page_size, 1), 1)) {
+    if (page_size_ == 0) {
+        throw std::runtime_error("Page size must be positive");
+    }
+    size_t frame_count = std::max<size_t>(pool_size_ / page_size_, 1);
+    buffer_pool_.resize(frame_count * page_size_);
+    frames_.resize(frame_count);
+    free_frames_.reserve(frame_count);
+    for (size_t f = frame_count; f > 0; --f) {
+        free_frames_.push_back(f - 1);
+    }
 }
 
-PageHandle BufferManager::get_page(PageId page_id) {
-    auto it = page_map_.find(page_id);
-    if (it != page_map_.end()) {
-        lru2_.access(page_id);
-        return PageHandle(it->second);
+BufferManager::~BufferManager() {
+    try {
+        flush_all();
+    } catch (...) {
+        // Destructors must not throw; unflushed pages are lost
     }
-    
-    // Page not in memory, need to load from disk
-    // TODO: Implement disk I/O
-    throw std::runtime_error("Page not in buffer");
 }
 
-void BufferManager::pin_page(PageId page_id) {
-    auto it = pin_count_.find(page_id);
-    if (it != pin_count_.end()) {
-        it->second++;
-    } else {
-        pin_count_[page_id] = 1;
+uint32_t BufferManager::open_file(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < files_.size(); ++i) {
+        if (files_[i]->path == path) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+
+    auto entry = std::make_unique<File>();
+    entry->path = path;
+    entry->stream.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!entry->stream.is_open()) {
+        // Create the file, then reopen it for update
+        std::ofstream create(path, std::ios::binary);
+        create.close();
+        entry->stream.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    }
+    if (!entry->stream.is_open()) {
+        throw std::runtime_error("Cannot open page file: " + path);
     }
+    entry->stream.seekg(0, std::ios::end);
+    entry->disk_size = static_cast<uint64_t>(entry->stream.tellg());
+    entry->page_count = static_cast<uint32_t>((entry->disk_size + page_size_ - 1) / page_size_);
+    files_.push_back(std::move(entry));
+    return static_cast<uint32_t>(files_.size() - 1);
+}
+
+uint32_t BufferManager::page_count(uint32_t file_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file(file_id).page_count;
+}
+
+PageHandle BufferManager::allocate_page(uint32_t file_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    File& f = file(file_id);
+    PageId page_id = make_page_id(file_id, f.page_count);
+    size_t frame = take_frame();
+    ++f.page_count;
+    std::memset(frame_data(frame), 0, page_size_);
+    frames_[frame] = Frame{page_id, 1, true};
+    page_map_[page_id] = frame;
+    lru2_.access(page_id);
+    return PageHandle(this, page_id, frame_data(frame));
+}
+
+PageHandle BufferManager::get_page(PageId page_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t frame = fetch_frame(page_id, true);
+    ++frames_[frame].pin_count;
+    return PageHandle(this, page_id, frame_data(frame));
+}
+
+void BufferManager::pin_page(PageId page_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t frame = fetch_frame(page_id, true);
+    ++frames_[frame].pin_count;
 }
 
 void BufferManager::unpin_page(PageId page_id) {
-    auto it = pin_count_.find(page_id);
-    if (it != pin_count_.end() && it->second > 0) {
-        it->second--;
-        if (it->second == 0) {
-            pin_count_.erase(it);
-        }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = page_map_.find(page_id);
+    if (it != page_map_.end() && frames_[it->second].pin_count > 0) {
+        --frames_[it->second].pin_count;
     }
 }
 
 bool BufferManager::is_pinned(PageId page_id) const {
-    auto it = pin_count_.find(page_id);
-    return it != pin_count_.end() && it->second > 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = page_map_.find(page_id);
+    return it != page_map_.end() && frames_[it->second].pin_count > 0;
 }
 
 void BufferManager::mark_dirty(PageId page_id) {
-    dirty_pages_.insert(page_id);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = page_map_.find(page_id);
+    if (it == page_map_.end()) {
+        throw std::runtime_error("Page not in buffer");
+    }
+    frames_[it->second].dirty = true;
 }
 
 void BufferManager::flush_all() {
-    // TODO: Write all dirty pages to disk
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [page_id, frame] : page_map_) {
+        if (frames_[frame].dirty) {
+            write_page(frames_[frame], frame_data(frame));
+            frames_[frame].dirty = false;
+        }
+    }
+    for (auto& f : files_) {
+        f->stream.flush();
+    }
+}
+
+size_t BufferManager::num_pages() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return page_map_.size();
+}
+
+BufferStats BufferManager::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// Resident frame of a page, reading it in on a miss (caller holds mutex_)
+size_t BufferManager::fetch_frame(PageId page_id, bool load) {
+    auto it = page_map_.find(page_id);
+    if (it != page_map_.end()) {
+        ++stats_.hits;
+        lru2_.access(page_id);
+        return it->second;
+    }
+
+    if (page_of(page_id) >= file(file_of(page_id)).page_count) {
+        throw std::runtime_error("Page out of range");
+    }
+    ++stats_.misses;
+    size_t frame = take_frame();
+    if (load) {
+        read_page(page_id, frame_data(frame));
+    } else {
+        std::memset(frame_data(frame), 0, page_size_);
+    }
+    frames_[frame] = Frame{page_id, 0, false};
+    page_map_[page_id] = frame;
+    lru2_.access(page_id);
+    return frame;
+}
+
+// A free frame, evicting the coldest unpinned page if needed
+size_t BufferManager::take_frame() {
+    if (!free_frames_.empty()) {
+        size_t frame = free_frames_.back();
+        free_frames_.pop_back();
+        return frame;
+    }
+
+    PageId victim;
+    bool found = lru2_.find_victim([&](PageId page_id) {
+        return frames_[page_map_.at(page_id)].pin_count == 0;
+    }, victim);
+    if (!found) {
+        throw std::runtime_error("Buffer pool exhausted: all pages are pinned");
+    }
+
+    size_t frame = page_map_.at(victim);
+    if (frames_[frame].dirty) {
+        write_page(frames_[frame], frame_data(frame));
+    }
+    page_map_.erase(victim);
+    lru2_.erase(victim);
+    ++stats_.evictions;
+    return frame;
+}
+
+void BufferManager::read_page(PageId page_id, uint8_t* data) {
+    File& f = file(file_of(page_id));
+    uint64_t offset = static_cast<uint64_t>(page_of(page_id)) * page_size_;
+    size_t available = 0;
+    if (offset < f.disk_size) {
+        available = static_cast<size_t>(std::min<uint64_t>(page_size_, f.disk_size - offset));
+        f.stream.clear();
+        f.stream.seekg(static_cast<std::streamoff>(offset));
+        f.stream.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(available));
+        if (static_cast<size_t>(f.stream.gcount()) != available) {
+            throw std::runtime_error("Short read from page file: " + f.path);
+        }
+    }
+    // The tail of the last page (or an appended page) reads as zeros
+    std::memset(data + available, 0, page_size_ - available);
+}
+
+void BufferManager::write_page(const Frame& frame, const uint8_t* data) {
+    File& f = file(file_of(frame.page_id));
+    uint64_t offset = static_cast<uint64_t>(page_of(frame.page_id)) * page_size_;
+    f.stream.clear();
+    f.stream.seekp(static_cast<std::streamoff>(offset));
+    f.stream.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(page_size_));
+    if (!f.stream) {
+        throw std::runtime_error("Write to page file failed: " + f.path);
+    }
+    f.disk_size = std::max<uint64_t>(f.disk_size, offset + page_size_);
+    ++stats_.writebacks;
+}
+
+BufferManager::File& BufferManager::file(uint32_t file_id) const {
+    if (file_id >= files_.size()) {
+        throw std::runtime_error("Unknown page file id: " + std::to_string(file_id));
+    }
+    return *files_[file_id];
 }
 
 } // namespace lyradb
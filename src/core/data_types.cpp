@@ -103,4 +103,13 @@ bool NullBitmap::is_null(size_t idx) const {
     return (bitmap_[byte_idx] & (1 << bit_idx)) != 0;
 }
 
+void NullBitmap::resize(size_t capacity) {
+    size_t old_bytes = bitmap_.size();
+    bitmap_.resize((capacity + 7) / 8, 0);
+    // Clear stale bits past the new end so regrowth starts not-null
+    if (capacity % 8 != 0 && bitmap_.size() <= old_bytes) {
+        bitmap_.back() &= static_cast<uint8_t>((1u << (capacity % 8)) - 1);
+    }
+}
+
 } // namespace lyradb
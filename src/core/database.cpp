@@ -3,13 +3,24 @@
 #include "lyradb/query_execution_engine.h"
 #include "lyradb/sql_parser.h"
 #include "lyradb/expression_evaluator.h"
+#include "lyradb/compiled_expression.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/vector_batch.h"
+#include "lyradb/table_scan.h"
+#include "lyradb/hash_aggregator.h"
+#include "lyradb/hash_join.h"
+#include "lyradb/sort_operator.h"
 #include "lyradb/hash_index_impl.h"
 #include "lyradb/b_tree_impl.h"
+#include "lyradb/write_ahead_log.h"
+#include "lyradb/task_scheduler.h"
 #include <stdexcept>
 #include <memory>
 #include <map>
 #include <unordered_map>
 #include <algorithm>
+#include <charconv>
+#include <numeric>
 
 namespace lyradb {
 
@@ -68,120 +79,393 @@ static bool is_pushdown_compatible(
 // ============================================================================
 
 /**
- * @brief Extract join key columns from a join condition
+ * @brief One table taking part in a join pipeline
  * 
- * For equality conditions like table1.col = table2.col, extracts:
- * - left_key: the column from the left table
- * - right_key: the column from the right table
+ * Joined rows are kept as one row-id list per table until the final
+ * projection: rows[i] is this table's row in output row i, with
+ * HashJoin::kNoMatch standing for the NULL padding of an outer join.
+ */
+struct JoinSource {
+    const Table* table;
+    std::vector<std::string> names;   // Table name and alias for qualified columns
+    std::vector<size_t> rows;
+};
+
+// Helper: Whether a column reference can name a column of a table
+static bool refers_to(const query::ColumnRefExpr* col_ref,
+                      const std::vector<std::string>& names,
+                      const Table& table) {
+    if (!col_ref->table_name.empty() &&
+        std::find(names.begin(), names.end(), col_ref->table_name) == names.end()) {
+        return false;
+    }
+    return table.get_schema().find_column(col_ref->column_name) != nullptr;
+}
+
+/**
+ * @brief Extract hash join keys from a join condition
  * 
- * Returns true if extraction was successful, false otherwise
+ * The condition must be a conjunction of column = column equalities, each
+ * relating a column of one earlier source table to a column of the joined
+ * table (either way round; qualified names pick the table, otherwise the
+ * left operand is taken from the earlier tables). All left-hand columns
+ * must belong to the same source.
+ * 
+ * Returns false if the condition needs the nested loop join.
  */
-static bool extract_join_keys_from_condition(
-    const query::Expression* condition,
-    std::vector<std::string>& left_keys,
-    std::vector<std::string>& right_keys) {
-    
-    if (!condition) return false;
-    
+static bool resolve_join_keys(const query::Expression* condition,
+                              const std::vector<JoinSource>& sources,
+                              const Table& join_table,
+                              const std::vector<std::string>& join_names,
+                              size_t& source,
+                              std::vector<size_t>& left_keys,
+                              std::vector<size_t>& right_keys) {
     auto binary = dynamic_cast<const query::BinaryExpr*>(condition);
     if (!binary) return false;
     
-    // Handle AND expressions - extract keys from all equality conditions
+    // AND expressions: every conjunct must be an equi-join key
     if (binary->op == query::BinaryOp::AND) {
-        bool left_extracted = extract_join_keys_from_condition(
-            binary->left.get(), left_keys, right_keys);
-        bool right_extracted = extract_join_keys_from_condition(
-            binary->right.get(), left_keys, right_keys);
-        return left_extracted || right_extracted;
+        return resolve_join_keys(binary->left.get(), sources, join_table, join_names,
+                                 source, left_keys, right_keys) &&
+               resolve_join_keys(binary->right.get(), sources, join_table, join_names,
+                                 source, left_keys, right_keys);
     }
+    if (binary->op != query::BinaryOp::EQUAL) return false;
     
-    // Handle equality conditions: column = column
-    if (binary->op == query::BinaryOp::EQUAL) {
-        auto left_col = dynamic_cast<const query::ColumnRefExpr*>(binary->left.get());
-        auto right_col = dynamic_cast<const query::ColumnRefExpr*>(binary->right.get());
-        
-        if (left_col && right_col) {
-            // Both sides are column references - extract them
-            left_keys.push_back(left_col->column_name);
-            right_keys.push_back(right_col->column_name);
-            return true;
+    auto left_col = dynamic_cast<const query::ColumnRefExpr*>(binary->left.get());
+    auto right_col = dynamic_cast<const query::ColumnRefExpr*>(binary->right.get());
+    if (!left_col || !right_col) return false;
+    
+    auto find_source = [&](const query::ColumnRefExpr* col_ref) {
+        for (size_t s = 0; s < sources.size(); ++s) {
+            if (refers_to(col_ref, sources[s].names, *sources[s].table)) {
+                return static_cast<int>(s);
+            }
         }
-    }
+        return -1;
+    };
     
-    return false;
+    const query::ColumnRefExpr* earlier = left_col;
+    const query::ColumnRefExpr* joined = right_col;
+    int s = find_source(left_col);
+    if (s < 0 || !refers_to(right_col, join_names, join_table)) {
+        earlier = right_col;
+        joined = left_col;
+        s = find_source(right_col);
+        if (s < 0 || !refers_to(left_col, join_names, join_table)) {
+            return false;
+        }
+    }
+    if (!left_keys.empty() && static_cast<size_t>(s) != source) {
+        return false;
+    }
+    source = static_cast<size_t>(s);
+    left_keys.push_back(sources[source].table->get_schema().column_index(earlier->column_name));
+    right_keys.push_back(join_table.get_schema().column_index(joined->column_name));
+    return true;
+}
+
+// Helper: Source and table column of an ordinal of the concatenated
+// schemas of all sources
+static std::pair<size_t, size_t> locate_column(const std::vector<JoinSource>& sources,
+                                               size_t col) {
+    size_t s = 0;
+    while (col >= sources[s].table->column_count()) {
+        col -= sources[s].table->column_count();
+        ++s;
+    }
+    return {s, col};
+}
+
+// Helper: Materialize some columns of the joined rows as strings,
+// morsel-parallel. columns are ordinals of the concatenated schemas of
+// all sources; rows[i] holds them in that order for output row i.
+static void gather_columns(const std::vector<JoinSource>& sources,
+                           const std::vector<size_t>& columns,
+                           QueryExecutor& executor,
+                           std::vector<std::vector<std::string>>& rows) {
+    std::vector<std::pair<size_t, size_t>> where;
+    where.reserve(columns.size());
+    for (size_t col : columns) {
+        where.push_back(locate_column(sources, col));
+    }
+    rows.assign(sources.front().rows.size(), {});
+    auto morsels = executor.make_morsels({RowRange{0, rows.size()}});
+    executor.run_morsels(morsels.size(), [&](size_t m, size_t) {
+        for (size_t i = morsels[m].begin; i < morsels[m].end; ++i) {
+            auto& row = rows[i];
+            row.reserve(where.size());
+            for (const auto& [s, col] : where) {
+                size_t row_id = sources[s].rows[i];
+                // kNoMatch is the NULL padding of an outer join
+                row.push_back(row_id == HashJoin::kNoMatch
+                                  ? std::string()
+                                  : sources[s].table->get_value(row_id, col));
+            }
+        }
+    });
 }
 
-// Helper: Extract join key value from row data
-static std::string extract_join_key(const std::vector<std::string>& row, 
-                                     const Schema& schema, 
-                                     const std::string& key_column) {
-    for (size_t i = 0; i < schema.num_columns() && i < row.size(); ++i) {
-        if (schema.get_column(i).name == key_column) {
-            return row[i];
+// Helper: Ordinals marked in used, with their names and types
+static std::vector<size_t> used_columns(const std::vector<bool>& used,
+                                        const std::vector<std::string>& col_names,
+                                        const std::vector<DataType>& col_types,
+                                        std::vector<std::string>& names,
+                                        std::vector<DataType>& types) {
+    std::vector<size_t> columns;
+    names.clear();
+    types.clear();
+    for (size_t i = 0; i < used.size(); ++i) {
+        if (used[i]) {
+            columns.push_back(i);
+            names.push_back(col_names[i]);
+            types.push_back(col_types[i]);
         }
     }
-    return "";
+    return columns;
 }
 
-// Helper: Extract all join keys from a row
-static std::string extract_join_keys(const std::vector<std::string>& row,
-                                      const Schema& schema,
-                                      const std::vector<std::string>& join_keys) {
-    std::string combined_key;
-    for (const auto& key : join_keys) {
-        for (size_t i = 0; i < schema.num_columns() && i < row.size(); ++i) {
-            if (schema.get_column(i).name == key) {
-                if (!combined_key.empty()) combined_key += "|";
-                combined_key += row[i];
-                break;
+// Helper: Sorted order of rows by the ORDER BY list
+// (normalized keys; with LIMIT only the leading rows are ordered)
+static std::vector<size_t> order_rows(const query::SelectStatement& stmt,
+                                      const std::vector<std::vector<std::string>>& rows,
+                                      const std::vector<std::string>& col_names,
+                                      const std::vector<DataType>& col_types,
+                                      QueryExecutor& executor) {
+    std::vector<SortKeySpec> sort_keys;
+    for (const auto& sort_key : stmt.order_by_list) {
+        sort_keys.push_back({sort_key.expression.get(),
+                             sort_key.direction == query::SortDirection::DESC});
+    }
+    size_t needed = 0;
+    if (stmt.limit > 0) {
+        needed = static_cast<size_t>(stmt.limit) +
+                 static_cast<size_t>(std::max<int64_t>(stmt.offset, 0));
+    }
+    return SortOperator(std::move(sort_keys)).sort(rows, col_names, col_types, needed, executor);
+}
+
+// Helper: The [begin, end) slice of n rows LIMIT and OFFSET keep
+static std::pair<size_t, size_t> limit_range(const query::SelectStatement& stmt, size_t n) {
+    size_t begin = std::min(static_cast<size_t>(std::max<int64_t>(stmt.offset, 0)), n);
+    size_t end = n;
+    if (stmt.limit > 0 && static_cast<size_t>(stmt.limit) < end - begin) {
+        end = begin + static_cast<size_t>(stmt.limit);
+    }
+    return {begin, end};
+}
+
+// Helper: A value read straight from a column array, so the evaluator
+// sees native numbers instead of re-parsing strings
+static ExpressionValue typed_value(const Column& col, size_t row) {
+    if (col.is_null(row)) {
+        return nullptr;
+    }
+    switch (col.type()) {
+        case DataType::INT32:
+        case DataType::DATE32:
+            return static_cast<int64_t>(col.data<int32_t>()[row]);
+        case DataType::INT64:
+        case DataType::TIMESTAMP:
+            return col.data<int64_t>()[row];
+        case DataType::FLOAT32:
+            return static_cast<double>(col.data<float>()[row]);
+        case DataType::FLOAT64:
+            return col.data<double>()[row];
+        case DataType::BOOL:
+            return col.data<uint8_t>()[row] != 0;
+        default:
+            return col.string_at(row);
+    }
+}
+
+// Helper: Load a row's typed values straight from its row group (or a
+// copy of the row if the delta store holds it)
+static void load_row_data(const Table& table, size_t row, RowData& row_data) {
+    const Schema& schema = table.get_schema();
+    if (table.delta_overlaps(row, row + 1)) {
+        auto columns = table.delta_columns(row, row + 1);
+        for (size_t i = 0; i < schema.num_columns(); ++i) {
+            row_data[schema.get_column(i).name] = typed_value(*columns[i], 0);
+        }
+        return;
+    }
+    size_t group = row / Table::kRowGroupRows;
+    for (size_t i = 0; i < schema.num_columns(); ++i) {
+        row_data[schema.get_column(i).name] =
+            typed_value(table.stored(i, group), row % Table::kRowGroupRows);
+    }
+}
+
+// ============================================================================
+// Hash Aggregation
+// ============================================================================
+
+// Helper: Collect the distinct aggregate calls of an expression tree
+static void collect_aggregates(const query::Expression* expr,
+                               std::vector<const query::AggregateExpr*>& aggregates) {
+    if (!expr) {
+        return;
+    }
+    if (auto agg = dynamic_cast<const query::AggregateExpr*>(expr)) {
+        std::string text = agg->to_string();
+        for (const auto* seen : aggregates) {
+            if (seen->to_string() == text) {
+                return;
             }
         }
+        aggregates.push_back(agg);
+    } else if (auto binary = dynamic_cast<const query::BinaryExpr*>(expr)) {
+        collect_aggregates(binary->left.get(), aggregates);
+        collect_aggregates(binary->right.get(), aggregates);
+    } else if (auto unary = dynamic_cast<const query::UnaryExpr*>(expr)) {
+        collect_aggregates(unary->operand.get(), aggregates);
+    } else if (auto func = dynamic_cast<const query::FunctionExpr*>(expr)) {
+        for (const auto& arg : func->arguments) {
+            collect_aggregates(arg.get(), aggregates);
+        }
+    }
+}
+
+// Helper: Output column name of a SELECT list expression
+static std::string output_name(const query::Expression* expr) {
+    if (auto col_ref = dynamic_cast<const query::ColumnRefExpr*>(expr)) {
+        return col_ref->column_name;
+    }
+    return expr->to_string();
+}
+
+// Helper: Render a computed value in the string row format ("" is NULL)
+static std::string format_value(const ExpressionValue& value) {
+    if (auto i = std::get_if<int64_t>(&value)) {
+        return std::to_string(*i);
+    }
+    if (auto d = std::get_if<double>(&value)) {
+        char buf[32];
+        auto res = std::to_chars(buf, buf + sizeof(buf), *d);
+        return std::string(buf, res.ptr);
+    }
+    if (auto s = std::get_if<std::string>(&value)) {
+        return *s;
     }
-    return combined_key;
+    if (auto b = std::get_if<bool>(&value)) {
+        return *b ? "true" : "false";
+    }
+    return "";
 }
 
-// Perform hash join between two sets of rows
-static std::vector<std::vector<std::string>> hash_join(
-    const std::vector<std::vector<std::string>>& left_rows,
-    const Schema& left_schema,
-    const std::vector<std::vector<std::string>>& right_rows,
-    const Schema& right_schema,
-    const std::vector<std::string>& left_join_keys,
-    const std::vector<std::string>& right_join_keys,
-    bool is_left_join = false) {
+// Helper: Run GROUP BY / aggregates over the filtered rows of a table.
+// Returns one row per group holding the SELECT list (the grouping keys for
+// SELECT *); HAVING is evaluated against the aggregated values. The output
+// column types are inferred from the computed values.
+static std::vector<std::vector<std::string>> aggregate_rows(
+    const Table& table,
+    const std::vector<size_t>& row_ids,
+    const query::SelectStatement& stmt,
+    const std::vector<const query::AggregateExpr*>& aggregate_exprs,
+    QueryExecutor& executor,
+    std::vector<std::string>& col_names,
+    std::vector<DataType>& col_types) {
     
-    std::vector<std::vector<std::string>> result;
+    std::vector<const query::Expression*> keys;
+    for (const auto& expr : stmt.group_by_list) {
+        keys.push_back(expr.get());
+    }
     
-    // Build hash table on smaller table (right table)
-    std::unordered_map<std::string, std::vector<std::vector<std::string>>> hash_table;
+    std::vector<AggregateSpec> specs;
+    for (const auto* agg : aggregate_exprs) {
+        AggregateSpec spec;
+        spec.argument = agg->argument.get();
+        switch (agg->aggregate_func) {
+            case query::AggregateFunc::COUNT:
+                spec.function = agg->distinct ? AggregationFunction::COUNT_DISTINCT
+                                              : AggregationFunction::COUNT;
+                break;
+            case query::AggregateFunc::SUM: spec.function = AggregationFunction::SUM; break;
+            case query::AggregateFunc::AVG: spec.function = AggregationFunction::AVG; break;
+            case query::AggregateFunc::MIN: spec.function = AggregationFunction::MIN; break;
+            case query::AggregateFunc::MAX: spec.function = AggregationFunction::MAX; break;
+        }
+        if (agg->distinct && (spec.function == AggregationFunction::SUM ||
+                              spec.function == AggregationFunction::AVG)) {
+            throw std::runtime_error("DISTINCT is not supported in " + agg->to_string());
+        }
+        specs.push_back(spec);
+    }
     
-    for (const auto& right_row : right_rows) {
-        std::string key = extract_join_keys(right_row, right_schema, right_join_keys);
-        hash_table[key].push_back(right_row);
+    HashAggregator aggregator(table, keys, specs);
+    aggregator.consume(row_ids, executor);
+    
+    std::vector<const query::Expression*> outputs;
+    for (const auto& expr : stmt.select_list) {
+        auto col_ref = dynamic_cast<const query::ColumnRefExpr*>(expr.get());
+        if (col_ref && col_ref->column_name == "*") {
+            outputs.insert(outputs.end(), keys.begin(), keys.end());
+        } else {
+            outputs.push_back(expr.get());
+        }
+    }
+    col_names.clear();
+    for (const auto* expr : outputs) {
+        col_names.push_back(output_name(expr));
     }
+    col_types.assign(outputs.size(), DataType::STRING);
+    std::vector<bool> typed(outputs.size(), false);
     
-    // Probe hash table with left rows
-    for (const auto& left_row : left_rows) {
-        std::string left_key = extract_join_keys(left_row, left_schema, left_join_keys);
+    // Outputs that repeat a grouping expression take the key value as is
+    std::vector<int> output_key(outputs.size(), -1);
+    for (size_t o = 0; o < outputs.size(); ++o) {
+        for (size_t k = 0; k < keys.size(); ++k) {
+            if (outputs[o]->to_string() == keys[k]->to_string()) {
+                output_key[o] = static_cast<int>(k);
+                break;
+            }
+        }
+    }
+    
+    ExpressionEvaluator evaluator;
+    RowData group_data;
+    std::vector<std::vector<std::string>> result;
+    for (size_t g = 0; g < aggregator.group_count(); ++g) {
+        for (size_t k = 0; k < keys.size(); ++k) {
+            group_data[output_name(keys[k])] = aggregator.key_value(g, k);
+        }
+        for (size_t a = 0; a < aggregate_exprs.size(); ++a) {
+            group_data[aggregate_exprs[a]->to_string()] = aggregator.aggregate_value(g, a);
+        }
+        
+        if (stmt.having_clause) {
+            auto having_result = evaluator.evaluate(stmt.having_clause.get(), group_data);
+            if (!std::holds_alternative<bool>(having_result) || !std::get<bool>(having_result)) {
+                continue;  // Skip this group
+            }
+        }
         
-        auto it = hash_table.find(left_key);
-        if (it != hash_table.end()) {
-            // Match found - add all matching right rows
-            for (const auto& right_row : it->second) {
-                auto joined_row = left_row;
-                joined_row.insert(joined_row.end(), right_row.begin(), right_row.end());
-                result.push_back(joined_row);
+        std::vector<std::string> row;
+        row.reserve(outputs.size());
+        for (size_t o = 0; o < outputs.size(); ++o) {
+            ExpressionValue value = output_key[o] >= 0
+                ? aggregator.key_value(g, static_cast<size_t>(output_key[o]))
+                : evaluator.evaluate(outputs[o], group_data);
+            // A column is FLOAT64 as soon as any of its values is a double
+            DataType type = DataType::STRING;
+            if (std::holds_alternative<double>(value)) {
+                type = DataType::FLOAT64;
+            } else if (std::holds_alternative<int64_t>(value)) {
+                type = DataType::INT64;
+            } else if (std::holds_alternative<bool>(value)) {
+                type = DataType::BOOL;
             }
-        } else if (is_left_join) {
-            // No match for LEFT JOIN - add with NULL padding
-            auto joined_row = left_row;
-            for (size_t i = 0; i < right_schema.num_columns(); ++i) {
-                joined_row.push_back("");  // NULL representation
+            if (!std::holds_alternative<std::nullptr_t>(value)) {
+                if (!typed[o] || type == DataType::FLOAT64) {
+                    col_types[o] = type;
+                    typed[o] = true;
+                }
             }
-            result.push_back(joined_row);
+            row.push_back(format_value(value));
         }
+        result.push_back(std::move(row));
     }
-    
     return result;
 }
 
@@ -194,9 +478,11 @@ Database::~Database() {
     if (is_open_) {
         close();
     }
+    stop_purge();
 }
 
 void Database::create_table(const std::string& name, const Schema& schema) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
     if (tables_.find(name) != tables_.end()) {
         throw std::runtime_error("Table already exists: " + name);
     }
@@ -204,7 +490,17 @@ void Database::create_table(const std::string& name, const Schema& schema) {
     tables_[name] = std::make_shared<Table>(name, schema);
 }
 
+void Database::attach_table(std::shared_ptr<Table> table) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    if (tables_.find(table->name()) != tables_.end()) {
+        throw std::runtime_error("Table already exists: " + table->name());
+    }
+    
+    tables_[table->name()] = std::move(table);
+}
+
 std::shared_ptr<Table> Database::get_table(const std::string& name) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
     auto it = tables_.find(name);
     if (it == tables_.end()) {
         throw std::runtime_error("Table not found: " + name);
@@ -212,6 +508,111 @@ std::shared_ptr<Table> Database::get_table(const std::string& name) {
     return it->second;
 }
 
+std::shared_ptr<const Table> Database::get_table_snapshot(const std::string& name) {
+    TableMap tables = committed_tables({name});
+    if (tables.empty()) {
+        throw std::runtime_error("Table not found: " + name);
+    }
+    return tables.begin()->second;
+}
+
+Database::TableMap Database::committed_tables(const std::vector<std::string>& names) const {
+    // One critical section, so the versions are from the same commit
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    TableMap tables;
+    for (const auto& name : names) {
+        // The oldest commit not yet durable, or else the open transaction,
+        // holds the version from before the first write readers may not see
+        const TableMap* replaced = nullptr;
+        for (const auto& pending : unpublished_) {
+            if (pending.checked_out.count(name) != 0) {
+                replaced = &pending.checked_out;
+                break;
+            }
+        }
+        if (replaced == nullptr && checked_out_.count(name) != 0) {
+            replaced = &checked_out_;
+        }
+        if (replaced != nullptr) {
+            const auto& committed = replaced->at(name);
+            if (committed) {
+                tables[name] = committed;
+            }
+            continue;
+        }
+        // Not written by the open transaction: the live table is committed
+        auto it = tables_.find(name);
+        if (it != tables_.end()) {
+            tables[name] = it->second->snapshot();
+        }
+    }
+    return tables;
+}
+
+void Database::check_out(const std::string& name) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    if (checked_out_.count(name) == 0) {
+        auto it = tables_.find(name);
+        checked_out_[name] = it != tables_.end() ? it->second->snapshot() : nullptr;
+    }
+}
+
+void Database::publish() {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    if (checked_out_.empty()) {
+        return;
+    }
+    for (const auto& entry : checked_out_) {
+        query_cache_.invalidate(entry.first);
+    }
+    // Dropping the committed versions frees those no reader holds
+    checked_out_.clear();
+    ++commit_version_;
+}
+
+void Database::publish_durable() {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    uint64_t durable = wal_ ? wal_->durable_lsn() : 0;
+    bool published = false;
+    while (!unpublished_.empty() && unpublished_.front().lsn <= durable) {
+        for (const auto& entry : unpublished_.front().checked_out) {
+            query_cache_.invalidate(entry.first);
+        }
+        unpublished_.pop_front();
+        published = true;
+    }
+    if (published) {
+        ++commit_version_;
+    }
+}
+
+void Database::abort_unpublished() {
+    // Later commits may have built on the lost ones, so wait for the open
+    // transaction to end and undo them all, newest first. Readers never
+    // saw them, so the cache stays valid
+    acquire_write_slot(true);
+    publish_durable();
+    while (true) {
+        UnpublishedCommit* newest = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(catalog_mutex_);
+            if (unpublished_.empty()) {
+                break;
+            }
+            newest = &unpublished_.back();
+        }
+        undo_to(*newest->txn, 0, 0);
+        std::lock_guard<std::mutex> lock(catalog_mutex_);
+        unpublished_.pop_back();
+    }
+    release_write_slot();
+}
+
+void Database::discard_checkouts() {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    checked_out_.clear();
+}
+
 std::unique_ptr<QueryResult> Database::query(const std::string& sql) {
     // ========================================================================
     // PHASE 3.4: QUERY RESULT CACHING
@@ -226,9 +627,16 @@ std::unique_ptr<QueryResult> Database::query(const std::string& sql) {
         throw std::runtime_error("Failed to parse SQL: " + parser.get_last_error());
     }
     
-    // Check if this is a SELECT query (can be cached)
+    // Check if this is a SELECT query (can be cached); a writer's own
+    // reads see uncommitted changes and bypass the cache
     auto select_stmt = dynamic_cast<query::SelectStatement*>(statement.get());
-    if (select_stmt && query_cache_.is_enabled()) {
+    bool cacheable = select_stmt && query_cache_.is_enabled() && !in_transaction();
+    uint64_t version = 0;
+    if (cacheable) {
+        {
+            std::lock_guard<std::mutex> lock(catalog_mutex_);
+            version = commit_version_;
+        }
         // Try to get from cache
         if (auto cached_result = query_cache_.get(sql)) {
             // Cache hit - return cloned result as unique_ptr
@@ -243,7 +651,7 @@ std::unique_ptr<QueryResult> Database::query(const std::string& sql) {
     auto result = execute(sql);
     
     // Cache SELECT results
-    if (select_stmt && query_cache_.is_enabled()) {
+    if (cacheable) {
         std::set<std::string> affected_tables;
         if (select_stmt->from_table) {
             affected_tables.insert(select_stmt->from_table->table_name);
@@ -253,12 +661,82 @@ std::unique_ptr<QueryResult> Database::query(const std::string& sql) {
         }
         // Convert unique_ptr to shared_ptr for caching
         auto shared_result = std::make_shared<EngineQueryResult>(*dynamic_cast<EngineQueryResult*>(result.get()));
-        query_cache_.put(sql, shared_result, affected_tables);
+        // Skip it if a commit since our snapshot already invalidated it
+        std::lock_guard<std::mutex> lock(catalog_mutex_);
+        if (commit_version_ == version) {
+            query_cache_.put(sql, shared_result, affected_tables);
+        }
     }
     
     return result;
 }
 
+// ============================================================================
+// Transactions
+// ============================================================================
+
+/**
+ * @brief Redo records to log on commit plus undo entries for rollback
+ */
+struct Database::Transaction {
+    struct Undo {
+        Undo(WalOp op, std::string table) : op(op), table(std::move(table)) {}
+        
+        WalOp op;
+        std::string table;
+        size_t row_count = 0;                              // INSERT: rows before
+        std::vector<size_t> row_ids;                       // UPDATE/DELETE; PURGE: the remap
+        std::vector<std::vector<std::string>> rows;        // UPDATE: previous values
+        std::shared_ptr<Table> dropped;                    // DROP TABLE; PURGE: version before
+        std::shared_ptr<index::DetachedIndexes> indexes;   // DROP TABLE: its indexes
+    };
+    
+    std::vector<WalRecord> redo;
+    std::vector<Undo> undo;
+};
+
+namespace {
+
+/**
+ * @brief Tables a SELECT reads
+ */
+std::vector<std::string> referenced_tables(const query::SelectStatement& select) {
+    std::vector<std::string> names;
+    if (select.from_table) {
+        names.push_back(select.from_table->table_name);
+    }
+    for (const auto& join : select.joins) {
+        names.push_back(join.table.table_name);
+    }
+    return names;
+}
+
+/**
+ * @brief Statements that change logged state (CREATE INDEX is not logged)
+ */
+bool is_logged_write(const query::Statement* statement) {
+    if (auto drop = dynamic_cast<const query::DropStatement*>(statement)) {
+        return drop->type == query::DropStatement::TABLE;
+    }
+    return dynamic_cast<const query::CreateTableStatement*>(statement) ||
+           dynamic_cast<const query::InsertStatement*>(statement) ||
+           dynamic_cast<const query::UpdateStatement*>(statement) ||
+           dynamic_cast<const query::DeleteStatement*>(statement);
+}
+
+/**
+ * @brief Index DDL: not logged, but reads the live table and rewrites the
+ * index registries
+ */
+bool is_index_ddl(const query::Statement* statement) {
+    if (auto drop = dynamic_cast<const query::DropStatement*>(statement)) {
+        return drop->type == query::DropStatement::INDEX;
+    }
+    return dynamic_cast<const query::CreateIndexStatement*>(statement) != nullptr;
+}
+
+}  // namespace
+
 std::unique_ptr<QueryResult> Database::execute(const std::string& sql) {
     // Actual query execution (was in query() method before caching)
     // Parse the SQL statement
@@ -269,8 +747,64 @@ std::unique_ptr<QueryResult> Database::execute(const std::string& sql) {
         throw std::runtime_error("Failed to parse SQL: " + parser.get_last_error());
     }
     
+    if (!is_logged_write(statement.get())) {
+        // Reads outside the writer's own transaction run on a snapshot
+        auto select_stmt = dynamic_cast<query::SelectStatement*>(statement.get());
+        if (select_stmt && !in_transaction()) {
+            TableMap snapshot = committed_tables(referenced_tables(*select_stmt));
+            return execute_statement(statement.get(), &snapshot);
+        }
+        if (is_index_ddl(statement.get())) {
+            // Holding the writer slot keeps writers and the purge thread
+            // from changing the table or the indexes meanwhile
+            bool owner = acquire_write_slot(false);
+            std::unique_ptr<QueryResult> result;
+            try {
+                result = execute_statement(statement.get());
+            } catch (...) {
+                if (owner) {
+                    release_write_slot();
+                }
+                throw;
+            }
+            if (owner) {
+                release_write_slot();
+            }
+            return result;
+        }
+        return execute_statement(statement.get());
+    }
+    
+    // Writes run in the caller's transaction, or in one of their own
+    bool autocommit = acquire_write_slot(false);
+    size_t undo_mark = txn_->undo.size();
+    size_t redo_mark = txn_->redo.size();
+    std::unique_ptr<QueryResult> result;
+    try {
+        result = execute_statement(statement.get());
+    } catch (...) {
+        // A failed statement leaves no partial effects
+        if (autocommit) {
+            rollback();
+        } else {
+            undo_to(*txn_, undo_mark, redo_mark);
+        }
+        throw;
+    }
+    if (autocommit) {
+        commit();
+    }
+    return result;
+}
+
+std::unique_ptr<QueryResult> Database::execute_statement(query::Statement* statement,
+                                                         const TableMap* snapshot) {
+    // Set for write statements (see execute()); owned by this thread.
+    // Other threads read without the slot, so they must not touch txn_
+    Transaction* txn = in_transaction() ? txn_.get() : nullptr;
+    
     // Handle CREATE TABLE
-    auto create_stmt = dynamic_cast<query::CreateTableStatement*>(statement.get());
+    auto create_stmt = dynamic_cast<query::CreateTableStatement*>(statement);
     if (create_stmt) {
         // Build schema from parsed columns
         std::vector<ColumnDef> col_defs;
@@ -300,18 +834,35 @@ std::unique_ptr<QueryResult> Database::execute(const std::string& sql) {
         
         // Create the table
         Schema schema(col_defs);
+        check_out(create_stmt->table_name);
         create_table(create_stmt->table_name, schema);
         
+        if (txn) {
+            WalRecord redo;
+            redo.op = WalOp::CREATE_TABLE;
+            redo.table = create_stmt->table_name;
+            redo.schema = schema;
+            txn->redo.push_back(std::move(redo));
+            txn->undo.push_back({WalOp::CREATE_TABLE, create_stmt->table_name});
+        }
+        
         return nullptr;  // CREATE TABLE returns null result
     }
     
     // Handle INSERT
-    auto insert_stmt = dynamic_cast<query::InsertStatement*>(statement.get());
+    auto insert_stmt = dynamic_cast<query::InsertStatement*>(statement);
     if (insert_stmt) {
         auto table = get_table(insert_stmt->table_name);
         
-        // Invalidate cache for this table (mutation detected)
-        query_cache_.invalidate(insert_stmt->table_name);
+        // Readers keep the committed version until we commit (which
+        // also invalidates cached results)
+        check_out(insert_stmt->table_name);
+        
+        if (txn) {
+            Transaction::Undo undo{WalOp::INSERT, insert_stmt->table_name};
+            undo.row_count = table->row_count();
+            txn->undo.push_back(std::move(undo));
+        }
         
         // For each row of values
         for (const auto& row_values : insert_stmt->values) {
@@ -349,6 +900,14 @@ std::unique_ptr<QueryResult> Database::execute(const std::string& sql) {
                 new_row_id,
                 string_values,
                 schema);
+            
+            if (txn) {
+                WalRecord redo;
+                redo.op = WalOp::INSERT;
+                redo.table = insert_stmt->table_name;
+                redo.values = std::move(string_values);
+                txn->redo.push_back(std::move(redo));
+            }
         }
         
         return nullptr;  // INSERT returns null result
@@ -357,85 +916,112 @@ std::unique_ptr<QueryResult> Database::execute(const std::string& sql) {
     // Handle UPDATE
     // Updates rows in a table based on column assignments and optional WHERE clause
     // Returns a QueryResult with affected_rows count
-    auto update_stmt = dynamic_cast<query::UpdateStatement*>(statement.get());
+    auto update_stmt = dynamic_cast<query::UpdateStatement*>(statement);
     if (update_stmt) {
         auto table = get_table(update_stmt->table_name);
         
-        // Invalidate cache for this table (mutation detected)
-        query_cache_.invalidate(update_stmt->table_name);
+        // Readers keep the committed version until we commit (which
+        // also invalidates cached results)
+        check_out(update_stmt->table_name);
         
         const Schema& schema = table->get_schema();
         
         // Create expression evaluator for WHERE clause and assignment expressions
         ExpressionEvaluator evaluator;
         
-        int rows_affected = 0;
-        std::vector<std::vector<std::string>> all_rows = table->scan_all();
+        // Select target rows with the vectorized filter first; rows are
+        // updated in place afterwards, which cannot change the selection
+        std::vector<size_t> target_rows;
+        QueryExecutor executor;
+        executor.set_parallelism(parallelism_);
+        executor.filter_table(*table, update_stmt->where_clause.get(), target_rows);
         
-        // Process each row
-        for (size_t i = 0; i < all_rows.size(); ++i) {
-            const auto& row = all_rows[i];
-            
+        // Compile assignments once against the table layout; any construct
+        // the compiler rejects sends all assignments through the interpreter
+        ExpressionCompiler compiler;
+        std::vector<std::unique_ptr<CompiledExpression>> assignment_programs;
+        bool use_programs = true;
+        for (const auto& assignment : update_stmt->assignments) {
+            assignment_programs.push_back(compiler.compile(assignment.second.get(), schema));
+            use_programs = use_programs && assignment_programs.back() != nullptr;
+        }
+        
+        RowData row_data;
+        
+        // Evaluate every new row before writing any: reads then see one
+        // version of the columns instead of re-merging after each write
+        std::vector<std::vector<std::string>> updated_rows;
+        updated_rows.reserve(target_rows.size());
+        for (size_t i : target_rows) {
             // Build row data map (column_name -> value) for expression evaluation
-            // This allows WHERE clause and RHS expressions to reference column values
-            RowData row_data;
-            for (size_t col_idx = 0; col_idx < schema.num_columns(); ++col_idx) {
-                row_data[schema.get_column(col_idx).name] = row[col_idx];
+            // This allows RHS expressions to reference column values
+            if (!use_programs) {
+                load_row_data(*table, i, row_data);
             }
             
-            // Evaluate WHERE clause for this row
-            // If WHERE is present, evaluate condition; otherwise update all rows
-            bool should_update = true;
-            if (update_stmt->where_clause) {
-                evaluator.set_context_row(row_data);
-                auto where_result = evaluator.evaluate(update_stmt->where_clause.get(), row_data);
-                
-                // Convert result to boolean
-                should_update = false;
-                if (std::holds_alternative<bool>(where_result)) {
-                    should_update = std::get<bool>(where_result);
-                } else if (std::holds_alternative<int64_t>(where_result)) {
-                    should_update = std::get<int64_t>(where_result) != 0;
-                } else if (std::holds_alternative<double>(where_result)) {
-                    should_update = std::get<double>(where_result) != 0.0;
-                } else if (std::holds_alternative<std::string>(where_result)) {
-                    should_update = !std::get<std::string>(where_result).empty();
-                }
-            }
+            std::vector<std::string> updated_row = table->get_row(i);
             
-            if (should_update) {
-                // Update the row with new values
-                std::vector<std::string> updated_row = row;
+            // Apply each assignment
+            for (size_t a = 0; a < update_stmt->assignments.size(); ++a) {
+                const auto& [col_name, expr] = update_stmt->assignments[a];
+                size_t col_idx = schema.column_index(col_name);
                 
-                // Apply each assignment
-                for (const auto& [col_name, expr] : update_stmt->assignments) {
-                    size_t col_idx = schema.column_index(col_name);
-                    
-                    // Evaluate assignment expression
+                // Evaluate assignment expression
+                ExpressionValue new_value;
+                if (use_programs) {
+                    new_value = assignment_programs[a]->evaluate(*table, i);
+                } else {
                     evaluator.set_context_row(row_data);
-                    auto new_value = evaluator.evaluate(expr.get(), row_data);
-                    
-                    // Convert result to string
-                    std::string str_value;
-                    if (std::holds_alternative<int64_t>(new_value)) {
-                        str_value = std::to_string(std::get<int64_t>(new_value));
-                    } else if (std::holds_alternative<double>(new_value)) {
-                        str_value = std::to_string(std::get<double>(new_value));
-                    } else if (std::holds_alternative<bool>(new_value)) {
-                        str_value = std::get<bool>(new_value) ? "true" : "false";
-                    } else if (std::holds_alternative<std::string>(new_value)) {
-                        str_value = std::get<std::string>(new_value);
-                    } else {
-                        str_value = "";
-                    }
-                    
-                    updated_row[col_idx] = str_value;
-                    row_data[col_name] = str_value;
+                    new_value = evaluator.evaluate(expr.get(), row_data);
+                }
+                
+                // Convert result to string
+                std::string str_value;
+                if (std::holds_alternative<int64_t>(new_value)) {
+                    str_value = std::to_string(std::get<int64_t>(new_value));
+                } else if (std::holds_alternative<double>(new_value)) {
+                    str_value = std::to_string(std::get<double>(new_value));
+                } else if (std::holds_alternative<bool>(new_value)) {
+                    str_value = std::get<bool>(new_value) ? "true" : "false";
+                } else if (std::holds_alternative<std::string>(new_value)) {
+                    str_value = std::get<std::string>(new_value);
+                } else {
+                    str_value = "";
                 }
                 
-                // Update the row in the table
-                table->update_row(i, updated_row);
-                rows_affected++;
+                // Every assignment reads the row as it was before the
+                // UPDATE, whichever path evaluates it
+                updated_row[col_idx] = str_value;
+            }
+            updated_rows.push_back(std::move(updated_row));
+        }
+        
+        int rows_affected = 0;
+        size_t undo_index = SIZE_MAX;   // This statement's undo entry
+        for (size_t k = 0; k < target_rows.size(); ++k) {
+            size_t i = target_rows[k];
+            std::vector<std::string>& updated_row = updated_rows[k];
+            
+            // Update the row in the table; keep the old values for rollback
+            if (txn) {
+                if (undo_index == SIZE_MAX) {
+                    undo_index = txn->undo.size();
+                    txn->undo.push_back({WalOp::UPDATE, update_stmt->table_name});
+                }
+                auto& undo = txn->undo[undo_index];
+                undo.row_ids.push_back(i);
+                undo.rows.push_back(table->get_row(i));
+            }
+            table->update_row(i, updated_row);
+            rows_affected++;
+            
+            if (txn) {
+                WalRecord redo;
+                redo.op = WalOp::UPDATE;
+                redo.table = update_stmt->table_name;
+                redo.row_ids.push_back(i);
+                redo.values = std::move(updated_row);
+                txn->redo.push_back(std::move(redo));
             }
         }
         
@@ -448,58 +1034,35 @@ std::unique_ptr<QueryResult> Database::execute(const std::string& sql) {
     // Handle DELETE
     // Deletes rows from a table based on optional WHERE clause
     // Returns a QueryResult with affected_rows count
-    auto delete_stmt = dynamic_cast<query::DeleteStatement*>(statement.get());
+    auto delete_stmt = dynamic_cast<query::DeleteStatement*>(statement);
     if (delete_stmt) {
         auto table = get_table(delete_stmt->table_name);
         
-        // Invalidate cache for this table (mutation detected)
-        query_cache_.invalidate(delete_stmt->table_name);
-        
-        const Schema& schema = table->get_schema();
-        
-        // Create expression evaluator for WHERE clause
-        ExpressionEvaluator evaluator;
+        // Readers keep the committed version until we commit (which
+        // also invalidates cached results)
+        check_out(delete_stmt->table_name);
         
+        // Find rows to delete with the vectorized filter (ascending live
+        // row ids); without a WHERE clause every live row is deleted
         std::vector<size_t> rows_to_delete;
-        std::vector<std::vector<std::string>> all_rows = table->scan_all();
+        QueryExecutor executor;
+        executor.set_parallelism(parallelism_);
+        executor.filter_table(*table, delete_stmt->where_clause.get(), rows_to_delete);
         
-        // Find rows to delete by evaluating WHERE clause for each row
-        for (size_t i = 0; i < all_rows.size(); ++i) {
-            const auto& row = all_rows[i];
-            
-            // Build row data map (column_name -> value) for expression evaluation
-            RowData row_data;
-            for (size_t col_idx = 0; col_idx < schema.num_columns(); ++col_idx) {
-                row_data[schema.get_column(col_idx).name] = row[col_idx];
-            }
-            
-            // Evaluate WHERE clause for this row
-            // If WHERE is present, evaluate condition; otherwise delete all rows
-            bool should_delete = true;
-            if (delete_stmt->where_clause) {
-                evaluator.set_context_row(row_data);
-                auto where_result = evaluator.evaluate(delete_stmt->where_clause.get(), row_data);
-                
-                // Convert result to boolean
-                should_delete = false;
-                if (std::holds_alternative<bool>(where_result)) {
-                    should_delete = std::get<bool>(where_result);
-                } else if (std::holds_alternative<int64_t>(where_result)) {
-                    should_delete = std::get<int64_t>(where_result) != 0;
-                } else if (std::holds_alternative<double>(where_result)) {
-                    should_delete = std::get<double>(where_result) != 0.0;
-                } else if (std::holds_alternative<std::string>(where_result)) {
-                    should_delete = !std::get<std::string>(where_result).empty();
-                }
-            }
+        // Mark the rows in the deletion vectors: row ids stay put, so
+        // nothing shifts and the row values stay readable for undo
+        int rows_affected = rows_to_delete.size();
+        if (txn && !rows_to_delete.empty()) {
+            Transaction::Undo undo{WalOp::DELETE, delete_stmt->table_name};
+            undo.row_ids = rows_to_delete;
             
-            if (should_delete) {
-                rows_to_delete.push_back(i);
-            }
+            WalRecord redo;
+            redo.op = WalOp::DELETE;
+            redo.table = delete_stmt->table_name;
+            redo.row_ids.assign(undo.row_ids.begin(), undo.row_ids.end());
+            txn->redo.push_back(std::move(redo));
+            txn->undo.push_back(std::move(undo));
         }
-        
-        // Delete the rows
-        int rows_affected = rows_to_delete.size();
         table->delete_rows(rows_to_delete);
         
         // Update all indexes (single-column and composite)
@@ -513,13 +1076,20 @@ std::unique_ptr<QueryResult> Database::execute(const std::string& sql) {
     }
     
     // Handle CREATE INDEX
-    auto create_index_stmt = dynamic_cast<query::CreateIndexStatement*>(statement.get());
+    auto create_index_stmt = dynamic_cast<query::CreateIndexStatement*>(statement);
     if (create_index_stmt) {
         auto table = get_table(create_index_stmt->table_name);
         const Schema& schema = table->get_schema();
         
         if (!create_index_stmt->columns.empty()) {
-            auto rows = table->scan_all();
+            // Row i of the build input is row id i; deleted rows stay empty
+            // and are not indexed
+            std::vector<std::vector<std::string>> rows(table->row_count());
+            for (size_t i = 0; i < rows.size(); ++i) {
+                if (!table->is_deleted(i)) {
+                    rows[i] = table->get_row(i);
+                }
+            }
             
             // Check if this is a single-column or multi-column index
             if (create_index_stmt->columns.size() == 1) {
@@ -588,17 +1158,37 @@ std::unique_ptr<QueryResult> Database::execute(const std::string& sql) {
     }
     
     // Handle DROP
-    auto drop_stmt = dynamic_cast<query::DropStatement*>(statement.get());
+    auto drop_stmt = dynamic_cast<query::DropStatement*>(statement);
     if (drop_stmt) {
         if (drop_stmt->type == query::DropStatement::TABLE) {
             // Drop table if exists
-            auto it = tables_.find(drop_stmt->object_name);
-            if (it != tables_.end()) {
-                tables_.erase(it);
+            std::shared_ptr<Table> dropped;
+            {
+                std::lock_guard<std::mutex> lock(catalog_mutex_);
+                auto it = tables_.find(drop_stmt->object_name);
+                if (it != tables_.end()) {
+                    dropped = it->second;
+                }
+            }
+            if (dropped) {
+                check_out(drop_stmt->object_name);
                 
-                // Clear all indexes on this table
-                index::clear_table_indexes(drop_stmt->object_name);
-                index::clear_composite_table_indexes(drop_stmt->object_name);
+                // The table's indexes go with it; a rollback puts both back
+                auto indexes = index::detach_table_indexes(drop_stmt->object_name);
+                if (txn) {
+                    Transaction::Undo undo{WalOp::DROP_TABLE, drop_stmt->object_name};
+                    undo.dropped = dropped;
+                    undo.indexes = std::move(indexes);
+                    txn->undo.push_back(std::move(undo));
+                    WalRecord redo;
+                    redo.op = WalOp::DROP_TABLE;
+                    redo.table = drop_stmt->object_name;
+                    txn->redo.push_back(std::move(redo));
+                }
+                {
+                    std::lock_guard<std::mutex> lock(catalog_mutex_);
+                    tables_.erase(drop_stmt->object_name);
+                }
             } else if (!drop_stmt->if_exists) {
                 throw std::runtime_error("Table not found: " + drop_stmt->object_name);
             }
@@ -610,26 +1200,41 @@ std::unique_ptr<QueryResult> Database::execute(const std::string& sql) {
     }
     
     // Handle SELECT
-    auto select_stmt = dynamic_cast<query::SelectStatement*>(statement.get());
+    auto select_stmt = dynamic_cast<query::SelectStatement*>(statement);
     if (select_stmt) {
         // Get all tables and scan for SELECT results
         // For now, return a simple in-memory result with table data
         
+        // Readers other than the writer get the tables from their snapshot
+        auto lookup = [&](const std::string& name) {
+            if (!snapshot) {
+                return get_table(name);
+            }
+            auto it = snapshot->find(name);
+            if (it == snapshot->end()) {
+                throw std::runtime_error("Table not found: " + name);
+            }
+            return it->second;
+        };
+        
         if (select_stmt->from_table && !select_stmt->from_table->table_name.empty()) {
-            auto table = get_table(select_stmt->from_table->table_name);
+            auto table = lookup(select_stmt->from_table->table_name);
             const Schema& schema = table->get_schema();
             
             // Get initial column names and schemas for tracking all tables in join
             std::vector<std::string> col_names;
+            std::vector<DataType> col_types;
             std::map<std::string, const Schema*> table_schemas;
             
             for (size_t i = 0; i < schema.num_columns(); ++i) {
                 col_names.push_back(schema.get_column(i).name);
+                col_types.push_back(schema.get_column(i).type);
             }
             table_schemas[select_stmt->from_table->table_name] = &schema;
             
-            // Get rows
-            auto rows = table->scan_all();
+            // Scans, projection and join probes run morsel-parallel
+            QueryExecutor executor;
+            executor.set_parallelism(parallelism_);
             
             // ========================================================================
             // FILTER PUSHDOWN OPTIMIZATION (Phase 3.3.1)
@@ -637,420 +1242,397 @@ std::unique_ptr<QueryResult> Database::execute(const std::string& sql) {
             // This is critical for performance: if WHERE filters 90% of rows,
             // we only need to join 10% instead of 100%
             // ========================================================================
+            bool filter_on_scan = false;
             if (select_stmt->where_clause && !select_stmt->joins.empty()) {
                 // Check if the WHERE clause can be pushed down to the primary table
-                if (is_pushdown_compatible(select_stmt->where_clause.get(), schema)) {
-                    // Apply filter early - BEFORE JOIN
-                    ExpressionEvaluator evaluator;
-                    std::vector<std::vector<std::string>> filtered_rows;
-                    
-                    for (const auto& row : rows) {
-                        RowData row_data;
-                        for (size_t i = 0; i < schema.num_columns() && i < row.size(); ++i) {
-                            row_data[schema.get_column(i).name] = row[i];
-                        }
-                        
-                        auto result = evaluator.evaluate(select_stmt->where_clause.get(), row_data);
-                        bool condition_met = false;
-                        
-                        if (std::holds_alternative<bool>(result)) {
-                            condition_met = std::get<bool>(result);
-                        } else if (std::holds_alternative<int64_t>(result)) {
-                            condition_met = std::get<int64_t>(result) != 0;
-                        } else if (std::holds_alternative<double>(result)) {
-                            condition_met = std::get<double>(result) != 0.0;
-                        }
-                        
-                        if (condition_met) {
-                            filtered_rows.push_back(row);
-                        }
-                    }
-                    
-                    // Update rows with filtered results
-                    rows = filtered_rows;
-                    // Mark that WHERE clause was applied so we don't apply it again after JOIN
-                    select_stmt->where_clause.reset();
-                }
+                filter_on_scan = is_pushdown_compatible(select_stmt->where_clause.get(), schema);
             } else if (select_stmt->where_clause && select_stmt->joins.empty()) {
                 // No joins - apply WHERE clause now
-                ExpressionEvaluator evaluator;
-                std::vector<std::vector<std::string>> filtered_rows;
-                
-                for (const auto& row : rows) {
-                    RowData row_data;
-                    for (size_t i = 0; i < schema.num_columns() && i < row.size(); ++i) {
-                        row_data[schema.get_column(i).name] = row[i];
-                    }
-                    
-                    auto result = evaluator.evaluate(select_stmt->where_clause.get(), row_data);
-                    bool condition_met = false;
-                    
-                    if (std::holds_alternative<bool>(result)) {
-                        condition_met = std::get<bool>(result);
-                    } else if (std::holds_alternative<int64_t>(result)) {
-                        condition_met = std::get<int64_t>(result) != 0;
-                    } else if (std::holds_alternative<double>(result)) {
-                        condition_met = std::get<double>(result) != 0.0;
-                    }
-                    
-                    if (condition_met) {
-                        filtered_rows.push_back(row);
+                filter_on_scan = true;
+            }
+            
+            // Aggregates read the typed columns directly; everything else
+            // works on materialized rows
+            std::vector<const query::AggregateExpr*> aggregate_exprs;
+            for (const auto& expr : select_stmt->select_list) {
+                collect_aggregates(expr.get(), aggregate_exprs);
+            }
+            collect_aggregates(select_stmt->having_clause.get(), aggregate_exprs);
+            bool aggregating = !select_stmt->group_by_list.empty() || !aggregate_exprs.empty();
+            
+            // Filter on the typed columns first, then materialize only the
+            // surviving rows
+            std::vector<size_t> row_ids;
+            const query::Expression* scan_filter =
+                filter_on_scan ? select_stmt->where_clause.get() : nullptr;
+            if (select_stmt->joins.empty() && !aggregating &&
+                select_stmt->order_by_list.empty() && select_stmt->limit > 0) {
+                // Rows come out in scan order, so LIMIT/OFFSET can stop the
+                // scan as soon as enough rows matched
+                size_t skip = static_cast<size_t>(std::max<int64_t>(select_stmt->offset, 0));
+                size_t needed = static_cast<size_t>(select_stmt->limit);
+                std::vector<bool> row_ids_only(table->column_count(), false);
+                TableScan scan(*table, scan_filter, TableScan::kBatchSize, &row_ids_only);
+                VectorBatch batch;
+                SelectionVector selection;
+                while (row_ids.size() < needed && scan.next(batch, selection)) {
+                    size_t k = std::min(skip, selection.size());
+                    skip -= k;
+                    for (; k < selection.size() && row_ids.size() < needed; ++k) {
+                        row_ids.push_back(batch.offset + selection[k]);
                     }
                 }
-                
-                rows = filtered_rows;
+                select_stmt->offset = 0;
+            } else {
+                executor.filter_table(*table, scan_filter, row_ids);
+            }
+            if (filter_on_scan) {
+                // Mark that WHERE clause was applied so we don't apply it again after JOIN
                 select_stmt->where_clause.reset();
             }
             
-            // Handle JOINs if present (using HASH JOIN for better performance)
+            std::vector<std::vector<std::string>> rows;
+            
+            // Rows travel as one row-id list per table (see JoinSource)
+            // through joins, WHERE, ORDER BY and LIMIT. Each stage
+            // materializes only the columns it reads, and the projected
+            // columns are gathered last, for the surviving rows only.
+            std::vector<JoinSource> sources;
+            sources.push_back(JoinSource{table.get(),
+                {select_stmt->from_table->table_name, select_stmt->from_table->alias},
+                std::move(row_ids)});
+            std::vector<std::unique_ptr<Table>> scratch_tables;
+            
+            // Handle JOINs if present: equi-joins run as radix hash joins on
+            // row ids, other conditions as a nested loop over materialized rows
             if (!select_stmt->joins.empty()) {
-                ExpressionEvaluator evaluator;
-                
                 for (const auto& join : select_stmt->joins) {
-                    auto join_table = get_table(join.table.table_name);
+                    auto join_table = lookup(join.table.table_name);
                     const Schema& join_schema = join_table->get_schema();
-                    
-                    auto join_rows = join_table->scan_all();
-                    std::vector<std::vector<std::string>> joined_rows;
+                    std::vector<std::string> join_names{join.table.table_name, join.table.alias};
                     bool is_left_join = (join.join_type == query::JoinType::LEFT);
                     
-                    // ====================================================================
-                    // HASH JOIN OPTIMIZATION (Phase 3.3.2)
-                    // Try to extract join keys for efficient O(n+m) hash join
-                    // Falls back to nested loop join for complex conditions
-                    // ====================================================================
-                    std::vector<std::string> left_join_keys;
-                    std::vector<std::string> right_join_keys;
-                    bool keys_extracted = extract_join_keys_from_condition(
-                        join.join_condition.get(),
-                        left_join_keys,
-                        right_join_keys);
-                    
-                    if (keys_extracted && !left_join_keys.empty() && !right_join_keys.empty()) {
-                        // Use hash join for equality conditions
-                        // Build hash table on right table (smaller is better)
-                        std::unordered_map<std::string, std::vector<std::vector<std::string>>> hash_table;
+                    size_t source = 0;
+                    std::vector<size_t> left_keys;
+                    std::vector<size_t> right_keys;
+                    if (resolve_join_keys(join.join_condition.get(), sources, *join_table,
+                                          join_names, source, left_keys, right_keys)) {
+                        std::vector<size_t> right_rows;
+                        executor.filter_table(*join_table, nullptr, right_rows);
                         
-                        for (const auto& right_row : join_rows) {
-                            std::string hash_key = extract_join_keys(right_row, join_schema, right_join_keys);
-                            hash_table[hash_key].push_back(right_row);
-                        }
+                        HashJoin hash_join(*sources[source].table, left_keys,
+                                           *join_table, right_keys,
+                                           is_left_join ? JoinKind::LEFT : JoinKind::INNER);
+                        JoinOutput matches;
+                        hash_join.execute(sources[source].rows, right_rows, executor, matches);
                         
-                        // Probe hash table with left rows
-                        for (const auto& left_row : rows) {
-                            std::string left_key = extract_join_keys(left_row, schema, left_join_keys);
-                            
-                            auto it = hash_table.find(left_key);
-                            if (it != hash_table.end()) {
-                                // Match found - add all matching right rows
-                                for (const auto& right_row : it->second) {
-                                    auto merged_row = left_row;
-                                    merged_row.insert(merged_row.end(), right_row.begin(), right_row.end());
-                                    joined_rows.push_back(merged_row);
-                                }
-                            } else if (is_left_join) {
-                                // No match for LEFT JOIN - add with NULL padding
-                                auto merged_row = left_row;
-                                for (size_t i = 0; i < join_schema.num_columns(); ++i) {
-                                    merged_row.push_back("");  // NULL representation
-                                }
-                                joined_rows.push_back(merged_row);
+                        // Expand every earlier table to the matched row pairs
+                        for (auto& input : sources) {
+                            std::vector<size_t> expanded(matches.left.size());
+                            for (size_t i = 0; i < matches.left.size(); ++i) {
+                                expanded[i] = input.rows[matches.left[i]];
                             }
+                            input.rows = std::move(expanded);
                         }
+                        sources.push_back(JoinSource{join_table.get(), join_names,
+                                                     std::move(matches.right)});
                     } else {
-                        // Fall back to nested loop join for complex conditions
+                        // Fall back to nested loop join for complex conditions.
+                        // The inner table is streamed a batch at a time; matches
+                        // are kept per outer row so the output keeps its order
+                        std::vector<size_t> all_columns(col_names.size());
+                        std::iota(all_columns.begin(), all_columns.end(), size_t{0});
+                        gather_columns(sources, all_columns, executor, rows);
+                        std::vector<RowData> left_data(rows.size());
+                        for (size_t l = 0; l < rows.size(); ++l) {
+                            for (size_t i = 0; i < col_names.size() && i < rows[l].size(); ++i) {
+                                left_data[l][col_names[i]] = rows[l][i];
+                            }
+                        }
+                        std::vector<std::vector<std::vector<std::string>>> matched(rows.size());
                         ExpressionEvaluator evaluator;
                         
-                        for (const auto& left_row : rows) {
-                            RowData left_data;
-                            for (size_t i = 0; i < schema.num_columns() && i < left_row.size(); ++i) {
-                                left_data[schema.get_column(i).name] = left_row[i];
-                            }
-                            
-                            bool match_found = false;
-                            
-                            for (const auto& right_row : join_rows) {
-                                RowData right_data;
-                                for (size_t i = 0; i < join_schema.num_columns() && i < right_row.size(); ++i) {
-                                    right_data[join_schema.get_column(i).name] = right_row[i];
-                                }
-                                
-                                // Merge contexts for join condition evaluation
-                                RowData merged_data = left_data;
-                                for (const auto& [key, val] : right_data) {
-                                    merged_data[key] = val;
-                                }
-                                
-                                // Evaluate join condition
-                                auto condition_result = evaluator.evaluate(join.join_condition.get(), merged_data);
-                                bool condition_met = false;
-                                
-                                if (std::holds_alternative<bool>(condition_result)) {
-                                    condition_met = std::get<bool>(condition_result);
-                                } else if (std::holds_alternative<int64_t>(condition_result)) {
-                                    condition_met = std::get<int64_t>(condition_result) != 0;
-                                }
-                                
-                                if (condition_met) {
-                                    // INNER/LEFT JOIN: include row
-                                    auto merged_row = left_row;
-                                    merged_row.insert(merged_row.end(), right_row.begin(), right_row.end());
-                                    joined_rows.push_back(merged_row);
-                                    match_found = true;
+                        std::vector<bool> row_ids_only(join_table->column_count(), false);
+                        TableScan scan(*join_table, nullptr, TableScan::kBatchSize, &row_ids_only);
+                        VectorBatch batch;
+                        SelectionVector selection;
+                        while (scan.next(batch, selection)) {
+                            for (uint32_t r : selection) {
+                                std::vector<std::string> right_row = join_table->get_row(batch.offset + r);
+                                for (size_t l = 0; l < rows.size(); ++l) {
+                                    // Merge contexts for join condition evaluation
+                                    RowData merged_data = left_data[l];
+                                    for (size_t i = 0; i < join_schema.num_columns() && i < right_row.size(); ++i) {
+                                        merged_data[join_schema.get_column(i).name] = right_row[i];
+                                    }
+                                    
+                                    // Evaluate join condition
+                                    auto condition_result = evaluator.evaluate(join.join_condition.get(), merged_data);
+                                    bool condition_met = false;
+                                    
+                                    if (std::holds_alternative<bool>(condition_result)) {
+                                        condition_met = std::get<bool>(condition_result);
+                                    } else if (std::holds_alternative<int64_t>(condition_result)) {
+                                        condition_met = std::get<int64_t>(condition_result) != 0;
+                                    }
+                                    
+                                    if (condition_met) {
+                                        matched[l].push_back(right_row);
+                                    }
                                 }
                             }
+                        }
+                        
+                        std::vector<std::vector<std::string>> joined_rows;
+                        for (size_t l = 0; l < rows.size(); ++l) {
+                            for (const auto& right_row : matched[l]) {
+                                // INNER/LEFT JOIN: include row
+                                auto merged_row = rows[l];
+                                merged_row.insert(merged_row.end(), right_row.begin(), right_row.end());
+                                joined_rows.push_back(std::move(merged_row));
+                            }
                             
                             // Handle LEFT JOIN with NULL padding
-                            if (!match_found && is_left_join) {
-                                auto merged_row = left_row;
-                                for (size_t i = 0; i < join_schema.num_columns(); ++i) {
-                                    merged_row.push_back("");  // NULL representation
-                                }
-                                joined_rows.push_back(merged_row);
+                            if (matched[l].empty() && is_left_join) {
+                                auto merged_row = rows[l];
+                                merged_row.resize(merged_row.size() + join_schema.num_columns());
+                                joined_rows.push_back(std::move(merged_row));
                             }
                         }
+                        
+                        // Continue from a scratch table holding the joined rows
+                        Schema joined_schema;
+                        std::vector<std::string> joined_names;
+                        for (const auto& input : sources) {
+                            joined_names.insert(joined_names.end(), input.names.begin(), input.names.end());
+                        }
+                        joined_names.insert(joined_names.end(), join_names.begin(), join_names.end());
+                        for (size_t i = 0; i < col_names.size(); ++i) {
+                            joined_schema.add_column(ColumnDef(col_names[i], col_types[i]));
+                        }
+                        for (size_t i = 0; i < join_schema.num_columns(); ++i) {
+                            joined_schema.add_column(join_schema.get_column(i));
+                        }
+                        auto scratch = std::make_unique<Table>("joined", joined_schema);
+                        for (const auto& row : joined_rows) {
+                            scratch->insert_row(row);
+                        }
+                        std::vector<size_t> scratch_rows(joined_rows.size());
+                        std::iota(scratch_rows.begin(), scratch_rows.end(), size_t{0});
+                        sources.clear();
+                        sources.push_back(JoinSource{scratch.get(), joined_names, std::move(scratch_rows)});
+                        scratch_tables.push_back(std::move(scratch));
                     }
                     
                     // Add joined table columns to col_names
                     for (size_t i = 0; i < join_schema.num_columns(); ++i) {
                         col_names.push_back(join_schema.get_column(i).name);
+                        col_types.push_back(join_schema.get_column(i).type);
                     }
-                    
-                    rows = joined_rows;
                 }
             }
             
-            // Filter by WHERE clause if present
+            // Filter by WHERE clause if present: conditions the scan could
+            // not take, compiled against just the columns they read
             if (select_stmt->where_clause) {
-                ExpressionEvaluator evaluator;
-                std::vector<std::vector<std::string>> filtered_rows;
+                const query::Expression* where = select_stmt->where_clause.get();
+                std::vector<bool> used(col_names.size(), false);
+                collect_columns(where, col_names, used);
+                std::vector<std::string> where_names;
+                std::vector<DataType> where_types;
+                gather_columns(sources, used_columns(used, col_names, col_types, where_names, where_types),
+                               executor, rows);
                 
-                for (const auto& row : rows) {
-                    // Create RowData from row
+                ExpressionCompiler where_compiler;
+                auto where_program = where_compiler.compile(where, where_names, where_types);
+                ExpressionEvaluator evaluator;
+                std::vector<size_t> keep;
+                for (size_t r = 0; r < rows.size(); ++r) {
+                    if (where_program) {
+                        if (where_program->matches(rows[r])) {
+                            keep.push_back(r);
+                        }
+                        continue;
+                    }
                     RowData row_data;
-                    for (size_t i = 0; i < schema.num_columns() && i < row.size(); ++i) {
-                        row_data[schema.get_column(i).name] = row[i];
+                    for (size_t i = 0; i < where_names.size(); ++i) {
+                        row_data[where_names[i]] = rows[r][i];
                     }
-                    
-                    // Evaluate WHERE condition
-                    auto result = evaluator.evaluate(select_stmt->where_clause.get(), row_data);
+                    auto result = evaluator.evaluate(where, row_data);
                     if (std::holds_alternative<bool>(result) && std::get<bool>(result)) {
-                        filtered_rows.push_back(row);
+                        keep.push_back(r);
+                    }
+                }
+                for (auto& source : sources) {
+                    for (size_t k = 0; k < keep.size(); ++k) {
+                        source.rows[k] = source.rows[keep[k]];
                     }
+                    source.rows.resize(keep.size());
                 }
-                rows = filtered_rows;
             }
             
-            // Handle GROUP BY if present
-            if (!select_stmt->group_by_list.empty()) {
-                // Create map for grouping: grouping_key -> list of rows in group
-                std::map<std::string, std::vector<std::vector<std::string>>> groups;
-                ExpressionEvaluator evaluator;
-                
-                // Group rows
-                for (const auto& row : rows) {
-                    // Create RowData for this row
-                    RowData row_data;
-                    for (size_t i = 0; i < schema.num_columns() && i < row.size(); ++i) {
-                        row_data[schema.get_column(i).name] = row[i];
+            // Handle GROUP BY and aggregates: the result is small, so ORDER BY
+            // and LIMIT work on its materialized rows
+            if (aggregating) {
+                const Table* source = table.get();
+                std::unique_ptr<Table> joined;
+                if (!select_stmt->joins.empty()) {
+                    // Joined rows are loaded into a typed scratch table first,
+                    // holding only the columns the aggregation reads
+                    std::vector<bool> used(col_names.size(), false);
+                    for (const auto& expr : select_stmt->select_list) {
+                        collect_columns(expr.get(), col_names, used);
                     }
-                    
-                    // Create grouping key from GROUP BY expressions
-                    std::string key;
-                    for (size_t i = 0; i < select_stmt->group_by_list.size(); ++i) {
-                        if (i > 0) key += "|";
-                        auto expr_value = evaluator.evaluate(select_stmt->group_by_list[i].get(), row_data);
-                        
-                        // Convert ExpressionValue to string
-                        if (std::holds_alternative<nullptr_t>(expr_value)) {
-                            key += "NULL";
-                        } else if (std::holds_alternative<int64_t>(expr_value)) {
-                            key += std::to_string(std::get<int64_t>(expr_value));
-                        } else if (std::holds_alternative<double>(expr_value)) {
-                            key += std::to_string(std::get<double>(expr_value));
-                        } else if (std::holds_alternative<std::string>(expr_value)) {
-                            key += std::get<std::string>(expr_value);
-                        } else if (std::holds_alternative<bool>(expr_value)) {
-                            key += std::get<bool>(expr_value) ? "true" : "false";
-                        }
+                    for (const auto& expr : select_stmt->group_by_list) {
+                        collect_columns(expr.get(), col_names, used);
                     }
-                    
-                    groups[key].push_back(row);
-                }
-                
-                // Build result rows from groups with aggregates
-                std::vector<std::vector<std::string>> grouped_rows;
-                
-                for (const auto& [key, group_rows] : groups) {
-                    // Start with the first row (for GROUP BY columns)
-                    auto result_row = group_rows[0];
-                    
-                    // TODO: Process aggregates in select_list
-                    // For now, just return the first row of each group
-                    
-                    // Apply HAVING clause if present
-                    if (select_stmt->having_clause) {
-                        // Create RowData from the group result for HAVING evaluation
-                        RowData group_data;
-                        for (size_t i = 0; i < schema.num_columns() && i < result_row.size(); ++i) {
-                            group_data[schema.get_column(i).name] = result_row[i];
-                        }
-                        
-                        // Evaluate HAVING condition
-                        auto having_result = evaluator.evaluate(select_stmt->having_clause.get(), group_data);
-                        
-                        // Only include group if HAVING condition is true
-                        if (!std::holds_alternative<bool>(having_result) || !std::get<bool>(having_result)) {
-                            continue;  // Skip this group
-                        }
+                    collect_columns(select_stmt->having_clause.get(), col_names, used);
+                    std::vector<std::string> names;
+                    std::vector<DataType> types;
+                    gather_columns(sources, used_columns(used, col_names, col_types, names, types),
+                                   executor, rows);
+                    Schema joined_schema;
+                    for (size_t i = 0; i < names.size(); ++i) {
+                        joined_schema.add_column(ColumnDef(names[i], types[i]));
                     }
-                    
-                    grouped_rows.push_back(result_row);
+                    joined = std::make_unique<Table>("joined", joined_schema);
+                    for (const auto& row : rows) {
+                        joined->insert_row(row);
+                    }
+                    row_ids.resize(rows.size());
+                    std::iota(row_ids.begin(), row_ids.end(), size_t{0});
+                    source = joined.get();
+                } else {
+                    row_ids = std::move(sources.front().rows);
                 }
+                rows = aggregate_rows(*source, row_ids, *select_stmt, aggregate_exprs,
+                                      executor, col_names, col_types);
                 
-                rows = grouped_rows;
+                std::vector<size_t> order(rows.size());
+                std::iota(order.begin(), order.end(), size_t{0});
+                if (!select_stmt->order_by_list.empty()) {
+                    order = order_rows(*select_stmt, rows, col_names, col_types, executor);
+                }
+                auto [begin, end] = limit_range(*select_stmt, order.size());
+                std::vector<std::vector<std::string>> result_rows;
+                result_rows.reserve(end - begin);
+                for (size_t i = begin; i < end; ++i) {
+                    result_rows.push_back(std::move(rows[order[i]]));
+                }
+                return std::make_unique<EngineQueryResult>(result_rows, col_names);
             }
             
-            // Handle ORDER BY if present
+            // Handle ORDER BY if present: sorts on its key columns alone and
+            // reorders the row ids; then LIMIT/OFFSET trims them
+            size_t num_rows = sources.front().rows.size();
+            std::vector<size_t> order;
             if (!select_stmt->order_by_list.empty()) {
-                ExpressionEvaluator evaluator;
-                
-                // ====================================================================
-                // PARTIAL SORT OPTIMIZATION (Phase 3.3.3)
-                // When LIMIT is specified, use partial_sort instead of full sort
-                // Performance: O(n log k) instead of O(n log n) where k = LIMIT
-                // ====================================================================
-                int64_t limit = select_stmt->limit;
-                bool use_partial_sort = (limit > 0 && limit < static_cast<int64_t>(rows.size()));
-                
-                if (use_partial_sort) {
-                    // Partial sort: only sort first 'limit' rows
-                    std::partial_sort(
-                        rows.begin(),
-                        rows.begin() + std::min(static_cast<size_t>(limit), rows.size()),
-                        rows.end(),
-                        [&](const std::vector<std::string>& row_a, const std::vector<std::string>& row_b) -> bool {
-                            // Same comparison logic as full sort
-                            for (const auto& sort_key : select_stmt->order_by_list) {
-                                RowData row_a_data, row_b_data;
-                                
-                                for (size_t i = 0; i < schema.num_columns() && i < row_a.size(); ++i) {
-                                    row_a_data[schema.get_column(i).name] = row_a[i];
-                                }
-                                for (size_t i = 0; i < schema.num_columns() && i < row_b.size(); ++i) {
-                                    row_b_data[schema.get_column(i).name] = row_b[i];
-                                }
-                                
-                                auto val_a = evaluator.evaluate(sort_key.expression.get(), row_a_data);
-                                auto val_b = evaluator.evaluate(sort_key.expression.get(), row_b_data);
-                                
-                                bool less_than = false;
-                                bool greater_than = false;
-                                
-                                if (std::holds_alternative<int64_t>(val_a) && std::holds_alternative<int64_t>(val_b)) {
-                                    int64_t a = std::get<int64_t>(val_a);
-                                    int64_t b = std::get<int64_t>(val_b);
-                                    less_than = (a < b);
-                                    greater_than = (a > b);
-                                } else if (std::holds_alternative<double>(val_a) && std::holds_alternative<double>(val_b)) {
-                                    double a = std::get<double>(val_a);
-                                    double b = std::get<double>(val_b);
-                                    less_than = (a < b);
-                                    greater_than = (a > b);
-                                } else if (std::holds_alternative<std::string>(val_a) && std::holds_alternative<std::string>(val_b)) {
-                                    const auto& a = std::get<std::string>(val_a);
-                                    const auto& b = std::get<std::string>(val_b);
-                                    less_than = (a < b);
-                                    greater_than = (a > b);
-                                }
-                                
-                                if (less_than) {
-                                    return (sort_key.direction == query::SortDirection::ASC);
-                                } else if (greater_than) {
-                                    return (sort_key.direction == query::SortDirection::DESC);
-                                }
-                            }
-                            return false;
-                        }
-                    );
+                std::vector<bool> used(col_names.size(), false);
+                for (const auto& sort_key : select_stmt->order_by_list) {
+                    collect_columns(sort_key.expression.get(), col_names, used);
+                }
+                std::vector<std::string> names;
+                std::vector<DataType> types;
+                gather_columns(sources, used_columns(used, col_names, col_types, names, types),
+                               executor, rows);
+                order = order_rows(*select_stmt, rows, names, types, executor);
+            } else {
+                order.resize(num_rows);
+                std::iota(order.begin(), order.end(), size_t{0});
+            }
+            auto [begin, end] = limit_range(*select_stmt, order.size());
+            if (!select_stmt->order_by_list.empty() || begin > 0 || end < num_rows) {
+                for (auto& source : sources) {
+                    std::vector<size_t> kept;
+                    kept.reserve(end - begin);
+                    for (size_t i = begin; i < end; ++i) {
+                        kept.push_back(source.rows[order[i]]);
+                    }
+                    source.rows = std::move(kept);
+                }
+            }
+            
+            // Projection: gather the selected columns of the surviving rows;
+            // computed expressions are evaluated over the columns they read
+            std::vector<size_t> first_column(sources.size(), 0);
+            for (size_t s = 1; s < sources.size(); ++s) {
+                first_column[s] = first_column[s - 1] + sources[s - 1].table->column_count();
+            }
+            auto resolve = [&](const query::ColumnRefExpr* col_ref) {
+                for (size_t s = 0; s < sources.size(); ++s) {
+                    if (refers_to(col_ref, sources[s].names, *sources[s].table)) {
+                        return first_column[s] +
+                               sources[s].table->get_schema().column_index(col_ref->column_name);
+                    }
+                }
+                throw std::runtime_error("Column not found: " + col_ref->to_string());
+            };
+            
+            std::vector<std::string> out_names;
+            std::vector<int64_t> out_columns;   // Ordinal, or -1 - index into computed
+            std::vector<const query::Expression*> computed;
+            std::vector<bool> used(col_names.size(), false);
+            for (const auto& expr : select_stmt->select_list) {
+                auto col_ref = dynamic_cast<const query::ColumnRefExpr*>(expr.get());
+                if (col_ref && col_ref->column_name == "*") {
+                    for (size_t i = 0; i < col_names.size(); ++i) {
+                        out_names.push_back(col_names[i]);
+                        out_columns.push_back(static_cast<int64_t>(i));
+                        used[i] = true;
+                    }
+                } else if (col_ref) {
+                    size_t col = resolve(col_ref);
+                    out_names.push_back(col_ref->column_name);
+                    out_columns.push_back(static_cast<int64_t>(col));
+                    used[col] = true;
                 } else {
-                    // Full sort when no LIMIT or LIMIT > rows
-                    std::sort(rows.begin(), rows.end(), 
-                        [&](const std::vector<std::string>& row_a, const std::vector<std::string>& row_b) -> bool {
-                            // Evaluate each sort key
-                            for (const auto& sort_key : select_stmt->order_by_list) {
-                                // Create RowData for both rows
-                                RowData row_a_data, row_b_data;
-                                
-                                for (size_t i = 0; i < schema.num_columns() && i < row_a.size(); ++i) {
-                                    row_a_data[schema.get_column(i).name] = row_a[i];
-                                }
-                                for (size_t i = 0; i < schema.num_columns() && i < row_b.size(); ++i) {
-                                    row_b_data[schema.get_column(i).name] = row_b[i];
-                                }
-                                
-                                // Evaluate sort expression for both rows
-                                auto val_a = evaluator.evaluate(sort_key.expression.get(), row_a_data);
-                                auto val_b = evaluator.evaluate(sort_key.expression.get(), row_b_data);
-                                
-                                // Compare values
-                                bool less_than = false;
-                                bool greater_than = false;
-                                
-                                // Handle different value types
-                                if (std::holds_alternative<int64_t>(val_a) && std::holds_alternative<int64_t>(val_b)) {
-                                    int64_t a = std::get<int64_t>(val_a);
-                                    int64_t b = std::get<int64_t>(val_b);
-                                    less_than = (a < b);
-                                    greater_than = (a > b);
-                                } else if (std::holds_alternative<double>(val_a) && std::holds_alternative<double>(val_b)) {
-                                    double a = std::get<double>(val_a);
-                                    double b = std::get<double>(val_b);
-                                    less_than = (a < b);
-                                    greater_than = (a > b);
-                                } else if (std::holds_alternative<std::string>(val_a) && std::holds_alternative<std::string>(val_b)) {
-                                    const auto& a = std::get<std::string>(val_a);
-                                    const auto& b = std::get<std::string>(val_b);
-                                    less_than = (a < b);
-                                    greater_than = (a > b);
-                                }
-                                
-                                // Return based on sort direction
-                                if (less_than) {
-                                    return (sort_key.direction == query::SortDirection::ASC);
-                                } else if (greater_than) {
-                                    return (sort_key.direction == query::SortDirection::DESC);
-                                }
-                                // If equal, continue to next sort key
-                            }
-                            return false;  // All sort keys are equal
-                        }
-                    );
+                    out_names.push_back(output_name(expr.get()));
+                    out_columns.push_back(-1 - static_cast<int64_t>(computed.size()));
+                    computed.push_back(expr.get());
+                    collect_columns(expr.get(), col_names, used);
                 }
             }
             
-            // Handle LIMIT and OFFSET
-            int64_t offset = select_stmt->offset;  // Default 0
-            int64_t limit = select_stmt->limit;     // Default -1 (no limit)
+            std::vector<std::string> names;
+            std::vector<DataType> types;
+            std::vector<size_t> gathered = used_columns(used, col_names, col_types, names, types);
+            gather_columns(sources, gathered, executor, rows);
+            std::vector<size_t> position(col_names.size(), 0);
+            for (size_t p = 0; p < gathered.size(); ++p) {
+                position[gathered[p]] = p;
+            }
             
-            // Apply OFFSET first
-            if (offset > 0 && static_cast<size_t>(offset) < rows.size()) {
-                std::vector<std::vector<std::string>> offset_rows(
-                    rows.begin() + offset,
-                    rows.end()
-                );
-                rows = offset_rows;
-            } else if (offset > 0) {
-                rows.clear();  // All rows skipped
+            std::vector<std::pair<size_t, size_t>> located;
+            for (size_t col : gathered) {
+                located.push_back(locate_column(sources, col));
             }
             
-            // Apply LIMIT
-            if (limit > 0 && static_cast<size_t>(limit) < rows.size()) {
-                rows.erase(rows.begin() + limit, rows.end());
+            std::vector<std::vector<std::string>> result_rows(rows.size());
+            ExpressionEvaluator evaluator;
+            RowData row_data;
+            for (size_t r = 0; r < rows.size(); ++r) {
+                if (!computed.empty()) {
+                    for (size_t p = 0; p < names.size(); ++p) {
+                        const auto& [source, col] = located[p];
+                        size_t row_id = sources[source].rows[r];
+                        row_data[names[p]] = row_id == HashJoin::kNoMatch
+                            ? ExpressionValue(nullptr)
+                            : typed_value(sources[source].table->column(col), row_id);
+                    }
+                }
+                auto& out = result_rows[r];
+                out.reserve(out_columns.size());
+                for (int64_t col : out_columns) {
+                    if (col >= 0) {
+                        out.push_back(rows[r][position[static_cast<size_t>(col)]]);
+                    } else {
+                        out.push_back(format_value(
+                            evaluator.evaluate(computed[static_cast<size_t>(-1 - col)], row_data)));
+                    }
+                }
             }
             
-            // Create result with in-memory data
-            return std::make_unique<EngineQueryResult>(rows, col_names);
+            return std::make_unique<EngineQueryResult>(result_rows, out_names);
         }
         
         return nullptr;
@@ -1060,6 +1642,7 @@ std::unique_ptr<QueryResult> Database::execute(const std::string& sql) {
 }
 
 std::vector<std::string> Database::list_tables() const {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
     std::vector<std::string> names;
     for (const auto& [name, _] : tables_) {
         names.push_back(name);
@@ -1068,6 +1651,7 @@ std::vector<std::string> Database::list_tables() const {
 }
 
 Schema Database::get_schema(const std::string& table_name) const {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
     auto it = tables_.find(table_name);
     if (it == tables_.end()) {
         throw std::runtime_error("Table not found: " + table_name);
@@ -1076,7 +1660,416 @@ Schema Database::get_schema(const std::string& table_name) const {
 }
 
 void Database::close() {
+    stop_purge();
     is_open_ = false;
 }
 
+void Database::open_wal(const std::string& wal_path, std::chrono::microseconds commit_delay,
+                        uint64_t checkpoint_lsn) {
+    if (wal_) {
+        throw std::runtime_error("Write-ahead log already attached");
+    }
+    auto wal = std::make_unique<WriteAheadLog>(wal_path, commit_delay, checkpoint_lsn);
+    replay(wal->take_recovered());
+    wal_ = std::move(wal);
+}
+
+void Database::close_wal() {
+    wal_.reset();
+}
+
+uint64_t Database::checkpoint(const std::function<void(uint64_t lsn)>& persist) {
+    acquire_write_slot(true);
+    uint64_t lsn = 0;
+    try {
+        // Commits that appended before we got the slot must be on disk
+        // before the log can be dropped
+        if (wal_) {
+            lsn = wal_->last_lsn();
+            wal_->wait_durable(lsn);
+            publish_durable();
+        }
+        persist(lsn);
+        if (wal_) {
+            wal_->reset(lsn);
+        }
+    } catch (...) {
+        release_write_slot();
+        throw;
+    }
+    release_write_slot();
+    return lsn;
+}
+
+void Database::replay(const std::vector<WalTransaction>& txns) {
+    query_cache_.clear();
+    std::vector<const WalRecord*> records;
+    for (const auto& txn : txns) {
+        for (const auto& record : txn.records) {
+            records.push_back(&record);
+        }
+    }
+    auto is_ddl = [](const WalRecord* record) {
+        return record->op == WalOp::CREATE_TABLE || record->op == WalOp::DROP_TABLE;
+    };
+    
+    size_t i = 0;
+    while (i < records.size()) {
+        if (is_ddl(records[i])) {
+            apply_redo(*records[i++]);
+            continue;
+        }
+        // DML up to the next DDL record: tables are independent, so each
+        // table's records replay as one task, in log order
+        std::map<std::string, std::vector<const WalRecord*>> by_table;
+        for (; i < records.size() && !is_ddl(records[i]); ++i) {
+            by_table[records[i]->table].push_back(records[i]);
+        }
+        std::vector<const std::vector<const WalRecord*>*> tasks;
+        for (const auto& entry : by_table) {
+            tasks.push_back(&entry.second);
+        }
+        TaskScheduler::global().parallel_for(tasks.size(), parallelism_, [&](size_t t, size_t) {
+            for (const WalRecord* record : *tasks[t]) {
+                apply_redo(*record);
+            }
+        });
+    }
+}
+
+bool Database::acquire_write_slot(bool explicit_begin) {
+    std::unique_lock<std::mutex> lock(txn_mutex_);
+    if (txn_ && txn_owner_ == std::this_thread::get_id()) {
+        if (explicit_begin) {
+            throw std::runtime_error("Transaction already active");
+        }
+        return false;
+    }
+    txn_cv_.wait(lock, [this]() { return txn_ == nullptr; });
+    txn_ = std::make_unique<Transaction>();
+    txn_owner_ = std::this_thread::get_id();
+    return true;
+}
+
+void Database::release_write_slot() {
+    {
+        std::lock_guard<std::mutex> lock(txn_mutex_);
+        txn_.reset();
+    }
+    txn_cv_.notify_one();
+}
+
+void Database::begin_transaction() {
+    acquire_write_slot(true);
+}
+
+bool Database::in_transaction() const {
+    std::lock_guard<std::mutex> lock(txn_mutex_);
+    return txn_ && txn_owner_ == std::this_thread::get_id();
+}
+
+void Database::check_txn_owner() const {
+    if (!txn_ || txn_owner_ != std::this_thread::get_id()) {
+        throw std::runtime_error("No active transaction");
+    }
+}
+
+void Database::commit() {
+    uint64_t lsn = 0;
+    std::vector<std::string> purge;
+    {
+        std::lock_guard<std::mutex> lock(txn_mutex_);
+        check_txn_owner();
+        // Append while still holding the slot so log order matches apply order
+        if (wal_ && !txn_->redo.empty()) {
+            try {
+                lsn = wal_->append(txn_->redo);
+            } catch (...) {
+                undo_to(*txn_, 0, 0);
+                discard_checkouts();
+                txn_.reset();
+                txn_cv_.notify_one();
+                throw;
+            }
+        }
+        purge = tables_to_purge();
+        if (lsn != 0) {
+            // Readers keep the versions it replaced until it is durable
+            std::lock_guard<std::mutex> catalog_lock(catalog_mutex_);
+            UnpublishedCommit pending;
+            pending.lsn = lsn;
+            pending.checked_out.swap(checked_out_);
+            pending.txn = std::move(txn_);
+            unpublished_.push_back(std::move(pending));
+        } else {
+            publish();
+            txn_.reset();
+        }
+    }
+    txn_cv_.notify_one();
+    
+    // Wait for the fsync outside the slot: the next writer's commit can
+    // join the same sync
+    if (lsn != 0) {
+        try {
+            wal_->wait_durable(lsn);
+        } catch (...) {
+            abort_unpublished();
+            throw;
+        }
+        publish_durable();
+    }
+    schedule_purge(purge);
+}
+
+void Database::rollback() {
+    {
+        std::lock_guard<std::mutex> lock(txn_mutex_);
+        check_txn_owner();
+        undo_to(*txn_, 0, 0);
+        discard_checkouts();
+        txn_.reset();
+    }
+    txn_cv_.notify_one();
+}
+
+size_t Database::purge_deleted(const std::string& table_name) {
+    acquire_write_slot(true);
+    return purge_in_slot(table_name);
+}
+
+size_t Database::purge_in_slot(const std::string& table_name) {
+    // The caller holds the writer slot; this commits or rolls back
+    size_t removed = 0;
+    try {
+        auto table = get_table(table_name);
+        removed = table->deleted_count();
+        if (removed > 0) {
+            check_out(table_name);
+            auto before = table->snapshot();
+            
+            Transaction::Undo undo{WalOp::PURGE, table_name};
+            undo.row_ids = table->purge_deleted();
+            undo.dropped = std::move(before);
+            txn_->undo.push_back(std::move(undo));
+            const std::vector<size_t>& remap = txn_->undo.back().row_ids;
+            index::remap_table_indexes(table_name, remap);
+            index::remap_composite_table_indexes(table_name, remap);
+            
+            WalRecord redo;
+            redo.op = WalOp::PURGE;
+            redo.table = table_name;
+            txn_->redo.push_back(std::move(redo));
+        }
+    } catch (...) {
+        rollback();
+        throw;
+    }
+    commit();
+    return removed;
+}
+
+std::vector<std::string> Database::tables_to_purge() const {
+    std::vector<std::string> names;
+    double threshold = purge_threshold_;
+    if (threshold <= 0) {
+        return names;
+    }
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    for (const auto& record : txn_->redo) {
+        if (record.op != WalOp::DELETE ||
+            std::find(names.begin(), names.end(), record.table) != names.end()) {
+            continue;
+        }
+        auto it = tables_.find(record.table);
+        if (it == tables_.end()) {
+            continue;   // Dropped later in the transaction
+        }
+        const Table& table = *it->second;
+        size_t bound = std::max(Table::kRowGroupRows,
+                                static_cast<size_t>(threshold * table.row_count()));
+        if (table.deleted_count() >= bound) {
+            names.push_back(record.table);
+        }
+    }
+    return names;
+}
+
+void Database::schedule_purge(const std::vector<std::string>& tables) {
+    if (tables.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(purge_mutex_);
+        if (purge_stop_) {
+            return;
+        }
+        for (const auto& name : tables) {
+            if (std::find(purge_queue_.begin(), purge_queue_.end(), name) == purge_queue_.end()) {
+                purge_queue_.push_back(name);
+            }
+        }
+        if (!purge_thread_.joinable()) {
+            purge_thread_ = std::thread([this]() { purge_loop(); });
+        }
+    }
+    purge_cv_.notify_one();
+}
+
+void Database::purge_loop() {
+    std::unique_lock<std::mutex> queue_lock(purge_mutex_);
+    while (true) {
+        purge_cv_.wait(queue_lock, [this]() { return purge_stop_ || !purge_queue_.empty(); });
+        if (purge_stop_) {
+            return;
+        }
+        std::string name = std::move(purge_queue_.front());
+        purge_queue_.pop_front();
+        queue_lock.unlock();
+        
+        // Queue for the writer slot like any writer, but give up on
+        // shutdown: the closing thread may hold the slot itself
+        {
+            std::unique_lock<std::mutex> lock(txn_mutex_);
+            txn_cv_.wait(lock, [this]() { return txn_ == nullptr || purge_stop_; });
+            if (purge_stop_) {
+                lock.unlock();
+                txn_cv_.notify_one();   // Pass on a wakeup meant for a writer
+                return;
+            }
+            txn_ = std::make_unique<Transaction>();
+            txn_owner_ = std::this_thread::get_id();
+        }
+        try {
+            purge_in_slot(name);
+        } catch (const std::exception&) {
+            // Dropped since it was scheduled; nothing to purge
+        }
+        queue_lock.lock();
+    }
+}
+
+void Database::stop_purge() {
+    {
+        std::lock_guard<std::mutex> lock(purge_mutex_);
+        purge_stop_ = true;
+    }
+    purge_cv_.notify_all();
+    {
+        // Wakes the purge thread if it waits for the writer slot
+        std::lock_guard<std::mutex> lock(txn_mutex_);
+    }
+    txn_cv_.notify_all();
+    if (purge_thread_.joinable()) {
+        purge_thread_.join();
+    }
+}
+
+void Database::undo_to(Transaction& txn, size_t undo_mark, size_t redo_mark) {
+    while (txn.undo.size() > undo_mark) {
+        Transaction::Undo& undo = txn.undo.back();
+        switch (undo.op) {
+            case WalOp::CREATE_TABLE:
+                {
+                    std::lock_guard<std::mutex> lock(catalog_mutex_);
+                    tables_.erase(undo.table);
+                }
+                index::clear_table_indexes(undo.table);
+                index::clear_composite_table_indexes(undo.table);
+                break;
+            case WalOp::DROP_TABLE: {
+                {
+                    std::lock_guard<std::mutex> lock(catalog_mutex_);
+                    tables_[undo.table] = undo.dropped;
+                }
+                index::restore_table_indexes(undo.indexes);
+                break;
+            }
+            case WalOp::INSERT: {
+                auto table = get_table(undo.table);
+                std::vector<size_t> added(table->row_count() - undo.row_count);
+                std::iota(added.begin(), added.end(), undo.row_count);
+                index::remove_from_table_indexes(undo.table, added);
+                index::remove_from_composite_table_indexes(undo.table, added);
+                table->truncate(undo.row_count);
+                break;
+            }
+            case WalOp::UPDATE: {
+                auto table = get_table(undo.table);
+                for (size_t k = undo.row_ids.size(); k-- > 0;) {
+                    table->update_row(undo.row_ids[k], undo.rows[k]);
+                }
+                break;
+            }
+            case WalOp::DELETE: {
+                auto table = get_table(undo.table);
+                table->undelete_rows(undo.row_ids);
+                const Schema& schema = table->get_schema();
+                for (size_t row_id : undo.row_ids) {
+                    std::vector<std::string> row = table->get_row(row_id);
+                    index::update_table_indexes(undo.table, row_id, row, schema);
+                    index::update_composite_table_indexes(undo.table, row_id, row, schema);
+                }
+                break;
+            }
+            case WalOp::PURGE: {
+                // Renumber the indexes back, then bring the old version back
+                auto table = get_table(undo.table);
+                std::vector<size_t> restored(table->row_count());
+                for (size_t row_id = 0; row_id < undo.row_ids.size(); ++row_id) {
+                    if (undo.row_ids[row_id] != Table::kPurgedRow) {
+                        restored[undo.row_ids[row_id]] = row_id;
+                    }
+                }
+                index::remap_table_indexes(undo.table, restored);
+                index::remap_composite_table_indexes(undo.table, restored);
+                table->restore(*undo.dropped);
+                break;
+            }
+        }
+        txn.undo.pop_back();
+    }
+    txn.redo.resize(redo_mark);
+}
+
+void Database::apply_redo(const WalRecord& record) {
+    switch (record.op) {
+        case WalOp::CREATE_TABLE:
+            create_table(record.table, record.schema);
+            break;
+        case WalOp::DROP_TABLE:
+            {
+                std::lock_guard<std::mutex> lock(catalog_mutex_);
+                tables_.erase(record.table);
+            }
+            index::clear_table_indexes(record.table);
+            index::clear_composite_table_indexes(record.table);
+            break;
+        case WalOp::INSERT: {
+            auto table = get_table(record.table);
+            size_t row_id = table->row_count();
+            table->insert_row(record.values);
+            index::update_table_indexes(record.table, row_id, record.values, table->get_schema());
+            index::update_composite_table_indexes(record.table, row_id, record.values, table->get_schema());
+            break;
+        }
+        case WalOp::UPDATE:
+            get_table(record.table)->update_row(record.row_ids.at(0), record.values);
+            break;
+        case WalOp::DELETE: {
+            std::vector<size_t> row_ids(record.row_ids.begin(), record.row_ids.end());
+            get_table(record.table)->delete_rows(row_ids);
+            index::remove_from_table_indexes(record.table, row_ids);
+            index::remove_from_composite_table_indexes(record.table, row_ids);
+            break;
+        }
+        case WalOp::PURGE: {
+            std::vector<size_t> remap = get_table(record.table)->purge_deleted();
+            index::remap_table_indexes(record.table, remap);
+            index::remap_composite_table_indexes(record.table, remap);
+            break;
+        }
+    }
+}
+
 }  // namespace lyradb
@@ -1,4 +1,9 @@
 #include "lyradb/database_file.h"
+#include "lyradb/io_throttle.h"
+#include "lyradb/table_serializer.h"
+#include "lyradb/task_scheduler.h"
+#include "lyradb/write_ahead_log.h"
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include <cstring>
@@ -7,26 +12,77 @@
 
 namespace lyradb {
 
+namespace {
+
+// Base manifest of a table rewritten by compact_step(), until the
+// checkpoint that switches to it writes the real one beside it
+const char* const kCompactManifest = "compact.lyta";
+
+}  // namespace
+
 // ============================================================================
 // DatabaseFile Implementation
 // ============================================================================
 
 DatabaseFile::DatabaseFile(const std::string& filepath)
+    : DatabaseFile(filepath, true) {}
+
+DatabaseFile::DatabaseFile(const std::string& filepath, bool load_existing)
     : filepath_(filepath), 
-      db_(std::make_unique<Database>()),
+      db_(std::make_unique<Database>(filepath)),
       is_open_(true),
-      modified_(false) {
+      modified_(false),
+      compactor_(std::make_unique<Compactor>()) {
     
-    // Check if file exists and load it
+    // Check if file exists and load it. Load and replay errors propagate:
+    // an empty database over files it could not read would overwrite
+    // them at the next checkpoint
     namespace fs = std::filesystem;
-    if (fs::exists(filepath)) {
-        try {
+    if (load_existing) {
+        if (fs::exists(filepath)) {
             read_from_file();
-        } catch (const std::exception& e) {
-            // If file cannot be loaded, start with empty database
-            db_ = std::make_unique<Database>();
+        } else {
+            // Work committed before a first checkpoint is only in the log
+            db_->open_wal(wal_path(filepath_));
+        }
+    }
+}
+
+DatabaseFile::DatabaseFile(DatabaseFile&& other) noexcept
+    // The compactor thread works on other, so it stops first
+    : filepath_((other.stop_compaction(), std::move(other.filepath_))),
+      db_(std::move(other.db_)),
+      is_open_(other.is_open_),
+      modified_(other.modified_),
+      stored_(std::move(other.stored_)),
+      checkpoint_id_(other.checkpoint_id_),
+      checkpoint_lsn_(other.checkpoint_lsn_),
+      next_table_id_(other.next_table_id_),
+      compactor_(std::move(other.compactor_)) {
+    other.is_open_ = false;
+    other.modified_ = false;
+}
+
+DatabaseFile& DatabaseFile::operator=(DatabaseFile&& other) noexcept {
+    if (this != &other) {
+        try {
+            close();
+        } catch (...) {
         }
+        other.stop_compaction();
+        filepath_ = std::move(other.filepath_);
+        db_ = std::move(other.db_);
+        is_open_ = other.is_open_;
+        modified_ = other.modified_;
+        stored_ = std::move(other.stored_);
+        checkpoint_id_ = other.checkpoint_id_;
+        checkpoint_lsn_ = other.checkpoint_lsn_;
+        next_table_id_ = other.next_table_id_;
+        compactor_ = std::move(other.compactor_);
+        other.is_open_ = false;
+        other.modified_ = false;
     }
+    return *this;
 }
 
 DatabaseFile DatabaseFile::open(const std::string& filepath) {
@@ -36,7 +92,7 @@ DatabaseFile DatabaseFile::open(const std::string& filepath) {
         throw std::runtime_error("Database file not found: " + filepath);
     }
     
-    DatabaseFile dbf(filepath);
+    DatabaseFile dbf(filepath, false);
     dbf.read_from_file();
     return dbf;
 }
@@ -64,16 +120,27 @@ void DatabaseFile::save() {
     if (!is_open_) {
         throw std::runtime_error("Database is closed");
     }
-    write_to_file();
+    checkpoint(false);
     modified_ = false;
 }
 
 void DatabaseFile::save_as(const std::string& filepath) {
-    filepath_ = filepath;
+    if (filepath != filepath_) {
+        // Nothing at the new location can be reused; the old files and
+        // log are left as they are
+        stop_compaction();
+        filepath_ = filepath;
+        std::lock_guard<std::mutex> lock(compactor_->mutex);
+        stored_.clear();
+        checkpoint_id_ = 0;
+        next_table_id_ = 0;
+        std::filesystem::remove_all(data_dir(filepath_));
+    }
     save();
 }
 
 void DatabaseFile::close() {
+    stop_compaction();
     if (modified_) {
         try {
             save();
@@ -109,25 +176,39 @@ const Database& DatabaseFile::get_database() const {
 
 size_t DatabaseFile::get_file_size() const {
     namespace fs = std::filesystem;
+    size_t total = 0;
     try {
         if (fs::exists(filepath_)) {
-            return fs::file_size(filepath_);
+            total += fs::file_size(filepath_);
+        }
+        if (fs::exists(wal_path(filepath_))) {
+            total += fs::file_size(wal_path(filepath_));
+        }
+        // Table data directory
+        if (fs::exists(data_dir(filepath_))) {
+            for (const auto& entry : fs::recursive_directory_iterator(data_dir(filepath_))) {
+                if (entry.is_regular_file()) {
+                    total += entry.file_size();
+                }
+            }
         }
     } catch (...) {
     }
-    return 0;
+    return total;
 }
 
 size_t DatabaseFile::get_table_count() const {
     if (!is_open_) return 0;
-    return db_->get_table_count();
+    return db_->list_tables().size();
 }
 
 size_t DatabaseFile::get_total_rows() const {
     if (!is_open_) return 0;
     // Sum rows from all tables
     size_t total = 0;
-    // This would require access to table enumeration
+    for (const auto& name : db_->list_tables()) {
+        total += db_->get_table(name)->live_row_count();
+    }
     return total;
 }
 
@@ -135,19 +216,169 @@ void DatabaseFile::compact() {
     if (!is_open_) {
         throw std::runtime_error("Database is closed");
     }
-    // Save to a temporary file, then replace
-    std::string temp_path = filepath_ + ".tmp";
-    std::string original_path = filepath_;
+    for (const auto& name : db_->list_tables()) {
+        db_->purge_deleted(name);
+    }
+    checkpoint(true);
+    modified_ = false;
+}
+
+CompactionStats DatabaseFile::compact_step(const CompactionOptions& options) {
+    namespace fs = std::filesystem;
+    if (!is_open_) {
+        throw std::runtime_error("Database is closed");
+    }
+    CompactionStats pass;
+    pass.passes = 1;
     
-    filepath_ = temp_path;
-    write_to_file();
+    // 1. Purge tables with many deleted rows. This dirties the row groups
+    //    from the first purged row on; the checkpoint below writes them
+    for (const auto& name : db_->list_tables()) {
+        try {
+            auto version = db_->get_table_snapshot(name);
+            size_t deleted = version->deleted_count();
+            if (deleted > 0 && deleted >= options.min_deleted_ratio * version->row_count()) {
+                pass.rows_purged += db_->purge_deleted(name);
+                pass.tables_purged++;
+            }
+        } catch (const std::runtime_error&) {
+            // Not committed yet, or dropped meanwhile
+        }
+    }
     
-    namespace fs = std::filesystem;
-    fs::remove(original_path);
-    fs::rename(temp_path, original_path);
+    // 2. Snapshot the tables worth rewriting right after a checkpoint:
+    //    their live versions are clean then, so whatever is dirty when
+    //    they are switched over changed after the snapshot
+    bool any = false;
+    {
+        std::lock_guard<std::mutex> lock(compactor_->mutex);
+        for (const auto& entry : stored_) {
+            any = any || worth_rewriting(entry.second, options);
+        }
+    }
+    std::vector<CompactedTable> jobs;
+    if (any) {
+        checkpoint(false, nullptr, [&]() {
+            for (const auto& entry : stored_) {
+                auto table = entry.second.table.lock();
+                if (table && worth_rewriting(entry.second, options)) {
+                    CompactedTable job;
+                    job.name = entry.first;
+                    job.dir = "t" + std::to_string(next_table_id_++);
+                    job.table = table;
+                    job.version = table->snapshot();
+                    job.checkpoint_id = checkpoint_id_;
+                    jobs.push_back(std::move(job));
+                }
+            }
+        });
+    }
     
-    filepath_ = original_path;
-    modified_ = false;
+    // 3. Rewrite them with nothing held, then switch over at a checkpoint,
+    //    which appends the row groups changed meanwhile. A table saved,
+    //    dropped or re-created in between keeps its old files
+    const fs::path data = data_dir(filepath_);
+    std::error_code ec;
+    try {
+        if (!jobs.empty()) {
+            IoThrottle throttle(options.bytes_per_second);
+            for (const auto& job : jobs) {
+                pass.bytes_written += rewrite_table(job, throttle);
+            }
+            checkpoint(false, &jobs);
+        }
+    } catch (...) {
+        for (const auto& job : jobs) {
+            if (!job.applied) {
+                fs::remove_all(data / job.dir, ec);
+            }
+        }
+        throw;
+    }
+    for (const auto& job : jobs) {
+        if (job.applied) {
+            fs::remove(data / job.dir / kCompactManifest, ec);
+            pass.tables_rewritten++;
+        } else {
+            fs::remove_all(data / job.dir, ec);
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(compactor_->mutex);
+    compactor_->stats.passes += pass.passes;
+    compactor_->stats.tables_purged += pass.tables_purged;
+    compactor_->stats.rows_purged += pass.rows_purged;
+    compactor_->stats.tables_rewritten += pass.tables_rewritten;
+    compactor_->stats.bytes_written += pass.bytes_written;
+    return pass;
+}
+
+bool DatabaseFile::worth_rewriting(const StoredTable& stored, const CompactionOptions& options) {
+    if (stored.file_bytes <= stored.page_bytes) {
+        return false;
+    }
+    uint64_t dead = stored.file_bytes - stored.page_bytes;
+    return dead >= options.min_dead_bytes && dead >= options.min_dead_ratio * stored.file_bytes;
+}
+
+uint64_t DatabaseFile::rewrite_table(const CompactedTable& job, IoThrottle& throttle) {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::path(data_dir(filepath_)) / job.dir;
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    storage::TableWriter writer((dir / kCompactManifest).string(),
+                                job.version->get_schema(), dir.string());
+    writer.set_throttle(&throttle);
+    writer.write_table(*job.version, TaskScheduler::global());
+    writer.finalize();
+    return writer.get_statistics().compressed_bytes;
+}
+
+void DatabaseFile::start_compaction(const CompactionOptions& options) {
+    if (!is_open_) {
+        throw std::runtime_error("Database is closed");
+    }
+    stop_compaction();
+    {
+        std::lock_guard<std::mutex> lock(compactor_->mutex);
+        compactor_->stop = false;
+        compactor_->options = options;
+    }
+    compactor_->thread = std::thread([this]() { compaction_loop(); });
+}
+
+void DatabaseFile::stop_compaction() {
+    if (!compactor_) {
+        return;   // Moved from
+    }
+    {
+        std::lock_guard<std::mutex> lock(compactor_->mutex);
+        compactor_->stop = true;
+    }
+    compactor_->wake.notify_all();
+    if (compactor_->thread.joinable()) {
+        compactor_->thread.join();
+    }
+}
+
+CompactionStats DatabaseFile::compaction_stats() const {
+    std::lock_guard<std::mutex> lock(compactor_->mutex);
+    return compactor_->stats;
+}
+
+void DatabaseFile::compaction_loop() {
+    std::unique_lock<std::mutex> lock(compactor_->mutex);
+    while (!compactor_->wake.wait_for(lock, compactor_->options.interval,
+                                      [this]() { return compactor_->stop; })) {
+        CompactionOptions options = compactor_->options;
+        lock.unlock();
+        try {
+            compact_step(options);
+        } catch (const std::exception&) {
+            // Nothing was switched over; the next pass tries again
+        }
+        lock.lock();
+    }
 }
 
 void DatabaseFile::backup(const std::string& backup_path) {
@@ -158,6 +389,14 @@ void DatabaseFile::backup(const std::string& backup_path) {
     }
     
     fs::copy_file(filepath_, backup_path, fs::copy_options::overwrite_existing);
+    fs::remove_all(data_dir(backup_path));
+    if (fs::exists(data_dir(filepath_))) {
+        fs::copy(data_dir(filepath_), data_dir(backup_path), fs::copy_options::recursive);
+    }
+    fs::remove(wal_path(backup_path));
+    if (fs::exists(wal_path(filepath_))) {
+        fs::copy_file(wal_path(filepath_), wal_path(backup_path));
+    }
 }
 
 DatabaseFile::~DatabaseFile() {
@@ -168,28 +407,194 @@ DatabaseFile::~DatabaseFile() {
     }
 }
 
-void DatabaseFile::write_to_file() {
-    std::ofstream file(filepath_, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file for writing: " + filepath_);
-    }
-    
-    // Write header
-    uint32_t magic = DB_MAGIC;
-    uint32_t version = DB_VERSION;
+std::string DatabaseFile::data_dir(const std::string& filepath) {
+    return filepath + ".tables";
+}
+
+std::string DatabaseFile::wal_path(const std::string& filepath) {
+    return filepath + ".wal";
+}
+
+namespace {
+
+// Make renames and new entries in a directory durable
+void sync_directory(const std::filesystem::path& dir) {
+#ifndef _WIN32
+    sync_file(dir.empty() ? "." : dir.string());
+#else
+    (void)dir;
+#endif
+}
+
+}  // namespace
+
+void DatabaseFile::checkpoint(bool rewrite_all, std::vector<CompactedTable>* compacted,
+                              const std::function<void()>& then) {
+    db_->checkpoint([&](uint64_t lsn) {
+        write_checkpoint(lsn, rewrite_all, compacted);
+        
+        // Log to this file's WAL from here on (after save_as(), or when an
+        // earlier switch failed to reopen it). The catalog just written
+        // covers everything committed, so the old log is not needed
+        WriteAheadLog* wal = db_->wal();
+        if (wal == nullptr || wal->path() != wal_path(filepath_)) {
+            db_->close_wal();
+            std::filesystem::remove(wal_path(filepath_));
+            db_->open_wal(wal_path(filepath_), std::chrono::microseconds(0), lsn);
+        }
+        if (then) {
+            then();
+        }
+    });
+}
+
+void DatabaseFile::write_checkpoint(uint64_t lsn, bool rewrite_all,
+                                    std::vector<CompactedTable>* compacted) {
+    namespace fs = std::filesystem;
     
-    file.write(reinterpret_cast<char*>(&magic), sizeof(magic));
-    file.write(reinterpret_cast<char*>(&version), sizeof(version));
+    const fs::path data = data_dir(filepath_);
+    fs::create_directories(data);
+    const uint64_t checkpoint_id = checkpoint_id_ + 1;
+    const std::string manifest_name = "table." + std::to_string(checkpoint_id) + ".lyta";
+    uint64_t next_table_id = next_table_id_;
     
-    // Write database metadata
-    uint64_t timestamp = std::chrono::system_clock::now().time_since_epoch().count();
-    file.write(reinterpret_cast<char*>(&timestamp), sizeof(timestamp));
+    // 1. Table files. Nothing written here is referenced until the catalog
+    //    is replaced, so a failure leaves the last checkpoint intact
+    std::map<std::string, StoredTable> next;
+    std::vector<std::shared_ptr<Table>> written;
+    for (const auto& name : db_->list_tables()) {
+        auto table = db_->get_table(name);
+        auto it = stored_.find(name);
+        bool stored = !rewrite_all && it != stored_.end() && it->second.table.lock() == table;
+        const CompactedTable* rebase = nullptr;
+        if (stored && compacted != nullptr) {
+            for (const auto& job : *compacted) {
+                if (job.name == name && job.checkpoint_id == checkpoint_id_ &&
+                    job.table.lock() == table) {
+                    rebase = &job;
+                }
+            }
+        }
+        if (stored && !table->is_dirty() && rebase == nullptr) {
+            next[name] = it->second;
+            continue;
+        }
+        
+        StoredTable entry;
+        entry.table = table;
+        fs::path table_dir;
+        if (rebase != nullptr) {
+            // Switch to the compacted files, appending the row groups
+            // changed since their snapshot
+            table_dir = rebase->dir;
+            entry.manifest = (table_dir / manifest_name).generic_string();
+            storage::TableReader base((data / table_dir / kCompactManifest).string());
+            storage::TableWriter writer((data / entry.manifest).string(), base);
+            writer.write_row_groups(*table, table->dirty_row_groups(), TaskScheduler::global());
+            writer.finalize();
+            entry.page_bytes = writer.get_statistics().compressed_bytes;
+        } else if (stored) {
+            // Append the dirty row groups to the existing column files
+            table_dir = fs::path(it->second.manifest).parent_path();
+            entry.manifest = (table_dir / manifest_name).generic_string();
+            storage::TableReader base((data / it->second.manifest).string());
+            storage::TableWriter writer((data / entry.manifest).string(), base);
+            writer.write_row_groups(*table, table->dirty_row_groups(), TaskScheduler::global());
+            writer.finalize();
+            entry.page_bytes = writer.get_statistics().compressed_bytes;
+        } else {
+            // New, re-created or compacted table: a fresh directory
+            table_dir = "t" + std::to_string(next_table_id++);
+            entry.manifest = (table_dir / manifest_name).generic_string();
+            fs::remove_all(data / table_dir);
+            fs::create_directories(data / table_dir);
+            storage::TableWriter writer((data / entry.manifest).string(),
+                                        table->get_schema(),
+                                        (data / table_dir).string());
+            writer.write_table(*table, TaskScheduler::global());
+            writer.finalize();
+            entry.page_bytes = writer.get_statistics().compressed_bytes;
+        }
+        for (const auto& file : fs::directory_iterator(data / table_dir)) {
+            sync_file(file.path().string());
+            if (file.path().extension() == ".lycol") {
+                entry.file_bytes += file.file_size();
+            }
+        }
+        sync_directory(data / table_dir);
+        written.push_back(table);
+        next[name] = std::move(entry);
+    }
+    sync_directory(data);
     
-    // TODO: Serialize database content
-    // This would write all tables, columns, and data
-    // For now, we write a simple placeholder
+    // 2. Catalog, written beside the old one and renamed over it: the
+    //    commit point of the checkpoint
+    const std::string staging_file = filepath_ + ".tmp";
+    {
+        std::ofstream file(staging_file, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file for writing: " + filepath_);
+        }
+        
+        // Write header
+        uint32_t magic = DB_MAGIC;
+        uint32_t version = DB_VERSION;
+        file.write(reinterpret_cast<char*>(&magic), sizeof(magic));
+        file.write(reinterpret_cast<char*>(&version), sizeof(version));
+        
+        // Write database metadata
+        uint64_t timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+        file.write(reinterpret_cast<char*>(&timestamp), sizeof(timestamp));
+        file.write(reinterpret_cast<const char*>(&lsn), sizeof(lsn));
+        file.write(reinterpret_cast<const char*>(&checkpoint_id), sizeof(checkpoint_id));
+        file.write(reinterpret_cast<char*>(&next_table_id), sizeof(next_table_id));
+        
+        // Table catalog: manifest paths relative to the data directory
+        uint32_t table_count = static_cast<uint32_t>(next.size());
+        file.write(reinterpret_cast<char*>(&table_count), sizeof(table_count));
+        for (const auto& entry : next) {
+            uint32_t len = static_cast<uint32_t>(entry.second.manifest.size());
+            file.write(reinterpret_cast<char*>(&len), sizeof(len));
+            file.write(entry.second.manifest.data(), len);
+        }
+        
+        file.close();
+        if (!file) {
+            throw std::runtime_error("Failed to write database file: " + filepath_);
+        }
+    }
+    sync_file(staging_file);
+    fs::rename(staging_file, filepath_);
+    if (compacted != nullptr) {
+        for (auto& job : *compacted) {
+            auto it = next.find(job.name);
+            job.applied = it != next.end() &&
+                          fs::path(it->second.manifest).parent_path() == fs::path(job.dir);
+        }
+    }
+    sync_directory(fs::path(filepath_).parent_path());
     
-    file.close();
+    // 3. Committed: forget dirty groups and drop files no longer referenced
+    for (const auto& table : written) {
+        table->clear_dirty();
+    }
+    std::error_code ec;
+    for (const auto& entry : stored_) {
+        auto it = next.find(entry.first);
+        fs::path old_dir = fs::path(entry.second.manifest).parent_path();
+        if (it == next.end() || fs::path(it->second.manifest).parent_path() != old_dir) {
+            fs::remove_all(data / old_dir, ec);
+        } else if (it->second.manifest != entry.second.manifest) {
+            fs::remove(data / entry.second.manifest, ec);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(compactor_->mutex);
+        stored_ = std::move(next);
+    }
+    checkpoint_id_ = checkpoint_id;
+    checkpoint_lsn_ = lsn;
+    next_table_id_ = next_table_id;
 }
 
 void DatabaseFile::read_from_file() {
@@ -215,12 +620,58 @@ void DatabaseFile::read_from_file() {
     
     // Read metadata
     uint64_t timestamp = 0;
+    uint64_t checkpoint_lsn = 0;
+    uint64_t checkpoint_id = 0;
+    uint64_t next_table_id = 0;
     file.read(reinterpret_cast<char*>(&timestamp), sizeof(timestamp));
+    file.read(reinterpret_cast<char*>(&checkpoint_lsn), sizeof(checkpoint_lsn));
+    file.read(reinterpret_cast<char*>(&checkpoint_id), sizeof(checkpoint_id));
+    file.read(reinterpret_cast<char*>(&next_table_id), sizeof(next_table_id));
     
-    // TODO: Deserialize database content
-    // This would read all tables, columns, and data
-    
+    uint32_t table_count = 0;
+    file.read(reinterpret_cast<char*>(&table_count), sizeof(table_count));
+    std::vector<std::string> manifests;
+    for (uint32_t i = 0; i < table_count; ++i) {
+        uint32_t len = 0;
+        file.read(reinterpret_cast<char*>(&len), sizeof(len));
+        std::string manifest(len, '\0');
+        file.read(&manifest[0], len);
+        manifests.push_back(std::move(manifest));
+    }
+    if (!file) {
+        throw std::runtime_error("Truncated database file: " + filepath_);
+    }
     file.close();
+    
+    // Attach every table lazily: only manifests and page indexes are
+    // read here, columns are decoded from the mapped files on first use
+    auto db = std::make_unique<Database>(filepath_);
+    std::map<std::string, StoredTable> stored;
+    for (const auto& manifest : manifests) {
+        storage::TableReader reader(
+            (std::filesystem::path(data_dir(filepath_)) / manifest).string());
+        auto table = reader.open_table();
+        db->attach_table(table);
+        StoredTable entry{manifest, table};
+        for (uint32_t c = 0; c < reader.get_column_count(); ++c) {
+            const storage::ColumnReader& column = reader.column_reader(c);
+            entry.file_bytes += reader.get_manifest().column_metadata[c].column_file_size;
+            for (uint32_t p = 0; p < column.page_count(); ++p) {
+                entry.page_bytes += column.get_page_metadata(p).page_size;
+            }
+        }
+        stored[table->name()] = std::move(entry);
+    }
+    
+    // Redo what was committed after the checkpoint
+    db->open_wal(wal_path(filepath_), std::chrono::microseconds(0), checkpoint_lsn);
+    
+    db_ = std::move(db);
+    std::lock_guard<std::mutex> lock(compactor_->mutex);
+    stored_ = std::move(stored);
+    checkpoint_id_ = checkpoint_id;
+    checkpoint_lsn_ = checkpoint_lsn;
+    next_table_id_ = next_table_id;
 }
 
 } // namespace lyradb
@@ -17,6 +17,7 @@ std::string QueryCache::compute_cache_key(const std::string& query_sql) const {
 }
 
 std::shared_ptr<QueryResult> QueryCache::get(const std::string& query_sql) {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (!enabled_) {
         stats_.total_misses++;
         return nullptr;
@@ -56,6 +57,7 @@ void QueryCache::put(const std::string& query_sql,
     if (!enabled_ || !result) {
         return;
     }
+    std::lock_guard<std::mutex> lock(mutex_);
     
     std::string key = compute_cache_key(query_sql);
     size_t result_size = estimate_result_size(result.get());
@@ -94,6 +96,7 @@ void QueryCache::put(const std::string& query_sql,
 }
 
 size_t QueryCache::invalidate(const std::string& table_name) {
+    std::lock_guard<std::mutex> lock(mutex_);
     size_t invalidated_count = 0;
     
     auto table_it = table_to_queries_.find(table_name);
@@ -118,6 +121,7 @@ size_t QueryCache::invalidate(const std::string& table_name) {
 }
 
 void QueryCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
     cache_data_.clear();
     access_order_.clear();
     table_to_queries_.clear();
@@ -178,6 +182,7 @@ size_t QueryCache::estimate_result_size(const QueryResult* result) const {
 }
 
 QueryCache::Statistics QueryCache::get_statistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
     return stats_;
 }
 
@@ -2,7 +2,10 @@
 #include "lyradb/hash_index.h"
 #include "lyradb/composite_key.h"
 #include "lyradb/schema.h"
+#include "lyradb/table.h"
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -84,6 +87,55 @@ static std::unordered_map<std::string, std::shared_ptr<HashIndexInstance>> g_has
  */
 static std::unordered_map<std::string, std::shared_ptr<CompositeHashIndexInstance>> g_composite_hash_indexes;
 
+/**
+ * @brief Guards both registries and the indexes in them: snapshot readers
+ * look up while writers and the purge thread insert, remove and renumber
+ */
+static std::mutex g_hash_index_mutex;
+
+namespace {
+
+/**
+ * @brief Membership test for a set of row ids, O(1) per lookup
+ */
+std::vector<bool> row_id_set(const std::vector<size_t>& row_ids) {
+    size_t bound = 0;
+    for (size_t row_id : row_ids) {
+        bound = std::max(bound, row_id + 1);
+    }
+    std::vector<bool> set(bound, false);
+    for (size_t row_id : row_ids) {
+        set[row_id] = true;
+    }
+    return set;
+}
+
+/**
+ * @brief Drop the given rows from one index in a single pass
+ */
+template <typename Index>
+void remove_rows(Index& index, const std::vector<bool>& removed) {
+    index.rewrite_values([&](size_t row_id) {
+        return row_id >= removed.size() || !removed[row_id];
+    });
+}
+
+/**
+ * @brief Apply a Table::purge_deleted() mapping to one index
+ */
+template <typename Index>
+void remap_rows(Index& index, const std::vector<size_t>& remap) {
+    index.rewrite_values([&](size_t& row_id) {
+        if (row_id >= remap.size()) {
+            return true;
+        }
+        row_id = remap[row_id];
+        return row_id != Table::kPurgedRow;
+    });
+}
+
+}  // namespace
+
 /**
  * @brief Build a hash index from table data
  * @param index_name Index identifier
@@ -99,6 +151,8 @@ void build_hash_index(
     const std::vector<std::vector<std::string>>& rows,
     const Schema& schema) {
     
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
     // Find column index
     int col_index = -1;
     for (size_t i = 0; i < schema.num_columns(); ++i) {
@@ -137,6 +191,8 @@ std::vector<size_t> lookup_hash_index(
     const std::string& index_name,
     const std::string& key) {
     
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
     auto it = g_hash_indexes.find(index_name);
     if (it == g_hash_indexes.end()) {
         return {};  // Index not found
@@ -162,6 +218,8 @@ void update_table_indexes(
     const std::vector<std::string>& row,
     const Schema& schema) {
     
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
     // Find all hash indexes on this table
     for (auto& [index_name, index_inst_ptr] : g_hash_indexes) {
         if (!index_inst_ptr) continue;
@@ -192,14 +250,37 @@ void remove_from_table_indexes(
     const std::string& table_name,
     const std::vector<size_t>& row_ids) {
     
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
+    // One pass per index, however many rows go
+    std::vector<bool> removed = row_id_set(row_ids);
+    
     // Find all hash indexes on this table
     for (auto& [index_name, index_inst_ptr] : g_hash_indexes) {
         if (!index_inst_ptr) continue;
         
         if (index_inst_ptr->table_name == table_name) {
-            for (size_t row_id : row_ids) {
-                index_inst_ptr->index->remove(row_id);
-            }
+            remove_rows(*index_inst_ptr->index, removed);
+        }
+    }
+}
+
+/**
+ * @brief Renumber rows in all indexes on a table after a purge
+ * @param table_name Table name
+ * @param remap Old row id -> new row id (Table::kPurgedRow drops it)
+ */
+void remap_table_indexes(
+    const std::string& table_name,
+    const std::vector<size_t>& remap) {
+    
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
+    for (auto& [index_name, index_inst_ptr] : g_hash_indexes) {
+        if (!index_inst_ptr) continue;
+        
+        if (index_inst_ptr->table_name == table_name) {
+            remap_rows(*index_inst_ptr->index, remap);
         }
     }
 }
@@ -209,6 +290,8 @@ void remove_from_table_indexes(
  * @param table_name Table name
  */
 void clear_table_indexes(const std::string& table_name) {
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
     std::vector<std::string> to_remove;
     
     for (auto& [index_name, index_inst_ptr] : g_hash_indexes) {
@@ -224,6 +307,61 @@ void clear_table_indexes(const std::string& table_name) {
     }
 }
 
+/**
+ * @brief Indexes of a dropped table, held until its transaction ends
+ */
+struct DetachedIndexes {
+    std::vector<std::pair<std::string, std::shared_ptr<HashIndexInstance>>> hash;
+    std::vector<std::pair<std::string, std::shared_ptr<CompositeHashIndexInstance>>> composite;
+};
+
+/**
+ * @brief Remove all hash and composite indexes for a table, keeping them
+ * @param table_name Table name
+ * @return The removed indexes, for restore_table_indexes()
+ */
+std::shared_ptr<DetachedIndexes> detach_table_indexes(const std::string& table_name) {
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
+    auto detached = std::make_shared<DetachedIndexes>();
+    for (auto it = g_hash_indexes.begin(); it != g_hash_indexes.end();) {
+        if (it->second && it->second->table_name == table_name) {
+            detached->hash.emplace_back(it->first, std::move(it->second));
+            it = g_hash_indexes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = g_composite_hash_indexes.begin(); it != g_composite_hash_indexes.end();) {
+        if (it->second && it->second->table_name == table_name) {
+            detached->composite.emplace_back(it->first, std::move(it->second));
+            it = g_composite_hash_indexes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return detached;
+}
+
+/**
+ * @brief Put indexes removed by detach_table_indexes() back
+ * @param detached The removed indexes (may be null)
+ */
+void restore_table_indexes(const std::shared_ptr<DetachedIndexes>& detached) {
+    if (!detached) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
+    for (const auto& [index_name, index_inst_ptr] : detached->hash) {
+        g_hash_indexes[index_name] = index_inst_ptr;
+    }
+    for (const auto& [index_name, index_inst_ptr] : detached->composite) {
+        g_composite_hash_indexes[index_name] = index_inst_ptr;
+    }
+}
+
 /**
  * @brief Build a composite hash index from table data (Phase 4.1.2)
  * @param index_name Index identifier
@@ -239,6 +377,8 @@ void build_composite_hash_index(
     const std::vector<std::vector<std::string>>& rows,
     const Schema& schema) {
     
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
     // Find column indices
     std::vector<int> col_indices;
     for (const auto& col_name : column_names) {
@@ -292,6 +432,8 @@ std::vector<size_t> lookup_composite_hash_index(
     const std::string& index_name,
     const std::vector<std::string>& key_values) {
     
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
     auto it = g_composite_hash_indexes.find(index_name);
     if (it == g_composite_hash_indexes.end()) {
         return {};  // Index not found
@@ -319,6 +461,8 @@ void update_composite_table_indexes(
     const std::vector<std::string>& row,
     const Schema& schema) {
     
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
     // Find all composite indexes on this table
     for (auto& [index_name, index_inst_ptr] : g_composite_hash_indexes) {
         if (!index_inst_ptr) continue;
@@ -366,14 +510,36 @@ void remove_from_composite_table_indexes(
     const std::string& table_name,
     const std::vector<size_t>& row_ids) {
     
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
+    std::vector<bool> removed = row_id_set(row_ids);
+    
     // Find all composite indexes on this table
     for (auto& [index_name, index_inst_ptr] : g_composite_hash_indexes) {
         if (!index_inst_ptr) continue;
         
         if (index_inst_ptr->table_name == table_name) {
-            for (size_t row_id : row_ids) {
-                index_inst_ptr->index->remove(row_id);
-            }
+            remove_rows(*index_inst_ptr->index, removed);
+        }
+    }
+}
+
+/**
+ * @brief Renumber rows in all composite indexes on a table after a purge
+ * @param table_name Table name
+ * @param remap Old row id -> new row id (Table::kPurgedRow drops it)
+ */
+void remap_composite_table_indexes(
+    const std::string& table_name,
+    const std::vector<size_t>& remap) {
+    
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
+    for (auto& [index_name, index_inst_ptr] : g_composite_hash_indexes) {
+        if (!index_inst_ptr) continue;
+        
+        if (index_inst_ptr->table_name == table_name) {
+            remap_rows(*index_inst_ptr->index, remap);
         }
     }
 }
@@ -383,6 +549,8 @@ void remove_from_composite_table_indexes(
  * @param table_name Table name
  */
 void clear_composite_table_indexes(const std::string& table_name) {
+    std::lock_guard<std::mutex> lock(g_hash_index_mutex);
+    
     std::vector<std::string> to_remove;
     
     for (auto& [index_name, index_inst_ptr] : g_composite_hash_indexes) {
@@ -0,0 +1,338 @@
+#include "lyradb/zone_map.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace lyradb {
+namespace indexes {
+
+namespace {
+
+enum class BoundKind { INT, DOUBLE, STRING, NONE };
+
+BoundKind bound_kind(DataType type) {
+    switch (type) {
+        case DataType::INT32:
+        case DataType::INT64:
+        case DataType::DATE32:
+        case DataType::TIMESTAMP:
+        case DataType::BOOL:
+            return BoundKind::INT;
+        case DataType::FLOAT32:
+        case DataType::FLOAT64:
+            return BoundKind::DOUBLE;
+        case DataType::STRING:
+            return BoundKind::STRING;
+        default:
+            return BoundKind::NONE;
+    }
+}
+
+template <typename T>
+bool range_may_match(T min, T max, simd::CompareOp op, T lo, T hi) {
+    switch (op) {
+        case simd::CompareOp::EQ: return lo >= min && lo <= max;
+        case simd::CompareOp::NE: return !(min == max && min == lo);
+        case simd::CompareOp::LT: return min < lo;
+        case simd::CompareOp::LE: return min <= lo;
+        case simd::CompareOp::GT: return max > lo;
+        case simd::CompareOp::GE: return max >= lo;
+        case simd::CompareOp::BETWEEN: return max >= lo && min <= hi;
+    }
+    return true;
+}
+
+template <typename T>
+void put(std::vector<uint8_t>& out, T value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void put_string(std::vector<uint8_t>& out, const std::string& value) {
+    put<uint32_t>(out, static_cast<uint32_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    T get() {
+        need(sizeof(T));
+        T value;
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    std::string get_string() {
+        uint32_t len = get<uint32_t>();
+        need(len);
+        std::string value(reinterpret_cast<const char*>(data_ + pos_), len);
+        pos_ += len;
+        return value;
+    }
+
+private:
+    void need(size_t bytes) const {
+        if (size_ - pos_ < bytes) {
+            throw std::runtime_error("Truncated zone map data");
+        }
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+}  // namespace
+
+ZoneMapIndex::ZoneMapIndex(DataType type) : type_(type) {}
+
+ZoneMapIndex::Zone& ZoneMapIndex::open_zone() {
+    if (!open_) {
+        Zone zone;
+        if (!zones_.empty()) {
+            zone.first_row = zones_.back().first_row + zones_.back().row_count;
+        }
+        zones_.push_back(zone);
+        open_ = true;
+    }
+    return zones_.back();
+}
+
+void ZoneMapIndex::include(Zone& zone, const void* slot) {
+    int64_t i = 0;
+    double d = 0.0;
+    switch (type_) {
+        case DataType::INT32:
+        case DataType::DATE32: {
+            int32_t v;
+            std::memcpy(&v, slot, sizeof(v));
+            i = v;
+            break;
+        }
+        case DataType::INT64:
+        case DataType::TIMESTAMP:
+            std::memcpy(&i, slot, sizeof(i));
+            break;
+        case DataType::BOOL:
+            i = *static_cast<const uint8_t*>(slot) != 0;
+            break;
+        case DataType::FLOAT32: {
+            float v;
+            std::memcpy(&v, slot, sizeof(v));
+            d = v;
+            break;
+        }
+        case DataType::FLOAT64:
+            std::memcpy(&d, slot, sizeof(d));
+            break;
+        default:
+            return;
+    }
+
+    if (bound_kind(type_) == BoundKind::INT) {
+        if (!zone.has_values) {
+            zone.min_int = zone.max_int = i;
+        } else {
+            zone.min_int = std::min(zone.min_int, i);
+            zone.max_int = std::max(zone.max_int, i);
+        }
+    } else {
+        if (std::isnan(d)) {
+            zone.has_nan = true;
+            return;
+        }
+        if (!zone.has_values) {
+            zone.min_double = zone.max_double = d;
+        } else {
+            zone.min_double = std::min(zone.min_double, d);
+            zone.max_double = std::max(zone.max_double, d);
+        }
+    }
+    zone.has_values = true;
+}
+
+void ZoneMapIndex::include_string(Zone& zone, const std::string& value) {
+    if (bound_kind(type_) != BoundKind::STRING) {
+        return;
+    }
+    if (!zone.has_values) {
+        zone.min_string = zone.max_string = value;
+    } else if (value < zone.min_string) {
+        zone.min_string = value;
+    } else if (value > zone.max_string) {
+        zone.max_string = value;
+    }
+    zone.has_values = true;
+}
+
+void ZoneMapIndex::add_value(const void* slot) {
+    Zone& zone = open_zone();
+    zone.row_count++;
+    include(zone, slot);
+}
+
+void ZoneMapIndex::add_string(const std::string& value) {
+    Zone& zone = open_zone();
+    zone.row_count++;
+    include_string(zone, value);
+}
+
+void ZoneMapIndex::add_null() {
+    Zone& zone = open_zone();
+    zone.row_count++;
+    zone.null_count++;
+}
+
+void ZoneMapIndex::seal() {
+    open_ = false;
+}
+
+void ZoneMapIndex::clear() {
+    zones_.clear();
+    open_ = false;
+}
+
+void ZoneMapIndex::truncate(size_t count) {
+    if (count < zones_.size()) {
+        zones_.resize(count);
+    }
+    open_ = false;
+}
+
+void ZoneMapIndex::widen(size_t row, const void* slot) {
+    include(zones_[find_zone(row)], slot);
+}
+
+void ZoneMapIndex::widen_string(size_t row, const std::string& value) {
+    include_string(zones_[find_zone(row)], value);
+}
+
+void ZoneMapIndex::set_null(size_t row, bool is_null) {
+    Zone& zone = zones_[find_zone(row)];
+    if (is_null) {
+        zone.null_count++;
+    } else if (zone.null_count > 0) {
+        zone.null_count--;
+    }
+}
+
+size_t ZoneMapIndex::find_zone(uint64_t row) const {
+    auto it = std::upper_bound(zones_.begin(), zones_.end(), row,
+        [](uint64_t r, const Zone& zone) { return r < zone.first_row; });
+    if (it == zones_.begin()) {
+        throw std::out_of_range("Row not covered by zone map: " + std::to_string(row));
+    }
+    return static_cast<size_t>(it - zones_.begin()) - 1;
+}
+
+bool ZoneMapIndex::may_match(const Zone& zone, simd::CompareOp op, int64_t lo, int64_t hi) const {
+    switch (bound_kind(type_)) {
+        case BoundKind::INT:
+            if (!zone.has_values) return false;
+            return range_may_match(zone.min_int, zone.max_int, op, lo, hi);
+        case BoundKind::DOUBLE:
+            return may_match(zone, op, static_cast<double>(lo), static_cast<double>(hi));
+        default:
+            return zone.null_count < zone.row_count;
+    }
+}
+
+bool ZoneMapIndex::may_match(const Zone& zone, simd::CompareOp op, double lo, double hi) const {
+    if (op == simd::CompareOp::NE && zone.has_nan) {
+        return true;
+    }
+    switch (bound_kind(type_)) {
+        case BoundKind::INT:
+            if (!zone.has_values) return false;
+            return range_may_match(static_cast<double>(zone.min_int),
+                                   static_cast<double>(zone.max_int), op, lo, hi);
+        case BoundKind::DOUBLE:
+            if (!zone.has_values) return false;
+            return range_may_match(zone.min_double, zone.max_double, op, lo, hi);
+        default:
+            return zone.null_count < zone.row_count;
+    }
+}
+
+bool ZoneMapIndex::may_match(const Zone& zone, simd::CompareOp op,
+                             const std::string& lo, const std::string& hi) const {
+    if (bound_kind(type_) != BoundKind::STRING) {
+        return zone.null_count < zone.row_count;
+    }
+    if (!zone.has_values) {
+        return false;
+    }
+    return range_may_match(zone.min_string, zone.max_string, op, lo, hi);
+}
+
+std::vector<uint8_t> ZoneMapIndex::serialize() const {
+    std::vector<uint8_t> out;
+    put<uint8_t>(out, static_cast<uint8_t>(type_));
+    put<uint8_t>(out, open_ ? 1 : 0);
+    put<uint32_t>(out, static_cast<uint32_t>(zones_.size()));
+    for (const Zone& zone : zones_) {
+        put<uint64_t>(out, zone.first_row);
+        put<uint32_t>(out, zone.row_count);
+        put<uint32_t>(out, zone.null_count);
+        put<uint8_t>(out, (zone.has_values ? 1 : 0) | (zone.has_nan ? 2 : 0));
+        switch (bound_kind(type_)) {
+            case BoundKind::INT:
+                put<int64_t>(out, zone.min_int);
+                put<int64_t>(out, zone.max_int);
+                break;
+            case BoundKind::DOUBLE:
+                put<double>(out, zone.min_double);
+                put<double>(out, zone.max_double);
+                break;
+            case BoundKind::STRING:
+                put_string(out, zone.min_string);
+                put_string(out, zone.max_string);
+                break;
+            default:
+                break;
+        }
+    }
+    return out;
+}
+
+ZoneMapIndex ZoneMapIndex::deserialize(const uint8_t* data, size_t size) {
+    Reader in(data, size);
+    ZoneMapIndex index(static_cast<DataType>(in.get<uint8_t>()));
+    index.open_ = in.get<uint8_t>() != 0;
+    uint32_t count = in.get<uint32_t>();
+    index.zones_.resize(count);
+    for (Zone& zone : index.zones_) {
+        zone.first_row = in.get<uint64_t>();
+        zone.row_count = in.get<uint32_t>();
+        zone.null_count = in.get<uint32_t>();
+        uint8_t flags = in.get<uint8_t>();
+        zone.has_values = (flags & 1) != 0;
+        zone.has_nan = (flags & 2) != 0;
+        switch (bound_kind(index.type_)) {
+            case BoundKind::INT:
+                zone.min_int = in.get<int64_t>();
+                zone.max_int = in.get<int64_t>();
+                break;
+            case BoundKind::DOUBLE:
+                zone.min_double = in.get<double>();
+                zone.max_double = in.get<double>();
+                break;
+            case BoundKind::STRING:
+                zone.min_string = in.get_string();
+                zone.max_string = in.get_string();
+                break;
+            default:
+                break;
+        }
+    }
+    index.open_ = index.open_ && count > 0;
+    return index;
+}
+
+} // namespace indexes
+} // namespace lyradb
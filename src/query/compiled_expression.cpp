@@ -0,0 +1,1605 @@
+#include "lyradb/compiled_expression.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/table.h"
+#include "lyradb/schema.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+
+namespace lyradb {
+
+namespace {
+
+ValueKind kind_of(DataType type) {
+    switch (type) {
+        case DataType::INT32:
+        case DataType::INT64:
+        case DataType::DATE32:
+        case DataType::TIMESTAMP:
+            return ValueKind::INT;
+        case DataType::FLOAT32:
+        case DataType::FLOAT64:
+            return ValueKind::DOUBLE;
+        case DataType::BOOL:
+            return ValueKind::BOOL;
+        default:
+            return ValueKind::STRING;
+    }
+}
+
+bool is_integral(ValueKind kind) {
+    return kind == ValueKind::INT || kind == ValueKind::BOOL;
+}
+
+double parse_double_or_zero(const std::string& text) {
+    // Mirrors ExpressionEvaluator::to_double: unparsable strings become 0.0
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    return end == text.c_str() ? 0.0 : value;
+}
+
+/**
+ * @brief SQL LIKE with % and _ wildcards
+ * Patterns without wildcards keep the evaluator's substring semantics.
+ */
+bool like_match(const std::string& str, const std::string& pattern) {
+    if (pattern.find_first_of("%_") == std::string::npos) {
+        return str.find(pattern) != std::string::npos;
+    }
+
+    size_t s = 0, p = 0;
+    size_t star_p = std::string::npos, star_s = 0;
+    while (s < str.size()) {
+        if (p < pattern.size() && (pattern[p] == '_' || pattern[p] == str[s])) {
+            ++s;
+            ++p;
+        } else if (p < pattern.size() && pattern[p] == '%') {
+            star_p = p++;
+            star_s = s;
+        } else if (star_p != std::string::npos) {
+            p = star_p + 1;
+            s = ++star_s;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '%') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+OpCode compare_opcode(query::BinaryOp op, ValueKind domain) {
+    int base = 0;
+    switch (op) {
+        case query::BinaryOp::EQUAL: base = 0; break;
+        case query::BinaryOp::NOT_EQUAL: base = 1; break;
+        case query::BinaryOp::LESS: base = 2; break;
+        case query::BinaryOp::LESS_EQUAL: base = 3; break;
+        case query::BinaryOp::GREATER: base = 4; break;
+        default: base = 5; break;  // GREATER_EQUAL
+    }
+    OpCode first = domain == ValueKind::INT ? OpCode::EQ_INT
+                 : domain == ValueKind::DOUBLE ? OpCode::EQ_DBL
+                 : OpCode::EQ_STR;
+    return static_cast<OpCode>(static_cast<int>(first) + base);
+}
+
+bool is_comparison(query::BinaryOp op) {
+    return op == query::BinaryOp::EQUAL || op == query::BinaryOp::NOT_EQUAL ||
+           op == query::BinaryOp::LESS || op == query::BinaryOp::LESS_EQUAL ||
+           op == query::BinaryOp::GREATER || op == query::BinaryOp::GREATER_EQUAL;
+}
+
+}  // namespace
+
+// ============================================================================
+// CompiledExpression - evaluation
+// ============================================================================
+
+template <typename Loader>
+const CompiledExpression::Register& CompiledExpression::run(const Loader& load) const {
+    Register* r = registers_.data();
+
+    for (const Instruction& ins : program_) {
+        Register& dst = r[ins.dst];
+
+        // Loads carry a column ordinal or constant index in ins.a rather
+        // than a register, so they run before any operand is bound
+        if (ins.op == OpCode::LOAD_COLUMN) {
+            load(ins.a, dst);
+            continue;
+        }
+        if (ins.op == OpCode::LOAD_CONST) {
+            dst = constants_[ins.a];
+            if (!dst.null && ins.kind == ValueKind::STRING) {
+                dst.s = &string_pool_[dst.i];
+            }
+            continue;
+        }
+
+        const Register& a = r[ins.a];
+        const Register& b = r[ins.b];
+
+        switch (ins.op) {
+            case OpCode::LOAD_COLUMN:
+            case OpCode::LOAD_CONST:
+                break;
+
+            // Casts
+            case OpCode::INT_TO_DBL:
+                dst.null = a.null;
+                dst.d = static_cast<double>(a.i);
+                break;
+            case OpCode::STR_TO_DBL:
+                dst.null = a.null;
+                if (!a.null) dst.d = parse_double_or_zero(*a.s);
+                break;
+            case OpCode::TO_BOOL: {
+                dst.null = a.null;
+                if (a.null) break;
+                switch (ins.kind) {
+                    case ValueKind::DOUBLE: dst.i = a.d != 0.0; break;
+                    case ValueKind::STRING: dst.i = !a.s->empty(); break;
+                    default: dst.i = a.i != 0; break;
+                }
+                break;
+            }
+
+            // Integer arithmetic
+            case OpCode::ADD_INT: dst.null = a.null || b.null; dst.i = a.i + b.i; break;
+            case OpCode::SUB_INT: dst.null = a.null || b.null; dst.i = a.i - b.i; break;
+            case OpCode::MUL_INT: dst.null = a.null || b.null; dst.i = a.i * b.i; break;
+            case OpCode::MOD_INT:
+                dst.null = a.null || b.null || b.i == 0;
+                if (!dst.null) dst.i = a.i % b.i;
+                break;
+            case OpCode::NEG_INT: dst.null = a.null; dst.i = -a.i; break;
+            case OpCode::ABS_INT: dst.null = a.null; dst.i = a.i < 0 ? -a.i : a.i; break;
+
+            // Floating point arithmetic
+            case OpCode::ADD_DBL: dst.null = a.null || b.null; dst.d = a.d + b.d; break;
+            case OpCode::SUB_DBL: dst.null = a.null || b.null; dst.d = a.d - b.d; break;
+            case OpCode::MUL_DBL: dst.null = a.null || b.null; dst.d = a.d * b.d; break;
+            case OpCode::DIV_DBL:
+                dst.null = a.null || b.null || std::abs(b.d) < 1e-9;
+                if (!dst.null) dst.d = a.d / b.d;
+                break;
+            case OpCode::NEG_DBL: dst.null = a.null; dst.d = -a.d; break;
+            case OpCode::ABS_DBL: dst.null = a.null; dst.d = std::abs(a.d); break;
+
+            // Comparisons
+            case OpCode::EQ_INT: dst.null = a.null || b.null; dst.i = a.i == b.i; break;
+            case OpCode::NE_INT: dst.null = a.null || b.null; dst.i = a.i != b.i; break;
+            case OpCode::LT_INT: dst.null = a.null || b.null; dst.i = a.i < b.i; break;
+            case OpCode::LE_INT: dst.null = a.null || b.null; dst.i = a.i <= b.i; break;
+            case OpCode::GT_INT: dst.null = a.null || b.null; dst.i = a.i > b.i; break;
+            case OpCode::GE_INT: dst.null = a.null || b.null; dst.i = a.i >= b.i; break;
+            case OpCode::EQ_DBL: dst.null = a.null || b.null; dst.i = a.d == b.d; break;
+            case OpCode::NE_DBL: dst.null = a.null || b.null; dst.i = a.d != b.d; break;
+            case OpCode::LT_DBL: dst.null = a.null || b.null; dst.i = a.d < b.d; break;
+            case OpCode::LE_DBL: dst.null = a.null || b.null; dst.i = a.d <= b.d; break;
+            case OpCode::GT_DBL: dst.null = a.null || b.null; dst.i = a.d > b.d; break;
+            case OpCode::GE_DBL: dst.null = a.null || b.null; dst.i = a.d >= b.d; break;
+            case OpCode::EQ_STR:
+                dst.null = a.null || b.null;
+                if (!dst.null) dst.i = *a.s == *b.s;
+                break;
+            case OpCode::NE_STR:
+                dst.null = a.null || b.null;
+                if (!dst.null) dst.i = *a.s != *b.s;
+                break;
+            case OpCode::LT_STR:
+                dst.null = a.null || b.null;
+                if (!dst.null) dst.i = *a.s < *b.s;
+                break;
+            case OpCode::LE_STR:
+                dst.null = a.null || b.null;
+                if (!dst.null) dst.i = *a.s <= *b.s;
+                break;
+            case OpCode::GT_STR:
+                dst.null = a.null || b.null;
+                if (!dst.null) dst.i = *a.s > *b.s;
+                break;
+            case OpCode::GE_STR:
+                dst.null = a.null || b.null;
+                if (!dst.null) dst.i = *a.s >= *b.s;
+                break;
+
+            // Three-valued logic
+            case OpCode::AND: {
+                bool a_false = !a.null && a.i == 0;
+                bool b_false = !b.null && b.i == 0;
+                if (a_false || b_false) {
+                    dst.null = false;
+                    dst.i = 0;
+                } else {
+                    dst.null = a.null || b.null;
+                    dst.i = 1;
+                }
+                break;
+            }
+            case OpCode::OR: {
+                bool a_true = !a.null && a.i != 0;
+                bool b_true = !b.null && b.i != 0;
+                if (a_true || b_true) {
+                    dst.null = false;
+                    dst.i = 1;
+                } else {
+                    dst.null = a.null || b.null;
+                    dst.i = 0;
+                }
+                break;
+            }
+            case OpCode::NOT:
+                dst.null = a.null;
+                dst.i = a.i == 0;
+                break;
+
+            // Strings
+            case OpCode::CONCAT:
+                dst.null = a.null || b.null;
+                if (!dst.null) {
+                    std::string& out = scratch_[ins.dst];
+                    out.assign(*a.s);
+                    out.append(*b.s);
+                    dst.s = &out;
+                }
+                break;
+            case OpCode::LIKE:
+                dst.null = a.null || b.null;
+                if (!dst.null) dst.i = like_match(*a.s, *b.s);
+                break;
+            case OpCode::UPPER:
+            case OpCode::LOWER:
+                dst.null = a.null;
+                if (!dst.null) {
+                    std::string& out = scratch_[ins.dst];
+                    out.assign(*a.s);
+                    bool upper = ins.op == OpCode::UPPER;
+                    for (auto& c : out) {
+                        c = static_cast<char>(upper ? std::toupper(static_cast<unsigned char>(c))
+                                                    : std::tolower(static_cast<unsigned char>(c)));
+                    }
+                    dst.s = &out;
+                }
+                break;
+            case OpCode::LENGTH:
+                dst.null = a.null;
+                if (!dst.null) dst.i = static_cast<int64_t>(a.s->size());
+                break;
+        }
+    }
+
+    return r[result_register_];
+}
+
+namespace {
+
+/**
+ * @brief Loads a register straight from the typed arrays of a table row's
+ * row group, or of a copy of the row if the delta store holds it
+ */
+struct TableLoader {
+    const Table& table;
+    size_t group = 0;
+    size_t row = 0;                                      // Within the group or the copy
+    std::vector<std::shared_ptr<const Column>> delta;   // Copy of a delta store row
+
+    TableLoader(const Table& t, size_t table_row) : table(t) {
+        if (t.delta_overlaps(table_row, table_row + 1)) {
+            delta = t.delta_columns(table_row, table_row + 1);
+        } else {
+            group = table_row / Table::kRowGroupRows;
+            row = table_row % Table::kRowGroupRows;
+        }
+    }
+
+    template <typename Reg>
+    void operator()(uint16_t col, Reg& reg) const {
+        const Column& column = delta.empty() ? table.stored(col, group) : *delta[col];
+        reg.null = column.is_null(row);
+        switch (column.type()) {
+            case DataType::INT32:
+            case DataType::DATE32:
+                reg.i = column.data<int32_t>()[row];
+                break;
+            case DataType::INT64:
+            case DataType::TIMESTAMP:
+                reg.i = column.data<int64_t>()[row];
+                break;
+            case DataType::FLOAT32:
+                reg.d = column.data<float>()[row];
+                break;
+            case DataType::FLOAT64:
+                reg.d = column.data<double>()[row];
+                break;
+            case DataType::BOOL:
+                reg.i = column.data<uint8_t>()[row];
+                break;
+            default:
+                reg.s = &column.string_at(row);
+                break;
+        }
+    }
+};
+
+/**
+ * @brief Loads a register from a string row, parsing by declared column type
+ */
+struct StringRowLoader {
+    const std::vector<std::string>& row;
+    const std::vector<DataType>& types;
+
+    template <typename Reg>
+    void operator()(uint16_t col, Reg& reg) const {
+        if (col >= row.size() || row[col].empty()) {
+            reg.null = true;
+            return;
+        }
+        const std::string& text = row[col];
+        reg.null = false;
+        switch (kind_of(types[col])) {
+            case ValueKind::INT: {
+                auto res = std::from_chars(text.data(), text.data() + text.size(), reg.i);
+                if (res.ec != std::errc()) {
+                    reg.i = static_cast<int64_t>(parse_double_or_zero(text));
+                }
+                break;
+            }
+            case ValueKind::DOUBLE:
+                reg.d = parse_double_or_zero(text);
+                break;
+            case ValueKind::BOOL:
+                reg.i = (text == "true" || text == "1" || text == "TRUE");
+                break;
+            default:
+                reg.s = &text;
+                break;
+        }
+    }
+};
+
+}  // namespace
+
+ExpressionValue CompiledExpression::evaluate(const Table& table, size_t row) const {
+    return to_value(run(TableLoader(table, row)));
+}
+
+ExpressionValue CompiledExpression::evaluate(const std::vector<std::string>& row) const {
+    return to_value(run(StringRowLoader{row, column_types_}));
+}
+
+bool CompiledExpression::matches(const Table& table, size_t row) const {
+    return to_predicate(run(TableLoader(table, row)));
+}
+
+bool CompiledExpression::matches(const std::vector<std::string>& row) const {
+    return to_predicate(run(StringRowLoader{row, column_types_}));
+}
+
+std::vector<size_t> CompiledExpression::referenced_columns() const {
+    std::vector<size_t> columns;
+    for (const auto& ins : program_) {
+        if (ins.op == OpCode::LOAD_COLUMN) {
+            columns.push_back(ins.a);
+        }
+    }
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+    return columns;
+}
+
+ExpressionValue CompiledExpression::to_value(const Register& reg) const {
+    if (reg.null) {
+        return nullptr;
+    }
+    switch (result_kind_) {
+        case ValueKind::INT: return reg.i;
+        case ValueKind::DOUBLE: return reg.d;
+        case ValueKind::BOOL: return reg.i != 0;
+        case ValueKind::STRING: return *reg.s;
+        default: return nullptr;
+    }
+}
+
+bool CompiledExpression::to_predicate(const Register& reg) const {
+    if (reg.null) {
+        return false;
+    }
+    switch (result_kind_) {
+        case ValueKind::DOUBLE: return reg.d != 0.0;
+        case ValueKind::STRING: return !reg.s->empty();
+        case ValueKind::NULL_VALUE: return false;
+        default: return reg.i != 0;
+    }
+}
+
+// ============================================================================
+// CompiledExpression - batch evaluation
+// ============================================================================
+
+namespace {
+
+template <typename T>
+void gather(const T* values, size_t offset, const SelectionVector& sel, int64_t* out) {
+    for (size_t k = 0; k < sel.size(); ++k) {
+        out[k] = static_cast<int64_t>(values[offset + sel[k]]);
+    }
+}
+
+template <typename T>
+void gather(const T* values, size_t offset, const SelectionVector& sel, double* out) {
+    for (size_t k = 0; k < sel.size(); ++k) {
+        out[k] = static_cast<double>(values[offset + sel[k]]);
+    }
+}
+
+/**
+ * @brief Keep selected rows whose run satisfies the comparison
+ * The test runs once per run of equal values (Column::run_ends()); rows
+ * of the selection are ascending, so the run cursor only moves forward.
+ */
+template <typename T, typename V, typename Test>
+size_t select_runs(const Column& column, const T* values, size_t offset,
+                   Test test, SelectionVector& sel) {
+    const std::vector<uint32_t>& ends = column.run_ends();
+    const bool has_nulls = column.null_count() != 0;
+    auto run = ends.begin();
+    size_t run_end = 0;
+    bool run_keep = false;
+    size_t out = 0;
+    for (size_t k = 0; k < sel.size(); ++k) {
+        uint32_t r = sel[k];
+        size_t row = offset + r;
+        if (row >= run_end) {
+            run = std::upper_bound(run, ends.end(), static_cast<uint32_t>(row));
+            run_end = *run;
+            run_keep = test(static_cast<V>(values[row]));
+        }
+        bool keep = run_keep && !(has_nulls && column.is_null(row));
+        sel[out] = r;
+        out += keep;
+    }
+    sel.resize(out);
+    return out;
+}
+
+/**
+ * @brief Keep selected rows whose native value satisfies the comparison
+ * The selection is compacted in place without branching on the outcome.
+ * @param all_values Column values from row 0 (data<T>() or dictionary codes)
+ */
+template <typename T, typename V, typename Test>
+size_t select_compare(const Column& column, const T* all_values, size_t offset, size_t batch_size,
+                      Test test, SelectionVector& sel) {
+    if (!column.run_ends().empty()) {
+        return select_runs<T, V>(column, all_values, offset, test, sel);
+    }
+    const T* values = all_values + offset;
+    const bool has_nulls = column.null_count() != 0;
+    const bool dense = sel.size() == batch_size;
+    size_t out = 0;
+
+    if (dense && !has_nulls) {
+        for (size_t r = 0; r < batch_size; ++r) {
+            sel[out] = static_cast<uint32_t>(r);
+            out += test(static_cast<V>(values[r]));
+        }
+    } else {
+        for (size_t k = 0; k < sel.size(); ++k) {
+            uint32_t r = sel[k];
+            bool keep = test(static_cast<V>(values[r]));
+            if (has_nulls) {
+                keep = keep && !column.is_null(offset + r);
+            }
+            sel[out] = r;
+            out += keep;
+        }
+    }
+    sel.resize(out);
+    return out;
+}
+
+template <typename T, typename V>
+size_t select_by_op(simd::CompareOp op, const Column& column, const T* values, size_t offset,
+                    size_t batch_size, V lo, V hi, SelectionVector& sel) {
+    switch (op) {
+        case simd::CompareOp::EQ:
+            return select_compare<T, V>(column, values, offset, batch_size,
+                                        [lo](V v) { return v == lo; }, sel);
+        case simd::CompareOp::NE:
+            return select_compare<T, V>(column, values, offset, batch_size,
+                                        [lo](V v) { return v != lo; }, sel);
+        case simd::CompareOp::LT:
+            return select_compare<T, V>(column, values, offset, batch_size,
+                                        [lo](V v) { return v < lo; }, sel);
+        case simd::CompareOp::LE:
+            return select_compare<T, V>(column, values, offset, batch_size,
+                                        [lo](V v) { return v <= lo; }, sel);
+        case simd::CompareOp::GT:
+            return select_compare<T, V>(column, values, offset, batch_size,
+                                        [lo](V v) { return v > lo; }, sel);
+        case simd::CompareOp::GE:
+            return select_compare<T, V>(column, values, offset, batch_size,
+                                        [lo](V v) { return v >= lo; }, sel);
+        default:
+            return select_compare<T, V>(column, values, offset, batch_size,
+                                        [lo, hi](V v) { return lo <= v && v <= hi; }, sel);
+    }
+}
+
+bool compare_order(simd::CompareOp op, int order) {
+    switch (op) {
+        case simd::CompareOp::EQ: return order == 0;
+        case simd::CompareOp::NE: return order != 0;
+        case simd::CompareOp::LT: return order < 0;
+        case simd::CompareOp::LE: return order <= 0;
+        case simd::CompareOp::GT: return order > 0;
+        default: return order >= 0;
+    }
+}
+
+/**
+ * @brief A string comparison restated over sorted dictionary codes
+ */
+struct CodePredicate {
+    simd::CompareOp op;
+    int64_t code;
+};
+
+CodePredicate dictionary_predicate(simd::CompareOp op, const std::vector<std::string>& dictionary,
+                                   const std::string& constant) {
+    auto lower = std::lower_bound(dictionary.begin(), dictionary.end(), constant);
+    auto upper = std::upper_bound(dictionary.begin(), dictionary.end(), constant);
+    const int64_t lb = lower - dictionary.begin();
+    const int64_t ub = upper - dictionary.begin();
+    const bool found = lower != upper;
+    switch (op) {
+        case simd::CompareOp::EQ: return {simd::CompareOp::EQ, found ? lb : -1};
+        case simd::CompareOp::NE: return found ? CodePredicate{simd::CompareOp::NE, lb}
+                                               : CodePredicate{simd::CompareOp::GE, 0};
+        case simd::CompareOp::LT: return {simd::CompareOp::LT, lb};
+        case simd::CompareOp::LE: return {simd::CompareOp::LT, ub};
+        case simd::CompareOp::GT: return {simd::CompareOp::GE, ub};
+        default: return {simd::CompareOp::GE, lb};
+    }
+}
+
+size_t select_strings(simd::CompareOp op, const Column& column, size_t offset,
+                      const std::string& constant, SelectionVector& sel) {
+    size_t out = 0;
+    for (size_t k = 0; k < sel.size(); ++k) {
+        size_t row = offset + sel[k];
+        bool keep = !column.is_null(row) && compare_order(op, column.string_at(row).compare(constant));
+        sel[out] = sel[k];
+        out += keep;
+    }
+    sel.resize(out);
+    return out;
+}
+
+simd::CompareOp to_compare_op(OpCode op) {
+    OpCode first = op >= OpCode::EQ_STR ? OpCode::EQ_STR
+                 : op >= OpCode::EQ_DBL ? OpCode::EQ_DBL
+                 : OpCode::EQ_INT;
+    return static_cast<simd::CompareOp>(static_cast<int>(op) - static_cast<int>(first));
+}
+
+ValueKind comparison_domain(OpCode op) {
+    if (op >= OpCode::EQ_STR) return ValueKind::STRING;
+    if (op >= OpCode::EQ_DBL) return ValueKind::DOUBLE;
+    return ValueKind::INT;
+}
+
+/**
+ * @brief Swap the operands of a comparison (a < b  <=>  b > a)
+ */
+simd::CompareOp mirror_comparison(simd::CompareOp op) {
+    switch (op) {
+        case simd::CompareOp::LT: return simd::CompareOp::GT;
+        case simd::CompareOp::LE: return simd::CompareOp::GE;
+        case simd::CompareOp::GT: return simd::CompareOp::LT;
+        case simd::CompareOp::GE: return simd::CompareOp::LE;
+        default: return op;
+    }
+}
+
+bool is_comparison_opcode(OpCode op) {
+    return op >= OpCode::EQ_INT && op <= OpCode::GE_STR;
+}
+
+bool fits_int32(int64_t v) {
+    return v >= std::numeric_limits<int32_t>::min() && v <= std::numeric_limits<int32_t>::max();
+}
+
+bool fits_float(double v) {
+    return static_cast<double>(static_cast<float>(v)) == v;
+}
+
+}  // namespace
+
+const CompiledExpression::VectorRegister& CompiledExpression::run_batch(
+    const VectorBatch& batch, const SelectionVector& sel) const {
+
+    const size_t n = sel.size();
+    for (auto& v : vectors_) {
+        v.null.resize(n);
+        v.i.resize(n);
+        v.d.resize(n);
+        v.s.resize(n);
+    }
+
+    // Each instruction is one loop over the whole selection, so the hot
+    // loops are branch-light and operate on contiguous arrays
+    for (const Instruction& ins : program_) {
+        VectorRegister& dst = vectors_[ins.dst];
+        uint8_t* dn = dst.null.data();
+        int64_t* di = dst.i.data();
+        double* dd = dst.d.data();
+
+        // Loads carry a column ordinal or constant index in ins.a rather
+        // than a register, so they run before any operand is bound
+        if (ins.op == OpCode::LOAD_COLUMN) {
+            const Column& column = *batch.columns[ins.a];
+            size_t offset = batch.position();
+            if (column.null_count() == 0) {
+                std::fill(dst.null.begin(), dst.null.end(), 0);
+            } else {
+                for (size_t k = 0; k < n; ++k) dn[k] = column.is_null(offset + sel[k]);
+            }
+            switch (column.type()) {
+                case DataType::INT32:
+                case DataType::DATE32:
+                    gather(column.data<int32_t>(), offset, sel, di);
+                    break;
+                case DataType::INT64:
+                case DataType::TIMESTAMP:
+                    gather(column.data<int64_t>(), offset, sel, di);
+                    break;
+                case DataType::FLOAT32:
+                    gather(column.data<float>(), offset, sel, dd);
+                    break;
+                case DataType::FLOAT64:
+                    gather(column.data<double>(), offset, sel, dd);
+                    break;
+                case DataType::BOOL:
+                    gather(column.data<uint8_t>(), offset, sel, di);
+                    break;
+                default:
+                    for (size_t k = 0; k < n; ++k) dst.s[k] = &column.string_at(offset + sel[k]);
+                    break;
+            }
+            continue;
+        }
+        if (ins.op == OpCode::LOAD_CONST) {
+            Register c = constants_[ins.a];
+            if (!c.null && ins.kind == ValueKind::STRING) {
+                c.s = &string_pool_[c.i];
+            }
+            std::fill(dst.null.begin(), dst.null.end(), c.null);
+            std::fill(dst.i.begin(), dst.i.end(), c.i);
+            std::fill(dst.d.begin(), dst.d.end(), c.d);
+            std::fill(dst.s.begin(), dst.s.end(), c.s);
+            continue;
+        }
+
+        const VectorRegister& a = vectors_[ins.a];
+        const VectorRegister& b = vectors_[ins.b];
+        const uint8_t* an = a.null.data();
+        const uint8_t* bn = b.null.data();
+        const int64_t* ai = a.i.data();
+        const int64_t* bi = b.i.data();
+        const double* ad = a.d.data();
+        const double* bd = b.d.data();
+
+        auto propagate_nulls = [&]() {
+            for (size_t k = 0; k < n; ++k) dn[k] = an[k] | bn[k];
+        };
+
+        switch (ins.op) {
+            case OpCode::LOAD_COLUMN:
+            case OpCode::LOAD_CONST:
+                break;
+
+            // Casts
+            case OpCode::INT_TO_DBL:
+                for (size_t k = 0; k < n; ++k) { dn[k] = an[k]; dd[k] = static_cast<double>(ai[k]); }
+                break;
+            case OpCode::STR_TO_DBL:
+                for (size_t k = 0; k < n; ++k) {
+                    dn[k] = an[k];
+                    dd[k] = an[k] ? 0.0 : parse_double_or_zero(*a.s[k]);
+                }
+                break;
+            case OpCode::TO_BOOL:
+                for (size_t k = 0; k < n; ++k) {
+                    dn[k] = an[k];
+                    if (an[k]) { di[k] = 0; continue; }
+                    switch (ins.kind) {
+                        case ValueKind::DOUBLE: di[k] = ad[k] != 0.0; break;
+                        case ValueKind::STRING: di[k] = !a.s[k]->empty(); break;
+                        default: di[k] = ai[k] != 0; break;
+                    }
+                }
+                break;
+
+            // Integer arithmetic
+            case OpCode::ADD_INT: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ai[k] + bi[k]; break;
+            case OpCode::SUB_INT: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ai[k] - bi[k]; break;
+            case OpCode::MUL_INT: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ai[k] * bi[k]; break;
+            case OpCode::MOD_INT:
+                for (size_t k = 0; k < n; ++k) {
+                    dn[k] = an[k] | bn[k] | (bi[k] == 0);
+                    di[k] = dn[k] ? 0 : ai[k] % bi[k];
+                }
+                break;
+            case OpCode::NEG_INT:
+                for (size_t k = 0; k < n; ++k) { dn[k] = an[k]; di[k] = -ai[k]; }
+                break;
+            case OpCode::ABS_INT:
+                for (size_t k = 0; k < n; ++k) { dn[k] = an[k]; di[k] = ai[k] < 0 ? -ai[k] : ai[k]; }
+                break;
+
+            // Floating point arithmetic
+            case OpCode::ADD_DBL: propagate_nulls(); for (size_t k = 0; k < n; ++k) dd[k] = ad[k] + bd[k]; break;
+            case OpCode::SUB_DBL: propagate_nulls(); for (size_t k = 0; k < n; ++k) dd[k] = ad[k] - bd[k]; break;
+            case OpCode::MUL_DBL: propagate_nulls(); for (size_t k = 0; k < n; ++k) dd[k] = ad[k] * bd[k]; break;
+            case OpCode::DIV_DBL:
+                for (size_t k = 0; k < n; ++k) {
+                    dn[k] = an[k] | bn[k] | (std::abs(bd[k]) < 1e-9);
+                    dd[k] = dn[k] ? 0.0 : ad[k] / bd[k];
+                }
+                break;
+            case OpCode::NEG_DBL:
+                for (size_t k = 0; k < n; ++k) { dn[k] = an[k]; dd[k] = -ad[k]; }
+                break;
+            case OpCode::ABS_DBL:
+                for (size_t k = 0; k < n; ++k) { dn[k] = an[k]; dd[k] = std::abs(ad[k]); }
+                break;
+
+            // Comparisons
+            case OpCode::EQ_INT: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ai[k] == bi[k]; break;
+            case OpCode::NE_INT: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ai[k] != bi[k]; break;
+            case OpCode::LT_INT: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ai[k] < bi[k]; break;
+            case OpCode::LE_INT: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ai[k] <= bi[k]; break;
+            case OpCode::GT_INT: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ai[k] > bi[k]; break;
+            case OpCode::GE_INT: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ai[k] >= bi[k]; break;
+            case OpCode::EQ_DBL: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ad[k] == bd[k]; break;
+            case OpCode::NE_DBL: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ad[k] != bd[k]; break;
+            case OpCode::LT_DBL: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ad[k] < bd[k]; break;
+            case OpCode::LE_DBL: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ad[k] <= bd[k]; break;
+            case OpCode::GT_DBL: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ad[k] > bd[k]; break;
+            case OpCode::GE_DBL: propagate_nulls(); for (size_t k = 0; k < n; ++k) di[k] = ad[k] >= bd[k]; break;
+            case OpCode::EQ_STR:
+            case OpCode::NE_STR:
+            case OpCode::LT_STR:
+            case OpCode::LE_STR:
+            case OpCode::GT_STR:
+            case OpCode::GE_STR: {
+                propagate_nulls();
+                int index = static_cast<int>(ins.op) - static_cast<int>(OpCode::EQ_STR);
+                for (size_t k = 0; k < n; ++k) {
+                    if (dn[k]) { di[k] = 0; continue; }
+                    int order = a.s[k]->compare(*b.s[k]);
+                    switch (index) {
+                        case 0: di[k] = order == 0; break;
+                        case 1: di[k] = order != 0; break;
+                        case 2: di[k] = order < 0; break;
+                        case 3: di[k] = order <= 0; break;
+                        case 4: di[k] = order > 0; break;
+                        default: di[k] = order >= 0; break;
+                    }
+                }
+                break;
+            }
+
+            // Three-valued logic
+            case OpCode::AND:
+                for (size_t k = 0; k < n; ++k) {
+                    bool a_false = !an[k] && ai[k] == 0;
+                    bool b_false = !bn[k] && bi[k] == 0;
+                    bool is_false = a_false || b_false;
+                    dn[k] = !is_false && (an[k] | bn[k]);
+                    di[k] = !is_false;
+                }
+                break;
+            case OpCode::OR:
+                for (size_t k = 0; k < n; ++k) {
+                    bool a_true = !an[k] && ai[k] != 0;
+                    bool b_true = !bn[k] && bi[k] != 0;
+                    bool is_true = a_true || b_true;
+                    dn[k] = !is_true && (an[k] | bn[k]);
+                    di[k] = is_true;
+                }
+                break;
+            case OpCode::NOT:
+                for (size_t k = 0; k < n; ++k) { dn[k] = an[k]; di[k] = ai[k] == 0; }
+                break;
+
+            // Strings
+            case OpCode::CONCAT:
+                propagate_nulls();
+                dst.owned.resize(n);
+                for (size_t k = 0; k < n; ++k) {
+                    if (dn[k]) continue;
+                    dst.owned[k].assign(*a.s[k]);
+                    dst.owned[k].append(*b.s[k]);
+                    dst.s[k] = &dst.owned[k];
+                }
+                break;
+            case OpCode::LIKE:
+                propagate_nulls();
+                for (size_t k = 0; k < n; ++k) {
+                    di[k] = !dn[k] && like_match(*a.s[k], *b.s[k]);
+                }
+                break;
+            case OpCode::UPPER:
+            case OpCode::LOWER: {
+                bool upper = ins.op == OpCode::UPPER;
+                dst.owned.resize(n);
+                for (size_t k = 0; k < n; ++k) {
+                    dn[k] = an[k];
+                    if (an[k]) continue;
+                    std::string& out = dst.owned[k];
+                    out.assign(*a.s[k]);
+                    for (auto& c : out) {
+                        c = static_cast<char>(upper ? std::toupper(static_cast<unsigned char>(c))
+                                                    : std::tolower(static_cast<unsigned char>(c)));
+                    }
+                    dst.s[k] = &out;
+                }
+                break;
+            }
+            case OpCode::LENGTH:
+                for (size_t k = 0; k < n; ++k) {
+                    dn[k] = an[k];
+                    di[k] = an[k] ? 0 : static_cast<int64_t>(a.s[k]->size());
+                }
+                break;
+        }
+    }
+
+    return vectors_[result_register_];
+}
+
+void CompiledExpression::evaluate_batch(const VectorBatch& batch, const SelectionVector& selection,
+                                        std::vector<ExpressionValue>& out) const {
+    const VectorRegister& result = run_batch(batch, selection);
+    out.clear();
+    out.reserve(selection.size());
+
+    Register reg;
+    for (size_t k = 0; k < selection.size(); ++k) {
+        reg.null = result.null[k] != 0;
+        reg.i = result.i[k];
+        reg.d = result.d[k];
+        reg.s = result.s[k];
+        out.push_back(to_value(reg));
+    }
+}
+
+size_t CompiledExpression::filter_batch(const VectorBatch& batch, SelectionVector& selection,
+                                        simd::InstructionSet isa) const {
+    if (selection.empty()) {
+        return 0;
+    }
+    if (column_predicate_.valid) {
+        return filter_column_predicate(batch, selection, isa);
+    }
+
+    const VectorRegister& result = run_batch(batch, selection);
+    size_t out = 0;
+    for (size_t k = 0; k < selection.size(); ++k) {
+        bool keep = false;
+        if (!result.null[k]) {
+            switch (result_kind_) {
+                case ValueKind::DOUBLE: keep = result.d[k] != 0.0; break;
+                case ValueKind::STRING: keep = !result.s[k]->empty(); break;
+                case ValueKind::NULL_VALUE: keep = false; break;
+                default: keep = result.i[k] != 0; break;
+            }
+        }
+        selection[out] = selection[k];
+        out += keep;
+    }
+    selection.resize(out);
+    return out;
+}
+
+size_t CompiledExpression::filter_column_predicate(const VectorBatch& batch,
+                                                   SelectionVector& selection,
+                                                   simd::InstructionSet isa) const {
+    // SIMD kernels compare every row of the batch, which only pays off while
+    // most of the selection is still live
+    if (isa != simd::InstructionSet::SCALAR && selection.size() * 4 >= batch.size * 3 &&
+        filter_simd(batch, selection, isa)) {
+        return selection.size();
+    }
+
+    const ColumnPredicate& pred = column_predicate_;
+    const Column& column = *batch.columns[pred.column];
+    size_t offset = batch.position();
+    size_t size = batch.size;
+
+    if (pred.column_rhs) {
+        // Scalar column-to-column comparison goes through the generic program
+        const VectorRegister& result = run_batch(batch, selection);
+        size_t out = 0;
+        for (size_t k = 0; k < selection.size(); ++k) {
+            selection[out] = selection[k];
+            out += !result.null[k] && result.i[k] != 0;
+        }
+        selection.resize(out);
+        return out;
+    }
+
+    if (pred.domain == ValueKind::STRING) {
+        if (column.is_dictionary_encoded()) {
+            // One dictionary lookup, then an integer compare per row
+            CodePredicate codes = dictionary_predicate(pred.op, column.dictionary(),
+                                                       string_pool_[pred.low.i]);
+            return select_by_op<uint32_t, int64_t>(codes.op, column, column.codes(), offset, size,
+                                                   codes.code, codes.code, selection);
+        }
+        return select_strings(pred.op, column, offset, string_pool_[pred.low.i], selection);
+    }
+
+    if (pred.domain == ValueKind::INT) {
+        int64_t lo = pred.low.i;
+        int64_t hi = pred.high.i;
+        switch (column.type()) {
+            case DataType::INT32:
+            case DataType::DATE32:
+                return select_by_op<int32_t>(pred.op, column, column.data<int32_t>(), offset, size,
+                                             lo, hi, selection);
+            case DataType::INT64:
+            case DataType::TIMESTAMP:
+                return select_by_op<int64_t>(pred.op, column, column.data<int64_t>(), offset, size,
+                                             lo, hi, selection);
+            default:
+                return select_by_op<uint8_t>(pred.op, column, column.data<uint8_t>(), offset, size,
+                                             lo, hi, selection);
+        }
+    }
+
+    double lo = pred.low.d;
+    double hi = pred.high.d;
+    switch (column.type()) {
+        case DataType::INT32:
+        case DataType::DATE32:
+            return select_by_op<int32_t>(pred.op, column, column.data<int32_t>(), offset, size,
+                                         lo, hi, selection);
+        case DataType::INT64:
+        case DataType::TIMESTAMP:
+            return select_by_op<int64_t>(pred.op, column, column.data<int64_t>(), offset, size,
+                                         lo, hi, selection);
+        case DataType::FLOAT32:
+            return select_by_op<float>(pred.op, column, column.data<float>(), offset, size,
+                                       lo, hi, selection);
+        default:
+            return select_by_op<double>(pred.op, column, column.data<double>(), offset, size,
+                                        lo, hi, selection);
+    }
+}
+
+int CompiledExpression::pruning_column() const {
+    if (!column_predicate_.valid || column_predicate_.column_rhs) {
+        return -1;
+    }
+    return column_predicate_.column;
+}
+
+bool CompiledExpression::may_match(const indexes::ZoneMapIndex& zone_map,
+                                   const indexes::ZoneMapIndex::Zone& zone) const {
+    const ColumnPredicate& pred = column_predicate_;
+    if (pruning_column() < 0) {
+        return true;
+    }
+    switch (pred.domain) {
+        case ValueKind::INT:
+            return zone_map.may_match(zone, pred.op, pred.low.i, pred.high.i);
+        case ValueKind::DOUBLE:
+            return zone_map.may_match(zone, pred.op, pred.low.d, pred.high.d);
+        case ValueKind::STRING: {
+            const std::string& constant = string_pool_[pred.low.i];
+            return zone_map.may_match(zone, pred.op, constant, constant);
+        }
+        default:
+            return true;
+    }
+}
+
+bool CompiledExpression::filter_simd(const VectorBatch& batch, SelectionVector& selection,
+                                     simd::InstructionSet isa) const {
+    const ColumnPredicate& pred = column_predicate_;
+    const Column& column = *batch.columns[pred.column];
+    const Column* rhs = pred.column_rhs ? batch.columns[pred.rhs_column] : nullptr;
+    const size_t n = batch.size;
+    const size_t offset = batch.position();
+
+    // Run-indexed columns are cheaper per run on the scalar path
+    if (!rhs && !column.run_ends().empty()) {
+        return false;
+    }
+
+    mask_.resize(simd::mask_words(n));
+    uint64_t* mask = mask_.data();
+
+    // Only comparisons the kernels evaluate exactly in the column's own type
+    // are taken; everything else stays on the scalar path
+    if (rhs) {
+        switch (column.type()) {
+            case DataType::INT32:
+            case DataType::DATE32:
+                simd::compare_columns(column.data<int32_t>() + offset, rhs->data<int32_t>() + offset,
+                                      n, pred.op, mask, isa);
+                break;
+            case DataType::INT64:
+            case DataType::TIMESTAMP:
+                simd::compare_columns(column.data<int64_t>() + offset, rhs->data<int64_t>() + offset,
+                                      n, pred.op, mask, isa);
+                break;
+            case DataType::FLOAT32:
+                simd::compare_columns(column.data<float>() + offset, rhs->data<float>() + offset,
+                                      n, pred.op, mask, isa);
+                break;
+            case DataType::FLOAT64:
+                simd::compare_columns(column.data<double>() + offset, rhs->data<double>() + offset,
+                                      n, pred.op, mask, isa);
+                break;
+            default:
+                return false;
+        }
+    } else if (pred.domain == ValueKind::INT) {
+        switch (column.type()) {
+            case DataType::INT32:
+            case DataType::DATE32:
+                if (!fits_int32(pred.low.i) || !fits_int32(pred.high.i)) {
+                    return false;
+                }
+                simd::compare(column.data<int32_t>() + offset, n, pred.op,
+                              static_cast<int32_t>(pred.low.i), static_cast<int32_t>(pred.high.i),
+                              mask, isa);
+                break;
+            case DataType::INT64:
+            case DataType::TIMESTAMP:
+                simd::compare(column.data<int64_t>() + offset, n, pred.op,
+                              pred.low.i, pred.high.i, mask, isa);
+                break;
+            default:
+                return false;
+        }
+    } else if (pred.domain == ValueKind::DOUBLE) {
+        switch (column.type()) {
+            case DataType::FLOAT32:
+                if (!fits_float(pred.low.d) || !fits_float(pred.high.d)) {
+                    return false;
+                }
+                simd::compare(column.data<float>() + offset, n, pred.op,
+                              static_cast<float>(pred.low.d), static_cast<float>(pred.high.d),
+                              mask, isa);
+                break;
+            case DataType::FLOAT64:
+                simd::compare(column.data<double>() + offset, n, pred.op,
+                              pred.low.d, pred.high.d, mask, isa);
+                break;
+            default:
+                return false;
+        }
+    } else if (pred.domain == ValueKind::STRING && column.is_dictionary_encoded()) {
+        CodePredicate codes = dictionary_predicate(pred.op, column.dictionary(),
+                                                   string_pool_[pred.low.i]);
+        if (!fits_int32(codes.code)) {
+            return false;
+        }
+        simd::compare(reinterpret_cast<const int32_t*>(column.codes()) + offset, n, codes.op,
+                      static_cast<int32_t>(codes.code), static_cast<int32_t>(codes.code), mask, isa);
+    } else {
+        return false;
+    }
+
+    // Merge the mask into the incoming selection
+    size_t out = 0;
+    if (selection.size() == n) {
+        out = simd::mask_to_selection(mask, n, selection.data());
+    } else {
+        for (size_t k = 0; k < selection.size(); ++k) {
+            uint32_t r = selection[k];
+            selection[out] = r;
+            out += (mask[r >> 6] >> (r & 63)) & 1;
+        }
+    }
+    selection.resize(out);
+
+    // NULL slots hold zeroes and may have matched; drop them afterwards
+    if (column.null_count() != 0 || (rhs && rhs->null_count() != 0)) {
+        out = 0;
+        for (size_t k = 0; k < selection.size(); ++k) {
+            size_t row = offset + selection[k];
+            selection[out] = selection[k];
+            out += !column.is_null(row) && !(rhs && rhs->is_null(row));
+        }
+        selection.resize(out);
+    }
+    return true;
+}
+
+void CompiledExpression::detect_column_predicate() {
+    column_predicate_ = ColumnPredicate();
+    if (program_.empty() || program_.back().dst != result_register_) {
+        return;
+    }
+
+    // Registers are written exactly once, so each operand can be traced back
+    // to the instruction that defined it
+    std::vector<int> defined_by(registers_.size(), -1);
+    for (size_t i = 0; i < program_.size(); ++i) {
+        defined_by[program_[i].dst] = static_cast<int>(i);
+    }
+
+    struct Operand {
+        bool is_column = false;
+        bool is_constant = false;
+        uint16_t index = 0;
+        bool widened = false;   // INT_TO_DBL applied
+        size_t instructions = 0;
+    };
+    auto trace = [&](uint16_t reg) {
+        Operand operand;
+        int at = defined_by[reg];
+        if (at >= 0 && program_[at].op == OpCode::INT_TO_DBL) {
+            operand.widened = true;
+            operand.instructions++;
+            at = defined_by[program_[at].a];
+        }
+        if (at < 0) {
+            return operand;
+        }
+        const Instruction& def = program_[at];
+        operand.is_column = def.op == OpCode::LOAD_COLUMN;
+        operand.is_constant = def.op == OpCode::LOAD_CONST;
+        operand.index = def.a;
+        operand.instructions++;
+        return operand;
+    };
+
+    // Match one comparison; `instructions` receives the size of its subtree
+    auto match_comparison = [&](uint16_t reg, ColumnPredicate& pred, size_t& instructions) {
+        int at = defined_by[reg];
+        if (at < 0 || !is_comparison_opcode(program_[at].op)) {
+            return false;
+        }
+        const Instruction& cmp = program_[at];
+        Operand left = trace(cmp.a);
+        Operand right = trace(cmp.b);
+        simd::CompareOp op = to_compare_op(cmp.op);
+        if (left.is_constant && right.is_column) {
+            std::swap(left, right);
+            op = mirror_comparison(op);
+        }
+        if (!left.is_column) {
+            return false;
+        }
+        pred.column = left.index;
+        pred.op = op;
+        pred.domain = comparison_domain(cmp.op);
+        instructions = 1 + left.instructions + right.instructions;
+
+        if (right.is_column) {
+            // Column pairs must share a physical type so kernels need no casts
+            if (left.widened || right.widened ||
+                column_types_[left.index] != column_types_[right.index]) {
+                return false;
+            }
+            pred.column_rhs = true;
+            pred.rhs_column = right.index;
+            return true;
+        }
+        if (!right.is_constant || constants_[right.index].null) {
+            return false;
+        }
+        pred.low = constants_[right.index];
+        if (right.widened) {
+            pred.low.d = static_cast<double>(pred.low.i);
+        }
+        return true;
+    };
+
+    ColumnPredicate pred;
+    size_t instructions = 0;
+    if (match_comparison(result_register_, pred, instructions)) {
+        // Every instruction must belong to the comparison for the kernel to
+        // be equivalent to the full program
+        if (instructions == program_.size()) {
+            pred.valid = true;
+            column_predicate_ = pred;
+        }
+        return;
+    }
+
+    // `col >= lo AND col <= hi` becomes one inclusive BETWEEN range
+    const Instruction& conj = program_.back();
+    if (conj.op != OpCode::AND) {
+        return;
+    }
+    ColumnPredicate a, b;
+    size_t a_instructions = 0, b_instructions = 0;
+    if (!match_comparison(conj.a, a, a_instructions) ||
+        !match_comparison(conj.b, b, b_instructions) ||
+        a.column_rhs || b.column_rhs || a.column != b.column || a.domain != b.domain ||
+        a.domain == ValueKind::STRING ||
+        1 + a_instructions + b_instructions != program_.size()) {
+        return;
+    }
+
+    auto is_lower = [](simd::CompareOp op) {
+        return op == simd::CompareOp::GE || op == simd::CompareOp::GT;
+    };
+    auto is_upper = [](simd::CompareOp op) {
+        return op == simd::CompareOp::LE || op == simd::CompareOp::LT;
+    };
+    if (is_upper(a.op) && is_lower(b.op)) {
+        std::swap(a, b);
+    }
+    if (!is_lower(a.op) || !is_upper(b.op)) {
+        return;
+    }
+
+    ColumnPredicate range = a;
+    range.op = simd::CompareOp::BETWEEN;
+    range.high = b.low;
+    if (a.domain == ValueKind::INT) {
+        // Strict integer bounds become inclusive ones
+        if (a.op == simd::CompareOp::GT) {
+            if (a.low.i == std::numeric_limits<int64_t>::max()) return;
+            range.low.i = a.low.i + 1;
+        }
+        if (b.op == simd::CompareOp::LT) {
+            if (b.low.i == std::numeric_limits<int64_t>::min()) return;
+            range.high.i = b.low.i - 1;
+        }
+    } else if (a.op != simd::CompareOp::GE || b.op != simd::CompareOp::LE) {
+        return;
+    }
+    range.valid = true;
+    column_predicate_ = range;
+}
+
+// ============================================================================
+// ExpressionCompiler
+// ============================================================================
+
+std::unique_ptr<CompiledExpression> ExpressionCompiler::compile(
+    const query::Expression* expr,
+    const Schema& schema) {
+
+    std::vector<std::string> names;
+    std::vector<DataType> types;
+    for (size_t i = 0; i < schema.num_columns(); ++i) {
+        names.push_back(schema.get_column(i).name);
+        types.push_back(schema.get_column(i).type);
+    }
+    return compile(expr, names, types);
+}
+
+std::unique_ptr<CompiledExpression> ExpressionCompiler::compile(
+    const query::Expression* expr,
+    const std::vector<std::string>& column_names,
+    const std::vector<DataType>& column_types) {
+
+    last_error_.clear();
+    if (!expr) {
+        last_error_ = "Null expression";
+        return nullptr;
+    }
+
+    auto program = std::unique_ptr<CompiledExpression>(new CompiledExpression());
+    program->column_types_ = column_types;
+    names_ = &column_names;
+    out_ = program.get();
+    kinds_.clear();
+
+    uint16_t result = 0;
+    bool ok = emit(expr, result);
+    out_ = nullptr;
+    names_ = nullptr;
+    if (!ok) {
+        return nullptr;
+    }
+
+    program->result_register_ = result;
+    program->result_kind_ = kinds_[result];
+    program->registers_.resize(kinds_.size());
+    program->scratch_.resize(kinds_.size());
+    program->vectors_.resize(kinds_.size());
+    program->detect_column_predicate();
+    return program;
+}
+
+uint16_t ExpressionCompiler::new_register(ValueKind kind) {
+    kinds_.push_back(kind);
+    return static_cast<uint16_t>(kinds_.size() - 1);
+}
+
+uint16_t ExpressionCompiler::emit_op(OpCode op, ValueKind kind, uint16_t a, uint16_t b,
+                                     ValueKind operand_kind) {
+    uint16_t dst = new_register(kind);
+    out_->program_.push_back(Instruction{op, operand_kind, dst, a, b});
+    return dst;
+}
+
+bool ExpressionCompiler::coerce_numeric(uint16_t& left, uint16_t& right, bool& as_double) {
+    ValueKind lk = kinds_[left];
+    ValueKind rk = kinds_[right];
+
+    if (is_integral(lk) && is_integral(rk)) {
+        as_double = false;
+        return true;
+    }
+
+    auto to_double = [this](uint16_t reg) -> int {
+        switch (kinds_[reg]) {
+            case ValueKind::DOUBLE: return reg;
+            case ValueKind::INT: return emit_op(OpCode::INT_TO_DBL, ValueKind::DOUBLE, reg);
+            case ValueKind::STRING: return emit_op(OpCode::STR_TO_DBL, ValueKind::DOUBLE, reg);
+            default: return -1;
+        }
+    };
+
+    int l = to_double(left);
+    int r = to_double(right);
+    if (l < 0 || r < 0) {
+        return false;
+    }
+    left = static_cast<uint16_t>(l);
+    right = static_cast<uint16_t>(r);
+    as_double = true;
+    return true;
+}
+
+uint16_t ExpressionCompiler::coerce_bool(uint16_t reg) {
+    if (kinds_[reg] == ValueKind::BOOL) {
+        return reg;
+    }
+    return emit_op(OpCode::TO_BOOL, ValueKind::BOOL, reg, 0, kinds_[reg]);
+}
+
+bool ExpressionCompiler::emit(const query::Expression* expr, uint16_t& reg) {
+    if (kinds_.size() >= std::numeric_limits<uint16_t>::max() - 4) {
+        last_error_ = "Expression too large to compile";
+        return false;
+    }
+
+    // Literals become constants
+    if (auto literal = dynamic_cast<const query::LiteralExpr*>(expr)) {
+        CompiledExpression::Register value;
+        ValueKind kind = ValueKind::NULL_VALUE;
+        const auto& token = literal->value;
+        try {
+            if (token.type == query::TokenType::INTEGER) {
+                value.null = false;
+                value.i = std::stoll(token.value);
+                kind = ValueKind::INT;
+            } else if (token.type == query::TokenType::FLOAT) {
+                value.null = false;
+                value.d = std::stod(token.value);
+                kind = ValueKind::DOUBLE;
+            } else if (token.type == query::TokenType::STRING) {
+                std::string str = token.value;
+                if (str.size() >= 2 &&
+                    ((str.front() == '\'' && str.back() == '\'') ||
+                     (str.front() == '"' && str.back() == '"'))) {
+                    str = str.substr(1, str.length() - 2);
+                }
+                value.null = false;
+                value.i = static_cast<int64_t>(out_->string_pool_.size());
+                out_->string_pool_.push_back(str);
+                kind = ValueKind::STRING;
+            } else if (token.type == query::TokenType::SELECT) {
+                value.null = false;
+                value.i = 1;
+                kind = ValueKind::BOOL;
+            } else if (token.type != query::TokenType::NULL_KW) {
+                last_error_ = "Unsupported literal: " + token.value;
+                return false;
+            }
+        } catch (...) {
+            last_error_ = "Invalid literal: " + token.value;
+            return false;
+        }
+        out_->constants_.push_back(value);
+        reg = emit_op(OpCode::LOAD_CONST, kind,
+                      static_cast<uint16_t>(out_->constants_.size() - 1), 0, kind);
+        return true;
+    }
+
+    // Column references resolve to ordinals once
+    if (auto col_ref = dynamic_cast<const query::ColumnRefExpr*>(expr)) {
+        const auto& names = *names_;
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == col_ref->column_name) {
+                reg = emit_op(OpCode::LOAD_COLUMN, kind_of(out_->column_types_[i]),
+                              static_cast<uint16_t>(i));
+                return true;
+            }
+        }
+        last_error_ = "Column not found: " + col_ref->column_name;
+        return false;
+    }
+
+    if (auto unary = dynamic_cast<const query::UnaryExpr*>(expr)) {
+        uint16_t operand = 0;
+        if (!unary->operand || !emit(unary->operand.get(), operand)) {
+            return false;
+        }
+        if (unary->op == query::UnaryOp::NOT) {
+            reg = emit_op(OpCode::NOT, ValueKind::BOOL, coerce_bool(operand));
+            return true;
+        }
+        switch (kinds_[operand]) {
+            case ValueKind::INT:
+                reg = emit_op(OpCode::NEG_INT, ValueKind::INT, operand);
+                return true;
+            case ValueKind::DOUBLE:
+                reg = emit_op(OpCode::NEG_DBL, ValueKind::DOUBLE, operand);
+                return true;
+            case ValueKind::STRING:
+                reg = emit_op(OpCode::NEG_DBL, ValueKind::DOUBLE,
+                              emit_op(OpCode::STR_TO_DBL, ValueKind::DOUBLE, operand));
+                return true;
+            case ValueKind::NULL_VALUE:
+                reg = operand;
+                return true;
+            default:
+                last_error_ = "Cannot negate boolean";
+                return false;
+        }
+    }
+
+    if (auto binary = dynamic_cast<const query::BinaryExpr*>(expr)) {
+        uint16_t left = 0, right = 0;
+        if (!binary->left || !binary->right ||
+            !emit(binary->left.get(), left) || !emit(binary->right.get(), right)) {
+            return false;
+        }
+
+        if (binary->op == query::BinaryOp::AND || binary->op == query::BinaryOp::OR) {
+            OpCode op = binary->op == query::BinaryOp::AND ? OpCode::AND : OpCode::OR;
+            reg = emit_op(op, ValueKind::BOOL, coerce_bool(left), coerce_bool(right));
+            return true;
+        }
+
+        if (binary->op == query::BinaryOp::IN) {
+            last_error_ = "IN is not compilable";
+            return false;
+        }
+
+        ValueKind lk = kinds_[left];
+        ValueKind rk = kinds_[right];
+
+        // Any other operator with a NULL literal operand is NULL
+        if (lk == ValueKind::NULL_VALUE || rk == ValueKind::NULL_VALUE) {
+            out_->constants_.push_back(CompiledExpression::Register());
+            reg = emit_op(OpCode::LOAD_CONST, ValueKind::NULL_VALUE,
+                          static_cast<uint16_t>(out_->constants_.size() - 1));
+            return true;
+        }
+
+        if (binary->op == query::BinaryOp::LIKE) {
+            if (lk != ValueKind::STRING || rk != ValueKind::STRING) {
+                last_error_ = "LIKE requires string operands";
+                return false;
+            }
+            reg = emit_op(OpCode::LIKE, ValueKind::BOOL, left, right);
+            return true;
+        }
+
+        if (is_comparison(binary->op)) {
+            if (lk == ValueKind::STRING && rk == ValueKind::STRING) {
+                reg = emit_op(compare_opcode(binary->op, ValueKind::STRING), ValueKind::BOOL, left, right);
+                return true;
+            }
+            if ((lk == ValueKind::BOOL) != (rk == ValueKind::BOOL) &&
+                (lk != ValueKind::INT && rk != ValueKind::INT)) {
+                last_error_ = "Cannot compare boolean with non-integer";
+                return false;
+            }
+            bool as_double = false;
+            if (!coerce_numeric(left, right, as_double)) {
+                last_error_ = "Incompatible comparison operands";
+                return false;
+            }
+            reg = emit_op(compare_opcode(binary->op, as_double ? ValueKind::DOUBLE : ValueKind::INT),
+                          ValueKind::BOOL, left, right);
+            return true;
+        }
+
+        // Arithmetic
+        if (lk == ValueKind::BOOL || rk == ValueKind::BOOL) {
+            last_error_ = "Arithmetic on boolean";
+            return false;
+        }
+        if (binary->op == query::BinaryOp::ADD &&
+            (lk == ValueKind::STRING || rk == ValueKind::STRING)) {
+            if (lk != rk) {
+                last_error_ = "Concatenation requires string operands";
+                return false;
+            }
+            reg = emit_op(OpCode::CONCAT, ValueKind::STRING, left, right);
+            return true;
+        }
+        if (binary->op == query::BinaryOp::MODULO) {
+            if (lk != ValueKind::INT || rk != ValueKind::INT) {
+                last_error_ = "Modulo requires integer operands";
+                return false;
+            }
+            reg = emit_op(OpCode::MOD_INT, ValueKind::INT, left, right);
+            return true;
+        }
+
+        bool as_double = false;
+        if (!coerce_numeric(left, right, as_double)) {
+            last_error_ = "Incompatible arithmetic operands";
+            return false;
+        }
+        if (binary->op == query::BinaryOp::DIVIDE && !as_double) {
+            left = emit_op(OpCode::INT_TO_DBL, ValueKind::DOUBLE, left);
+            right = emit_op(OpCode::INT_TO_DBL, ValueKind::DOUBLE, right);
+            as_double = true;
+        }
+        ValueKind kind = as_double ? ValueKind::DOUBLE : ValueKind::INT;
+        OpCode op;
+        switch (binary->op) {
+            case query::BinaryOp::ADD: op = as_double ? OpCode::ADD_DBL : OpCode::ADD_INT; break;
+            case query::BinaryOp::SUBTRACT: op = as_double ? OpCode::SUB_DBL : OpCode::SUB_INT; break;
+            case query::BinaryOp::MULTIPLY: op = as_double ? OpCode::MUL_DBL : OpCode::MUL_INT; break;
+            case query::BinaryOp::DIVIDE: op = OpCode::DIV_DBL; break;
+            default:
+                last_error_ = "Unsupported binary operator";
+                return false;
+        }
+        reg = emit_op(op, kind, left, right);
+        return true;
+    }
+
+    if (auto func = dynamic_cast<const query::FunctionExpr*>(expr)) {
+        const auto& name = func->function_name;
+        if (func->arguments.size() != 1) {
+            last_error_ = "Function not compilable: " + name;
+            return false;
+        }
+        uint16_t arg = 0;
+        if (!emit(func->arguments[0].get(), arg)) {
+            return false;
+        }
+        ValueKind kind = kinds_[arg];
+        if ((name == "UPPER" || name == "LOWER") && kind == ValueKind::STRING) {
+            reg = emit_op(name == "UPPER" ? OpCode::UPPER : OpCode::LOWER, ValueKind::STRING, arg);
+            return true;
+        }
+        if (name == "LENGTH" && kind == ValueKind::STRING) {
+            reg = emit_op(OpCode::LENGTH, ValueKind::INT, arg);
+            return true;
+        }
+        if (name == "ABS" && kind == ValueKind::INT) {
+            reg = emit_op(OpCode::ABS_INT, ValueKind::INT, arg);
+            return true;
+        }
+        if (name == "ABS" && kind == ValueKind::DOUBLE) {
+            reg = emit_op(OpCode::ABS_DBL, ValueKind::DOUBLE, arg);
+            return true;
+        }
+        last_error_ = "Function not compilable: " + name;
+        return false;
+    }
+
+    last_error_ = "Expression not compilable: " + expr->to_string();
+    return false;
+}
+
+} // namespace lyradb
@@ -1,5 +1,7 @@
 #include "lyradb/expression_evaluator.h"
 #include "lyradb/sql_parser.h"
+#include "lyradb/compiled_expression.h"
+#include "lyradb/vector_batch.h"
 #include <cmath>
 #include <algorithm>
 #include <cctype>
@@ -8,6 +10,114 @@
 
 namespace lyradb {
 
+namespace {
+
+// Direction of a column-vs-literal bound: +1 lower, -1 upper, 0 neither
+int bound_direction(const query::Expression* expr, std::string& column) {
+    auto binary = dynamic_cast<const query::BinaryExpr*>(expr);
+    if (!binary || !binary->left || !binary->right) {
+        return 0;
+    }
+    auto left_col = dynamic_cast<const query::ColumnRefExpr*>(binary->left.get());
+    auto right_col = dynamic_cast<const query::ColumnRefExpr*>(binary->right.get());
+    bool left_lit = dynamic_cast<const query::LiteralExpr*>(binary->left.get()) != nullptr;
+    bool right_lit = dynamic_cast<const query::LiteralExpr*>(binary->right.get()) != nullptr;
+
+    int direction = 0;
+    switch (binary->op) {
+        case query::BinaryOp::GREATER:
+        case query::BinaryOp::GREATER_EQUAL: direction = 1; break;
+        case query::BinaryOp::LESS:
+        case query::BinaryOp::LESS_EQUAL: direction = -1; break;
+        default: return 0;
+    }
+    if (left_col && right_lit) {
+        column = left_col->column_name;
+        return direction;
+    }
+    if (left_lit && right_col) {
+        column = right_col->column_name;
+        return -direction;
+    }
+    return 0;
+}
+
+// `col >= lo AND col <= hi` compiles into a single range kernel, so it is
+// kept whole rather than split into two conjuncts
+bool is_range_pair(const query::BinaryExpr* binary) {
+    std::string left_column, right_column;
+    int left = bound_direction(binary->left.get(), left_column);
+    int right = bound_direction(binary->right.get(), right_column);
+    return left != 0 && left == -right && left_column == right_column;
+}
+
+void collect_conjuncts(const query::Expression* expr,
+                       std::vector<const query::Expression*>& out) {
+    auto binary = dynamic_cast<const query::BinaryExpr*>(expr);
+    if (binary && binary->op == query::BinaryOp::AND && binary->left && binary->right &&
+        !is_range_pair(binary)) {
+        collect_conjuncts(binary->left.get(), out);
+        collect_conjuncts(binary->right.get(), out);
+        return;
+    }
+    out.push_back(expr);
+}
+
+// Narrow ranges to the zones a column predicate may match; zone rows are
+// counted from base
+void narrow_to_zones(const CompiledExpression& program, const indexes::ZoneMapIndex& zone_map,
+                     size_t base, std::vector<RowRange>& ranges) {
+    // Pages this conjunct may match, adjacent ones merged
+    std::vector<RowRange> allowed;
+    for (const auto& zone : zone_map.zones()) {
+        if (!program.may_match(zone_map, zone)) {
+            continue;
+        }
+        size_t begin = base + zone.first_row;
+        size_t end = begin + zone.row_count;
+        if (!allowed.empty() && allowed.back().end == begin) {
+            allowed.back().end = end;
+        } else {
+            allowed.push_back(RowRange{begin, end});
+        }
+    }
+    
+    // Intersect with what earlier conjuncts left
+    std::vector<RowRange> narrowed;
+    size_t a = 0, b = 0;
+    while (a < ranges.size() && b < allowed.size()) {
+        size_t begin = std::max(ranges[a].begin, allowed[b].begin);
+        size_t end = std::min(ranges[a].end, allowed[b].end);
+        if (begin < end) {
+            narrowed.push_back(RowRange{begin, end});
+        }
+        if (ranges[a].end < allowed[b].end) {
+            ++a;
+        } else {
+            ++b;
+        }
+    }
+    ranges.swap(narrowed);
+}
+
+bool is_truthy(const ExpressionValue& value) {
+    if (std::holds_alternative<bool>(value)) {
+        return std::get<bool>(value);
+    } else if (std::holds_alternative<int64_t>(value)) {
+        return std::get<int64_t>(value) != 0;
+    } else if (std::holds_alternative<double>(value)) {
+        return std::get<double>(value) != 0.0;
+    }
+    return false;
+}
+
+}  // namespace
+
+ExpressionEvaluator::ExpressionEvaluator()
+    : instruction_set_(simd::detect_instruction_set()) {}
+
+ExpressionEvaluator::~ExpressionEvaluator() = default;
+
 ExpressionValue ExpressionEvaluator::evaluate(const query::Expression* expr, const RowData& row) {
     if (!expr) {
         return nullptr;
@@ -25,8 +135,12 @@ ExpressionValue ExpressionEvaluator::evaluate(const query::Expression* expr, con
     } else if (auto func = dynamic_cast<const query::FunctionExpr*>(expr)) {
         return eval_function(func, row);
     } else if (auto agg = dynamic_cast<const query::AggregateExpr*>(expr)) {
-        // For single-row context, return 0 for aggregates
-        // (Full aggregate evaluation requires batch context)
+        // Aggregates are computed by the aggregation operator; rows of its
+        // output carry each value under the aggregate's text, e.g. "SUM(x)"
+        auto it = row.find(agg->to_string());
+        if (it != row.end()) {
+            return it->second;
+        }
         return 0LL;
     }
     
@@ -48,6 +162,229 @@ std::vector<ExpressionValue> ExpressionEvaluator::evaluate_batch(
     return results;
 }
 
+std::vector<ExpressionValue> ExpressionEvaluator::evaluate_batch(
+    const query::Expression* expr,
+    const VectorBatch& batch,
+    const SelectionVector& selection) {
+    
+    std::vector<ExpressionValue> results;
+    prepare_batch_plan(value_plan_, expr, batch, false);
+    
+    if (value_plan_.programs[0]) {
+        value_plan_.programs[0]->evaluate_batch(batch, selection, results);
+        return results;
+    }
+    
+    results.reserve(selection.size());
+    RowData row;
+    for (uint32_t r : selection) {
+        load_batch_row(batch, batch.position() + r, row);
+        results.push_back(evaluate(expr, row));
+    }
+    return results;
+}
+
+size_t ExpressionEvaluator::filter_batch(
+    const query::Expression* expr,
+    const VectorBatch& batch,
+    SelectionVector& selection) {
+    
+    prepare_batch_plan(filter_plan_, expr, batch, true);
+    
+    RowData row;
+    for (size_t c = 0; c < filter_plan_.conjuncts.size() && !selection.empty(); ++c) {
+        const auto& program = filter_plan_.programs[c];
+        if (program) {
+            program->filter_batch(batch, selection, instruction_set_);
+            continue;
+        }
+        
+        // Interpreted conjunct: only rows that survived so far are visited
+        size_t out = 0;
+        for (size_t k = 0; k < selection.size(); ++k) {
+            load_batch_row(batch, batch.position() + selection[k], row);
+            bool keep = is_truthy(evaluate(filter_plan_.conjuncts[c], row));
+            selection[out] = selection[k];
+            out += keep;
+        }
+        selection.resize(out);
+    }
+    return selection.size();
+}
+
+void ExpressionEvaluator::candidate_ranges(
+    const query::Expression* expr,
+    const VectorBatch& batch,
+    std::vector<RowRange>& ranges) {
+    
+    ranges.assign(1, RowRange{batch.offset, batch.offset + batch.size});
+    prepare_batch_plan(filter_plan_, expr, batch, true);
+    
+    for (const auto& program : filter_plan_.programs) {
+        int column = program ? program->pruning_column() : -1;
+        if (column < 0) {
+            continue;
+        }
+        narrow_to_zones(*program, batch.columns[column]->zone_map(), batch.base, ranges);
+        if (ranges.empty()) {
+            return;
+        }
+    }
+}
+
+void ExpressionEvaluator::candidate_ranges(
+    const query::Expression* expr,
+    const Table& table,
+    std::vector<RowRange>& ranges) {
+    
+    // Zone maps are per row group; candidates running across a group
+    // boundary are joined. Table::zone_map() serves a lazy table's zone
+    // maps as stored, so pruning loads no column
+    ranges.clear();
+    prepare_batch_plan(filter_plan_, expr, table.get_schema(), true);
+    std::vector<RowRange> group_ranges;
+    for (size_t g = 0; g < table.stored_group_count(); ++g) {
+        size_t base = g * Table::kRowGroupRows;
+        group_ranges.assign(1, RowRange{base, std::min(base + Table::kRowGroupRows,
+                                                       table.stored_row_count())});
+        for (const auto& program : filter_plan_.programs) {
+            int column = program ? program->pruning_column() : -1;
+            if (column >= 0 && !group_ranges.empty()) {
+                narrow_to_zones(*program, table.zone_map(column, g), base, group_ranges);
+            }
+        }
+        for (const RowRange& range : group_ranges) {
+            if (!ranges.empty() && ranges.back().end == range.begin) {
+                ranges.back().end = range.end;
+            } else {
+                ranges.push_back(range);
+            }
+        }
+    }
+    add_delta_rows(table, ranges);
+}
+
+void ExpressionEvaluator::prepare_batch_plan(BatchPlan& plan, const query::Expression* expr,
+                                             const VectorBatch& batch, bool split_conjuncts) {
+    // Programs read the batch's columns when run, so batches of other row
+    // groups (or delta copies) with the same layout reuse them
+    bool same_layout = plan.expr == expr && !plan.programs.empty() &&
+                       plan.names.size() == batch.columns.size();
+    for (size_t i = 0; same_layout && i < batch.columns.size(); ++i) {
+        const Column* column = batch.columns[i];
+        same_layout = column ? plan.types[i] == column->type() && plan.names[i] == column->name()
+                             : plan.names[i].empty();
+    }
+    if (same_layout) {
+        return;
+    }
+    
+    plan.expr = expr;
+    plan.names.clear();
+    plan.types.clear();
+    for (const Column* column : batch.columns) {
+        plan.names.push_back(column ? column->name() : std::string());
+        plan.types.push_back(column ? column->type() : DataType::STRING);
+    }
+    compile_batch_plan(plan, split_conjuncts);
+}
+
+void ExpressionEvaluator::prepare_batch_plan(BatchPlan& plan, const query::Expression* expr,
+                                             const Schema& schema, bool split_conjuncts) {
+    bool same_layout = plan.expr == expr && !plan.programs.empty() &&
+                       plan.names.size() == schema.num_columns();
+    for (size_t i = 0; same_layout && i < schema.num_columns(); ++i) {
+        const ColumnDef& def = schema.get_column(i);
+        same_layout = plan.types[i] == def.type && plan.names[i] == def.name;
+    }
+    if (same_layout) {
+        return;
+    }
+    
+    plan.expr = expr;
+    plan.names.clear();
+    plan.types.clear();
+    for (size_t i = 0; i < schema.num_columns(); ++i) {
+        plan.names.push_back(schema.get_column(i).name);
+        plan.types.push_back(schema.get_column(i).type);
+    }
+    compile_batch_plan(plan, split_conjuncts);
+}
+
+void ExpressionEvaluator::compile_batch_plan(BatchPlan& plan, bool split_conjuncts) {
+    const query::Expression* expr = plan.expr;
+    plan.conjuncts.clear();
+    plan.programs.clear();
+    
+    if (split_conjuncts) {
+        collect_conjuncts(expr, plan.conjuncts);
+    } else {
+        plan.conjuncts.push_back(expr);
+    }
+    
+    ExpressionCompiler compiler;
+    for (const auto* conjunct : plan.conjuncts) {
+        plan.programs.push_back(compiler.compile(conjunct, plan.names, plan.types));
+    }
+    
+    if (split_conjuncts) {
+        // Cheapest first: single-column kernels, then compiled programs, then
+        // interpreted conjuncts (AND is order-independent for filtering)
+        auto rank = [](const std::unique_ptr<CompiledExpression>& program) {
+            return !program ? 2 : program->is_column_predicate() ? 0 : 1;
+        };
+        std::vector<size_t> order(plan.conjuncts.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return rank(plan.programs[a]) < rank(plan.programs[b]);
+        });
+        
+        std::vector<const query::Expression*> conjuncts;
+        std::vector<std::unique_ptr<CompiledExpression>> programs;
+        for (size_t i : order) {
+            conjuncts.push_back(plan.conjuncts[i]);
+            programs.push_back(std::move(plan.programs[i]));
+        }
+        plan.conjuncts = std::move(conjuncts);
+        plan.programs = std::move(programs);
+    }
+}
+
+void ExpressionEvaluator::load_batch_row(const VectorBatch& batch, size_t row, RowData& out) const {
+    for (const Column* column : batch.columns) {
+        if (!column) {
+            continue;
+        }
+        ExpressionValue& value = out[column->name()];
+        if (column->is_null(row)) {
+            value = nullptr;
+            continue;
+        }
+        switch (column->type()) {
+            case DataType::INT32:
+            case DataType::DATE32:
+                value = static_cast<int64_t>(column->data<int32_t>()[row]);
+                break;
+            case DataType::INT64:
+            case DataType::TIMESTAMP:
+                value = column->data<int64_t>()[row];
+                break;
+            case DataType::FLOAT32:
+                value = static_cast<double>(column->data<float>()[row]);
+                break;
+            case DataType::FLOAT64:
+                value = column->data<double>()[row];
+                break;
+            case DataType::BOOL:
+                value = column->data<uint8_t>()[row] != 0;
+                break;
+            default:
+                value = column->string_at(row);
+                break;
+        }
+    }
+}
+
 void ExpressionEvaluator::set_context_row(const RowData& row) {
     context_row_ = row;
 }
@@ -485,4 +822,41 @@ ExpressionValue ExpressionEvaluator::func_coalesce(const std::vector<ExpressionV
     return nullptr;
 }
 
+void collect_columns(const query::Expression* expr,
+                     const std::vector<std::string>& col_names,
+                     std::vector<bool>& used) {
+    if (!expr) {
+        return;
+    }
+    if (auto col_ref = dynamic_cast<const query::ColumnRefExpr*>(expr)) {
+        for (size_t i = 0; i < col_names.size(); ++i) {
+            if (col_ref->column_name == "*" || col_names[i] == col_ref->column_name) {
+                used[i] = true;
+            }
+        }
+    } else if (auto binary = dynamic_cast<const query::BinaryExpr*>(expr)) {
+        collect_columns(binary->left.get(), col_names, used);
+        collect_columns(binary->right.get(), col_names, used);
+    } else if (auto unary = dynamic_cast<const query::UnaryExpr*>(expr)) {
+        collect_columns(unary->operand.get(), col_names, used);
+    } else if (auto func = dynamic_cast<const query::FunctionExpr*>(expr)) {
+        for (const auto& arg : func->arguments) {
+            collect_columns(arg.get(), col_names, used);
+        }
+    } else if (auto agg = dynamic_cast<const query::AggregateExpr*>(expr)) {
+        collect_columns(agg->argument.get(), col_names, used);
+    }
+}
+
+std::vector<bool> referenced_columns(const query::Expression* expr, const Table& table) {
+    const Schema& schema = table.get_schema();
+    std::vector<std::string> col_names;
+    for (size_t i = 0; i < schema.num_columns(); ++i) {
+        col_names.push_back(schema.get_column(i).name);
+    }
+    std::vector<bool> used(col_names.size(), false);
+    collect_columns(expr, col_names, used);
+    return used;
+}
+
 } // namespace lyradb
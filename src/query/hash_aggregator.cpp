@@ -0,0 +1,657 @@
+#include "lyradb/hash_aggregator.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/table.h"
+#include "lyradb/column.h"
+#include "lyradb/vector_batch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace lyradb {
+
+namespace {
+
+// Rows per chunk when key or argument expressions must be evaluated
+constexpr size_t kChunkRows = 1024;
+
+// ============================================================================
+// Typed values and packed keys
+// ============================================================================
+
+enum class Tag : uint8_t { NUL, INT, DOUBLE, STRING, BOOL };
+
+/**
+ * @brief Non-owning view of one input value
+ */
+struct Datum {
+    Tag tag = Tag::NUL;
+    int64_t i = 0;
+    double d = 0.0;
+    const std::string* s = nullptr;
+};
+
+Datum read_column(const Column& column, size_t row) {
+    Datum datum;
+    if (column.is_null(row)) {
+        return datum;
+    }
+    switch (column.type()) {
+        case DataType::INT32:
+        case DataType::DATE32:
+            datum.tag = Tag::INT;
+            datum.i = column.data<int32_t>()[row];
+            break;
+        case DataType::INT64:
+        case DataType::TIMESTAMP:
+            datum.tag = Tag::INT;
+            datum.i = column.data<int64_t>()[row];
+            break;
+        case DataType::FLOAT32:
+            datum.tag = Tag::DOUBLE;
+            datum.d = column.data<float>()[row];
+            break;
+        case DataType::FLOAT64:
+            datum.tag = Tag::DOUBLE;
+            datum.d = column.data<double>()[row];
+            break;
+        case DataType::BOOL:
+            datum.tag = Tag::BOOL;
+            datum.i = column.data<uint8_t>()[row] != 0;
+            break;
+        default:
+            datum.tag = Tag::STRING;
+            datum.s = &column.string_at(row);
+            break;
+    }
+    return datum;
+}
+
+Datum read_value(const ExpressionValue& value) {
+    Datum datum;
+    if (auto i = std::get_if<int64_t>(&value)) {
+        datum.tag = Tag::INT;
+        datum.i = *i;
+    } else if (auto d = std::get_if<double>(&value)) {
+        datum.tag = Tag::DOUBLE;
+        datum.d = *d;
+    } else if (auto s = std::get_if<std::string>(&value)) {
+        datum.tag = Tag::STRING;
+        datum.s = s;
+    } else if (auto b = std::get_if<bool>(&value)) {
+        datum.tag = Tag::BOOL;
+        datum.i = *b;
+    }
+    return datum;
+}
+
+void pack(const Datum& datum, std::vector<uint8_t>& out) {
+    out.push_back(static_cast<uint8_t>(datum.tag));
+    size_t at = out.size();
+    switch (datum.tag) {
+        case Tag::NUL:
+            break;
+        case Tag::INT:
+        case Tag::BOOL:
+            out.resize(at + sizeof(int64_t));
+            std::memcpy(out.data() + at, &datum.i, sizeof(int64_t));
+            break;
+        case Tag::DOUBLE: {
+            // -0.0 and 0.0 (and all NaNs) must land in the same group
+            double d = datum.d == 0.0 ? 0.0 : datum.d;
+            if (std::isnan(d)) {
+                d = std::numeric_limits<double>::quiet_NaN();
+            }
+            out.resize(at + sizeof(double));
+            std::memcpy(out.data() + at, &d, sizeof(double));
+            break;
+        }
+        case Tag::STRING: {
+            uint32_t len = static_cast<uint32_t>(datum.s->size());
+            out.resize(at + sizeof(len) + len);
+            std::memcpy(out.data() + at, &len, sizeof(len));
+            std::memcpy(out.data() + at + sizeof(len), datum.s->data(), len);
+            break;
+        }
+    }
+}
+
+ExpressionValue unpack(const uint8_t*& p) {
+    Tag tag = static_cast<Tag>(*p++);
+    switch (tag) {
+        case Tag::INT:
+        case Tag::BOOL: {
+            int64_t i;
+            std::memcpy(&i, p, sizeof(i));
+            p += sizeof(i);
+            if (tag == Tag::BOOL) {
+                return i != 0;
+            }
+            return i;
+        }
+        case Tag::DOUBLE: {
+            double d;
+            std::memcpy(&d, p, sizeof(d));
+            p += sizeof(d);
+            return d;
+        }
+        case Tag::STRING: {
+            uint32_t len;
+            std::memcpy(&len, p, sizeof(len));
+            p += sizeof(len);
+            std::string s(reinterpret_cast<const char*>(p), len);
+            p += len;
+            return s;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+uint64_t hash_key(const uint8_t* p, size_t n) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ n;
+    while (n >= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = (h ^ w) * 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+        p += 8;
+        n -= 8;
+    }
+    uint64_t w = 0;
+    if (n > 0) {
+        std::memcpy(&w, p, n);
+    }
+    h = (h ^ w) * 0xC4CEB9FE1A85EC53ULL;
+    return h ^ (h >> 29);
+}
+
+// ============================================================================
+// Open-addressed key table
+// ============================================================================
+
+/**
+ * @brief Linear-probing hash table mapping packed keys to dense ids
+ *
+ * Keys live back to back in one arena; slots hold entry id + 1 so an
+ * all-zero slot array means empty. Ids are assigned in insertion order.
+ */
+class KeyTable {
+public:
+    KeyTable() : slots_(16, 0), offsets_(1, 0) {}
+
+    uint32_t find_or_insert(const uint8_t* key, size_t len, uint64_t hash, bool& inserted) {
+        size_t mask = slots_.size() - 1;
+        for (size_t idx = hash & mask;; idx = (idx + 1) & mask) {
+            uint32_t slot = slots_[idx];
+            if (slot == 0) {
+                uint32_t id = static_cast<uint32_t>(hashes_.size());
+                hashes_.push_back(hash);
+                arena_.insert(arena_.end(), key, key + len);
+                offsets_.push_back(arena_.size());
+                slots_[idx] = id + 1;
+                inserted = true;
+                if (hashes_.size() * 2 > slots_.size()) {
+                    grow();
+                }
+                return id;
+            }
+            uint32_t id = slot - 1;
+            // Global aggregates pack an empty key whose pointers may be
+            // null, and memcmp must not see those even for zero bytes
+            if (hashes_[id] == hash && key_size(id) == len &&
+                (len == 0 || std::memcmp(key_data(id), key, len) == 0)) {
+                inserted = false;
+                return id;
+            }
+        }
+    }
+
+    size_t size() const { return hashes_.size(); }
+    uint64_t hash(uint32_t id) const { return hashes_[id]; }
+    const uint8_t* key_data(uint32_t id) const { return arena_.data() + offsets_[id]; }
+    size_t key_size(uint32_t id) const { return offsets_[id + 1] - offsets_[id]; }
+
+private:
+    std::vector<uint32_t> slots_;     // Entry id + 1; 0 = empty; power-of-two size
+    std::vector<uint64_t> hashes_;    // Per entry
+    std::vector<size_t> offsets_;     // Entry i spans arena_[offsets_[i], offsets_[i+1])
+    std::vector<uint8_t> arena_;
+
+    void grow() {
+        std::vector<uint32_t> slots(slots_.size() * 2, 0);
+        size_t mask = slots.size() - 1;
+        for (uint32_t id = 0; id < hashes_.size(); ++id) {
+            size_t idx = hashes_[id] & mask;
+            while (slots[idx] != 0) {
+                idx = (idx + 1) & mask;
+            }
+            slots[idx] = id + 1;
+        }
+        slots_.swap(slots);
+    }
+};
+
+// ============================================================================
+// Accumulators
+// ============================================================================
+
+/**
+ * @brief Running state of one aggregate for one group
+ */
+struct AggState {
+    int64_t count = 0;           // Non-NULL inputs (all rows for COUNT(*))
+    int64_t sum_int = 0;
+    double sum_double = 0.0;
+    bool has_double = false;     // SUM is reported as double
+    Tag extreme = Tag::NUL;      // MIN/MAX so far
+    int64_t extreme_int = 0;
+    double extreme_double = 0.0;
+    std::string extreme_string;
+};
+
+void add_int(AggState& state, int64_t v) {
+    constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+    constexpr int64_t kMin = std::numeric_limits<int64_t>::min();
+    if ((v > 0 && state.sum_int > kMax - v) || (v < 0 && state.sum_int < kMin - v)) {
+        // Overflow: move the exact part over and continue in double
+        state.sum_double += static_cast<double>(state.sum_int) + static_cast<double>(v);
+        state.sum_int = 0;
+        state.has_double = true;
+    } else {
+        state.sum_int += v;
+    }
+}
+
+void add_sum(AggState& state, const Datum& datum) {
+    switch (datum.tag) {
+        case Tag::INT:
+        case Tag::BOOL:
+            add_int(state, datum.i);
+            break;
+        case Tag::DOUBLE:
+            state.sum_double += datum.d;
+            state.has_double = true;
+            break;
+        case Tag::STRING:
+            // DECIMAL and numeric text
+            state.sum_double += std::strtod(datum.s->c_str(), nullptr);
+            state.has_double = true;
+            break;
+        case Tag::NUL:
+            break;
+    }
+}
+
+bool is_numeric(Tag tag) {
+    return tag == Tag::INT || tag == Tag::DOUBLE || tag == Tag::BOOL;
+}
+
+/**
+ * @brief Three-way compare of a value against the current extreme
+ */
+int compare_extreme(const Datum& datum, const AggState& state) {
+    if (datum.tag == Tag::STRING && state.extreme == Tag::STRING) {
+        return datum.s->compare(state.extreme_string);
+    }
+    if (is_numeric(datum.tag) && is_numeric(state.extreme)) {
+        if (datum.tag != Tag::DOUBLE && state.extreme != Tag::DOUBLE) {
+            return datum.i < state.extreme_int ? -1 : (datum.i > state.extreme_int ? 1 : 0);
+        }
+        double a = datum.tag == Tag::DOUBLE ? datum.d : static_cast<double>(datum.i);
+        double b = state.extreme == Tag::DOUBLE ? state.extreme_double
+                                                : static_cast<double>(state.extreme_int);
+        return a < b ? -1 : (a > b ? 1 : 0);
+    }
+    // Mixed strings and numbers: numbers sort first
+    return datum.tag == Tag::STRING ? 1 : -1;
+}
+
+void set_extreme(AggState& state, const Datum& datum) {
+    state.extreme = datum.tag;
+    state.extreme_int = datum.i;
+    state.extreme_double = datum.d;
+    if (datum.tag == Tag::STRING) {
+        state.extreme_string = *datum.s;
+    }
+}
+
+void update_extreme(AggState& state, const Datum& datum, bool is_min) {
+    if (state.extreme == Tag::NUL) {
+        set_extreme(state, datum);
+        return;
+    }
+    int cmp = compare_extreme(datum, state);
+    if (is_min ? cmp < 0 : cmp > 0) {
+        set_extreme(state, datum);
+    }
+}
+
+Datum extreme_datum(const AggState& state) {
+    Datum datum;
+    datum.tag = state.extreme;
+    datum.i = state.extreme_int;
+    datum.d = state.extreme_double;
+    datum.s = &state.extreme_string;
+    return datum;
+}
+
+ExpressionValue final_value(AggregationFunction function, const AggState& state) {
+    switch (function) {
+        case AggregationFunction::COUNT:
+        case AggregationFunction::COUNT_DISTINCT:
+            return state.count;
+        case AggregationFunction::SUM:
+            if (state.count == 0) {
+                return nullptr;
+            }
+            if (state.has_double) {
+                return state.sum_double + static_cast<double>(state.sum_int);
+            }
+            return state.sum_int;
+        case AggregationFunction::AVG:
+            if (state.count == 0) {
+                return nullptr;
+            }
+            return (state.sum_double + static_cast<double>(state.sum_int)) /
+                   static_cast<double>(state.count);
+        case AggregationFunction::MIN:
+        case AggregationFunction::MAX:
+            switch (state.extreme) {
+                case Tag::INT: return state.extreme_int;
+                case Tag::BOOL: return state.extreme_int != 0;
+                case Tag::DOUBLE: return state.extreme_double;
+                case Tag::STRING: return state.extreme_string;
+                default: return nullptr;
+            }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+// ============================================================================
+// HashAggregator
+// ============================================================================
+
+struct HashAggregator::Input {
+    const query::Expression* expr = nullptr;  // nullptr for COUNT(*)
+    const Column* column = nullptr;           // Set for plain column references
+};
+
+/**
+ * @brief Groups and accumulators built by one participant slot
+ */
+struct HashAggregator::Partial {
+    explicit Partial(size_t num_aggregates) : distinct(num_aggregates) {}
+
+    KeyTable groups;
+    std::vector<uint64_t> first_row;         // Smallest input row per group
+    std::vector<AggState> states;            // group-major, one per aggregate
+    std::vector<KeyTable> distinct;          // COUNT DISTINCT: (group, value) pairs
+
+    ExpressionEvaluator evaluator;
+    std::vector<std::vector<ExpressionValue>> key_scratch;       // Evaluated key expressions
+    std::vector<std::vector<ExpressionValue>> argument_scratch;  // Evaluated arguments
+    std::vector<uint8_t> key;
+    std::vector<uint8_t> distinct_key;
+};
+
+HashAggregator::HashAggregator(const Table& table,
+                               std::vector<const query::Expression*> keys,
+                               std::vector<AggregateSpec> aggregates)
+    : table_(table), keys_(std::move(keys)), aggregates_(std::move(aggregates)) {
+    const Schema& schema = table_.get_schema();
+    auto bind = [&](const query::Expression* expr) {
+        Input input;
+        input.expr = expr;
+        if (auto ref = dynamic_cast<const query::ColumnRefExpr*>(expr)) {
+            if (schema.find_column(ref->column_name)) {
+                input.column = &table_.column(schema.column_index(ref->column_name));
+            }
+        }
+        return input;
+    };
+    for (const auto* key : keys_) {
+        key_inputs_.push_back(bind(key));
+    }
+    for (const auto& aggregate : aggregates_) {
+        argument_inputs_.push_back(bind(aggregate.argument));
+    }
+}
+
+HashAggregator::~HashAggregator() = default;
+
+void HashAggregator::consume(const std::vector<size_t>& row_ids, QueryExecutor& executor) {
+    // One partial table per slot; slots never run two morsels at once
+    std::vector<std::unique_ptr<Partial>> partials(executor.parallelism());
+    auto morsels = executor.make_morsels({RowRange{0, row_ids.size()}});
+    executor.run_morsels(morsels.size(), [&](size_t m, size_t slot) {
+        if (!partials[slot]) {
+            partials[slot] = std::make_unique<Partial>(aggregates_.size());
+        }
+        consume_rows(*partials[slot], row_ids, morsels[m].begin, morsels[m].end);
+    });
+
+    Partial* result = nullptr;
+    for (auto& partial : partials) {
+        if (!partial) {
+            continue;
+        }
+        if (!result) {
+            result = partial.get();
+        } else {
+            merge(*result, *partial);
+            partial.reset();
+        }
+    }
+    if (!result) {
+        partials[0] = std::make_unique<Partial>(aggregates_.size());
+        result = partials[0].get();
+    }
+    finish(*result);
+}
+
+void HashAggregator::consume_rows(Partial& partial, const std::vector<size_t>& row_ids,
+                                  size_t begin, size_t end) {
+    const size_t num_aggregates = aggregates_.size();
+    partial.key_scratch.resize(key_inputs_.size());
+    partial.argument_scratch.resize(num_aggregates);
+
+    bool evaluate = false;
+    for (const Input& input : key_inputs_) {
+        evaluate = evaluate || !input.column;
+    }
+    for (const Input& input : argument_inputs_) {
+        evaluate = evaluate || (input.expr && !input.column);
+    }
+
+    auto read = [&](const Input& input, const std::vector<ExpressionValue>& scratch,
+                    size_t row, size_t pos) {
+        return input.column ? read_column(*input.column, row) : read_value(scratch[pos]);
+    };
+
+    SelectionVector selection;
+    for (size_t chunk = begin; chunk < end; chunk += kChunkRows) {
+        size_t chunk_end = std::min(end, chunk + kChunkRows);
+
+        // Computed keys and arguments are evaluated a chunk at a time
+        if (evaluate) {
+            size_t first = row_ids[chunk];
+            VectorBatch batch = VectorBatch::from_table(table_, first, row_ids[chunk_end - 1] - first + 1);
+            selection.resize(chunk_end - chunk);
+            for (size_t r = chunk; r < chunk_end; ++r) {
+                selection[r - chunk] = static_cast<uint32_t>(row_ids[r] - first);
+            }
+            for (size_t k = 0; k < key_inputs_.size(); ++k) {
+                if (!key_inputs_[k].column) {
+                    partial.key_scratch[k] = partial.evaluator.evaluate_batch(
+                        key_inputs_[k].expr, batch, selection);
+                }
+            }
+            for (size_t a = 0; a < num_aggregates; ++a) {
+                const Input& input = argument_inputs_[a];
+                if (input.expr && !input.column) {
+                    partial.argument_scratch[a] = partial.evaluator.evaluate_batch(
+                        input.expr, batch, selection);
+                }
+            }
+        }
+
+        for (size_t r = chunk; r < chunk_end; ++r) {
+            size_t row = row_ids[r];
+            size_t pos = r - chunk;
+
+            partial.key.clear();
+            for (size_t k = 0; k < key_inputs_.size(); ++k) {
+                pack(read(key_inputs_[k], partial.key_scratch[k], row, pos), partial.key);
+            }
+            bool inserted;
+            uint32_t group = partial.groups.find_or_insert(
+                partial.key.data(), partial.key.size(),
+                hash_key(partial.key.data(), partial.key.size()), inserted);
+            if (inserted) {
+                partial.first_row.push_back(row);
+                partial.states.resize(partial.states.size() + num_aggregates);
+            } else if (row < partial.first_row[group]) {
+                partial.first_row[group] = row;
+            }
+
+            AggState* states = &partial.states[static_cast<size_t>(group) * num_aggregates];
+            for (size_t a = 0; a < num_aggregates; ++a) {
+                const Input& input = argument_inputs_[a];
+                AggState& state = states[a];
+                if (!input.expr) {
+                    state.count++;   // COUNT(*)
+                    continue;
+                }
+                Datum datum = read(input, partial.argument_scratch[a], row, pos);
+                if (datum.tag == Tag::NUL) {
+                    continue;
+                }
+                switch (aggregates_[a].function) {
+                    case AggregationFunction::COUNT:
+                        state.count++;
+                        break;
+                    case AggregationFunction::SUM:
+                    case AggregationFunction::AVG:
+                        state.count++;
+                        add_sum(state, datum);
+                        break;
+                    case AggregationFunction::MIN:
+                    case AggregationFunction::MAX:
+                        state.count++;
+                        update_extreme(state, datum, aggregates_[a].function == AggregationFunction::MIN);
+                        break;
+                    case AggregationFunction::COUNT_DISTINCT: {
+                        partial.distinct_key.resize(sizeof(group));
+                        std::memcpy(partial.distinct_key.data(), &group, sizeof(group));
+                        pack(datum, partial.distinct_key);
+                        bool fresh;
+                        partial.distinct[a].find_or_insert(
+                            partial.distinct_key.data(), partial.distinct_key.size(),
+                            hash_key(partial.distinct_key.data(), partial.distinct_key.size()), fresh);
+                        if (fresh) {
+                            state.count++;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void HashAggregator::merge(Partial& into, Partial& from) const {
+    const size_t num_aggregates = aggregates_.size();
+    std::vector<uint32_t> mapping(from.groups.size());
+
+    for (uint32_t g = 0; g < from.groups.size(); ++g) {
+        bool inserted;
+        uint32_t target = into.groups.find_or_insert(
+            from.groups.key_data(g), from.groups.key_size(g), from.groups.hash(g), inserted);
+        mapping[g] = target;
+        if (inserted) {
+            into.first_row.push_back(from.first_row[g]);
+            into.states.resize(into.states.size() + num_aggregates);
+        } else {
+            into.first_row[target] = std::min(into.first_row[target], from.first_row[g]);
+        }
+
+        AggState* dst = &into.states[static_cast<size_t>(target) * num_aggregates];
+        AggState* src = &from.states[static_cast<size_t>(g) * num_aggregates];
+        for (size_t a = 0; a < num_aggregates; ++a) {
+            if (aggregates_[a].function == AggregationFunction::COUNT_DISTINCT) {
+                continue;   // Recounted from the merged value sets below
+            }
+            dst[a].count += src[a].count;
+            add_int(dst[a], src[a].sum_int);
+            dst[a].sum_double += src[a].sum_double;
+            dst[a].has_double = dst[a].has_double || src[a].has_double;
+            if (src[a].extreme != Tag::NUL) {
+                update_extreme(dst[a], extreme_datum(src[a]),
+                               aggregates_[a].function == AggregationFunction::MIN);
+            }
+        }
+    }
+
+    for (size_t a = 0; a < num_aggregates; ++a) {
+        const KeyTable& values = from.distinct[a];
+        for (uint32_t e = 0; e < values.size(); ++e) {
+            // Re-key the pair with the group id of the merged table
+            uint32_t group;
+            std::memcpy(&group, values.key_data(e), sizeof(group));
+            group = mapping[group];
+            into.distinct_key.assign(values.key_data(e), values.key_data(e) + values.key_size(e));
+            std::memcpy(into.distinct_key.data(), &group, sizeof(group));
+            bool fresh;
+            into.distinct[a].find_or_insert(
+                into.distinct_key.data(), into.distinct_key.size(),
+                hash_key(into.distinct_key.data(), into.distinct_key.size()), fresh);
+            if (fresh) {
+                into.states[static_cast<size_t>(group) * num_aggregates + a].count++;
+            }
+        }
+    }
+}
+
+void HashAggregator::finish(Partial& result) {
+    const size_t num_aggregates = aggregates_.size();
+    const size_t num_keys = key_inputs_.size();
+
+    // A global aggregate always yields one row
+    if (num_keys == 0 && result.groups.size() == 0) {
+        const uint8_t empty = 0;
+        bool inserted;
+        result.groups.find_or_insert(&empty, 0, hash_key(&empty, 0), inserted);
+        result.first_row.push_back(0);
+        result.states.resize(num_aggregates);
+    }
+
+    group_count_ = result.groups.size();
+    std::vector<uint32_t> order(group_count_);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return result.first_row[a] < result.first_row[b];
+    });
+
+    key_values_.clear();
+    key_values_.reserve(group_count_ * num_keys);
+    aggregate_values_.clear();
+    aggregate_values_.reserve(group_count_ * num_aggregates);
+    for (uint32_t group : order) {
+        const uint8_t* p = result.groups.key_data(group);
+        for (size_t k = 0; k < num_keys; ++k) {
+            key_values_.push_back(unpack(p));
+        }
+        const AggState* states = &result.states[static_cast<size_t>(group) * num_aggregates];
+        for (size_t a = 0; a < num_aggregates; ++a) {
+            aggregate_values_.push_back(final_value(aggregates_[a].function, states[a]));
+        }
+    }
+}
+
+} // namespace lyradb
@@ -0,0 +1,422 @@
+#include "lyradb/hash_join.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/vector_batch.h"
+#include "lyradb/table.h"
+#include "lyradb/column.h"
+#include "lyradb/config.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace lyradb {
+
+namespace {
+
+// Build-side bytes per row: partition entry, chain link and two head slots
+constexpr size_t kBuildBytesPerRow = 16 + 4 + 2 * 4;
+constexpr size_t kMaxPartitionBits = 12;
+
+// Comparison domain of one key column pair
+enum class KeyDomain { INT, DOUBLE, STRING };
+
+bool is_integer_type(DataType type) {
+    return type == DataType::INT32 || type == DataType::INT64 ||
+           type == DataType::DATE32 || type == DataType::TIMESTAMP ||
+           type == DataType::BOOL;
+}
+
+bool is_float_type(DataType type) {
+    return type == DataType::FLOAT32 || type == DataType::FLOAT64;
+}
+
+int64_t read_int(const Column& column, size_t row) {
+    switch (column.type()) {
+        case DataType::INT32:
+        case DataType::DATE32:
+            return column.data<int32_t>()[row];
+        case DataType::BOOL:
+            return column.data<uint8_t>()[row] != 0;
+        default:
+            return column.data<int64_t>()[row];
+    }
+}
+
+double read_double(const Column& column, size_t row) {
+    switch (column.type()) {
+        case DataType::FLOAT32:
+            return column.data<float>()[row];
+        case DataType::FLOAT64:
+            return column.data<double>()[row];
+        default:
+            return static_cast<double>(read_int(column, row));
+    }
+}
+
+uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t hash_bytes(const char* p, size_t n) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ n;
+    while (n >= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = (h ^ w) * 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+        p += 8;
+        n -= 8;
+    }
+    uint64_t w = 0;
+    std::memcpy(&w, p, n);
+    return mix(h ^ w);
+}
+
+/**
+ * @brief Position of one input row, scattered to its partition
+ */
+struct Entry {
+    uint64_t hash;
+    size_t pos;
+};
+
+} // namespace
+
+struct HashJoin::KeyColumn {
+    const Column* left;
+    const Column* right;
+    KeyDomain domain;
+};
+
+/**
+ * @brief One join input after partitioning
+ */
+struct HashJoin::Side {
+    bool is_left = false;
+    const std::vector<size_t>* rows = nullptr;
+    std::vector<Entry> entries;           // Grouped by partition, positions ascending
+    std::vector<size_t> bounds;           // Partition p spans [bounds[p], bounds[p+1])
+    std::vector<size_t> null_positions;   // Rows with a NULL key (never match)
+};
+
+HashJoin::HashJoin(const Table& left, std::vector<size_t> left_keys,
+                   const Table& right, std::vector<size_t> right_keys,
+                   JoinKind kind)
+    : left_(left), right_(right), kind_(kind) {
+    if (left_keys.empty() || left_keys.size() != right_keys.size()) {
+        throw std::runtime_error("Hash join needs matching, non-empty key lists");
+    }
+    for (size_t k = 0; k < left_keys.size(); ++k) {
+        KeyColumn key;
+        key.left = &left.column(left_keys[k]);
+        key.right = &right.column(right_keys[k]);
+        DataType lt = key.left->type();
+        DataType rt = key.right->type();
+        if (is_integer_type(lt) && is_integer_type(rt)) {
+            key.domain = KeyDomain::INT;
+        } else if ((is_integer_type(lt) || is_float_type(lt)) &&
+                   (is_integer_type(rt) || is_float_type(rt))) {
+            key.domain = KeyDomain::DOUBLE;
+        } else {
+            key.domain = KeyDomain::STRING;
+        }
+        keys_.push_back(key);
+    }
+}
+
+HashJoin::~HashJoin() = default;
+
+bool HashJoin::hash_row(bool left_side, size_t row, uint64_t& hash) const {
+    uint64_t h = 0;
+    for (const KeyColumn& key : keys_) {
+        const Column& column = left_side ? *key.left : *key.right;
+        if (column.is_null(row)) {
+            return false;
+        }
+        uint64_t key_hash;
+        switch (key.domain) {
+            case KeyDomain::INT:
+                key_hash = mix(static_cast<uint64_t>(read_int(column, row)));
+                break;
+            case KeyDomain::DOUBLE: {
+                double d = read_double(column, row);
+                d = d == 0.0 ? 0.0 : d;   // -0.0 == 0.0
+                uint64_t bits;
+                std::memcpy(&bits, &d, sizeof(bits));
+                key_hash = mix(bits);
+                break;
+            }
+            default:
+                if (column.is_fixed_width()) {
+                    std::string text = column.get_string(row);
+                    key_hash = hash_bytes(text.data(), text.size());
+                } else {
+                    const std::string& text = column.string_at(row);
+                    key_hash = hash_bytes(text.data(), text.size());
+                }
+                break;
+        }
+        h = mix(h ^ (key_hash + 0x9E3779B97F4A7C15ULL + (h << 6)));
+    }
+    hash = h;
+    return true;
+}
+
+bool HashJoin::keys_equal(size_t left_row, size_t right_row) const {
+    for (const KeyColumn& key : keys_) {
+        switch (key.domain) {
+            case KeyDomain::INT:
+                if (read_int(*key.left, left_row) != read_int(*key.right, right_row)) {
+                    return false;
+                }
+                break;
+            case KeyDomain::DOUBLE:
+                if (read_double(*key.left, left_row) != read_double(*key.right, right_row)) {
+                    return false;
+                }
+                break;
+            default:
+                if (!key.left->is_fixed_width() && !key.right->is_fixed_width()) {
+                    if (key.left->string_at(left_row) != key.right->string_at(right_row)) {
+                        return false;
+                    }
+                } else if (key.left->get_string(left_row) != key.right->get_string(right_row)) {
+                    return false;
+                }
+                break;
+        }
+    }
+    return true;
+}
+
+void HashJoin::partition(Side& side, size_t bits, QueryExecutor& executor) const {
+    const std::vector<size_t>& rows = *side.rows;
+    const size_t n = rows.size();
+    const size_t partitions = size_t{1} << bits;
+    auto partition_of = [bits](uint64_t hash) {
+        return bits == 0 ? size_t{0} : static_cast<size_t>(hash >> (64 - bits));
+    };
+
+    // Pass 1: hash every row and count rows per (morsel, partition)
+    std::vector<uint64_t> hashes(n);
+    std::vector<uint8_t> valid(n);
+    auto morsels = executor.make_morsels({RowRange{0, n}});
+    std::vector<size_t> histogram(morsels.size() * partitions, 0);
+    executor.run_morsels(morsels.size(), [&](size_t m, size_t) {
+        size_t* counts = &histogram[m * partitions];
+        for (size_t pos = morsels[m].begin; pos < morsels[m].end; ++pos) {
+            uint64_t hash = 0;
+            bool ok = rows[pos] != kNoMatch && hash_row(side.is_left, rows[pos], hash);
+            valid[pos] = ok;
+            hashes[pos] = hash;
+            if (ok) {
+                counts[partition_of(hash)]++;
+            }
+        }
+    });
+
+    // Scatter offsets: partition-major, morsel order within a partition
+    side.bounds.assign(partitions + 1, 0);
+    size_t total = 0;
+    for (size_t p = 0; p < partitions; ++p) {
+        side.bounds[p] = total;
+        for (size_t m = 0; m < morsels.size(); ++m) {
+            size_t count = histogram[m * partitions + p];
+            histogram[m * partitions + p] = total;
+            total += count;
+        }
+    }
+    side.bounds[partitions] = total;
+
+    // Pass 2: stable scatter, so each partition keeps ascending positions
+    side.entries.resize(total);
+    executor.run_morsels(morsels.size(), [&](size_t m, size_t) {
+        size_t* offsets = &histogram[m * partitions];
+        for (size_t pos = morsels[m].begin; pos < morsels[m].end; ++pos) {
+            if (valid[pos]) {
+                side.entries[offsets[partition_of(hashes[pos])]++] = Entry{hashes[pos], pos};
+            }
+        }
+    });
+
+    side.null_positions.clear();
+    for (size_t pos = 0; pos < n; ++pos) {
+        if (!valid[pos]) {
+            side.null_positions.push_back(pos);
+        }
+    }
+}
+
+size_t HashJoin::execute(const std::vector<size_t>& left_rows,
+                         const std::vector<size_t>& right_rows,
+                         QueryExecutor& executor,
+                         JoinOutput& output) {
+    output.left.clear();
+    output.right.clear();
+
+    Side left;
+    left.is_left = true;
+    left.rows = &left_rows;
+    Side right;
+    right.rows = &right_rows;
+
+    // Build on the smaller input, sized so a partition fits in cache
+    build_left_ = left_rows.size() < right_rows.size();
+    size_t build_rows = build_left_ ? left_rows.size() : right_rows.size();
+    size_t bits = 0;
+    while (bits < kMaxPartitionBits &&
+           (build_rows * kBuildBytesPerRow >> bits) > LYRADB_JOIN_PARTITION_SIZE) {
+        ++bits;
+    }
+    partition_count_ = size_t{1} << bits;
+    partition(left, bits, executor);
+    partition(right, bits, executor);
+
+    const Side& build = build_left_ ? left : right;
+    const Side& probe = build_left_ ? right : left;
+    const bool pairs = kind_ == JoinKind::INNER || kind_ == JoinKind::LEFT;
+    const bool track_matches = build_left_ && kind_ != JoinKind::INNER;
+
+    // Per partition: (left, right) pairs, or left positions for SEMI/ANTI
+    std::vector<std::vector<size_t>> out_left(partition_count_);
+    std::vector<std::vector<size_t>> out_right(partition_count_);
+
+    executor.run_morsels(partition_count_, [&](size_t p, size_t) {
+        const Entry* build_entries = build.entries.data() + build.bounds[p];
+        const size_t build_count = build.bounds[p + 1] - build.bounds[p];
+        const Entry* probe_entries = probe.entries.data() + probe.bounds[p];
+        const size_t probe_count = probe.bounds[p + 1] - probe.bounds[p];
+        auto& lefts = out_left[p];
+        auto& rights = out_right[p];
+
+        // Chained table; links are inserted back to front so every chain
+        // visits build rows in ascending position order
+        size_t capacity = 16;
+        while (capacity < build_count * 2) {
+            capacity <<= 1;
+        }
+        const size_t mask = capacity - 1;
+        std::vector<uint32_t> heads(capacity, 0);
+        std::vector<uint32_t> next(build_count);
+        for (size_t i = build_count; i-- > 0;) {
+            size_t slot = build_entries[i].hash & mask;
+            next[i] = heads[slot];
+            heads[slot] = static_cast<uint32_t>(i + 1);
+        }
+        std::vector<uint8_t> matched(track_matches ? build_count : 0, 0);
+
+        for (size_t q = 0; q < probe_count; ++q) {
+            const Entry& probe_entry = probe_entries[q];
+            const size_t probe_row = (*probe.rows)[probe_entry.pos];
+            bool found = false;
+            for (uint32_t link = heads[probe_entry.hash & mask]; link != 0; link = next[link - 1]) {
+                const Entry& build_entry = build_entries[link - 1];
+                if (build_entry.hash != probe_entry.hash) {
+                    continue;
+                }
+                const size_t build_row = (*build.rows)[build_entry.pos];
+                if (!(build_left_ ? keys_equal(build_row, probe_row)
+                                  : keys_equal(probe_row, build_row))) {
+                    continue;
+                }
+                found = true;
+                if (track_matches) {
+                    matched[link - 1] = 1;
+                }
+                if (pairs) {
+                    lefts.push_back(build_left_ ? build_entry.pos : probe_entry.pos);
+                    rights.push_back(build_left_ ? probe_entry.pos : build_entry.pos);
+                } else if (!build_left_) {
+                    break;   // SEMI/ANTI only need to know about one match
+                }
+            }
+            if (!build_left_) {
+                if (kind_ == JoinKind::LEFT && !found) {
+                    lefts.push_back(probe_entry.pos);
+                    rights.push_back(kNoMatch);
+                } else if ((kind_ == JoinKind::SEMI && found) ||
+                           (kind_ == JoinKind::ANTI && !found)) {
+                    lefts.push_back(probe_entry.pos);
+                }
+            }
+        }
+
+        if (track_matches) {
+            for (size_t i = 0; i < build_count; ++i) {
+                bool keep = kind_ == JoinKind::SEMI ? matched[i] != 0 : matched[i] == 0;
+                if (keep) {
+                    lefts.push_back(build_entries[i].pos);
+                    if (kind_ == JoinKind::LEFT) {
+                        rights.push_back(kNoMatch);
+                    }
+                }
+            }
+        }
+    });
+
+    // Left rows with NULL keys never match
+    std::vector<size_t> null_left;
+    if (kind_ == JoinKind::LEFT || kind_ == JoinKind::ANTI) {
+        null_left = left.null_positions;
+    }
+
+    if (!pairs) {
+        // SEMI/ANTI: each left position at most once, ascending
+        std::vector<uint8_t> keep(left_rows.size(), 0);
+        for (const auto& lefts : out_left) {
+            for (size_t pos : lefts) {
+                keep[pos] = 1;
+            }
+        }
+        for (size_t pos : null_left) {
+            keep[pos] = 1;
+        }
+        for (size_t pos = 0; pos < keep.size(); ++pos) {
+            if (keep[pos]) {
+                output.left.push_back(pos);
+            }
+        }
+        return output.left.size();
+    }
+
+    // Counting sort by left position. All pairs of one left row come from
+    // the same partition in ascending right order, so the sort is stable
+    // and the result matches a nested loop over left then right.
+    std::vector<size_t> start(left_rows.size() + 1, 0);
+    for (const auto& lefts : out_left) {
+        for (size_t pos : lefts) {
+            start[pos + 1]++;
+        }
+    }
+    for (size_t pos : null_left) {
+        start[pos + 1]++;
+    }
+    for (size_t i = 1; i < start.size(); ++i) {
+        start[i] += start[i - 1];
+    }
+    output.left.resize(start.back());
+    output.right.resize(start.back());
+    for (size_t p = 0; p < partition_count_; ++p) {
+        for (size_t i = 0; i < out_left[p].size(); ++i) {
+            size_t at = start[out_left[p][i]]++;
+            output.left[at] = out_left[p][i];
+            output.right[at] = out_right[p][i];
+        }
+        std::vector<size_t>().swap(out_left[p]);
+        std::vector<size_t>().swap(out_right[p]);
+    }
+    for (size_t pos : null_left) {
+        size_t at = start[pos]++;
+        output.left[at] = pos;
+        output.right[at] = kNoMatch;
+    }
+    return output.left.size();
+}
+
+} // namespace lyradb
@@ -4,6 +4,11 @@
 #include "lyradb/database.h"
 #include "lyradb/table.h"
 #include "lyradb/column.h"
+#include "lyradb/expression_evaluator.h"
+#include "lyradb/vector_batch.h"
+#include "lyradb/simd_kernels.h"
+#include "lyradb/task_scheduler.h"
+#include "lyradb/config.h"
 #include "lyradb/composite_query_optimizer.h"
 #include "lyradb/simple_query_optimizer.h"
 #include <algorithm>
@@ -18,7 +23,9 @@ namespace lyradb {
 
 QueryExecutor::QueryExecutor(Database* database)
     : batch_size_(1024), simd_enabled_(true), 
-      rows_processed_(0), batches_processed_(0), database_(database) {
+      rows_processed_(0), batches_processed_(0), rows_pruned_(0),
+      parallelism_(0), morsel_size_(LYRADB_DEFAULT_MORSEL_SIZE),
+      scheduler_(&TaskScheduler::global()), database_(database) {
 }
 
 QueryExecutor::~QueryExecutor() {
@@ -37,6 +44,111 @@ void QueryExecutor::execute(const QueryPlan& plan) {
     batches_processed_++;
 }
 
+size_t QueryExecutor::filter_table(const Table& table,
+                                   const query::Expression* predicate,
+                                   std::vector<size_t>& row_ids) {
+    row_ids.clear();
+    size_t num_rows = table.row_count();
+    
+    // Zone maps drop whole pages the predicate cannot match; they cover
+    // the stored row groups only, so the delta store's rows stay candidates
+    std::vector<RowRange> ranges;
+    if (predicate) {
+        ExpressionEvaluator evaluator;
+        evaluator.candidate_ranges(predicate, table, ranges);
+    } else {
+        ranges.push_back(RowRange{0, num_rows});
+    }
+    std::vector<RowRange> morsels = make_morsels(ranges);
+    // Deleted rows still occupy their row ids; the scan skips them
+    const bool has_deletes = table.deleted_count() > 0;
+    // Only row ids come out, so batches bind just the predicate's columns
+    const std::vector<bool> bind = referenced_columns(predicate, table);
+    
+    // One evaluator per thread: compiled plans keep per-batch scratch state
+    std::vector<ExpressionEvaluator> evaluators(parallelism());
+    std::vector<std::vector<size_t>> matches(morsels.size());
+    
+    run_morsels(morsels.size(), [&](size_t m, size_t slot) {
+        const RowRange& morsel = morsels[m];
+        SelectionVector selection;
+        // Batches end at row group boundaries as well
+        for (size_t start = morsel.begin; start < morsel.end;) {
+            VectorBatch batch = VectorBatch::scan_table(table, start,
+                                                        std::min(batch_size_, morsel.end - start),
+                                                        &bind);
+            select_all(selection, batch.size);
+            
+            if (predicate) {
+                simd_filter(evaluators[slot], batch, predicate, selection);
+            }
+            for (uint32_t r : selection) {
+                if (!has_deletes || !table.is_deleted(start + r)) {
+                    matches[m].push_back(start + r);
+                }
+            }
+            start += batch.size;
+        }
+    });
+    
+    // Morsels are in row order, so concatenation keeps row_ids ascending
+    size_t scanned = 0;
+    size_t total = 0;
+    for (size_t m = 0; m < morsels.size(); ++m) {
+        size_t rows = morsels[m].end - morsels[m].begin;
+        scanned += rows;
+        batches_processed_ += (rows + batch_size_ - 1) / batch_size_;
+        total += matches[m].size();
+    }
+    row_ids.reserve(total);
+    for (const auto& part : matches) {
+        row_ids.insert(row_ids.end(), part.begin(), part.end());
+    }
+    rows_processed_ += scanned;
+    rows_pruned_ += num_rows - scanned;
+    
+    return row_ids.size();
+}
+
+void QueryExecutor::materialize_rows(const Table& table,
+                                     const std::vector<size_t>& row_ids,
+                                     std::vector<std::vector<std::string>>& rows) {
+    rows.clear();
+    rows.resize(row_ids.size());
+    std::vector<RowRange> morsels = make_morsels({RowRange{0, row_ids.size()}});
+    run_morsels(morsels.size(), [&](size_t m, size_t) {
+        for (size_t i = morsels[m].begin; i < morsels[m].end; ++i) {
+            rows[i] = table.get_row(row_ids[i]);
+        }
+    });
+}
+
+std::vector<RowRange> QueryExecutor::make_morsels(const std::vector<RowRange>& ranges) const {
+    return split_morsels(ranges, morsel_size_);
+}
+
+void QueryExecutor::run_morsels(size_t num_morsels,
+                                const std::function<void(size_t morsel, size_t slot)>& fn) {
+    scheduler_->parallel_for(num_morsels, parallelism(), fn);
+}
+
+void QueryExecutor::set_parallelism(size_t dop) {
+    parallelism_ = dop;
+}
+
+size_t QueryExecutor::parallelism() const {
+    size_t available = scheduler_->max_parallelism();
+    return parallelism_ == 0 ? available : std::min(parallelism_, available);
+}
+
+void QueryExecutor::set_morsel_size(size_t rows) {
+    morsel_size_ = std::max(rows, size_t(1));
+}
+
+void QueryExecutor::set_scheduler(TaskScheduler* scheduler) {
+    scheduler_ = scheduler ? scheduler : &TaskScheduler::global();
+}
+
 void QueryExecutor::set_batch_size(size_t size) {
     batch_size_ = std::max(size_t(64), std::min(size, size_t(8192)));
 }
@@ -50,8 +162,12 @@ std::string QueryExecutor::get_stats() const {
     stats += "Query Executor Statistics:\n";
     stats += "  Rows Processed: " + std::to_string(rows_processed_) + "\n";
     stats += "  Batches Processed: " + std::to_string(batches_processed_) + "\n";
+    stats += "  Rows Pruned (zone maps): " + std::to_string(rows_pruned_) + "\n";
     stats += "  Batch Size: " + std::to_string(batch_size_) + "\n";
+    stats += "  Parallelism: " + std::to_string(parallelism()) + "\n";
     stats += "  SIMD Enabled: " + std::string(simd_enabled_ ? "Yes" : "No") + "\n";
+    stats += "  Instruction Set: " + std::string(simd::instruction_set_name(
+        simd_enabled_ ? simd::detect_instruction_set() : simd::InstructionSet::SCALAR)) + "\n";
     
     if (batches_processed_ > 0) {
         double avg_batch_size = static_cast<double>(rows_processed_) / batches_processed_;
@@ -838,27 +954,15 @@ size_t QueryExecutor::execute_limit(const plan::PlanNode* node, ExecutionContext
     return output_rows;
 }
 
-std::vector<std::vector<uint8_t>> QueryExecutor::simd_filter(
-    const std::vector<std::vector<uint8_t>>& data,
-    const std::string& predicate) {
-    
-    // SIMD-optimized filter implementation
-    // Processes 8-16 rows at a time using SIMD instructions
-    
-    std::vector<std::vector<uint8_t>> result;
-    
-    // TODO: Implement SIMD filtering
-    // - Parse predicate (e.g., "column > 100")
-    // - Load 8-16 rows into SIMD register
-    // - Execute comparison in parallel
-    // - Store matching rows to result
-    
-    for (const auto& row : data) {
-        // Placeholder: return all rows
-        result.push_back(row);
-    }
-    
-    return result;
+size_t QueryExecutor::simd_filter(ExpressionEvaluator& evaluator,
+                                  const VectorBatch& batch,
+                                  const query::Expression* predicate,
+                                  std::vector<uint32_t>& selection) {
+    // The kernels themselves are chosen per call; the evaluator only needs
+    // to know the widest instruction set it may use
+    evaluator.set_instruction_set(simd_enabled_ ? simd::detect_instruction_set()
+                                                : simd::InstructionSet::SCALAR);
+    return evaluator.filter_batch(predicate, batch, selection);
 }
 
 std::vector<std::vector<uint8_t>> QueryExecutor::vectorized_sort(
@@ -0,0 +1,480 @@
+#include "lyradb/simd_kernels.h"
+#include "lyradb/config.h"
+#include <algorithm>
+#include <stdexcept>
+
+#if LYRADB_ENABLE_SIMD && (defined(__x86_64__) || defined(_M_X64))
+#define LYRADB_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define LYRADB_SIMD_X86 0
+#endif
+
+// Kernels are compiled for their instruction set with function attributes so
+// the rest of the library keeps the baseline target; MSVC needs no attribute
+// to use AVX intrinsics.
+#if defined(__GNUC__) || defined(__clang__)
+#define LYRADB_ALWAYS_INLINE inline __attribute__((always_inline))
+#define LYRADB_AVX2_INLINE inline __attribute__((always_inline, target("avx2")))
+#define LYRADB_AVX512_INLINE inline __attribute__((always_inline, target("avx512f")))
+#define LYRADB_TARGET_AVX2 __attribute__((target("avx2")))
+#define LYRADB_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define LYRADB_ALWAYS_INLINE __forceinline
+#define LYRADB_AVX2_INLINE __forceinline
+#define LYRADB_AVX512_INLINE __forceinline
+#define LYRADB_TARGET_AVX2
+#define LYRADB_TARGET_AVX512
+#endif
+
+namespace lyradb {
+namespace simd {
+
+namespace {
+
+// ============================================================================
+// CPU feature detection
+// ============================================================================
+
+InstructionSet probe_instruction_set() {
+#if LYRADB_SIMD_X86
+    uint32_t ecx1 = 0;
+    uint32_t ebx7 = 0;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return InstructionSet::SCALAR;
+    }
+    __cpuid(info, 1);
+    ecx1 = static_cast<uint32_t>(info[2]);
+    __cpuidex(info, 7, 0);
+    ebx7 = static_cast<uint32_t>(info[1]);
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, nullptr) < 7 || !__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return InstructionSet::SCALAR;
+    }
+    ecx1 = ecx;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    ebx7 = ebx;
+#endif
+
+    // AVX needs OS support for saving YMM state (OSXSAVE + XCR0 bits 1-2)
+    const bool osxsave = (ecx1 & (1u << 27)) != 0;
+    const bool avx = (ecx1 & (1u << 28)) != 0;
+    if (!osxsave || !avx) {
+        return InstructionSet::SCALAR;
+    }
+
+#if defined(_MSC_VER)
+    uint64_t xcr0 = _xgetbv(0);
+#else
+    uint32_t xcr0_lo, xcr0_hi;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    uint64_t xcr0 = (static_cast<uint64_t>(xcr0_hi) << 32) | xcr0_lo;
+#endif
+    if ((xcr0 & 0x6) != 0x6) {
+        return InstructionSet::SCALAR;
+    }
+
+    const bool avx2 = (ebx7 & (1u << 5)) != 0;
+    const bool avx512f = (ebx7 & (1u << 16)) != 0;
+    // AVX-512 additionally needs opmask and ZMM state enabled (XCR0 bits 5-7)
+    if (avx512f && (xcr0 & 0xE6) == 0xE6) {
+        return InstructionSet::AVX512;
+    }
+    if (avx2) {
+        return InstructionSet::AVX2;
+    }
+#endif
+    return InstructionSet::SCALAR;
+}
+
+// ============================================================================
+// Scalar kernels (also used for tails shorter than one mask word)
+// ============================================================================
+
+template <CompareOp OP, typename T>
+LYRADB_ALWAYS_INLINE bool test(T v, T lo, T hi) {
+    if constexpr (OP == CompareOp::EQ) return v == lo;
+    if constexpr (OP == CompareOp::NE) return v != lo;
+    if constexpr (OP == CompareOp::LT) return v < lo;
+    if constexpr (OP == CompareOp::LE) return v <= lo;
+    if constexpr (OP == CompareOp::GT) return v > lo;
+    if constexpr (OP == CompareOp::GE) return v >= lo;
+    return lo <= v && v <= hi;
+}
+
+template <CompareOp OP, bool kColumns, typename T>
+LYRADB_ALWAYS_INLINE uint64_t scalar_word(const T* left, const T* right, T lo, T hi, size_t count) {
+    uint64_t bits = 0;
+    for (size_t j = 0; j < count; ++j) {
+        bool match = test<OP>(left[j], kColumns ? right[j] : lo, hi);
+        bits |= static_cast<uint64_t>(match) << j;
+    }
+    return bits;
+}
+
+template <CompareOp OP, bool kColumns, typename T>
+void scalar_kernel(const T* left, const T* right, T lo, T hi, size_t n, uint64_t* mask) {
+    for (size_t base = 0, w = 0; base < n; base += 64, ++w) {
+        size_t count = std::min<size_t>(64, n - base);
+        mask[w] = scalar_word<OP, kColumns>(left + base, kColumns ? right + base : nullptr,
+                                            lo, hi, count);
+    }
+}
+
+template <bool kColumns, typename T>
+void scalar_dispatch(const T* left, const T* right, T lo, T hi,
+                     size_t n, CompareOp op, uint64_t* mask) {
+    switch (op) {
+        case CompareOp::EQ: scalar_kernel<CompareOp::EQ, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::NE: scalar_kernel<CompareOp::NE, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::LT: scalar_kernel<CompareOp::LT, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::LE: scalar_kernel<CompareOp::LE, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::GT: scalar_kernel<CompareOp::GT, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::GE: scalar_kernel<CompareOp::GE, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::BETWEEN: scalar_kernel<CompareOp::BETWEEN, false>(left, right, lo, hi, n, mask); break;
+    }
+}
+
+#if LYRADB_SIMD_X86
+
+// ============================================================================
+// AVX2 lane traits
+// ============================================================================
+
+struct Avx2Int32 {
+    static constexpr size_t kLanes = 8;
+    static LYRADB_AVX2_INLINE __m256i load(const int32_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    static LYRADB_AVX2_INLINE __m256i broadcast(int32_t v) { return _mm256_set1_epi32(v); }
+    static LYRADB_AVX2_INLINE uint64_t bits(__m256i m) {
+        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+    }
+    template <CompareOp OP>
+    static LYRADB_AVX2_INLINE uint64_t cmp(__m256i a, __m256i b) {
+        constexpr uint64_t kAll = 0xFF;
+        if constexpr (OP == CompareOp::EQ) return bits(_mm256_cmpeq_epi32(a, b));
+        if constexpr (OP == CompareOp::NE) return ~bits(_mm256_cmpeq_epi32(a, b)) & kAll;
+        if constexpr (OP == CompareOp::LT) return bits(_mm256_cmpgt_epi32(b, a));
+        if constexpr (OP == CompareOp::LE) return ~bits(_mm256_cmpgt_epi32(a, b)) & kAll;
+        if constexpr (OP == CompareOp::GT) return bits(_mm256_cmpgt_epi32(a, b));
+        return ~bits(_mm256_cmpgt_epi32(b, a)) & kAll;
+    }
+};
+
+struct Avx2Int64 {
+    static constexpr size_t kLanes = 4;
+    static LYRADB_AVX2_INLINE __m256i load(const int64_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    static LYRADB_AVX2_INLINE __m256i broadcast(int64_t v) { return _mm256_set1_epi64x(v); }
+    static LYRADB_AVX2_INLINE uint64_t bits(__m256i m) {
+        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+    }
+    template <CompareOp OP>
+    static LYRADB_AVX2_INLINE uint64_t cmp(__m256i a, __m256i b) {
+        constexpr uint64_t kAll = 0xF;
+        if constexpr (OP == CompareOp::EQ) return bits(_mm256_cmpeq_epi64(a, b));
+        if constexpr (OP == CompareOp::NE) return ~bits(_mm256_cmpeq_epi64(a, b)) & kAll;
+        if constexpr (OP == CompareOp::LT) return bits(_mm256_cmpgt_epi64(b, a));
+        if constexpr (OP == CompareOp::LE) return ~bits(_mm256_cmpgt_epi64(a, b)) & kAll;
+        if constexpr (OP == CompareOp::GT) return bits(_mm256_cmpgt_epi64(a, b));
+        return ~bits(_mm256_cmpgt_epi64(b, a)) & kAll;
+    }
+};
+
+// Floating point predicates are ordered (false on NaN) except NE, which
+// matches the scalar `!=` (true on NaN)
+struct Avx2Float {
+    static constexpr size_t kLanes = 8;
+    static LYRADB_AVX2_INLINE __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+    static LYRADB_AVX2_INLINE __m256 broadcast(float v) { return _mm256_set1_ps(v); }
+    template <CompareOp OP>
+    static LYRADB_AVX2_INLINE uint64_t cmp(__m256 a, __m256 b) {
+        constexpr int kPredicate =
+            OP == CompareOp::EQ ? _CMP_EQ_OQ :
+            OP == CompareOp::NE ? _CMP_NEQ_UQ :
+            OP == CompareOp::LT ? _CMP_LT_OQ :
+            OP == CompareOp::LE ? _CMP_LE_OQ :
+            OP == CompareOp::GT ? _CMP_GT_OQ : _CMP_GE_OQ;
+        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, kPredicate)));
+    }
+};
+
+struct Avx2Double {
+    static constexpr size_t kLanes = 4;
+    static LYRADB_AVX2_INLINE __m256d load(const double* p) { return _mm256_loadu_pd(p); }
+    static LYRADB_AVX2_INLINE __m256d broadcast(double v) { return _mm256_set1_pd(v); }
+    template <CompareOp OP>
+    static LYRADB_AVX2_INLINE uint64_t cmp(__m256d a, __m256d b) {
+        constexpr int kPredicate =
+            OP == CompareOp::EQ ? _CMP_EQ_OQ :
+            OP == CompareOp::NE ? _CMP_NEQ_UQ :
+            OP == CompareOp::LT ? _CMP_LT_OQ :
+            OP == CompareOp::LE ? _CMP_LE_OQ :
+            OP == CompareOp::GT ? _CMP_GT_OQ : _CMP_GE_OQ;
+        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, kPredicate)));
+    }
+};
+
+// ============================================================================
+// AVX-512 lane traits (comparisons write opmask registers directly)
+// ============================================================================
+
+template <CompareOp OP>
+constexpr int int_predicate() {
+    return OP == CompareOp::EQ ? _MM_CMPINT_EQ :
+           OP == CompareOp::NE ? _MM_CMPINT_NE :
+           OP == CompareOp::LT ? _MM_CMPINT_LT :
+           OP == CompareOp::LE ? _MM_CMPINT_LE :
+           OP == CompareOp::GT ? _MM_CMPINT_NLE : _MM_CMPINT_NLT;
+}
+
+template <CompareOp OP>
+constexpr int float_predicate() {
+    return OP == CompareOp::EQ ? _CMP_EQ_OQ :
+           OP == CompareOp::NE ? _CMP_NEQ_UQ :
+           OP == CompareOp::LT ? _CMP_LT_OQ :
+           OP == CompareOp::LE ? _CMP_LE_OQ :
+           OP == CompareOp::GT ? _CMP_GT_OQ : _CMP_GE_OQ;
+}
+
+struct Avx512Int32 {
+    static constexpr size_t kLanes = 16;
+    static LYRADB_AVX512_INLINE __m512i load(const int32_t* p) { return _mm512_loadu_si512(p); }
+    static LYRADB_AVX512_INLINE __m512i broadcast(int32_t v) { return _mm512_set1_epi32(v); }
+    template <CompareOp OP>
+    static LYRADB_AVX512_INLINE uint64_t cmp(__m512i a, __m512i b) {
+        return _mm512_cmp_epi32_mask(a, b, int_predicate<OP>());
+    }
+};
+
+struct Avx512Int64 {
+    static constexpr size_t kLanes = 8;
+    static LYRADB_AVX512_INLINE __m512i load(const int64_t* p) { return _mm512_loadu_si512(p); }
+    static LYRADB_AVX512_INLINE __m512i broadcast(int64_t v) { return _mm512_set1_epi64(v); }
+    template <CompareOp OP>
+    static LYRADB_AVX512_INLINE uint64_t cmp(__m512i a, __m512i b) {
+        return _mm512_cmp_epi64_mask(a, b, int_predicate<OP>());
+    }
+};
+
+struct Avx512Float {
+    static constexpr size_t kLanes = 16;
+    static LYRADB_AVX512_INLINE __m512 load(const float* p) { return _mm512_loadu_ps(p); }
+    static LYRADB_AVX512_INLINE __m512 broadcast(float v) { return _mm512_set1_ps(v); }
+    template <CompareOp OP>
+    static LYRADB_AVX512_INLINE uint64_t cmp(__m512 a, __m512 b) {
+        return _mm512_cmp_ps_mask(a, b, float_predicate<OP>());
+    }
+};
+
+struct Avx512Double {
+    static constexpr size_t kLanes = 8;
+    static LYRADB_AVX512_INLINE __m512d load(const double* p) { return _mm512_loadu_pd(p); }
+    static LYRADB_AVX512_INLINE __m512d broadcast(double v) { return _mm512_set1_pd(v); }
+    template <CompareOp OP>
+    static LYRADB_AVX512_INLINE uint64_t cmp(__m512d a, __m512d b) {
+        return _mm512_cmp_pd_mask(a, b, float_predicate<OP>());
+    }
+};
+
+// ============================================================================
+// Vector kernel driver
+//
+// K supplies load/broadcast and cmp<OP>() returning one bit per lane; each
+// 64-row mask word is assembled from 64 / K::kLanes vector comparisons.
+// GCC and Clang only inline target-specific intrinsics into functions built
+// for that target, so the driver is stamped out once per instruction set.
+// ============================================================================
+
+#define LYRADB_DEFINE_VECTOR_DRIVER(NAME, TARGET)                                          \
+    struct NAME {                                                                          \
+        template <typename K, CompareOp OP, bool kColumns, typename T>                     \
+        TARGET static void run(const T* left, const T* right, T lo, T hi,                  \
+                               size_t n, uint64_t* mask) {                                 \
+            const auto vlo = K::broadcast(lo);                                             \
+            const auto vhi = K::broadcast(hi);                                             \
+            const size_t full_words = n / 64;                                              \
+            for (size_t w = 0; w < full_words; ++w) {                                      \
+                const T* a = left + w * 64;                                                \
+                uint64_t bits = 0;                                                         \
+                for (size_t j = 0; j < 64; j += K::kLanes) {                               \
+                    const auto v = K::load(a + j);                                         \
+                    uint64_t m;                                                            \
+                    if constexpr (OP == CompareOp::BETWEEN) {                              \
+                        m = K::template cmp<CompareOp::GE>(v, vlo) &                       \
+                            K::template cmp<CompareOp::LE>(v, vhi);                        \
+                    } else if constexpr (kColumns) {                                       \
+                        m = K::template cmp<OP>(v, K::load(right + w * 64 + j));           \
+                    } else {                                                               \
+                        m = K::template cmp<OP>(v, vlo);                                   \
+                    }                                                                      \
+                    bits |= m << j;                                                        \
+                }                                                                          \
+                mask[w] = bits;                                                            \
+            }                                                                              \
+            const size_t tail = n % 64;                                                    \
+            if (tail != 0) {                                                               \
+                const size_t base = full_words * 64;                                       \
+                mask[full_words] = scalar_word<OP, kColumns>(                              \
+                    left + base, kColumns ? right + base : nullptr, lo, hi, tail);         \
+            }                                                                              \
+        }                                                                                  \
+    };
+
+LYRADB_DEFINE_VECTOR_DRIVER(Avx2Driver, LYRADB_TARGET_AVX2)
+LYRADB_DEFINE_VECTOR_DRIVER(Avx512Driver, LYRADB_TARGET_AVX512)
+
+#undef LYRADB_DEFINE_VECTOR_DRIVER
+
+// Lane traits per value type
+template <typename T> struct Avx2Lanes;
+template <> struct Avx2Lanes<int32_t> { using type = Avx2Int32; };
+template <> struct Avx2Lanes<int64_t> { using type = Avx2Int64; };
+template <> struct Avx2Lanes<float> { using type = Avx2Float; };
+template <> struct Avx2Lanes<double> { using type = Avx2Double; };
+
+template <typename T> struct Avx512Lanes;
+template <> struct Avx512Lanes<int32_t> { using type = Avx512Int32; };
+template <> struct Avx512Lanes<int64_t> { using type = Avx512Int64; };
+template <> struct Avx512Lanes<float> { using type = Avx512Float; };
+template <> struct Avx512Lanes<double> { using type = Avx512Double; };
+
+template <typename Driver, typename K, bool kColumns, typename T>
+void vector_dispatch(const T* left, const T* right, T lo, T hi,
+                     size_t n, CompareOp op, uint64_t* mask) {
+    switch (op) {
+        case CompareOp::EQ: Driver::template run<K, CompareOp::EQ, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::NE: Driver::template run<K, CompareOp::NE, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::LT: Driver::template run<K, CompareOp::LT, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::LE: Driver::template run<K, CompareOp::LE, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::GT: Driver::template run<K, CompareOp::GT, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::GE: Driver::template run<K, CompareOp::GE, kColumns>(left, right, lo, hi, n, mask); break;
+        case CompareOp::BETWEEN: Driver::template run<K, CompareOp::BETWEEN, false>(left, right, lo, hi, n, mask); break;
+    }
+}
+
+#endif  // LYRADB_SIMD_X86
+
+template <bool kColumns, typename T>
+void run_compare(const T* left, const T* right, T lo, T hi, size_t n, CompareOp op,
+                 uint64_t* mask, InstructionSet isa) {
+    if (n == 0) {
+        return;
+    }
+    // Never run a kernel the CPU cannot execute
+    isa = std::min(isa, detect_instruction_set());
+#if LYRADB_SIMD_X86
+    if (isa == InstructionSet::AVX512) {
+        using K = typename Avx512Lanes<T>::type;
+        vector_dispatch<Avx512Driver, K, kColumns>(left, right, lo, hi, n, op, mask);
+        return;
+    }
+    if (isa == InstructionSet::AVX2) {
+        using K = typename Avx2Lanes<T>::type;
+        vector_dispatch<Avx2Driver, K, kColumns>(left, right, lo, hi, n, op, mask);
+        return;
+    }
+#endif
+    scalar_dispatch<kColumns>(left, right, lo, hi, n, op, mask);
+}
+
+template <typename T>
+void run_compare_columns(const T* left, const T* right, size_t n, CompareOp op,
+                         uint64_t* mask, InstructionSet isa) {
+    if (op == CompareOp::BETWEEN) {
+        throw std::invalid_argument("BETWEEN is not a column-to-column comparison");
+    }
+    run_compare<true>(left, right, T(), T(), n, op, mask, isa);
+}
+
+inline unsigned count_trailing_zeros(uint64_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(bits));
+#endif
+}
+
+}  // namespace
+
+InstructionSet detect_instruction_set() {
+    static const InstructionSet detected = probe_instruction_set();
+    return detected;
+}
+
+const char* instruction_set_name(InstructionSet isa) {
+    switch (isa) {
+        case InstructionSet::AVX512: return "AVX-512";
+        case InstructionSet::AVX2: return "AVX2";
+        default: return "Scalar";
+    }
+}
+
+void compare(const int32_t* values, size_t n, CompareOp op, int32_t lo, int32_t hi,
+             uint64_t* mask, InstructionSet isa) {
+    run_compare<false>(values, static_cast<const int32_t*>(nullptr), lo, hi, n, op, mask, isa);
+}
+
+void compare(const int64_t* values, size_t n, CompareOp op, int64_t lo, int64_t hi,
+             uint64_t* mask, InstructionSet isa) {
+    run_compare<false>(values, static_cast<const int64_t*>(nullptr), lo, hi, n, op, mask, isa);
+}
+
+void compare(const float* values, size_t n, CompareOp op, float lo, float hi,
+             uint64_t* mask, InstructionSet isa) {
+    run_compare<false>(values, static_cast<const float*>(nullptr), lo, hi, n, op, mask, isa);
+}
+
+void compare(const double* values, size_t n, CompareOp op, double lo, double hi,
+             uint64_t* mask, InstructionSet isa) {
+    run_compare<false>(values, static_cast<const double*>(nullptr), lo, hi, n, op, mask, isa);
+}
+
+void compare_columns(const int32_t* left, const int32_t* right, size_t n, CompareOp op,
+                     uint64_t* mask, InstructionSet isa) {
+    run_compare_columns(left, right, n, op, mask, isa);
+}
+
+void compare_columns(const int64_t* left, const int64_t* right, size_t n, CompareOp op,
+                     uint64_t* mask, InstructionSet isa) {
+    run_compare_columns(left, right, n, op, mask, isa);
+}
+
+void compare_columns(const float* left, const float* right, size_t n, CompareOp op,
+                     uint64_t* mask, InstructionSet isa) {
+    run_compare_columns(left, right, n, op, mask, isa);
+}
+
+void compare_columns(const double* left, const double* right, size_t n, CompareOp op,
+                     uint64_t* mask, InstructionSet isa) {
+    run_compare_columns(left, right, n, op, mask, isa);
+}
+
+size_t mask_to_selection(const uint64_t* mask, size_t n, uint32_t* out) {
+    size_t count = 0;
+    for (size_t w = 0; w < mask_words(n); ++w) {
+        uint64_t bits = mask[w];
+        const uint32_t base = static_cast<uint32_t>(w * 64);
+        while (bits != 0) {
+            out[count++] = base + count_trailing_zeros(bits);
+            bits &= bits - 1;
+        }
+    }
+    return count;
+}
+
+} // namespace simd
+} // namespace lyradb
@@ -0,0 +1,339 @@
+#include "lyradb/sort_operator.h"
+#include "lyradb/expression_evaluator.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/vector_batch.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace lyradb {
+
+namespace {
+
+// Class bytes: numbers < strings < NULL
+constexpr uint8_t kNumberClass = 0x01;
+constexpr uint8_t kStringClass = 0x02;
+constexpr uint8_t kNullClass = 0x03;
+
+// Inputs below this size are sorted on one thread
+constexpr size_t kMinParallelSortRows = 16384;
+
+void put_byte(uint8_t byte, bool descending, std::string& out) {
+    out.push_back(static_cast<char>(descending ? ~byte : byte));
+}
+
+void put_u64(uint64_t bits, bool descending, std::string& out) {
+    if (descending) {
+        bits = ~bits;
+    }
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((bits >> shift) & 0xFF));
+    }
+}
+
+/**
+ * @brief Normalized key of one row plus its first 8 bytes, big-endian
+ */
+struct SortItem {
+    uint64_t prefix;
+    const uint8_t* key;
+    size_t size;
+    size_t row;
+};
+
+struct ItemLess {
+    bool operator()(const SortItem& a, const SortItem& b) const {
+        if (a.prefix != b.prefix) {
+            return a.prefix < b.prefix;
+        }
+        size_t common = std::min(a.size, b.size);
+        if (common > 8) {
+            int cmp = std::memcmp(a.key + 8, b.key + 8, common - 8);
+            if (cmp != 0) {
+                return cmp < 0;
+            }
+        }
+        if (a.size != b.size) {
+            return a.size < b.size;
+        }
+        return a.row < b.row;   // Equal keys keep input order
+    }
+};
+
+uint64_t load_prefix(const uint8_t* key, size_t size) {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        prefix = (prefix << 8) | (i < size ? key[i] : 0);
+    }
+    return prefix;
+}
+
+bool is_integer_type(DataType type) {
+    return type == DataType::INT32 || type == DataType::INT64 ||
+           type == DataType::DATE32 || type == DataType::TIMESTAMP;
+}
+
+bool parse_int(const std::string& text, int64_t& value) {
+    auto res = std::from_chars(text.data(), text.data() + text.size(), value);
+    return res.ec == std::errc() && res.ptr == text.data() + text.size();
+}
+
+bool parse_double(const std::string& text, double& value) {
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size();
+}
+
+bool parse_bool(const std::string& text, int64_t& value) {
+    if (text == "true" || text == "TRUE" || text == "1") {
+        value = 1;
+        return true;
+    }
+    if (text == "false" || text == "FALSE" || text == "0") {
+        value = 0;
+        return true;
+    }
+    return false;
+}
+
+// Encode a stored cell in the comparison domain of its column type
+void encode_cell(const std::string& text, DataType type, bool descending, std::string& out) {
+    if (text.empty()) {
+        SortKeyEncoder::encode_null(descending, out);
+        return;
+    }
+    int64_t i;
+    double d;
+    if (is_integer_type(type) && parse_int(text, i)) {
+        SortKeyEncoder::encode_int(i, descending, out);
+    } else if (type == DataType::BOOL && parse_bool(text, i)) {
+        SortKeyEncoder::encode_int(i, descending, out);
+    } else if ((type == DataType::FLOAT32 || type == DataType::FLOAT64 ||
+                type == DataType::DECIMAL) && parse_double(text, d)) {
+        SortKeyEncoder::encode_double(d, descending, out);
+    } else {
+        SortKeyEncoder::encode_string(text, descending, out);
+    }
+}
+
+// Typed value of a stored cell, for evaluating sort expressions
+ExpressionValue cell_value(const std::string& text, DataType type) {
+    if (text.empty()) {
+        return nullptr;
+    }
+    int64_t i;
+    double d;
+    if (is_integer_type(type) && parse_int(text, i)) {
+        return i;
+    }
+    if (type == DataType::BOOL && parse_bool(text, i)) {
+        return i != 0;
+    }
+    if ((type == DataType::FLOAT32 || type == DataType::FLOAT64) && parse_double(text, d)) {
+        return d;
+    }
+    return text;
+}
+
+// Expression results: numbers compare as doubles so int and float mix
+void encode_value(const ExpressionValue& value, bool descending, std::string& out) {
+    if (auto i = std::get_if<int64_t>(&value)) {
+        SortKeyEncoder::encode_double(static_cast<double>(*i), descending, out);
+    } else if (auto d = std::get_if<double>(&value)) {
+        SortKeyEncoder::encode_double(*d, descending, out);
+    } else if (auto b = std::get_if<bool>(&value)) {
+        SortKeyEncoder::encode_double(*b ? 1.0 : 0.0, descending, out);
+    } else if (auto s = std::get_if<std::string>(&value)) {
+        SortKeyEncoder::encode_string(*s, descending, out);
+    } else {
+        SortKeyEncoder::encode_null(descending, out);
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// SortKeyEncoder
+// ============================================================================
+
+void SortKeyEncoder::encode_null(bool descending, std::string& out) {
+    put_byte(kNullClass, descending, out);
+}
+
+void SortKeyEncoder::encode_int(int64_t value, bool descending, std::string& out) {
+    put_byte(kNumberClass, descending, out);
+    put_u64(static_cast<uint64_t>(value) ^ (uint64_t{1} << 63), descending, out);
+}
+
+void SortKeyEncoder::encode_double(double value, bool descending, std::string& out) {
+    put_byte(kNumberClass, descending, out);
+    if (value == 0.0) {
+        value = 0.0;   // -0.0 == 0.0
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // Negative: reverse their order; positive: move above the negatives
+    bits = (bits >> 63) ? ~bits : bits ^ (uint64_t{1} << 63);
+    put_u64(bits, descending, out);
+}
+
+void SortKeyEncoder::encode_string(const std::string& value, bool descending, std::string& out) {
+    put_byte(kStringClass, descending, out);
+    for (char c : value) {
+        put_byte(static_cast<uint8_t>(c), descending, out);
+        if (c == '\0') {
+            put_byte(0xFF, descending, out);
+        }
+    }
+    put_byte(0x00, descending, out);
+    put_byte(0x00, descending, out);
+}
+
+// ============================================================================
+// SortOperator
+// ============================================================================
+
+SortOperator::SortOperator(std::vector<SortKeySpec> keys) : keys_(std::move(keys)) {}
+
+std::vector<size_t> SortOperator::sort(const std::vector<std::vector<std::string>>& rows,
+                                       const std::vector<std::string>& col_names,
+                                       const std::vector<DataType>& col_types,
+                                       size_t limit,
+                                       QueryExecutor& executor) const {
+    const size_t n = rows.size();
+
+    // Keys naming an output column (including aggregates such as
+    // COUNT(*)) read the cell; anything else is evaluated per row
+    std::vector<int> key_column(keys_.size(), -1);
+    bool evaluate = false;
+    for (size_t k = 0; k < keys_.size(); ++k) {
+        auto col_ref = dynamic_cast<const query::ColumnRefExpr*>(keys_[k].expression);
+        std::string name = col_ref ? col_ref->column_name : keys_[k].expression->to_string();
+        for (size_t c = 0; c < col_names.size(); ++c) {
+            if (col_names[c] == name) {
+                key_column[k] = static_cast<int>(c);
+                break;
+            }
+        }
+        evaluate = evaluate || key_column[k] < 0;
+    }
+
+    // Encode every row's key once; each morsel owns its key arena
+    std::vector<SortItem> items(n);
+    auto morsels = executor.make_morsels({RowRange{0, n}});
+    std::vector<std::string> arenas(morsels.size());
+    std::vector<std::unique_ptr<ExpressionEvaluator>> evaluators(executor.parallelism());
+    executor.run_morsels(morsels.size(), [&](size_t m, size_t slot) {
+        std::string& arena = arenas[m];
+        std::vector<size_t> offsets;
+        offsets.reserve(morsels[m].end - morsels[m].begin + 1);
+        if (evaluate && !evaluators[slot]) {
+            evaluators[slot] = std::make_unique<ExpressionEvaluator>();
+        }
+        RowData row_data;
+        for (size_t r = morsels[m].begin; r < morsels[m].end; ++r) {
+            const auto& row = rows[r];
+            if (evaluate) {
+                for (size_t c = 0; c < col_names.size() && c < row.size(); ++c) {
+                    row_data[col_names[c]] = cell_value(row[c], col_types[c]);
+                }
+            }
+            offsets.push_back(arena.size());
+            for (size_t k = 0; k < keys_.size(); ++k) {
+                int c = key_column[k];
+                if (c >= 0) {
+                    const std::string empty;
+                    const std::string& text = static_cast<size_t>(c) < row.size() ? row[c] : empty;
+                    encode_cell(text, col_types[c], keys_[k].descending, arena);
+                } else {
+                    encode_value(evaluators[slot]->evaluate(keys_[k].expression, row_data),
+                                 keys_[k].descending, arena);
+                }
+            }
+        }
+        offsets.push_back(arena.size());
+
+        // The arena no longer moves: point the items into it
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(arena.data());
+        for (size_t r = morsels[m].begin; r < morsels[m].end; ++r) {
+            size_t i = r - morsels[m].begin;
+            SortItem& item = items[r];
+            item.key = base + offsets[i];
+            item.size = offsets[i + 1] - offsets[i];
+            item.prefix = load_prefix(item.key, item.size);
+            item.row = r;
+        }
+    });
+
+    ItemLess less;
+    std::vector<size_t> order;
+
+    if (limit > 0 && limit < n) {
+        // Top-N: a bounded max-heap per thread, then one small final sort
+        std::vector<std::vector<SortItem>> heaps(executor.parallelism());
+        executor.run_morsels(morsels.size(), [&](size_t m, size_t slot) {
+            auto& heap = heaps[slot];
+            for (size_t r = morsels[m].begin; r < morsels[m].end; ++r) {
+                if (heap.size() < limit) {
+                    heap.push_back(items[r]);
+                    std::push_heap(heap.begin(), heap.end(), less);
+                } else if (less(items[r], heap.front())) {
+                    std::pop_heap(heap.begin(), heap.end(), less);
+                    heap.back() = items[r];
+                    std::push_heap(heap.begin(), heap.end(), less);
+                }
+            }
+        });
+        std::vector<SortItem> best;
+        for (const auto& heap : heaps) {
+            best.insert(best.end(), heap.begin(), heap.end());
+        }
+        std::sort(best.begin(), best.end(), less);
+        best.resize(std::min(best.size(), limit));
+        for (const auto& item : best) {
+            order.push_back(item.row);
+        }
+        return order;
+    }
+
+    // Full sort: one sorted run per thread, then pairwise parallel merges
+    size_t runs = n < kMinParallelSortRows ? 1 : std::min(executor.parallelism(), n);
+    std::vector<size_t> bounds(runs + 1);
+    for (size_t r = 0; r <= runs; ++r) {
+        bounds[r] = n * r / runs;
+    }
+    executor.run_morsels(runs, [&](size_t r, size_t) {
+        std::sort(items.begin() + bounds[r], items.begin() + bounds[r + 1], less);
+    });
+    if (runs > 1) {
+        std::vector<SortItem> buffer(n);
+        std::vector<SortItem>* src = &items;
+        std::vector<SortItem>* dst = &buffer;
+        for (size_t width = 1; width < runs; width *= 2) {
+            size_t merges = (runs + 2 * width - 1) / (2 * width);
+            executor.run_morsels(merges, [&](size_t p, size_t) {
+                size_t lo = bounds[2 * p * width];
+                size_t mid = bounds[std::min(2 * p * width + width, runs)];
+                size_t hi = bounds[std::min(2 * p * width + 2 * width, runs)];
+                std::merge(src->begin() + lo, src->begin() + mid,
+                           src->begin() + mid, src->begin() + hi,
+                           dst->begin() + lo, less);
+            });
+            std::swap(src, dst);
+        }
+        if (src != &items) {
+            items.swap(buffer);
+        }
+    }
+
+    order.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = items[i].row;
+    }
+    return order;
+}
+
+} // namespace lyradb
@@ -67,7 +67,7 @@ std::string AggregateExpr::to_string() const {
     }
     
     if (argument) {
-        return func_name + "(" + argument->to_string() + ")";
+        return func_name + (distinct ? "(DISTINCT " : "(") + argument->to_string() + ")";
     }
     return func_name + "(*)";
 }
@@ -668,8 +668,9 @@ std::unique_ptr<Expression> SqlParser::parse_primary_expression() {
         
         consume(TokenType::LPAREN, "Expected ( in aggregate function");
         
+        bool distinct = match(TokenType::DISTINCT);
         std::unique_ptr<Expression> arg;
-        if (match(TokenType::STAR)) {
+        if (!distinct && match(TokenType::STAR)) {
             // COUNT(*)
             arg = nullptr;
         } else {
@@ -678,7 +679,7 @@ std::unique_ptr<Expression> SqlParser::parse_primary_expression() {
         
         consume(TokenType::RPAREN, "Expected )");
         
-        return std::make_unique<AggregateExpr>(func, std::move(arg));
+        return std::make_unique<AggregateExpr>(func, std::move(arg), distinct);
     }
     
     // Identifier (column reference or function call)
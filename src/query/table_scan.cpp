@@ -0,0 +1,82 @@
+#include "lyradb/table_scan.h"
+#include "lyradb/table.h"
+#include <algorithm>
+
+namespace lyradb {
+
+TableScan::TableScan(const Table& table, const query::Expression* predicate,
+                     size_t batch_size, const std::vector<bool>* columns)
+    : table_(table), predicate_(predicate),
+      batch_size_(std::max(batch_size, size_t(1))),
+      has_deletes_(table.deleted_count() > 0),
+      bind_all_(columns == nullptr) {
+    if (columns) {
+        bind_ = referenced_columns(predicate_, table);
+        for (size_t i = 0; i < bind_.size(); ++i) {
+            bind_[i] = bind_[i] || (*columns)[i];
+        }
+    }
+    size_t num_rows = table.row_count();
+    if (predicate_) {
+        evaluator_.candidate_ranges(predicate_, table, ranges_);
+    } else if (num_rows > 0) {
+        ranges_.push_back(RowRange{0, num_rows});
+    }
+    if (!ranges_.empty()) {
+        position_ = ranges_[0].begin;
+    }
+}
+
+bool TableScan::next(VectorBatch& batch, SelectionVector& selection) {
+    while (range_ < ranges_.size()) {
+        const RowRange& range = ranges_[range_];
+        if (position_ >= range.end) {
+            if (++range_ < ranges_.size()) {
+                position_ = ranges_[range_].begin;
+            }
+            continue;
+        }
+        // Batches end at row group boundaries
+        size_t group = position_ / Table::kRowGroupRows;
+        size_t size = std::min({batch_size_, range.end - position_,
+                                (group + 1) * Table::kRowGroupRows - position_});
+        const std::vector<bool>* bind = bind_all_ ? nullptr : &bind_;
+        if (table_.delta_overlaps(position_, position_ + size)) {
+            batch = VectorBatch::scan_table(table_, position_, size, bind);
+        } else {
+            if (group != group_) {
+                columns_ = VectorBatch::from_stored(table_, group, bind).columns;
+                group_ = group;
+            }
+            if (batch.columns != columns_) {
+                batch.columns = columns_;
+            }
+            batch.owned.clear();
+            batch.base = group * Table::kRowGroupRows;
+        }
+        batch.offset = position_;
+        batch.size = size;
+        position_ += batch.size;
+        rows_scanned_ += batch.size;
+
+        select_all(selection, batch.size);
+        if (predicate_) {
+            evaluator_.filter_batch(predicate_, batch, selection);
+        }
+        if (has_deletes_) {
+            size_t kept = 0;
+            for (uint32_t r : selection) {
+                if (!table_.is_deleted(batch.offset + r)) {
+                    selection[kept++] = r;
+                }
+            }
+            selection.resize(kept);
+        }
+        if (!selection.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace lyradb
@@ -0,0 +1,185 @@
+#include "lyradb/task_scheduler.h"
+#include <algorithm>
+#include <exception>
+
+namespace lyradb {
+
+// One parallel_for() call; lives on the caller's stack
+struct TaskScheduler::Job {
+    // Remaining tasks [begin, end) dealt to one participant
+    struct Block {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    explicit Job(const TaskFn& body, size_t slots) : fn(body), blocks(slots) {}
+
+    const TaskFn& fn;
+    std::vector<Block> blocks;
+    size_t next_slot = 1;           // Slot 0 is the caller; guarded by mutex_
+    size_t attached = 0;            // Workers inside participate(); guarded by mutex_
+    std::condition_variable detached;
+
+    std::atomic<bool> failed{false};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+};
+
+TaskScheduler::TaskScheduler(size_t num_threads) {
+    if (num_threads == 0) {
+        size_t cores = std::thread::hardware_concurrency();
+        num_threads = cores > 1 ? cores - 1 : 0;
+    }
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+TaskScheduler& TaskScheduler::global() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+size_t TaskScheduler::parallel_for(size_t num_tasks, size_t dop, const TaskFn& fn) {
+    if (num_tasks == 0) {
+        return 0;
+    }
+    size_t slots = dop == 0 ? max_parallelism() : std::min(dop, max_parallelism());
+    slots = std::min(slots, num_tasks);
+    if (slots <= 1) {
+        for (size_t task = 0; task < num_tasks; ++task) {
+            fn(task, 0);
+        }
+        return 1;
+    }
+
+    // Contiguous blocks keep neighbouring morsels on the same thread
+    Job job(fn, slots);
+    size_t per_slot = num_tasks / slots;
+    size_t extra = num_tasks % slots;
+    size_t next = 0;
+    for (size_t s = 0; s < slots; ++s) {
+        job.blocks[s].begin = next;
+        next += per_slot + (s < extra ? 1 : 0);
+        job.blocks[s].end = next;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(&job);
+    }
+    work_available_.notify_all();
+
+    participate(job, 0);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        jobs_.erase(std::remove(jobs_.begin(), jobs_.end(), &job), jobs_.end());
+        job.detached.wait(lock, [&] { return job.attached == 0; });
+    }
+
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+    return slots;
+}
+
+void TaskScheduler::participate(Job& job, size_t slot) {
+    auto run = [&](size_t task) {
+        if (job.failed.load(std::memory_order_relaxed)) {
+            return;
+        }
+        try {
+            job.fn(task, slot);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.error_mutex);
+            if (!job.error) {
+                job.error = std::current_exception();
+            }
+            job.failed = true;
+        }
+    };
+
+    // Own block, front to back
+    Job::Block& own = job.blocks[slot];
+    for (;;) {
+        size_t task;
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.begin == own.end) {
+                break;
+            }
+            task = own.begin++;
+        }
+        run(task);
+    }
+
+    // Steal from the back of the fullest remaining block
+    for (;;) {
+        size_t victim = job.blocks.size();
+        size_t most = 0;
+        for (size_t s = 0; s < job.blocks.size(); ++s) {
+            std::lock_guard<std::mutex> lock(job.blocks[s].mutex);
+            size_t left = job.blocks[s].end - job.blocks[s].begin;
+            if (left > most) {
+                most = left;
+                victim = s;
+            }
+        }
+        if (victim == job.blocks.size()) {
+            return;
+        }
+
+        size_t task;
+        {
+            Job::Block& block = job.blocks[victim];
+            std::lock_guard<std::mutex> lock(block.mutex);
+            if (block.begin == block.end) {
+                continue;
+            }
+            task = --block.end;
+        }
+        steals_.fetch_add(1, std::memory_order_relaxed);
+        run(task);
+    }
+}
+
+void TaskScheduler::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        work_available_.wait(lock, [&] { return stopping_ || !jobs_.empty(); });
+        if (stopping_) {
+            return;
+        }
+
+        Job* job = jobs_.front();
+        size_t slot = job->next_slot++;
+        if (job->next_slot >= job->blocks.size()) {
+            jobs_.erase(jobs_.begin());
+        }
+        job->attached++;
+
+        lock.unlock();
+        participate(*job, slot);
+        lock.lock();
+
+        if (--job->attached == 0) {
+            job->detached.notify_all();
+        }
+    }
+}
+
+} // namespace lyradb
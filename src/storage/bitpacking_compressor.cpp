@@ -1,11 +1,245 @@
 #include "lyradb/bitpacking_compressor.h"
+#include "lyradb/config.h"
+#include "lyradb/simd_kernels.h"
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if LYRADB_ENABLE_SIMD && (defined(__x86_64__) || defined(_M_X64))
+#define LYRADB_BITPACK_X86 1
+#include <immintrin.h>
+#else
+#define LYRADB_BITPACK_X86 0
+#endif
+
+// AVX2 kernels are compiled with function attributes so the rest of the
+// library keeps the baseline target (see simd_kernels.cpp)
+#if defined(__GNUC__) || defined(__clang__)
+#define LYRADB_BITPACK_AVX2_INLINE inline __attribute__((always_inline, target("avx2")))
+#define LYRADB_BITPACK_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LYRADB_BITPACK_AVX2_INLINE __forceinline
+#define LYRADB_BITPACK_TARGET_AVX2
+#endif
 
 namespace lyradb {
 namespace compression {
 
+namespace {
+
+constexpr unsigned kLanes = 8;
+constexpr unsigned kLaneValues = BitpackingCompressor::kBlockValues / kLanes;
+
+template <unsigned W>
+constexpr uint32_t width_mask() {
+    return W >= 32 ? ~uint32_t(0) : (uint32_t(1) << W) - 1;
+}
+
+// Bits needed for an unsigned range
+uint8_t width_of(uint64_t range) {
+    uint8_t width = 0;
+    while (range != 0) {
+        ++width;
+        range >>= 1;
+    }
+    return width;
+}
+
+// Packed word idx; packed data has no alignment guarantee
+inline uint32_t load_word(const uint8_t* in, size_t idx) {
+    uint32_t word;
+    std::memcpy(&word, in + idx * sizeof(uint32_t), sizeof(word));
+    return word;
+}
+
+// base + value without signed overflow
+template <typename T>
+T add_base(T base, uint64_t value) {
+    using U = std::make_unsigned_t<T>;
+    return static_cast<T>(static_cast<U>(base) + static_cast<U>(value));
+}
+
+// ============================================================================
+// Scalar kernels: one instantiation per bit width. Lanes are the inner
+// loop, so the compiler can still vectorize them on the baseline target.
+// ============================================================================
+
+template <unsigned W>
+void pack_scalar(const uint32_t* in, uint32_t* out) {
+    if constexpr (W > 0) {
+        std::fill(out, out + kLanes * W, 0u);
+        for (unsigned j = 0; j < kLaneValues; ++j) {
+            const unsigned bit = j * W;
+            const unsigned word = bit / 32;
+            const unsigned shift = bit % 32;
+            for (unsigned lane = 0; lane < kLanes; ++lane) {
+                uint32_t v = in[j * kLanes + lane] & width_mask<W>();
+                out[word * kLanes + lane] |= v << shift;
+                if (shift + W > 32) {
+                    out[(word + 1) * kLanes + lane] |= v >> (32 - shift);
+                }
+            }
+        }
+    }
+}
+
+template <unsigned W, typename T>
+void unpack_scalar(const uint8_t* in, T base, T* out) {
+    if constexpr (W == 0) {
+        std::fill(out, out + BitpackingCompressor::kBlockValues, base);
+    } else {
+        for (unsigned j = 0; j < kLaneValues; ++j) {
+            const unsigned bit = j * W;
+            const unsigned word = bit / 32;
+            const unsigned shift = bit % 32;
+            for (unsigned lane = 0; lane < kLanes; ++lane) {
+                uint32_t v = load_word(in, word * kLanes + lane) >> shift;
+                if (shift + W > 32) {
+                    v |= load_word(in, (word + 1) * kLanes + lane) << (32 - shift);
+                }
+                out[j * kLanes + lane] = add_base(base, v & width_mask<W>());
+            }
+        }
+    }
+}
+
+// ============================================================================
+// AVX2 kernels: eight lanes per register, so each step unpacks eight
+// consecutive values with shifts known at compile time
+// ============================================================================
+
+#if LYRADB_BITPACK_X86
+
+LYRADB_BITPACK_AVX2_INLINE void store_avx2(__m256i v, __m256i base, int32_t* out) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi32(v, base));
+}
+
+LYRADB_BITPACK_AVX2_INLINE void store_avx2(__m256i v, __m256i base, int64_t* out) {
+    __m256i lo = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v));
+    __m256i hi = _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi64(lo, base));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4), _mm256_add_epi64(hi, base));
+}
+
+template <unsigned W, unsigned J, typename T>
+LYRADB_BITPACK_AVX2_INLINE void unpack_step_avx2(const uint8_t* in, __m256i mask,
+                                                 __m256i base, T* out) {
+    constexpr unsigned bit = J * W;
+    constexpr unsigned word = bit / 32;
+    constexpr unsigned shift = bit % 32;
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + word * 32));
+    if constexpr (shift != 0) {
+        v = _mm256_srli_epi32(v, shift);
+    }
+    if constexpr (shift + W > 32) {
+        __m256i next = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(in + (word + 1) * 32));
+        v = _mm256_or_si256(v, _mm256_slli_epi32(next, 32 - shift));
+    }
+    if constexpr (W < 32) {
+        v = _mm256_and_si256(v, mask);
+    }
+    store_avx2(v, base, out + J * kLanes);
+}
+
+template <unsigned W, typename T, unsigned... J>
+LYRADB_BITPACK_AVX2_INLINE void unpack_steps_avx2(const uint8_t* in, __m256i mask, __m256i base,
+                                                  T* out, std::integer_sequence<unsigned, J...>) {
+    (unpack_step_avx2<W, J>(in, mask, base, out), ...);
+}
+
+template <unsigned W, typename T>
+LYRADB_BITPACK_TARGET_AVX2 void unpack_avx2(const uint8_t* in, T base, T* out) {
+    if constexpr (W == 0) {
+        std::fill(out, out + BitpackingCompressor::kBlockValues, base);
+    } else {
+        __m256i mask = _mm256_set1_epi32(static_cast<int32_t>(width_mask<W>()));
+        __m256i bases;
+        if constexpr (sizeof(T) == 8) {
+            bases = _mm256_set1_epi64x(base);
+        } else {
+            bases = _mm256_set1_epi32(base);
+        }
+        unpack_steps_avx2<W>(in, mask, bases, out,
+                             std::make_integer_sequence<unsigned, kLaneValues>());
+    }
+}
+
+#endif
+
+// ============================================================================
+// Kernel tables indexed by bit width
+// ============================================================================
+
+using PackFn = void (*)(const uint32_t*, uint32_t*);
+template <typename T>
+using UnpackFn = void (*)(const uint8_t*, T, T*);
+
+template <unsigned... W>
+constexpr std::array<PackFn, 33> pack_table(std::integer_sequence<unsigned, W...>) {
+    return {{&pack_scalar<W>...}};
+}
+
+template <typename T, unsigned... W>
+constexpr std::array<UnpackFn<T>, 33> unpack_table(std::integer_sequence<unsigned, W...>) {
+    return {{&unpack_scalar<W, T>...}};
+}
+
+#if LYRADB_BITPACK_X86
+template <typename T, unsigned... W>
+constexpr std::array<UnpackFn<T>, 33> unpack_table_avx2(std::integer_sequence<unsigned, W...>) {
+    return {{&unpack_avx2<W, T>...}};
+}
+#endif
+
+using Widths = std::make_integer_sequence<unsigned, 33>;
+
+template <typename T>
+UnpackFn<T> unpack_kernel(uint8_t bit_width) {
+    if (bit_width > 32) {
+        throw std::runtime_error("Block bit width above 32: " + std::to_string(bit_width));
+    }
+#if LYRADB_BITPACK_X86
+    static const bool avx2 = simd::detect_instruction_set() != simd::InstructionSet::SCALAR;
+    if (avx2) {
+        static constexpr auto table = unpack_table_avx2<T>(Widths());
+        return table[bit_width];
+    }
+#endif
+    static constexpr auto table = unpack_table<T>(Widths());
+    return table[bit_width];
+}
+
+} // namespace
+
+void BitpackingCompressor::pack_block(const uint32_t* in, uint8_t bit_width, uint32_t* out) {
+    if (bit_width > 32) {
+        throw std::runtime_error("Block bit width above 32: " + std::to_string(bit_width));
+    }
+    static constexpr auto table = pack_table(Widths());
+    table[bit_width](in, out);
+}
+
+void BitpackingCompressor::unpack_block(const uint32_t* in, uint8_t bit_width, uint32_t* out) {
+    // Same bits as int32 with a zero base
+    unpack_kernel<int32_t>(bit_width)(reinterpret_cast<const uint8_t*>(in), 0,
+                                      reinterpret_cast<int32_t*>(out));
+}
+
+void BitpackingCompressor::unpack_block(const uint32_t* in, uint8_t bit_width,
+                                        int64_t base, int64_t* out) {
+    unpack_kernel<int64_t>(bit_width)(reinterpret_cast<const uint8_t*>(in), base, out);
+}
+
+void BitpackingCompressor::unpack_block(const uint32_t* in, uint8_t bit_width,
+                                        int32_t base, int32_t* out) {
+    unpack_kernel<int32_t>(bit_width)(reinterpret_cast<const uint8_t*>(in), base, out);
+}
+
 std::vector<uint8_t> BitpackingCompressor::compress(
     const int64_t* values, 
     size_t count) {
@@ -23,15 +257,13 @@ std::vector<uint8_t> BitpackingCompressor::compress(
         max_val = std::max(max_val, values[i]);
     }
     
-    // Calculate bits needed for range
-    int64_t range = max_val - min_val;
-    uint8_t bit_width = calculate_bit_width(range);
+    // Calculate bits needed for range (unsigned: the span may exceed INT64_MAX)
+    uint8_t bit_width = width_of(static_cast<uint64_t>(max_val) - static_cast<uint64_t>(min_val));
     
     // Allocate result buffer
     // Header: 1 (bit_width) + 4 (num_values) + 8 (min_value)
     // Data: ceil(count * bit_width / 8) bytes
-    size_t data_bytes = (count * bit_width + 7) / 8;
-    std::vector<uint8_t> result(BitpackHeader::SIZE + data_bytes);
+    std::vector<uint8_t> result(BitpackHeader::SIZE + packed_bytes(count, bit_width));
     
     // Write header
     result[0] = bit_width;
@@ -43,12 +275,28 @@ std::vector<uint8_t> BitpackingCompressor::compress(
     
     std::memcpy(result.data() + 5, &min_val, 8);
     
-    // Encode values (delta from min, stored in bit_width bits)
-    size_t bit_offset = 0;
+    // Encode values (delta from min, stored in bit_width bits): whole
+    // blocks first, then the tail
     uint8_t* data_ptr = result.data() + BitpackHeader::SIZE;
+    size_t i = 0;
+    if (bit_width <= 32) {
+        uint32_t block[kBlockValues];
+        uint32_t words[kLanes * 32];
+        const size_t block_bytes = sizeof(uint32_t) * kLanes * bit_width;
+        for (; i + kBlockValues <= count; i += kBlockValues) {
+            for (size_t k = 0; k < kBlockValues; ++k) {
+                block[k] = static_cast<uint32_t>(
+                    static_cast<uint64_t>(values[i + k]) - static_cast<uint64_t>(min_val));
+            }
+            pack_block(block, bit_width, words);
+            std::memcpy(data_ptr, words, block_bytes);
+            data_ptr += block_bytes;
+        }
+    }
     
-    for (size_t i = 0; i < count; ++i) {
-        uint64_t delta = static_cast<uint64_t>(values[i] - min_val);
+    size_t bit_offset = 0;
+    for (; i < count; ++i) {
+        uint64_t delta = static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(min_val);
         write_bits(data_ptr, bit_offset, delta, bit_width);
         bit_offset += bit_width;
     }
@@ -56,42 +304,68 @@ std::vector<uint8_t> BitpackingCompressor::compress(
     return result;
 }
 
-std::vector<int64_t> BitpackingCompressor::decompress(
-    const uint8_t* data, 
-    size_t length) {
-    
+size_t BitpackingCompressor::value_count(const uint8_t* data, size_t length) {
     if (!data || length < BitpackHeader::SIZE) {
-        return {};
+        return 0;
     }
-    
+    return static_cast<size_t>(data[1]) | (static_cast<size_t>(data[2]) << 8) |
+           (static_cast<size_t>(data[3]) << 16) | (static_cast<size_t>(data[4]) << 24);
+}
+
+template <typename T>
+size_t BitpackingCompressor::decode(const uint8_t* data, size_t length, T* out) {
+    size_t count = value_count(data, length);
+    if (count == 0) {
+        return 0;
+    }
+
     // Read header
     uint8_t bit_width = data[0];
-    uint32_t count = 
-        data[1] | 
-        (data[2] << 8) | 
-        (data[3] << 16) | 
-        (data[4] << 24);
-    
     int64_t min_val;
     std::memcpy(&min_val, data + 5, 8);
-    
-    // Decode values
-    std::vector<int64_t> result;
-    result.reserve(count);
-    
-    size_t bit_offset = 0;
+    if (bit_width > 64 || length - BitpackHeader::SIZE < packed_bytes(count, bit_width)) {
+        throw std::runtime_error("Corrupt bitpacked data");
+    }
+    const T base = static_cast<T>(min_val);
+
+    // Decode values: whole blocks through the kernels, then the tail
     const uint8_t* data_ptr = data + BitpackHeader::SIZE;
-    size_t data_length = length - BitpackHeader::SIZE;
-    
-    for (uint32_t i = 0; i < count; ++i) {
-        uint64_t delta = read_bits(data_ptr, bit_offset, bit_width);
-        result.push_back(min_val + static_cast<int64_t>(delta));
+    size_t i = 0;
+    if (bit_width <= 32) {
+        auto kernel = unpack_kernel<T>(bit_width);
+        const size_t block_bytes = sizeof(uint32_t) * kLanes * bit_width;
+        for (; i + kBlockValues <= count; i += kBlockValues) {
+            kernel(data_ptr, base, out + i);
+            data_ptr += block_bytes;
+        }
+    }
+
+    size_t bit_offset = 0;
+    for (; i < count; ++i) {
+        out[i] = add_base(base, read_bits(data_ptr, bit_offset, bit_width));
         bit_offset += bit_width;
     }
+
+    return count;
+}
+
+std::vector<int64_t> BitpackingCompressor::decompress(
+    const uint8_t* data, 
+    size_t length) {
     
+    std::vector<int64_t> result(value_count(data, length));
+    decode(data, length, result.data());
     return result;
 }
 
+size_t BitpackingCompressor::decompress_into(const uint8_t* data, size_t length, int64_t* out) {
+    return decode(data, length, out);
+}
+
+size_t BitpackingCompressor::decompress_into(const uint8_t* data, size_t length, int32_t* out) {
+    return decode(data, length, out);
+}
+
 double BitpackingCompressor::estimate_compression_ratio(
     const int64_t* values, 
     size_t count) {
@@ -109,31 +383,20 @@ double BitpackingCompressor::estimate_compression_ratio(
         max_val = std::max(max_val, values[i]);
     }
     
-    int64_t range = max_val - min_val;
-    uint8_t bit_width = calculate_bit_width(range);
+    uint8_t bit_width = width_of(static_cast<uint64_t>(max_val) - static_cast<uint64_t>(min_val));
     
     // Original size: 8 bytes * count
     size_t original_size = count * 8;
     
     // Compressed size: header + bitpacked data
-    size_t compressed_size = BitpackHeader::SIZE + 
-                            ((count * bit_width + 7) / 8);
+    size_t compressed_size = BitpackHeader::SIZE + packed_bytes(count, bit_width);
     
     return static_cast<double>(compressed_size) / original_size;
 }
 
 uint8_t BitpackingCompressor::calculate_bit_width(int64_t max_value) {
     if (max_value <= 0) return 0;
-    
-    uint8_t width = 1;
-    int64_t limit = 1;
-    
-    while (width < 64 && limit < max_value) {
-        width++;
-        limit = (1LL << width) - 1;
-    }
-    
-    return std::min(width, uint8_t(64));
+    return width_of(static_cast<uint64_t>(max_value));
 }
 
 void BitpackingCompressor::write_bits(
@@ -142,16 +405,18 @@ void BitpackingCompressor::write_bits(
     uint64_t value, 
     uint8_t bit_width) {
     
-    for (uint8_t i = 0; i < bit_width; ++i) {
-        size_t byte_pos = (bit_offset + i) / 8;
-        size_t bit_pos = (bit_offset + i) % 8;
-        
-        uint8_t bit = (value >> i) & 1;
-        if (bit) {
-            buffer[byte_pos] |= (1 << bit_pos);
-        } else {
-            buffer[byte_pos] &= ~(1 << bit_pos);
-        }
+    // A byte at a time; bits outside the field keep their value
+    uint8_t* p = buffer + bit_offset / 8;
+    unsigned shift = bit_offset % 8;
+    unsigned remaining = bit_width;
+    while (remaining > 0) {
+        unsigned take = std::min(8 - shift, remaining);
+        uint8_t mask = static_cast<uint8_t>(((1u << take) - 1) << shift);
+        *p = static_cast<uint8_t>((*p & ~mask) | ((value << shift) & mask));
+        value >>= take;
+        remaining -= take;
+        shift = 0;
+        ++p;
     }
 }
 
@@ -160,14 +425,17 @@ uint64_t BitpackingCompressor::read_bits(
     size_t bit_offset, 
     uint8_t bit_width) {
     
+    const uint8_t* p = buffer + bit_offset / 8;
+    unsigned shift = bit_offset % 8;
     uint64_t value = 0;
-    
-    for (uint8_t i = 0; i < bit_width; ++i) {
-        size_t byte_pos = (bit_offset + i) / 8;
-        size_t bit_pos = (bit_offset + i) % 8;
-        
-        uint8_t bit = (buffer[byte_pos] >> bit_pos) & 1;
-        value |= static_cast<uint64_t>(bit) << i;
+    unsigned filled = 0;
+    while (filled < bit_width) {
+        unsigned take = std::min(8 - shift, bit_width - filled);
+        uint64_t bits = (*p >> shift) & ((1u << take) - 1);
+        value |= bits << filled;
+        filled += take;
+        shift = 0;
+        ++p;
     }
     
     return value;
@@ -1,68 +1,538 @@
 #include "lyradb/column.h"
+#include "lyradb/config.h"
+#include "lyradb/dict_compressor.h"
+#include "lyradb/rle_compressor.h"
+#include "lyradb/storage_format.h"
 #include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <cctype>
+#include <charconv>
 #include <algorithm>
+#include <limits>
 #include <stdexcept>
 
 namespace lyradb {
 
+namespace {
+
+bool iequals(const std::string& a, const char* b) {
+    size_t n = std::strlen(b);
+    if (a.size() != n) return false;
+    for (size_t i = 0; i < n; ++i) {
+        if (std::toupper(static_cast<unsigned char>(a[i])) != b[i]) return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool parse_integer(const std::string& text, T& out) {
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    auto res = std::from_chars(begin, end, out);
+    if (res.ec == std::errc() && res.ptr == end) {
+        return true;
+    }
+    // Accept integral values written in floating form (e.g. "31.000000"
+    // produced by arithmetic in UPDATE assignments)
+    char* parse_end = nullptr;
+    double d = std::strtod(begin, &parse_end);
+    if (parse_end != end || text.empty() || !std::isfinite(d) || d != std::trunc(d)) {
+        return false;
+    }
+    // T's range is [-2^digits, 2^digits), both bounds exact in a double
+    const double limit = std::ldexp(1.0, std::numeric_limits<T>::digits);
+    if (d < -limit || d >= limit) {
+        return false;
+    }
+    out = static_cast<T>(d);
+    return true;
+}
+
+template <typename T>
+bool parse_floating(const std::string& text, T& out) {
+    if (text.empty()) return false;
+    char* parse_end = nullptr;
+    double d = std::strtod(text.c_str(), &parse_end);
+    if (parse_end != text.c_str() + text.size()) {
+        return false;
+    }
+    out = static_cast<T>(d);
+    return true;
+}
+
+template <typename T>
+void put_pod(std::vector<uint8_t>& out, T value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+std::string format_number(T value) {
+    char buf[64];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    return std::string(buf, res.ptr);
+}
+
+}  // namespace
+
 Column::Column(const std::string& name, DataType type, size_t initial_capacity)
-    : name_(name), type_(type) {
-    current_page_.reserve(65536);  // 64 KB page size
+    : name_(name), type_(type), value_size_(Type::size_bytes(type)), nulls_(0), zone_map_(type) {
+    if (is_fixed_width()) {
+        values_.reserve(initial_capacity * value_size_);
+    } else {
+        strings_.reserve(initial_capacity);
+    }
 }
 
 void Column::append_value(const void* value) {
-    size_t value_size = Type::size_bytes(type_);
-    if (value_size > 0 && value != nullptr) {
+    if (value == nullptr) {
+        append_null();
+        return;
+    }
+    if (is_fixed_width()) {
         const uint8_t* bytes = static_cast<const uint8_t*>(value);
-        current_page_.insert(current_page_.end(), bytes, bytes + value_size);
+        values_.insert(values_.end(), bytes, bytes + value_size_);
+        zone_map_.add_value(bytes);
+    } else {
+        std::string text(static_cast<const char*>(value));
+        if (!append_code(text)) {
+            strings_.push_back(text);
+        }
+        zone_map_.add_string(text);
     }
-    // Mark as not null - for now, skip bitmap update
     num_values_++;
+    nulls_.resize(num_values_);
+    extend_runs();
+    after_append();
 }
 
 void Column::append_null() {
-    size_t value_size = Type::size_bytes(type_);
-    if (value_size > 0) {
-        std::vector<uint8_t> zeros(value_size, 0);
-        current_page_.insert(current_page_.end(), zeros.begin(), zeros.end());
+    if (is_fixed_width()) {
+        values_.insert(values_.end(), value_size_, 0);
+    } else if (!append_code(std::string())) {
+        strings_.emplace_back();
     }
-    // Mark as null - for now, skip bitmap update
     num_values_++;
+    nulls_.resize(num_values_);
+    nulls_.set_null(num_values_ - 1, true);
+    extend_runs();
+    null_count_++;
+    zone_map_.add_null();
+    after_append();
+}
+
+void Column::append_string(const std::string& text) {
+    if (text.empty() || (is_fixed_width() && iequals(text, "NULL"))) {
+        append_null();
+        return;
+    }
+    if (is_fixed_width()) {
+        uint8_t slot[8] = {0};
+        parse_into(type_, name_, text, slot);
+        append_value(slot);
+    } else {
+        if (!append_code(text)) {
+            strings_.push_back(text);
+        }
+        zone_map_.add_string(text);
+        num_values_++;
+        nulls_.resize(num_values_);
+        after_append();
+    }
+}
+
+void Column::set_string(size_t row, const std::string& text) {
+    if (row >= num_values_) {
+        throw std::out_of_range("Row index out of range: " + std::to_string(row));
+    }
+    bool make_null = text.empty() || (is_fixed_width() && iequals(text, "NULL"));
+    decode();
+    if (is_fixed_width()) {
+        uint8_t* slot = values_.data() + row * value_size_;
+        if (make_null) {
+            std::memset(slot, 0, value_size_);
+        } else {
+            parse_into(type_, name_, text, slot);
+        }
+    } else {
+        strings_[row] = text;
+    }
+    bool was_null = is_null(row);
+    if (was_null != make_null) {
+        nulls_.set_null(row, make_null);
+        zone_map_.set_null(row, make_null);
+        if (make_null) {
+            null_count_++;
+        } else {
+            null_count_--;
+        }
+    }
+    if (!make_null) {
+        if (is_fixed_width()) {
+            zone_map_.widen(row, values_.data() + row * value_size_);
+        } else {
+            zone_map_.widen_string(row, text);
+        }
+    }
+}
+
+void Column::erase_rows(const std::vector<size_t>& sorted_rows) {
+    if (sorted_rows.empty()) {
+        return;
+    }
+    decode();
+
+    // Single compaction pass: slide surviving values down over erased slots
+    size_t write = 0;
+    size_t next = 0;
+    for (size_t read = 0; read < num_values_; ++read) {
+        if (next < sorted_rows.size() && sorted_rows[next] == read) {
+            ++next;
+            continue;
+        }
+        if (write != read) {
+            if (is_fixed_width()) {
+                std::memcpy(values_.data() + write * value_size_,
+                            values_.data() + read * value_size_,
+                            value_size_);
+            } else {
+                strings_[write] = std::move(strings_[read]);
+            }
+            if (null_count_ != 0) {
+                nulls_.set_null(write, nulls_.is_null(read));
+            }
+        }
+        ++write;
+    }
+
+    truncate(write);
+    rebuild_pages();
+}
+
+void Column::truncate(size_t num_values) {
+    if (num_values >= num_values_) {
+        return;
+    }
+    decode();
+    if (is_fixed_width()) {
+        values_.resize(num_values * value_size_);
+    } else {
+        strings_.resize(num_values);
+    }
+    num_values_ = num_values;
+    nulls_.resize(num_values_);
+
+    null_count_ = 0;
+    for (size_t i = 0; i < num_values_; ++i) {
+        if (nulls_.is_null(i)) null_count_++;
+    }
+
+    if (sealed_values_ > num_values_) {
+        rebuild_pages();
+    } else {
+        rebuild_zone_map(page_starts_.size());  // Only the open tail shrank
+    }
+}
+
+void Column::encode() {
+    if (num_values_ == 0) {
+        return;
+    }
+    if (!is_fixed_width()) {
+        if (dictionary_encoded_ || !compression::DictionaryCompressor::is_suitable(strings_)) {
+            return;
+        }
+        auto encoded = compression::DictionaryCompressor::encode(strings_, true);
+        dictionary_ = std::move(encoded.dictionary);
+        codes_ = std::move(encoded.codes);
+        strings_.clear();
+        strings_.shrink_to_fit();
+        dictionary_encoded_ = true;
+        return;
+    }
+    if (!run_ends_.empty()) {
+        return;
+    }
+    auto runs = compression::RLECompressor::analyze_runs(values_.data(), values_.size(), value_size_);
+    if (runs.size() * kMinRunLength > num_values_) {
+        return;
+    }
+    run_ends_.reserve(runs.size());
+    uint32_t end = 0;
+    for (const auto& run : runs) {
+        end += run.run_count;
+        run_ends_.push_back(end);
+    }
+}
+
+void Column::decode() {
+    run_ends_.clear();
+    if (!dictionary_encoded_) {
+        return;
+    }
+    strings_.reserve(codes_.size());
+    for (uint32_t code : codes_) {
+        strings_.push_back(dictionary_[code]);
+    }
+    dictionary_encoded_ = false;
+    dictionary_.clear();
+    codes_.clear();
+}
+
+bool Column::append_code(const std::string& text) {
+    if (!dictionary_encoded_) {
+        return false;
+    }
+    auto it = std::lower_bound(dictionary_.begin(), dictionary_.end(), text);
+    if (it == dictionary_.end() || *it != text) {
+        decode();  // A new value would break the code order
+        return false;
+    }
+    codes_.push_back(static_cast<uint32_t>(it - dictionary_.begin()));
+    return true;
+}
+
+void Column::extend_runs() {
+    if (run_ends_.empty()) {
+        return;
+    }
+    size_t last = num_values_ - 1;
+    if (std::memcmp(values_.data() + last * value_size_,
+                    values_.data() + (last - 1) * value_size_, value_size_) == 0) {
+        run_ends_.back()++;
+    } else {
+        run_ends_.push_back(static_cast<uint32_t>(num_values_));
+    }
+}
+
+void Column::after_append() {
+    size_t open_rows = num_values_ - sealed_values_;
+    size_t page_rows = is_fixed_width()
+        ? LYRADB_DEFAULT_PAGE_SIZE / value_size_
+        : kStringPageRows;
+    if (open_rows >= page_rows) {
+        seal_page(num_values_);
+        zone_map_.seal();
+    }
 }
 
 void Column::finalize_page() {
-    if (current_page_.empty()) {
+    if (num_values_ == sealed_values_) {
         return;
     }
-    
+    seal_page(num_values_);
+    zone_map_.seal();
+}
+
+void Column::seal_page(size_t end_row) {
+    size_t count = end_row - sealed_values_;
+    size_t bytes = 0;
+    if (is_fixed_width()) {
+        bytes = count * value_size_;
+    } else {
+        for (size_t i = sealed_values_; i < end_row; ++i) {
+            bytes += sizeof(uint32_t) + string_at(i).size();
+        }
+    }
+
     PageHeader header;
-    header.page_size = current_page_.size();
-    header.num_values = num_values_;
-    header.compression_type = 0;  // No compression for now
+    header.page_size = static_cast<uint32_t>(bytes);
+    header.num_values = static_cast<uint32_t>(count);
+    header.compression_type = 0;  // No compression for in-memory pages
     header.encoding_type = 0;
-    header.data_size = current_page_.size();
-    header.compressed_size = current_page_.size();
-    
-    pages_.push_back(current_page_);
+    header.data_size = static_cast<uint32_t>(bytes);
+    header.compressed_size = static_cast<uint32_t>(bytes);
+
+    page_starts_.push_back(sealed_values_);
     page_headers_.push_back(header);
-    current_page_.clear();
-    
+    sealed_values_ = end_row;
+
     update_stats();
 }
 
-const std::vector<uint8_t>& Column::get_page(size_t page_idx) const {
-    if (page_idx >= pages_.size()) {
+void Column::rebuild_pages() {
+    // Re-chunk after rows were removed; page boundaries are logical only
+    size_t page_rows = is_fixed_width()
+        ? LYRADB_DEFAULT_PAGE_SIZE / value_size_
+        : kStringPageRows;
+    size_t sealed_target = std::min(sealed_values_, num_values_);
+
+    page_starts_.clear();
+    page_headers_.clear();
+    sealed_values_ = 0;
+    while (sealed_values_ < sealed_target) {
+        seal_page(std::min(sealed_values_ + page_rows, sealed_target));
+    }
+    rebuild_zone_map(0);
+}
+
+void Column::rebuild_zone_map(size_t first_page) {
+    // One zone per sealed page from first_page on, then one for the open tail
+    zone_map_.truncate(first_page);
+    size_t page = first_page;
+    size_t start = page < page_starts_.size() ? page_starts_[page] : sealed_values_;
+    for (size_t row = start; row < num_values_; ++row) {
+        if (is_null(row)) {
+            zone_map_.add_null();
+        } else if (is_fixed_width()) {
+            zone_map_.add_value(values_.data() + row * value_size_);
+        } else {
+            zone_map_.add_string(string_at(row));
+        }
+        if (page < page_starts_.size() &&
+            row + 1 == page_starts_[page] + page_headers_[page].num_values) {
+            zone_map_.seal();
+            ++page;
+        }
+    }
+    update_stats();
+}
+
+std::vector<uint8_t> Column::get_page(size_t page_idx) const {
+    if (page_idx >= page_headers_.size()) {
         throw std::out_of_range("Page index out of range");
     }
-    return pages_[page_idx];
+    size_t start = page_starts_[page_idx];
+    size_t count = page_headers_[page_idx].num_values;
+
+    if (is_fixed_width()) {
+        const uint8_t* begin = values_.data() + start * value_size_;
+        return std::vector<uint8_t>(begin, begin + count * value_size_);
+    }
+
+    // Strings: [uint32 length][bytes] per value
+    std::vector<uint8_t> page;
+    page.reserve(page_headers_[page_idx].data_size);
+    for (size_t i = start; i < start + count; ++i) {
+        const std::string& value = string_at(i);
+        uint32_t len = static_cast<uint32_t>(value.size());
+        const uint8_t* len_bytes = reinterpret_cast<const uint8_t*>(&len);
+        page.insert(page.end(), len_bytes, len_bytes + sizeof(len));
+        page.insert(page.end(), value.begin(), value.end());
+    }
+    return page;
+}
+
+std::string Column::get_string(size_t row) const {
+    if (is_null(row)) {
+        return "";
+    }
+    if (!is_fixed_width()) {
+        return string_at(row);
+    }
+    return format_slot(type_, values_.data() + row * value_size_);
+}
+
+std::string Column::canonical_string(DataType type, const std::string& column,
+                                     const std::string& text) {
+    bool fixed_width = Type::size_bytes(type) > 0;
+    if (text.empty() || (fixed_width && iequals(text, "NULL"))) {
+        return "";
+    }
+    if (!fixed_width) {
+        return text;
+    }
+    uint8_t slot[8] = {0};
+    parse_into(type, column, text, slot);
+    return format_slot(type, slot);
+}
+
+std::string Column::format_slot(DataType type, const uint8_t* slot) {
+    switch (type) {
+        case DataType::INT32:
+        case DataType::DATE32: {
+            int32_t v;
+            std::memcpy(&v, slot, sizeof(v));
+            return format_number(v);
+        }
+        case DataType::INT64:
+        case DataType::TIMESTAMP: {
+            int64_t v;
+            std::memcpy(&v, slot, sizeof(v));
+            return format_number(v);
+        }
+        case DataType::FLOAT32: {
+            float v;
+            std::memcpy(&v, slot, sizeof(v));
+            return format_number(v);
+        }
+        case DataType::FLOAT64: {
+            double v;
+            std::memcpy(&v, slot, sizeof(v));
+            return format_number(v);
+        }
+        case DataType::BOOL:
+            return *slot ? "true" : "false";
+        default:
+            return "";
+    }
+}
+
+void Column::parse_into(DataType type, const std::string& column, const std::string& text,
+                        uint8_t* slot) {
+    bool ok = false;
+    switch (type) {
+        case DataType::INT32:
+        case DataType::DATE32: {
+            int32_t v = 0;
+            ok = parse_integer(text, v);
+            std::memcpy(slot, &v, sizeof(v));
+            break;
+        }
+        case DataType::INT64:
+        case DataType::TIMESTAMP: {
+            int64_t v = 0;
+            ok = parse_integer(text, v);
+            std::memcpy(slot, &v, sizeof(v));
+            break;
+        }
+        case DataType::FLOAT32: {
+            float v = 0;
+            ok = parse_floating(text, v);
+            std::memcpy(slot, &v, sizeof(v));
+            break;
+        }
+        case DataType::FLOAT64: {
+            double v = 0;
+            ok = parse_floating(text, v);
+            std::memcpy(slot, &v, sizeof(v));
+            break;
+        }
+        case DataType::BOOL: {
+            if (iequals(text, "TRUE") || text == "1") {
+                *slot = 1;
+                ok = true;
+            } else if (iequals(text, "FALSE") || text == "0") {
+                *slot = 0;
+                ok = true;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    if (!ok) {
+        throw std::runtime_error("Invalid " + Type::to_string(type) +
+                                 " value for column '" + column + "': " + text);
+    }
 }
 
 void Column::update_stats() {
-    // TODO: Implement statistics calculation
-    // - min/max values
-    // - null count
-    // - distinct count
-    // - bloom filter generation
+    // Column-wide integer min/max roll up from the zones
+    stats_.null_count = static_cast<uint32_t>(null_count_);
+    if (!is_fixed_width() || type_ == DataType::FLOAT32 || type_ == DataType::FLOAT64) {
+        return;
+    }
+    bool first = true;
+    for (const auto& zone : zone_map_.zones()) {
+        if (!zone.has_values) {
+            continue;
+        }
+        stats_.min_value = first ? zone.min_int : std::min(stats_.min_value, zone.min_int);
+        stats_.max_value = first ? zone.max_int : std::max(stats_.max_value, zone.max_int);
+        first = false;
+    }
 }
 
 std::vector<uint8_t> Column::compress_page(const std::vector<uint8_t>& data) {
@@ -71,15 +541,227 @@ std::vector<uint8_t> Column::compress_page(const std::vector<uint8_t>& data) {
 }
 
 std::vector<uint8_t> Column::serialize() const {
-    // TODO: Implement serialization to .lycol format
-    std::vector<uint8_t> result;
-    return result;
+    // Layout: magic, version, type, name, row count, page row counts,
+    // null bitmap, values, zone map. Integers are little-endian.
+    std::vector<uint8_t> out;
+    put_pod<uint32_t>(out, storage::LYCOL_MAGIC);
+    put_pod<uint32_t>(out, storage::LYCOL_VERSION);
+    put_pod<uint8_t>(out, static_cast<uint8_t>(type_));
+    put_pod<uint16_t>(out, static_cast<uint16_t>(name_.size()));
+    out.insert(out.end(), name_.begin(), name_.end());
+    put_pod<uint64_t>(out, num_values_);
+
+    put_pod<uint32_t>(out, static_cast<uint32_t>(page_headers_.size()));
+    for (const auto& header : page_headers_) {
+        put_pod<uint32_t>(out, header.num_values);
+    }
+
+    put_pod<uint64_t>(out, null_count_);
+    if (null_count_ != 0) {
+        out.insert(out.end(), nulls_.data(), nulls_.data() + nulls_.byte_size());
+    }
+
+    if (is_fixed_width()) {
+        out.insert(out.end(), values_.begin(), values_.begin() + num_values_ * value_size_);
+    } else {
+        for (size_t i = 0; i < num_values_; ++i) {
+            const std::string& value = string_at(i);
+            put_pod<uint32_t>(out, static_cast<uint32_t>(value.size()));
+            out.insert(out.end(), value.begin(), value.end());
+        }
+    }
+
+    std::vector<uint8_t> zones = zone_map_.serialize();
+    put_pod<uint32_t>(out, static_cast<uint32_t>(zones.size()));
+    out.insert(out.end(), zones.begin(), zones.end());
+    return out;
 }
 
 Column Column::deserialize(const std::vector<uint8_t>& data) {
-    // TODO: Implement deserialization from .lycol format
-    Column col("", DataType::INT32);
+    size_t pos = 0;
+    auto need = [&](size_t bytes) {
+        if (data.size() - pos < bytes) {
+            throw std::runtime_error("Truncated column data");
+        }
+    };
+    auto get = [&](auto& value) {
+        need(sizeof(value));
+        std::memcpy(&value, data.data() + pos, sizeof(value));
+        pos += sizeof(value);
+    };
+
+    uint32_t magic = 0, version = 0;
+    get(magic);
+    get(version);
+    if (magic != storage::LYCOL_MAGIC || version != storage::LYCOL_VERSION) {
+        throw std::runtime_error("Not a .lycol column image");
+    }
+    uint8_t type = 0;
+    uint16_t name_len = 0;
+    get(type);
+    get(name_len);
+    need(name_len);
+    std::string name(reinterpret_cast<const char*>(data.data() + pos), name_len);
+    pos += name_len;
+    uint64_t num_values = 0;
+    get(num_values);
+
+    Column col(name, static_cast<DataType>(type), static_cast<size_t>(num_values));
+    uint32_t num_pages = 0;
+    get(num_pages);
+    std::vector<uint32_t> page_rows(num_pages);
+    for (auto& rows : page_rows) {
+        get(rows);
+    }
+
+    uint64_t null_count = 0;
+    get(null_count);
+    col.num_values_ = static_cast<size_t>(num_values);
+    col.null_count_ = static_cast<size_t>(null_count);
+    col.nulls_.resize(col.num_values_);
+    if (null_count != 0) {
+        size_t bytes = (col.num_values_ + 7) / 8;
+        need(bytes);
+        for (size_t i = 0; i < col.num_values_; ++i) {
+            if (data[pos + i / 8] & (1u << (i % 8))) {
+                col.nulls_.set_null(i, true);
+            }
+        }
+        pos += bytes;
+    }
+
+    if (col.is_fixed_width()) {
+        size_t bytes = col.num_values_ * col.value_size_;
+        need(bytes);
+        col.values_.assign(data.begin() + pos, data.begin() + pos + bytes);
+        pos += bytes;
+    } else {
+        col.strings_.resize(col.num_values_);
+        for (auto& value : col.strings_) {
+            uint32_t len = 0;
+            get(len);
+            need(len);
+            value.assign(reinterpret_cast<const char*>(data.data() + pos), len);
+            pos += len;
+        }
+    }
+
+    for (uint32_t rows : page_rows) {
+        if (rows == 0 || col.num_values_ - col.sealed_values_ < rows) {
+            throw std::runtime_error("Corrupt page table in column '" + name + "'");
+        }
+        col.seal_page(col.sealed_values_ + rows);
+    }
+
+    // Zone map is stored, so pruning works without rescanning the values
+    uint32_t zone_bytes = 0;
+    get(zone_bytes);
+    need(zone_bytes);
+    col.zone_map_ = indexes::ZoneMapIndex::deserialize(data.data() + pos, zone_bytes);
+    col.update_stats();
     return col;
 }
 
+std::vector<uint8_t> Column::serialize_rows(size_t begin, size_t end) const {
+    if (begin > end || end > num_values_) {
+        throw std::out_of_range("Row range out of bounds");
+    }
+    size_t count = end - begin;
+    size_t nulls = 0;
+    for (size_t i = begin; null_count_ != 0 && i < end; ++i) {
+        if (nulls_.is_null(i)) nulls++;
+    }
+
+    std::vector<uint8_t> out;
+    put_pod<uint32_t>(out, static_cast<uint32_t>(count));
+    put_pod<uint32_t>(out, static_cast<uint32_t>(nulls));
+    if (nulls != 0) {
+        size_t offset = out.size();
+        out.resize(offset + (count + 7) / 8, 0);
+        for (size_t i = 0; i < count; ++i) {
+            if (nulls_.is_null(begin + i)) {
+                out[offset + i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+            }
+        }
+    }
+
+    if (is_fixed_width()) {
+        out.insert(out.end(), values_.begin() + begin * value_size_,
+                   values_.begin() + end * value_size_);
+    } else {
+        for (size_t i = begin; i < end; ++i) {
+            const std::string& value = string_at(i);
+            put_pod<uint32_t>(out, static_cast<uint32_t>(value.size()));
+            out.insert(out.end(), value.begin(), value.end());
+        }
+    }
+    return out;
+}
+
+void Column::append_rows(const uint8_t* data, size_t size) {
+    decode();
+    size_t pos = 0;
+    auto need = [&](size_t bytes) {
+        if (size - pos < bytes) {
+            throw std::runtime_error("Truncated row segment in column '" + name_ + "'");
+        }
+    };
+    auto get_u32 = [&]() {
+        uint32_t value = 0;
+        need(sizeof(value));
+        std::memcpy(&value, data + pos, sizeof(value));
+        pos += sizeof(value);
+        return value;
+    };
+
+    size_t count = get_u32();
+    size_t nulls = get_u32();
+    const uint8_t* null_bits = nullptr;
+    if (nulls != 0) {
+        need((count + 7) / 8);
+        null_bits = data + pos;
+        pos += (count + 7) / 8;
+    }
+
+    // Values go in first so a malformed segment leaves the column as it was
+    if (is_fixed_width()) {
+        need(count * value_size_);
+        values_.insert(values_.end(), data + pos, data + pos + count * value_size_);
+        pos += count * value_size_;
+    } else {
+        size_t old_size = strings_.size();
+        try {
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t len = get_u32();
+                need(len);
+                strings_.emplace_back(reinterpret_cast<const char*>(data + pos), len);
+                pos += len;
+            }
+        } catch (...) {
+            strings_.resize(old_size);
+            throw;
+        }
+    }
+
+    size_t first = num_values_;
+    num_values_ += count;
+    nulls_.resize(num_values_);
+    for (size_t i = 0; null_bits != nullptr && i < count; ++i) {
+        if (null_bits[i / 8] & (1u << (i % 8))) {
+            nulls_.set_null(first + i, true);
+        }
+    }
+    null_count_ += nulls;
+
+    // Seal the pages the segment filled, then redo zones from the old tail on
+    size_t first_page = page_starts_.size();
+    size_t page_rows = is_fixed_width()
+        ? LYRADB_DEFAULT_PAGE_SIZE / value_size_
+        : kStringPageRows;
+    while (num_values_ - sealed_values_ >= page_rows) {
+        seal_page(sealed_values_ + page_rows);
+    }
+    rebuild_zone_map(first_page);
+}
+
 } // namespace lyradb
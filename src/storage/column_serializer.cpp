@@ -4,69 +4,515 @@
 #include "lyradb/dict_compressor.h"
 #include "lyradb/bitpacking_compressor.h"
 #include "lyradb/delta_compressor.h"
+#include "lyradb/pfor_compressor.h"
+#include "lyradb/fsst_compressor.h"
 #include "lyradb/zstd_compressor.h"
+#include "lyradb/table_format.h"
+#include "lyradb/mapped_file.h"
 #include <fstream>
+#include <filesystem>
 #include <algorithm>
 #include <cstring>
+#include <stdexcept>
 
 using namespace lyradb::compression;
 
 namespace lyradb {
 namespace storage {
 
+namespace {
+
+// RLE over raw page bytes works on 8-byte words
+constexpr size_t kRleWordSize = 8;
+
+// Footer: page index offset + magic
+constexpr size_t kFooterSize = sizeof(uint64_t) + sizeof(uint32_t);
+
+template <typename T>
+void put(std::vector<uint8_t>& out, T value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void put_string16(std::vector<uint8_t>& out, const std::string& value) {
+    put<uint16_t>(out, static_cast<uint16_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+// PFOR pages hold a Column::serialize_rows() segment of 4- or 8-byte
+// integers: the [count][nulls][null bitmap] prefix is kept raw and the
+// values are PFOR-coded. Payload: [value_size (1)][prefix_size (4)]
+// [prefix][PFOR data]
+constexpr size_t kPforPageHeader = 1 + sizeof(uint32_t);
+
+/**
+ * @brief Locate the values of an integer row segment
+ * @return false if the segment does not hold 4- or 8-byte values
+ */
+bool integer_segment(const uint8_t* data, size_t size, size_t& prefix_size, size_t& value_size) {
+    if (size < 2 * sizeof(uint32_t)) {
+        return false;
+    }
+    uint32_t count;
+    uint32_t nulls;
+    std::memcpy(&count, data, sizeof(count));
+    std::memcpy(&nulls, data + sizeof(count), sizeof(nulls));
+    prefix_size = 2 * sizeof(uint32_t) + (nulls != 0 ? (size_t(count) + 7) / 8 : 0);
+    if (count == 0 || size < prefix_size) {
+        return false;
+    }
+    value_size = (size - prefix_size) / count;
+    return (value_size == 4 || value_size == 8) && prefix_size + count * value_size == size;
+}
+
+std::vector<uint8_t> encode_pfor_segment(const uint8_t* data, size_t size) {
+    size_t prefix_size;
+    size_t value_size;
+    if (!integer_segment(data, size, prefix_size, value_size)) {
+        return {};
+    }
+    size_t count = (size - prefix_size) / value_size;
+    std::vector<int64_t> values(count);
+    const uint8_t* in = data + prefix_size;
+    for (size_t i = 0; i < count; ++i, in += value_size) {
+        if (value_size == 4) {
+            int32_t v;
+            std::memcpy(&v, in, sizeof(v));
+            values[i] = v;
+        } else {
+            std::memcpy(&values[i], in, sizeof(int64_t));
+        }
+    }
+
+    std::vector<uint8_t> payload;
+    put<uint8_t>(payload, static_cast<uint8_t>(value_size));
+    put<uint32_t>(payload, static_cast<uint32_t>(prefix_size));
+    payload.insert(payload.end(), data, data + prefix_size);
+    std::vector<uint8_t> packed = PforCompressor::compress(values.data(), count);
+    payload.insert(payload.end(), packed.begin(), packed.end());
+    return payload;
+}
+
+std::vector<uint8_t> decode_pfor_segment(const uint8_t* payload, size_t size) {
+    if (size < kPforPageHeader) {
+        throw std::runtime_error("Corrupt PFOR page");
+    }
+    uint8_t value_size = payload[0];
+    uint32_t prefix_size;
+    std::memcpy(&prefix_size, payload + 1, sizeof(prefix_size));
+    if ((value_size != 4 && value_size != 8) || size - kPforPageHeader < prefix_size) {
+        throw std::runtime_error("Corrupt PFOR page");
+    }
+    const uint8_t* packed = payload + kPforPageHeader + prefix_size;
+    size_t packed_size = size - kPforPageHeader - prefix_size;
+    std::vector<int64_t> values = PforCompressor::decompress(packed, packed_size);
+
+    std::vector<uint8_t> data(payload + kPforPageHeader, packed);
+    data.resize(prefix_size + values.size() * value_size);
+    uint8_t* out = data.data() + prefix_size;
+    for (size_t i = 0; i < values.size(); ++i, out += value_size) {
+        if (value_size == 4) {
+            int32_t v = static_cast<int32_t>(values[i]);
+            std::memcpy(out, &v, sizeof(v));
+        } else {
+            std::memcpy(out, &values[i], sizeof(int64_t));
+        }
+    }
+    return data;
+}
+
+// Dictionary pages hold a Column::serialize_rows() segment of strings:
+// the prefix is kept raw and the values are dictionary-coded with an
+// order-preserving dictionary. Payload: [prefix_size (4)][prefix]
+// [dictionary data]
+
+/**
+ * @brief Split a string row segment into its prefix and values
+ * @return false if the segment is not a sequence of length-prefixed strings
+ */
+bool string_segment(const uint8_t* data, size_t size, size_t& prefix_size,
+                    std::vector<std::string>& values) {
+    if (size < 2 * sizeof(uint32_t)) {
+        return false;
+    }
+    uint32_t count;
+    uint32_t nulls;
+    std::memcpy(&count, data, sizeof(count));
+    std::memcpy(&nulls, data + sizeof(count), sizeof(nulls));
+    prefix_size = 2 * sizeof(uint32_t) + (nulls != 0 ? (size_t(count) + 7) / 8 : 0);
+    if (size < prefix_size || (size - prefix_size) / sizeof(uint32_t) < count) {
+        return false;
+    }
+    size_t pos = prefix_size;
+    values.clear();
+    values.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t len;
+        if (size - pos < sizeof(len)) {
+            return false;
+        }
+        std::memcpy(&len, data + pos, sizeof(len));
+        pos += sizeof(len);
+        if (size - pos < len) {
+            return false;
+        }
+        values.emplace_back(reinterpret_cast<const char*>(data + pos), len);
+        pos += len;
+    }
+    return pos == size;
+}
+
+std::vector<uint8_t> encode_dictionary_segment(const uint8_t* data, size_t size) {
+    size_t prefix_size;
+    std::vector<std::string> values;
+    if (!string_segment(data, size, prefix_size, values)) {
+        return {};
+    }
+    std::vector<uint8_t> payload;
+    put<uint32_t>(payload, static_cast<uint32_t>(prefix_size));
+    payload.insert(payload.end(), data, data + prefix_size);
+    std::vector<uint8_t> dict = DictionaryCompressor::compress(values, true);
+    payload.insert(payload.end(), dict.begin(), dict.end());
+    return payload;
+}
+
+std::vector<uint8_t> decode_dictionary_segment(const uint8_t* payload, size_t size) {
+    uint32_t prefix_size;
+    if (size < sizeof(prefix_size)) {
+        throw std::runtime_error("Corrupt dictionary page");
+    }
+    std::memcpy(&prefix_size, payload, sizeof(prefix_size));
+    if (size - sizeof(prefix_size) < prefix_size) {
+        throw std::runtime_error("Corrupt dictionary page");
+    }
+    const uint8_t* dict = payload + sizeof(prefix_size) + prefix_size;
+    auto decoded = DictionaryCompressor::decode(dict, size - sizeof(prefix_size) - prefix_size);
+
+    std::vector<uint8_t> data(payload + sizeof(prefix_size), dict);
+    for (uint32_t code : decoded.codes) {
+        const std::string& value = decoded.dictionary[code];
+        put<uint32_t>(data, static_cast<uint32_t>(value.size()));
+        data.insert(data.end(), value.begin(), value.end());
+    }
+    return data;
+}
+
+// FSST pages share the dictionary page layout, with FSST data after the
+// prefix: [prefix_size (4)][prefix][FSST data]
+
+std::vector<uint8_t> encode_fsst_segment(const uint8_t* data, size_t size) {
+    size_t prefix_size;
+    std::vector<std::string> values;
+    if (!string_segment(data, size, prefix_size, values)) {
+        return {};
+    }
+    std::vector<uint8_t> payload;
+    put<uint32_t>(payload, static_cast<uint32_t>(prefix_size));
+    payload.insert(payload.end(), data, data + prefix_size);
+    std::vector<uint8_t> fsst = FsstCompressor::compress(values);
+    payload.insert(payload.end(), fsst.begin(), fsst.end());
+    return payload;
+}
+
+std::vector<uint8_t> decode_fsst_segment(const uint8_t* payload, size_t size) {
+    uint32_t prefix_size;
+    if (size < sizeof(prefix_size)) {
+        throw std::runtime_error("Corrupt FSST page");
+    }
+    std::memcpy(&prefix_size, payload, sizeof(prefix_size));
+    if (size - sizeof(prefix_size) < prefix_size) {
+        throw std::runtime_error("Corrupt FSST page");
+    }
+    const uint8_t* fsst = payload + sizeof(prefix_size) + prefix_size;
+    FsstCompressor::Decoder decoder(fsst, size - sizeof(prefix_size) - prefix_size);
+
+    // Values decode straight into the segment
+    std::vector<uint8_t> data(payload + sizeof(prefix_size), fsst);
+    for (size_t i = 0; i < decoder.size(); ++i) {
+        size_t length = decoder.value_length(i);
+        put<uint32_t>(data, static_cast<uint32_t>(length));
+        size_t pos = data.size();
+        data.resize(pos + length);
+        decoder.decode_into(i, reinterpret_cast<char*>(data.data() + pos), length);
+    }
+    return data;
+}
+
+/**
+ * @brief Bounds-checked little-endian reader over a byte buffer
+ */
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        need(sizeof(T));
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    std::string get_string16() {
+        uint16_t len = get<uint16_t>();
+        need(len);
+        std::string value(reinterpret_cast<const char*>(data_ + pos_), len);
+        pos_ += len;
+        return value;
+    }
+
+    size_t position() const { return pos_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+
+    void need(size_t bytes) const {
+        if (size_ - pos_ < bytes) {
+            throw std::runtime_error("Truncated .lycol metadata");
+        }
+    }
+};
+
+std::vector<uint8_t> serialize_metadata(const TableMetadata& metadata) {
+    std::vector<uint8_t> out;
+    put_string16(out, metadata.table_name);
+    put<uint64_t>(out, metadata.row_count);
+    put<uint32_t>(out, metadata.column_count);
+    put<uint8_t>(out, metadata.compression_enabled ? 1 : 0);
+    put<uint32_t>(out, static_cast<uint32_t>(metadata.columns.size()));
+    for (const auto& col : metadata.columns) {
+        put<uint32_t>(out, col.column_id);
+        put<uint8_t>(out, col.data_type);
+        put_string16(out, std::string(col.name.begin(), col.name.end()));
+        put<uint32_t>(out, col.null_count);
+        put<int64_t>(out, col.min_value);
+        put<int64_t>(out, col.max_value);
+        put<uint32_t>(out, col.distinct_count);
+        put<uint32_t>(out, col.page_count);
+    }
+    return out;
+}
+
+TableMetadata deserialize_metadata(const std::vector<uint8_t>& data) {
+    TableMetadata metadata;
+    metadata.magic = LYCOL_MAGIC;
+    metadata.version = LYCOL_VERSION;
+    metadata.checksum = 0;
+    metadata.row_count = 0;
+    metadata.column_count = 0;
+    metadata.compression_enabled = false;
+    if (data.empty()) {
+        return metadata;
+    }
+    ByteReader in(data.data(), data.size());
+    metadata.table_name = in.get_string16();
+    metadata.row_count = in.get<uint64_t>();
+    metadata.column_count = in.get<uint32_t>();
+    metadata.compression_enabled = in.get<uint8_t>() != 0;
+    uint32_t defs = in.get<uint32_t>();
+    for (uint32_t i = 0; i < defs; ++i) {
+        ColumnDefinition col;
+        col.column_id = in.get<uint32_t>();
+        col.data_type = in.get<uint8_t>();
+        std::string name = in.get_string16();
+        col.name_length = static_cast<uint16_t>(name.size());
+        col.name.assign(name.begin(), name.end());
+        col.null_count = in.get<uint32_t>();
+        col.min_value = in.get<int64_t>();
+        col.max_value = in.get<int64_t>();
+        col.distinct_count = in.get<uint32_t>();
+        col.page_count = in.get<uint32_t>();
+        metadata.columns.push_back(std::move(col));
+    }
+    return metadata;
+}
+
+} // namespace
+
 // ======================== ColumnWriter ========================
 
 ColumnWriter::ColumnWriter(const std::string& filepath, uint32_t column_id, uint8_t data_type)
     : filepath_(filepath), column_id_(column_id), data_type_(data_type),
       page_count_(0), bytes_written_(0) {
+    file_.open(filepath_, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filepath_);
+    }
 }
 
-void ColumnWriter::write_table_metadata(const TableMetadata& metadata) {
-    // Metadata writing deferred - placeholder implementation
-    // TODO: Implement proper metadata serialization
-    std::ofstream file(filepath_, std::ios::binary);
-    if (!file.is_open()) {
+ColumnWriter::ColumnWriter(const std::string& filepath, uint32_t column_id, uint8_t data_type,
+                           uint64_t committed_size)
+    : filepath_(filepath), column_id_(column_id), data_type_(data_type),
+      page_count_(0), bytes_written_(committed_size), header_written_(true) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(filepath_, ec);
+    if (ec || size < committed_size) {
+        throw std::runtime_error("Column file is shorter than its committed size: " + filepath_);
+    }
+    std::filesystem::resize_file(filepath_, committed_size, ec);
+    if (ec) {
+        throw std::runtime_error("Failed to open file: " + filepath_);
+    }
+    file_.open(filepath_, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file_.is_open()) {
         throw std::runtime_error("Failed to open file: " + filepath_);
     }
-    bytes_written_ += 512;  // Reserve 512 bytes for metadata
+    file_.seekp(static_cast<std::streamoff>(committed_size));
 }
 
-void ColumnWriter::write_page(
+ColumnWriter::~ColumnWriter() {
+    if (!finalized_) {
+        try {
+            finalize();
+        } catch (...) {
+            // Suppress exceptions in destructor
+        }
+    }
+}
+
+void ColumnWriter::write_table_metadata(const TableMetadata& metadata) {
+    if (header_written_) {
+        throw std::runtime_error("Table metadata must be written before any page: " + filepath_);
+    }
+    write_header(&metadata);
+}
+
+ColumnWriter::EncodedPage ColumnWriter::encode_page(
     const uint8_t* data,
     size_t size,
-    uint32_t row_count,
     uint8_t compression_algo) {
-    
+
     if (!data || size == 0) {
         throw std::runtime_error("Invalid page data");
     }
-    
-    // Simplified write - just store uncompressed for now
-    std::vector<uint8_t> page_data(data, data + size);
-    
+
+    EncodedPage page;
+    page.original_size = size;
+    auto algo = static_cast<CompressionAlgorithm>(compression_algo);
+    switch (algo) {
+        case CompressionAlgorithm::PFOR:
+            page.payload = encode_pfor_segment(data, size);
+            break;
+        case CompressionAlgorithm::DICTIONARY:
+            page.payload = encode_dictionary_segment(data, size);
+            break;
+        case CompressionAlgorithm::FSST:
+            page.payload = encode_fsst_segment(data, size);
+            break;
+        default:
+            break;
+    }
+    bool typed = !page.payload.empty();  // Empty: not a segment of that type
+    if (!typed && algo == CompressionAlgorithm::RLE && size % kRleWordSize == 0) {
+        page.payload = RLECompressor::compress(data, size, kRleWordSize);
+    } else if (!typed && algo != CompressionAlgorithm::UNCOMPRESSED) {
+        algo = CompressionAlgorithm::ZSTD;
+        page.payload = ZstdCompressor(3).compress(data, size);
+    }
+
+    // Keep the raw bytes when compression does not pay off
+    if (algo == CompressionAlgorithm::UNCOMPRESSED || page.payload.size() >= size) {
+        algo = CompressionAlgorithm::UNCOMPRESSED;
+        page.payload.assign(data, data + size);
+    }
+    page.compression_algo = static_cast<uint8_t>(algo);
+    page.crc32 = format_utils::calculate_table_checksum(page.payload.data(), page.payload.size());
+    return page;
+}
+
+void ColumnWriter::write_page(
+    const uint8_t* data,
+    size_t size,
+    uint32_t row_count,
+    uint8_t compression_algo) {
+
+    write_encoded_page(encode_page(data, size, compression_algo), row_count);
+}
+
+void ColumnWriter::write_encoded_page(const EncodedPage& page, uint32_t row_count) {
+    write_encoded_page(page, row_count, page_count_);
+}
+
+void ColumnWriter::write_encoded_page(const EncodedPage& page, uint32_t row_count,
+                                      uint64_t page_id) {
+    if (finalized_) {
+        throw std::runtime_error("Cannot write to finalized column file: " + filepath_);
+    }
+    if (!header_written_) {
+        write_header(nullptr);
+    }
+
+    PageHeader header{};
+    header.magic = PageHeader::MAGIC;
+    header.page_id = page_id;
+    header.column_id = column_id_;
+    header.row_count = row_count;
+    header.compression_algo = page.compression_algo;
+    header.compression_ratio_pct = page.original_size == 0 ? 100 :
+        static_cast<uint32_t>(page.payload.size() * 100 / page.original_size);
+    header.original_size = page.original_size;
+    header.compressed_size = page.payload.size();
+    header.crc32_checksum = page.crc32;
+
+    PageMetadata meta{};
+    meta.page_id = page_id;
+    meta.column_id = column_id_;
+    meta.row_count = row_count;
+    meta.file_offset = bytes_written_;
+    meta.page_size = page.payload.size();
+    meta.compression.algorithm = page.compression_algo;
+    meta.compression.original_bytes = page.original_size;
+    meta.compression.compressed_bytes = page.payload.size();
+    meta.compression.compression_ratio = page.original_size == 0 ? 1.0 :
+        static_cast<double>(page.payload.size()) / page.original_size;
+
+    write_bytes(&header, sizeof(header));
+    write_bytes(page.payload.data(), page.payload.size());
+    page_index_.push_back(meta);
+    page_count_++;
+}
+
+void ColumnWriter::add_page(const PageMetadata& page) {
+    if (finalized_) {
+        throw std::runtime_error("Cannot write to finalized column file: " + filepath_);
+    }
+    page_index_.push_back(page);
     page_count_++;
-    bytes_written_ += size;
 }
 
 void ColumnWriter::finalize() {
-    std::ofstream file(filepath_, std::ios::binary | std::ios::app);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file for finalization");
-    }
-    
-    // Write page index (simplified - write page count and offsets)
-    uint32_t index_size = page_index_.size();
-    file.write((char*)&index_size, sizeof(uint32_t));
-    
+    if (finalized_) {
+        return;
+    }
+    if (!header_written_) {
+        write_header(nullptr);
+    }
+
+    // Page index, then its offset and the magic so readers can find it from the end
+    std::stable_sort(page_index_.begin(), page_index_.end(),
+                     [](const PageMetadata& a, const PageMetadata& b) { return a.page_id < b.page_id; });
+    std::vector<uint8_t> index;
+    put<uint32_t>(index, static_cast<uint32_t>(page_index_.size()));
     for (const auto& page : page_index_) {
-        file.write((char*)&page.page_id, sizeof(uint64_t));
-        file.write((char*)&page.file_offset, sizeof(uint64_t));
-        file.write((char*)&page.page_size, sizeof(uint64_t));
+        put<uint64_t>(index, page.page_id);
+        put<uint32_t>(index, page.row_count);
+        put<uint64_t>(index, page.file_offset);
+        put<uint64_t>(index, page.page_size);
+        put<uint64_t>(index, page.compression.original_bytes);
+        put<uint8_t>(index, page.compression.algorithm);
     }
-    
-    if (!file) {
+    put<uint64_t>(index, bytes_written_);
+    put<uint32_t>(index, LYCOL_MAGIC);
+    write_bytes(index.data(), index.size());
+
+    file_.close();
+    if (!file_) {
         throw std::runtime_error("Failed to write file index");
     }
+    finalized_ = true;
 }
 
 uint64_t ColumnWriter::current_offset() const {
@@ -77,22 +523,63 @@ uint64_t ColumnWriter::total_bytes_written() const {
     return bytes_written_;
 }
 
-uint32_t ColumnWriter::calculate_crc32(const uint8_t* data, size_t size) {
-    // Simplified CRC32 calculation
-    uint32_t crc = 0xFFFFFFFF;
-    for (size_t i = 0; i < size; ++i) {
-        crc = (crc >> 8) ^ ((crc ^ data[i]) & 0xFF);
+void ColumnWriter::write_header(const TableMetadata* metadata) {
+    std::vector<uint8_t> header;
+    put<uint32_t>(header, LYCOL_MAGIC);
+    put<uint32_t>(header, LYCOL_VERSION);
+    put<uint32_t>(header, column_id_);
+    put<uint8_t>(header, data_type_);
+    std::vector<uint8_t> meta = metadata ? serialize_metadata(*metadata) : std::vector<uint8_t>();
+    put<uint32_t>(header, static_cast<uint32_t>(meta.size()));
+    header.insert(header.end(), meta.begin(), meta.end());
+    write_bytes(header.data(), header.size());
+    header_written_ = true;
+}
+
+void ColumnWriter::write_bytes(const void* data, size_t size) {
+    file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    if (!file_) {
+        throw std::runtime_error("Failed to write column file: " + filepath_);
     }
-    return crc ^ 0xFFFFFFFF;
+    bytes_written_ += size;
 }
 
 // ======================== ColumnReader ========================
 
-ColumnReader::ColumnReader(const std::string& filepath)
-    : filepath_(filepath), is_valid_(true) {
-    // Simplified - just mark as valid without reading metadata
+ColumnReader::ColumnReader(const std::string& filepath, uint64_t committed_size)
+    : filepath_(filepath), committed_size_(committed_size), is_valid_(false) {
+    try {
+        map_ = std::make_unique<MappedFile>(filepath_);
+    } catch (const std::exception&) {
+        throw std::runtime_error("Failed to open column file: " + filepath_);
+    }
+
+    // Fixed header: magic, version, column id, data type, metadata size
+    constexpr size_t kFixedHeaderSize = 17;
+    if (map_->size() < kFixedHeaderSize) {
+        throw std::runtime_error("Not a .lycol file: " + filepath_);
+    }
+    ByteReader in(map_->data(), map_->size());
+    uint32_t magic = in.get<uint32_t>();
+    uint32_t version = in.get<uint32_t>();
+    if (magic != LYCOL_MAGIC || version != LYCOL_VERSION) {
+        throw std::runtime_error("Not a .lycol file: " + filepath_);
+    }
+    column_id_ = in.get<uint32_t>();
+    data_type_ = in.get<uint8_t>();
+    uint32_t meta_size = in.get<uint32_t>();
+    if (map_->size() - in.position() < meta_size) {
+        throw std::runtime_error("Truncated .lycol header: " + filepath_);
+    }
+    const uint8_t* meta = map_->data() + in.position();
+    metadata_ = deserialize_metadata(std::vector<uint8_t>(meta, meta + meta_size));
+
+    load_index();
+    is_valid_ = true;
 }
 
+ColumnReader::~ColumnReader() = default;
+
 TableMetadata ColumnReader::read_table_metadata() {
     if (!is_valid_) {
         throw std::runtime_error("File is invalid");
@@ -104,9 +591,47 @@ std::vector<uint8_t> ColumnReader::read_page(uint32_t page_index) {
     if (page_index >= page_index_.size()) {
         throw std::runtime_error("Invalid page index");
     }
-    
-    // Simplified - just return empty vector for now
+    const PageMetadata& meta = page_index_[page_index];
+
+    // Pages are read straight out of the mapping; the OS faults them in
+    // on first touch, so untouched pages cost no I/O
+    PageHeader header;
+    std::memcpy(&header, map_->data() + meta.file_offset, sizeof(header));
+    const uint8_t* payload = map_->data() + meta.file_offset + sizeof(header);
+
+    if (!header.is_valid() || header.compressed_size != meta.page_size) {
+        throw std::runtime_error("Corrupt page header in " + filepath_);
+    }
+    if (!verify_crc32(payload, meta.page_size, header.crc32_checksum)) {
+        throw std::runtime_error("Page checksum mismatch in " + filepath_);
+    }
+
     std::vector<uint8_t> data;
+    switch (static_cast<CompressionAlgorithm>(header.compression_algo)) {
+        case CompressionAlgorithm::UNCOMPRESSED:
+            data.assign(payload, payload + meta.page_size);
+            break;
+        case CompressionAlgorithm::RLE:
+            data = RLECompressor::decompress(payload, meta.page_size, kRleWordSize);
+            break;
+        case CompressionAlgorithm::ZSTD:
+            data = ZstdCompressor::decompress(payload, meta.page_size);
+            break;
+        case CompressionAlgorithm::PFOR:
+            data = decode_pfor_segment(payload, meta.page_size);
+            break;
+        case CompressionAlgorithm::DICTIONARY:
+            data = decode_dictionary_segment(payload, meta.page_size);
+            break;
+        case CompressionAlgorithm::FSST:
+            data = decode_fsst_segment(payload, meta.page_size);
+            break;
+        default:
+            throw std::runtime_error("Unsupported page compression in " + filepath_);
+    }
+    if (data.size() != header.original_size) {
+        throw std::runtime_error("Page size mismatch in " + filepath_);
+    }
     return data;
 }
 
@@ -143,8 +668,45 @@ bool ColumnReader::validate() {
 }
 
 void ColumnReader::load_index() {
-    // Simplified index loading - in production would be more robust
     page_index_.clear();
+
+    // Later versions may have been appended; this one ends at its footer
+    uint64_t file_size = committed_size_ != 0 ? committed_size_ : map_->size();
+    if (file_size > map_->size()) {
+        throw std::runtime_error("Column file is shorter than its committed size: " + filepath_);
+    }
+    if (file_size < kFooterSize) {
+        throw std::runtime_error("Missing page index in " + filepath_);
+    }
+    ByteReader tail(map_->data() + file_size - kFooterSize, kFooterSize);
+    uint64_t index_offset = tail.get<uint64_t>();
+    if (tail.get<uint32_t>() != LYCOL_MAGIC || index_offset > file_size - kFooterSize) {
+        throw std::runtime_error("Missing page index in " + filepath_ + " (file not finalized?)");
+    }
+
+    ByteReader in(map_->data() + index_offset, file_size - kFooterSize - index_offset);
+    uint32_t count = in.get<uint32_t>();
+    for (uint32_t i = 0; i < count; ++i) {
+        PageMetadata meta{};
+        meta.column_id = column_id_;
+        meta.page_id = in.get<uint64_t>();
+        meta.row_count = in.get<uint32_t>();
+        meta.file_offset = in.get<uint64_t>();
+        meta.page_size = in.get<uint64_t>();
+        meta.compression.original_bytes = in.get<uint64_t>();
+        meta.compression.algorithm = in.get<uint8_t>();
+        meta.compression.compressed_bytes = meta.page_size;
+        meta.compression.compression_ratio = meta.compression.original_bytes == 0 ? 1.0 :
+            static_cast<double>(meta.page_size) / meta.compression.original_bytes;
+        if (meta.file_offset + sizeof(PageHeader) + meta.page_size > index_offset) {
+            throw std::runtime_error("Corrupt page index in " + filepath_);
+        }
+        page_index_.push_back(meta);
+    }
+}
+
+bool ColumnReader::verify_crc32(const uint8_t* data, size_t size, uint32_t expected_crc) {
+    return format_utils::calculate_table_checksum(data, size) == expected_crc;
 }
 
 } // namespace storage
@@ -3,6 +3,8 @@
 #include "lyradb/dict_compressor.h"
 #include "lyradb/bitpacking_compressor.h"
 #include "lyradb/delta_compressor.h"
+#include "lyradb/pfor_compressor.h"
+#include "lyradb/fsst_compressor.h"
 
 namespace lyradb {
 namespace compression {
@@ -36,8 +38,15 @@ CompressionAlgorithm CompressionSelector::select_for_integers(
         best_algo = CompressionAlgorithm::BITPACKING;
     }
     
-    // Use ZSTD as fallback if compression is beneficial
-    if (best_ratio > min_compression_ratio) {
+    // Try PFOR (bounded ranges with outliers, PFOR-delta for sorted data)
+    double pfor_ratio = PforCompressor::estimate_compression_ratio(values, count);
+    if (pfor_ratio < best_ratio) {
+        best_ratio = pfor_ratio;
+        best_algo = CompressionAlgorithm::PFOR;
+    }
+    
+    // Check if ratio meets threshold
+    if (best_ratio <= min_compression_ratio) {
         return best_algo;
     }
     
@@ -90,7 +99,15 @@ CompressionAlgorithm CompressionSelector::select_for_strings(
         }
     }
     
-    // Fall back to ZSTD for high-cardinality strings
+    // FSST for high-cardinality strings: values stay individually readable
+    if (FsstCompressor::is_suitable(values)) {
+        double ratio = FsstCompressor::estimate_compression_ratio(values);
+        if (ratio <= min_compression_ratio) {
+            return CompressionAlgorithm::FSST;
+        }
+    }
+    
+    // Fall back to ZSTD for strings neither codec helps
     return CompressionAlgorithm::ZSTD;
 }
 
@@ -108,6 +125,10 @@ const char* CompressionSelector::algorithm_name(CompressionAlgorithm algo) {
             return "Delta Encoding";
         case CompressionAlgorithm::ZSTD:
             return "ZSTD";
+        case CompressionAlgorithm::PFOR:
+            return "Patched Frame of Reference";
+        case CompressionAlgorithm::FSST:
+            return "FSST";
         default:
             return "Unknown";
     }
@@ -144,6 +165,13 @@ double CompressionSelector::estimate_ratio(
             return DeltaCompressor::estimate_compression_ratio(values, count);
         }
             
+        case CompressionAlgorithm::PFOR: {
+            if (length % sizeof(int64_t) != 0) return 1.0;
+            auto* values = reinterpret_cast<const int64_t*>(data);
+            size_t count = length / sizeof(int64_t);
+            return PforCompressor::estimate_compression_ratio(values, count);
+        }
+            
         case CompressionAlgorithm::UNCOMPRESSED:
         case CompressionAlgorithm::ZSTD:
         case CompressionAlgorithm::DICTIONARY:
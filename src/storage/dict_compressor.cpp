@@ -1,122 +1,158 @@
 #include "lyradb/dict_compressor.h"
+#include "lyradb/bitpacking_compressor.h"
 #include <algorithm>
 #include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
 
 namespace lyradb {
 namespace compression {
 
+namespace {
+
+void put_u32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(value & 0xFF);
+    out.push_back((value >> 8) & 0xFF);
+    out.push_back((value >> 16) & 0xFF);
+    out.push_back((value >> 24) & 0xFF);
+}
+
+uint32_t get_u32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+} // namespace
+
+DictionaryCompressor::Decoded DictionaryCompressor::encode(
+    const std::vector<std::string>& values,
+    bool order_preserving) {
+    
+    Decoded result;
+    result.sorted = order_preserving;
+    result.codes.resize(values.size());
+    
+    // One hash lookup per value; keys view the input strings
+    std::unordered_map<std::string_view, uint32_t> ids;
+    for (size_t i = 0; i < values.size(); ++i) {
+        auto inserted = ids.emplace(values[i], static_cast<uint32_t>(result.dictionary.size()));
+        if (inserted.second) {
+            result.dictionary.push_back(values[i]);
+        }
+        result.codes[i] = inserted.first->second;
+    }
+    
+    if (order_preserving) {
+        std::vector<uint32_t> order(result.dictionary.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return result.dictionary[a] < result.dictionary[b];
+        });
+        std::vector<uint32_t> remap(order.size());
+        std::vector<std::string> sorted(order.size());
+        for (uint32_t code = 0; code < order.size(); ++code) {
+            remap[order[code]] = code;
+            sorted[code] = std::move(result.dictionary[order[code]]);
+        }
+        result.dictionary = std::move(sorted);
+        for (auto& code : result.codes) {
+            code = remap[code];
+        }
+    }
+    
+    return result;
+}
+
 std::vector<uint8_t> DictionaryCompressor::compress(
-    const std::vector<std::string>& values) {
+    const std::vector<std::string>& values,
+    bool order_preserving) {
     
     if (values.empty()) {
         return {};
     }
     
     // Build dictionary
-    auto dict = build_dictionary(values);
+    Decoded encoded = encode(values, order_preserving);
     
     std::vector<uint8_t> result;
     
-    // Write dictionary header: number of entries
-    uint32_t dict_size = dict.size();
-    result.push_back(dict_size & 0xFF);
-    result.push_back((dict_size >> 8) & 0xFF);
-    result.push_back((dict_size >> 16) & 0xFF);
-    result.push_back((dict_size >> 24) & 0xFF);
-    
-    // Write dictionary entries
-    for (const auto& entry : dict) {
-        // Key length (2 bytes)
-        uint16_t key_len = entry.key.length();
-        result.push_back(key_len & 0xFF);
-        result.push_back((key_len >> 8) & 0xFF);
-        
-        // Key bytes
-        result.insert(result.end(), entry.key.begin(), entry.key.end());
-        
-        // Value ID (4 bytes)
-        uint32_t id = entry.id;
-        result.push_back(id & 0xFF);
-        result.push_back((id >> 8) & 0xFF);
-        result.push_back((id >> 16) & 0xFF);
-        result.push_back((id >> 24) & 0xFF);
-    }
+    // Write dictionary header: number of entries and flags
+    put_u32(result, static_cast<uint32_t>(encoded.dictionary.size()));
+    result.push_back(order_preserving ? kSortedFlag : 0);
     
-    // Write compressed values (IDs only)
-    for (const auto& value : values) {
-        // Find ID for this value
-        uint32_t id = 0;
-        for (const auto& entry : dict) {
-            if (entry.key == value) {
-                id = entry.id;
-                break;
-            }
-        }
-        
-        result.push_back(id & 0xFF);
-        result.push_back((id >> 8) & 0xFF);
-        result.push_back((id >> 16) & 0xFF);
-        result.push_back((id >> 24) & 0xFF);
+    // Write dictionary entries in code order
+    for (const auto& key : encoded.dictionary) {
+        put_u32(result, static_cast<uint32_t>(key.size()));
+        result.insert(result.end(), key.begin(), key.end());
     }
     
+    // Write compressed values: codes packed to the dictionary's bit width
+    std::vector<int64_t> codes(encoded.codes.begin(), encoded.codes.end());
+    std::vector<uint8_t> packed = BitpackingCompressor::compress(codes.data(), codes.size());
+    result.insert(result.end(), packed.begin(), packed.end());
+    
     return result;
 }
 
-std::vector<std::string> DictionaryCompressor::decompress(
-    const uint8_t* data, 
+DictionaryCompressor::Decoded DictionaryCompressor::decode(
+    const uint8_t* data,
     size_t length) {
     
-    if (!data || length < 4) {
-        return {};
+    Decoded result;
+    if (!data || length == 0) {
+        return result;
+    }
+    if (length < kHeaderSize) {
+        throw std::runtime_error("Corrupt dictionary data");
     }
-    
-    std::vector<std::string> result;
-    size_t pos = 0;
-    
-    // Read dictionary size
-    uint32_t dict_size = 
-        data[pos] | 
-        (data[pos + 1] << 8) | 
-        (data[pos + 2] << 16) | 
-        (data[pos + 3] << 24);
-    pos += 4;
     
     // Read dictionary
-    std::vector<std::string> dict(dict_size);
+    uint32_t dict_size = get_u32(data);
+    result.sorted = (data[4] & kSortedFlag) != 0;
+    size_t pos = kHeaderSize;
+    result.dictionary.reserve(std::min<size_t>(dict_size, length / 4));
     for (uint32_t i = 0; i < dict_size; ++i) {
-        if (pos + 2 > length) return result;
-        
-        uint16_t key_len = data[pos] | (data[pos + 1] << 8);
-        pos += 2;
-        
-        if (pos + key_len > length) return result;
-        
-        dict[i] = std::string(
-            reinterpret_cast<const char*>(data + pos), 
-            key_len);
-        pos += key_len;
-        
-        // Skip ID (4 bytes)
+        if (length - pos < 4) {
+            throw std::runtime_error("Corrupt dictionary data");
+        }
+        uint32_t key_len = get_u32(data + pos);
         pos += 4;
+        if (length - pos < key_len) {
+            throw std::runtime_error("Corrupt dictionary data");
+        }
+        result.dictionary.emplace_back(reinterpret_cast<const char*>(data + pos), key_len);
+        pos += key_len;
     }
     
-    // Read and decompress values
-    while (pos + 4 <= length) {
-        uint32_t id = 
-            data[pos] | 
-            (data[pos + 1] << 8) | 
-            (data[pos + 2] << 16) | 
-            (data[pos + 3] << 24);
-        pos += 4;
-        
-        if (id < dict.size()) {
-            result.push_back(dict[id]);
+    // Unpack codes through the bitpacking kernels
+    size_t count = BitpackingCompressor::value_count(data + pos, length - pos);
+    result.codes.resize(count);
+    BitpackingCompressor::decompress_into(data + pos, length - pos,
+                                          reinterpret_cast<int32_t*>(result.codes.data()));
+    for (uint32_t code : result.codes) {
+        if (code >= dict_size) {
+            throw std::runtime_error("Corrupt dictionary data");
         }
     }
     
     return result;
 }
 
+std::vector<std::string> DictionaryCompressor::decompress(
+    const uint8_t* data,
+    size_t length) {
+    
+    Decoded decoded = decode(data, length);
+    std::vector<std::string> result;
+    result.reserve(decoded.codes.size());
+    for (uint32_t code : decoded.codes) {
+        result.push_back(decoded.dictionary[code]);
+    }
+    return result;
+}
+
 double DictionaryCompressor::estimate_compression_ratio(
     const std::vector<std::string>& values) {
     
@@ -124,29 +160,27 @@ double DictionaryCompressor::estimate_compression_ratio(
         return 1.0;
     }
     
-    // Count unique values
-    std::unordered_map<std::string, uint32_t> freq;
-    for (const auto& val : values) {
-        freq[val]++;
-    }
-    
     // Original size: sum of all string lengths
     size_t original_size = 0;
+    std::unordered_set<std::string_view> unique;
     for (const auto& val : values) {
         original_size += val.length();
+        unique.insert(val);
+    }
+    if (original_size == 0) {
+        return 1.0;
     }
     
     // Compressed size estimate:
-    // - Dictionary header: 4 bytes
-    // - Dict entries: sum of (2 + key_len + 4) for each unique value
-    // - Values: 4 bytes * num_values (IDs only)
-    
-    size_t dict_size = 4;  // Header
-    for (const auto& [key, _] : freq) {
-        dict_size += 2 + key.length() + 4;  // len + key + id
+    // - Dictionary header and entries: len + key for each unique value
+    // - Values: bitpacking header + one code of ceil(log2(unique)) bits each
+    size_t dict_size = kHeaderSize;
+    for (const auto& key : unique) {
+        dict_size += 4 + key.length();
     }
-    
-    size_t value_size = values.size() * 4;  // IDs
+    size_t code_bits = BitpackingCompressor::calculate_bit_width(
+        static_cast<int64_t>(unique.size()) - 1);
+    size_t value_size = 13 + (values.size() * code_bits + 7) / 8;
     size_t total_compressed = dict_size + value_size;
     
     return static_cast<double>(total_compressed) / original_size;
@@ -161,44 +195,14 @@ bool DictionaryCompressor::is_suitable(
     }
     
     // Count unique values
-    std::unordered_map<std::string, uint32_t> freq;
+    std::unordered_set<std::string_view> unique;
     for (const auto& val : values) {
-        freq[val]++;
+        unique.insert(val);
     }
     
-    double cardinality = static_cast<double>(freq.size()) / values.size();
+    double cardinality = static_cast<double>(unique.size()) / values.size();
     return cardinality < cardinality_threshold;
 }
 
-std::vector<DictionaryCompressor::DictEntry> 
-DictionaryCompressor::build_dictionary(
-    const std::vector<std::string>& values) {
-    
-    std::unordered_map<std::string, uint32_t> freq;
-    for (const auto& val : values) {
-        freq[val]++;
-    }
-    
-    std::vector<DictEntry> dict;
-    uint32_t id = 0;
-    
-    for (auto& [key, frequency] : freq) {
-        dict.push_back({key, id++, frequency});
-    }
-    
-    // Sort by frequency (descending) for better compression
-    std::sort(dict.begin(), dict.end(),
-        [](const DictEntry& a, const DictEntry& b) {
-            return a.frequency > b.frequency;
-        });
-    
-    // Update IDs after sorting
-    for (uint32_t i = 0; i < dict.size(); ++i) {
-        dict[i].id = i;
-    }
-    
-    return dict;
-}
-
 } // namespace compression
 } // namespace lyradb
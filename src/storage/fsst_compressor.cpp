@@ -0,0 +1,363 @@
+#include "lyradb/fsst_compressor.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace lyradb {
+namespace compression {
+
+namespace {
+
+void put_u32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(value & 0xFF);
+    out.push_back((value >> 8) & 0xFF);
+    out.push_back((value >> 16) & 0xFF);
+    out.push_back((value >> 24) & 0xFF);
+}
+
+uint32_t get_u32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// Up to 8 bytes at p as a little-endian word, zero-filled past the end
+inline uint64_t load_word(const char* p, size_t rest) {
+    uint64_t word = 0;
+    std::memcpy(&word, p, std::min<size_t>(rest, 8));
+    return word;
+}
+
+inline uint64_t length_mask(size_t length) {
+    return length >= 8 ? ~uint64_t(0) : (uint64_t(1) << (8 * length)) - 1;
+}
+
+constexpr size_t kHeaderSize = 4 + 1;
+
+} // namespace
+
+// ============================================================================
+// Symbol table (encoding side)
+// ============================================================================
+
+FsstCompressor::SymbolTable::SymbolTable(std::vector<std::string> table)
+    : symbols(std::move(table)) {
+    for (size_t code = 0; code < symbols.size(); ++code) {
+        const std::string& symbol = symbols[code];
+        words[code] = load_word(symbol.data(), symbol.size());
+        by_first[static_cast<uint8_t>(symbol[0])].push_back(static_cast<uint8_t>(code));
+    }
+    for (auto& codes : by_first) {
+        std::stable_sort(codes.begin(), codes.end(), [&](uint8_t a, uint8_t b) {
+            return symbols[a].size() > symbols[b].size();
+        });
+    }
+}
+
+size_t FsstCompressor::SymbolTable::match(const char* p, size_t rest, uint8_t& code) const {
+    const std::vector<uint8_t>& candidates = by_first[static_cast<uint8_t>(*p)];
+    if (candidates.empty()) {
+        return 0;
+    }
+    const uint64_t word = load_word(p, rest);
+    for (uint8_t candidate : candidates) {
+        size_t length = symbols[candidate].size();
+        if (length <= rest && (word & length_mask(length)) == words[candidate]) {
+            code = candidate;
+            return length;
+        }
+    }
+    return 0;
+}
+
+void FsstCompressor::SymbolTable::encode(const std::string& value, std::vector<uint8_t>& out) const {
+    const char* p = value.data();
+    size_t rest = value.size();
+    while (rest > 0) {
+        uint8_t code;
+        size_t length = match(p, rest, code);
+        if (length == 0) {
+            out.push_back(kEscape);
+            out.push_back(static_cast<uint8_t>(*p));
+            length = 1;
+        } else {
+            out.push_back(code);
+        }
+        p += length;
+        rest -= length;
+    }
+}
+
+size_t FsstCompressor::SymbolTable::serialized_size() const {
+    size_t size = 1 + symbols.size();
+    for (const auto& symbol : symbols) {
+        size += symbol.size();
+    }
+    return size;
+}
+
+// ============================================================================
+// Training
+// ============================================================================
+
+std::vector<const std::string*> FsstCompressor::sample(const std::vector<std::string>& values) {
+    size_t total = 0;
+    for (const auto& value : values) {
+        total += value.size();
+    }
+    // Every stride-th value, spread over the whole input
+    size_t stride = std::max<size_t>(1, (total + kSampleBytes - 1) / kSampleBytes);
+    std::vector<const std::string*> result;
+    result.reserve(values.size() / stride + 1);
+    for (size_t i = 0; i < values.size(); i += stride) {
+        result.push_back(&values[i]);
+    }
+    return result;
+}
+
+FsstCompressor::SymbolTable FsstCompressor::train(const std::vector<const std::string*>& sample) {
+    std::vector<std::string> symbols;
+    std::unordered_map<std::string_view, size_t> counts;
+    for (size_t generation = 0; generation < kGenerations; ++generation) {
+        // Count symbols (or escaped bytes) the current table emits, and
+        // adjacent pairs: the candidates for the next generation
+        SymbolTable table(symbols);
+        counts.clear();
+        for (const std::string* value : sample) {
+            const char* p = value->data();
+            size_t rest = value->size();
+            std::string_view previous;
+            while (rest > 0) {
+                uint8_t code;
+                size_t length = std::max<size_t>(1, table.match(p, rest, code));
+                std::string_view token(p, length);
+                counts[token]++;
+                if (!previous.empty() && previous.size() + length <= kMaxSymbolLength) {
+                    counts[std::string_view(previous.data(), previous.size() + length)]++;
+                }
+                previous = token;
+                p += length;
+                rest -= length;
+            }
+        }
+
+        // Keep the candidates that save the most bytes
+        std::vector<std::pair<size_t, std::string_view>> candidates;
+        candidates.reserve(counts.size());
+        for (const auto& entry : counts) {
+            candidates.emplace_back(entry.second * entry.first.size(), entry.first);
+        }
+        size_t keep = std::min(kMaxSymbols, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(),
+                          [](const auto& a, const auto& b) {
+                              if (a.first != b.first) return a.first > b.first;
+                              if (a.second.size() != b.second.size()) {
+                                  return a.second.size() > b.second.size();
+                              }
+                              return a.second < b.second;
+                          });
+        symbols.clear();
+        for (size_t i = 0; i < keep; ++i) {
+            symbols.emplace_back(candidates[i].second);
+        }
+    }
+    return SymbolTable(std::move(symbols));
+}
+
+// ============================================================================
+// Compression
+// ============================================================================
+
+std::vector<uint8_t> FsstCompressor::compress(const std::vector<std::string>& values) {
+    if (values.empty()) {
+        return {};
+    }
+
+    SymbolTable table = train(sample(values));
+
+    std::vector<uint8_t> result;
+    put_u32(result, static_cast<uint32_t>(values.size()));
+    result.push_back(static_cast<uint8_t>(table.symbols.size()));
+    for (const auto& symbol : table.symbols) {
+        result.push_back(static_cast<uint8_t>(symbol.size()));
+    }
+    for (const auto& symbol : table.symbols) {
+        result.insert(result.end(), symbol.begin(), symbol.end());
+    }
+
+    // Offsets are known only once the codes are written
+    std::vector<uint8_t> codes;
+    std::vector<uint32_t> offsets;
+    offsets.reserve(values.size() + 1);
+    offsets.push_back(0);
+    for (const auto& value : values) {
+        table.encode(value, codes);
+        offsets.push_back(static_cast<uint32_t>(codes.size()));
+    }
+    result.reserve(result.size() + offsets.size() * 4 + codes.size());
+    for (uint32_t offset : offsets) {
+        put_u32(result, offset);
+    }
+    result.insert(result.end(), codes.begin(), codes.end());
+    return result;
+}
+
+std::vector<std::string> FsstCompressor::decompress(
+    const uint8_t* data,
+    size_t length) {
+
+    std::vector<std::string> result;
+    if (!data || length == 0) {
+        return result;
+    }
+    Decoder decoder(data, length);
+    result.resize(decoder.size());
+    for (size_t i = 0; i < decoder.size(); ++i) {
+        result[i].resize(decoder.value_length(i));
+        decoder.decode_into(i, &result[i][0], result[i].size());
+    }
+    return result;
+}
+
+double FsstCompressor::estimate_compression_ratio(const std::vector<std::string>& values) {
+    size_t original_size = 0;
+    for (const auto& value : values) {
+        original_size += value.size();
+    }
+    if (original_size == 0) {
+        return 1.0;
+    }
+
+    // Encode the training sample and scale up to the whole input
+    std::vector<const std::string*> values_sample = sample(values);
+    SymbolTable table = train(values_sample);
+    std::vector<uint8_t> codes;
+    size_t sample_size = 0;
+    for (const std::string* value : values_sample) {
+        table.encode(*value, codes);
+        sample_size += value->size();
+    }
+    if (sample_size == 0) {
+        return 1.0;
+    }
+    double code_bytes = static_cast<double>(codes.size()) * original_size / sample_size;
+    double compressed = 4 + table.serialized_size() + 4.0 * (values.size() + 1) + code_bytes;
+    return compressed / original_size;
+}
+
+bool FsstCompressor::is_suitable(const std::vector<std::string>& values) {
+    if (values.empty()) {
+        return false;
+    }
+    size_t total = 0;
+    for (const auto& value : values) {
+        total += value.size();
+    }
+    return total >= kMinAverageLength * values.size();
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+FsstCompressor::Decoder::Decoder(const uint8_t* data, size_t length) {
+    if (!data || length < kHeaderSize) {
+        throw std::runtime_error("Corrupt FSST data");
+    }
+    count_ = get_u32(data);
+    size_t num_symbols = data[4];
+    size_t pos = kHeaderSize;
+    if (length - pos < num_symbols) {
+        throw std::runtime_error("Corrupt FSST data");
+    }
+    const uint8_t* symbol_lengths = data + pos;
+    pos += num_symbols;
+    for (size_t code = 0; code < num_symbols; ++code) {
+        size_t symbol_length = symbol_lengths[code];
+        if (symbol_length == 0 || symbol_length > kMaxSymbolLength || length - pos < symbol_length) {
+            throw std::runtime_error("Corrupt FSST data");
+        }
+        lengths_[code] = static_cast<uint8_t>(symbol_length);
+        symbols_[code] = load_word(reinterpret_cast<const char*>(data + pos), symbol_length);
+        pos += symbol_length;
+    }
+
+    if ((length - pos) / 4 < count_ + 1) {
+        throw std::runtime_error("Corrupt FSST data");
+    }
+    offsets_ = data + pos;
+    pos += 4 * (count_ + 1);
+    codes_ = data + pos;
+    codes_size_ = length - pos;
+    if (get_u32(offsets_) != 0 || get_u32(offsets_ + 4 * count_) != codes_size_) {
+        throw std::runtime_error("Corrupt FSST data");
+    }
+}
+
+void FsstCompressor::Decoder::code_range(size_t index, size_t& begin, size_t& end) const {
+    if (index >= count_) {
+        throw std::out_of_range("FSST value index out of range");
+    }
+    begin = get_u32(offsets_ + 4 * index);
+    end = get_u32(offsets_ + 4 * (index + 1));
+    if (begin > end || end > codes_size_) {
+        throw std::runtime_error("Corrupt FSST data");
+    }
+}
+
+size_t FsstCompressor::Decoder::value_length(size_t index) const {
+    size_t begin;
+    size_t end;
+    code_range(index, begin, end);
+    size_t length = 0;
+    for (size_t i = begin; i < end; ++i) {
+        uint8_t code = codes_[i];
+        if (code == kEscape) {
+            if (++i == end) {
+                throw std::runtime_error("Corrupt FSST data");
+            }
+            length += 1;
+        } else if (lengths_[code] == 0) {
+            throw std::runtime_error("Corrupt FSST data");
+        } else {
+            length += lengths_[code];
+        }
+    }
+    return length;
+}
+
+void FsstCompressor::Decoder::decode_into(size_t index, char* out, size_t length) const {
+    size_t begin;
+    size_t end;
+    code_range(index, begin, end);
+    size_t pos = 0;
+    for (size_t i = begin; i < end; ++i) {
+        uint8_t code = codes_[i];
+        if (code == kEscape) {
+            if (i + 1 == end || pos >= length) {
+                return;
+            }
+            out[pos++] = static_cast<char>(codes_[++i]);
+            continue;
+        }
+        size_t symbol_length = lengths_[code];
+        if (length - pos >= 8) {
+            // Whole-word store; the bytes past the symbol are overwritten next
+            std::memcpy(out + pos, &symbols_[code], 8);
+        } else {
+            std::memcpy(out + pos, &symbols_[code], std::min(symbol_length, length - pos));
+        }
+        pos += std::min(symbol_length, length - pos);
+    }
+}
+
+std::string FsstCompressor::Decoder::value(size_t index) const {
+    std::string result(value_length(index), '\0');
+    decode_into(index, &result[0], result.size());
+    return result;
+}
+
+} // namespace compression
+} // namespace lyradb
@@ -0,0 +1,34 @@
+#include "lyradb/io_throttle.h"
+#include <thread>
+
+namespace lyradb {
+
+IoThrottle::IoThrottle(uint64_t bytes_per_second)
+    : bytes_per_second_(bytes_per_second), next_(Clock::now()) {}
+
+void IoThrottle::acquire(size_t bytes) {
+    Clock::time_point start;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bytes_acquired_ += bytes;
+        if (bytes_per_second_ == 0) {
+            return;
+        }
+        // Idle time earns at most one second of credit
+        Clock::time_point now = Clock::now();
+        if (next_ < now - std::chrono::seconds(1)) {
+            next_ = now - std::chrono::seconds(1);
+        }
+        start = next_;
+        next_ += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(bytes) / bytes_per_second_));
+    }
+    std::this_thread::sleep_until(start);
+}
+
+uint64_t IoThrottle::bytes_acquired() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_acquired_;
+}
+
+} // namespace lyradb
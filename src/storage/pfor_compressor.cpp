@@ -0,0 +1,263 @@
+#include "lyradb/pfor_compressor.h"
+#include "lyradb/bitpacking_compressor.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace lyradb {
+namespace compression {
+
+namespace {
+
+// Widths above this would leave the block kernels for the scalar path
+constexpr uint8_t kMaxPackedWidth = 32;
+
+// Bits needed to store v (0 for 0)
+uint8_t bit_length(uint64_t v) {
+    uint8_t bits = 0;
+    if (v >> 32) { v >>= 32; bits += 32; }
+    if (v >> 16) { v >>= 16; bits += 16; }
+    if (v >> 8) { v >>= 8; bits += 8; }
+    if (v >> 4) { v >>= 4; bits += 4; }
+    if (v >> 2) { v >>= 2; bits += 2; }
+    if (v >> 1) { v >>= 1; bits += 1; }
+    return static_cast<uint8_t>(bits + v);
+}
+
+// Value i of the packed sequence: the value itself, or in delta mode the
+// difference to the next one (wrapping, so any int64 input round-trips)
+inline int64_t sequence_value(const int64_t* values, size_t i, bool delta) {
+    return delta
+        ? static_cast<int64_t>(static_cast<uint64_t>(values[i + 1]) - static_cast<uint64_t>(values[i]))
+        : values[i];
+}
+
+void put_u32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+uint32_t get_u32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// Size of a BitpackingCompressor array of count values below 2^bit_width
+size_t bitpacked_size(size_t count, size_t bit_width) {
+    return count == 0 ? 0 : 13 + (count * bit_width + 7) / 8;
+}
+
+} // namespace
+
+PforCompressor::Plan PforCompressor::plan_frame(const int64_t* values, size_t count, bool delta,
+                                                int64_t base) {
+    Plan result;
+    result.delta = delta;
+    result.base = base;
+    const size_t n = delta ? count - 1 : count;
+
+    // Histogram of offset bit lengths: the size at every candidate width
+    // follows from it without touching the data again. Values below the
+    // base wrap around and end up as (wide) exceptions.
+    size_t histogram[65] = {0};
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t offset = static_cast<uint64_t>(sequence_value(values, i, delta)) -
+                          static_cast<uint64_t>(base);
+        histogram[bit_length(offset)]++;
+    }
+    uint8_t max_width = 64;
+    while (max_width > 0 && histogram[max_width] == 0) {
+        max_width--;
+    }
+
+    const size_t position_bits = bit_length(n - 1);
+    size_t exceptions = n;
+    size_t best = SIZE_MAX;
+    for (uint8_t b = 0; b <= std::min(max_width, kMaxPackedWidth); ++b) {
+        exceptions -= histogram[b];
+        size_t bytes = bitpacked_size(n, b) +
+                       bitpacked_size(exceptions, position_bits) +
+                       bitpacked_size(exceptions, max_width - b);
+        if (bytes < best) {
+            best = bytes;
+            result.bit_width = b;
+        }
+    }
+    result.bytes = PforHeader::SIZE + best;
+    return result;
+}
+
+PforCompressor::Plan PforCompressor::plan_mode(const int64_t* values, size_t count, bool delta) {
+    const size_t n = delta ? count - 1 : count;
+    if (n == 0) {
+        Plan result;
+        result.delta = delta;
+        result.bytes = PforHeader::SIZE;
+        return result;
+    }
+
+    // Frame at the minimum, or just above the lowest values so that a
+    // few low outliers become exceptions instead of widening every value
+    std::vector<int64_t> sequence(n);
+    for (size_t i = 0; i < n; ++i) {
+        sequence[i] = sequence_value(values, i, delta);
+    }
+    Plan best = plan_frame(values, count, delta, *std::min_element(sequence.begin(), sequence.end()));
+    if (n >= kExceptionQuantile) {
+        auto low = sequence.begin() + n / kExceptionQuantile;
+        std::nth_element(sequence.begin(), low, sequence.end());
+        Plan above = plan_frame(values, count, delta, *low);
+        if (above.bytes < best.bytes) {
+            best = above;
+        }
+    }
+    return best;
+}
+
+PforCompressor::Plan PforCompressor::plan(const int64_t* values, size_t count) {
+    Plan plain = plan_mode(values, count, false);
+    if (count < 2) {
+        return plain;
+    }
+    Plan delta = plan_mode(values, count, true);
+    return delta.bytes < plain.bytes ? delta : plain;
+}
+
+std::vector<uint8_t> PforCompressor::compress(
+    const int64_t* values,
+    size_t count) {
+
+    if (!values || count == 0) {
+        return {};
+    }
+
+    const Plan p = plan(values, count);
+    const size_t n = p.delta ? count - 1 : count;
+    const uint8_t b = p.bit_width;
+    const uint64_t mask = b == 0 ? 0 : (uint64_t(1) << b) - 1;
+
+    const int64_t base = p.base;
+
+    // Low bits of every offset stay in place (framed by the base so the
+    // bitpacked array decodes straight to base + low); the rest of each
+    // outlier becomes an exception
+    std::vector<int64_t> lows(n);
+    std::vector<int64_t> positions;
+    std::vector<int64_t> highs;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t offset = static_cast<uint64_t>(sequence_value(values, i, p.delta)) -
+                          static_cast<uint64_t>(base);
+        lows[i] = static_cast<int64_t>(static_cast<uint64_t>(base) + (offset & mask));
+        if (offset >> b) {
+            positions.push_back(static_cast<int64_t>(i));
+            highs.push_back(static_cast<int64_t>(offset >> b));
+        }
+    }
+
+    std::vector<uint8_t> packed = BitpackingCompressor::compress(lows.data(), n);
+    std::vector<uint8_t> packed_positions = BitpackingCompressor::compress(positions.data(), positions.size());
+    std::vector<uint8_t> packed_highs = BitpackingCompressor::compress(highs.data(), highs.size());
+
+    std::vector<uint8_t> result(PforHeader::SIZE);
+    result[0] = b;
+    result[1] = p.delta ? kDeltaFlag : 0;
+    put_u32(result.data() + 2, static_cast<uint32_t>(count));
+    std::memcpy(result.data() + 6, &values[0], 8);
+    put_u32(result.data() + 14, static_cast<uint32_t>(packed.size()));
+    put_u32(result.data() + 18, static_cast<uint32_t>(packed_positions.size()));
+    result.insert(result.end(), packed.begin(), packed.end());
+    result.insert(result.end(), packed_positions.begin(), packed_positions.end());
+    result.insert(result.end(), packed_highs.begin(), packed_highs.end());
+    return result;
+}
+
+size_t PforCompressor::value_count(const uint8_t* data, size_t length) {
+    if (!data || length < PforHeader::SIZE) {
+        return 0;
+    }
+    return get_u32(data + 2);
+}
+
+std::vector<int64_t> PforCompressor::decompress(
+    const uint8_t* data,
+    size_t length) {
+
+    std::vector<int64_t> result(value_count(data, length));
+    decompress_into(data, length, result.data());
+    return result;
+}
+
+size_t PforCompressor::decompress_into(const uint8_t* data, size_t length, int64_t* out) {
+    size_t count = value_count(data, length);
+    if (count == 0) {
+        return 0;
+    }
+
+    const uint8_t b = data[0];
+    const bool delta = (data[1] & kDeltaFlag) != 0;
+    int64_t first;
+    std::memcpy(&first, data + 6, 8);
+    const size_t packed_size = get_u32(data + 14);
+    const size_t positions_size = get_u32(data + 18);
+    if (b > kMaxPackedWidth || length - PforHeader::SIZE < packed_size ||
+        length - PforHeader::SIZE - packed_size < positions_size) {
+        throw std::runtime_error("Corrupt PFOR data");
+    }
+    const uint8_t* packed = data + PforHeader::SIZE;
+    const uint8_t* packed_positions = packed + packed_size;
+    const uint8_t* packed_highs = packed_positions + positions_size;
+    const size_t highs_size = length - PforHeader::SIZE - packed_size - positions_size;
+
+    // 1. Unpack base + low bits through the block kernels
+    const size_t n = delta ? count - 1 : count;
+    int64_t* sequence = delta ? out + 1 : out;
+    if (BitpackingCompressor::value_count(packed, packed_size) != n) {
+        throw std::runtime_error("Corrupt PFOR data");
+    }
+    BitpackingCompressor::decompress_into(packed, packed_size, sequence);
+
+    // 2. Patch the exceptions' high bits back in
+    if (positions_size > 0) {
+        std::vector<int64_t> positions = BitpackingCompressor::decompress(packed_positions, positions_size);
+        std::vector<int64_t> highs = BitpackingCompressor::decompress(packed_highs, highs_size);
+        if (positions.size() != highs.size()) {
+            throw std::runtime_error("Corrupt PFOR data");
+        }
+        for (size_t e = 0; e < positions.size(); ++e) {
+            uint64_t pos = static_cast<uint64_t>(positions[e]);
+            if (pos >= n) {
+                throw std::runtime_error("Corrupt PFOR data");
+            }
+            sequence[pos] = static_cast<int64_t>(
+                static_cast<uint64_t>(sequence[pos]) + (static_cast<uint64_t>(highs[e]) << b));
+        }
+    }
+
+    // 3. Delta mode: prefix sum from the first value
+    if (delta) {
+        uint64_t running = static_cast<uint64_t>(first);
+        out[0] = first;
+        for (size_t i = 1; i < count; ++i) {
+            running += static_cast<uint64_t>(out[i]);
+            out[i] = static_cast<int64_t>(running);
+        }
+    }
+
+    return count;
+}
+
+double PforCompressor::estimate_compression_ratio(
+    const int64_t* values,
+    size_t count) {
+
+    if (!values || count == 0) {
+        return 1.0;
+    }
+    return static_cast<double>(plan(values, count).bytes) / (count * sizeof(int64_t));
+}
+
+} // namespace compression
+} // namespace lyradb
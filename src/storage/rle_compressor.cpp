@@ -1,4 +1,5 @@
 #include "lyradb/rle_compressor.h"
+#include <cstdint>
 #include <cstring>
 #include <stdexcept>
 
@@ -131,5 +132,31 @@ double RLECompressor::estimate_compression_ratio(
     return ratio;
 }
 
+std::vector<RLECompressor::RLESegment> RLECompressor::analyze_runs(
+    const uint8_t* data, 
+    size_t length, 
+    size_t value_size) {
+    
+    std::vector<RLESegment> runs;
+    if (!data || value_size == 0) {
+        return runs;
+    }
+    
+    size_t num_values = length / value_size;
+    size_t i = 0;
+    while (i < num_values) {
+        const uint8_t* current_value = data + (i * value_size);
+        size_t run_count = 1;
+        while (i + run_count < num_values && run_count < UINT32_MAX &&
+               std::memcmp(current_value, data + ((i + run_count) * value_size), value_size) == 0) {
+            run_count++;
+        }
+        runs.push_back({static_cast<uint32_t>(run_count), current_value});
+        i += run_count;
+    }
+    
+    return runs;
+}
+
 } // namespace compression
 } // namespace lyradb
@@ -5,57 +5,416 @@
 #include <sstream>
 #include <cstring>
 #include <cmath>
+#include <cstdlib>
+#include <charconv>
 
 namespace lyradb {
 
+namespace {
+
+bool parse_int64(const std::string& text, int64_t& out) {
+    auto res = std::from_chars(text.data(), text.data() + text.size(), out);
+    return res.ec == std::errc() && res.ptr == text.data() + text.size();
+}
+
+bool parse_double(const std::string& text, double& out) {
+    char* end = nullptr;
+    out = std::strtod(text.c_str(), &end);
+    return !text.empty() && end == text.c_str() + text.size();
+}
+
+/**
+ * @brief Compare a native column array against a constant
+ * T is the storage type, C the comparison domain; NULL slots never match
+ */
+template <typename T, typename C>
+void filter_native(const Column& col, const T* values, size_t n,
+                   const std::string& op, C constant,
+                   std::vector<size_t>& out) {
+    auto run = [&](auto pred) {
+        for (size_t i = 0; i < n; ++i) {
+            if (pred(static_cast<C>(values[i])) && !col.is_null(i)) {
+                out.push_back(i);
+            }
+        }
+    };
+    
+    if (op == "=") {
+        run([constant](C v) { return v == constant; });
+    } else if (op == "!=") {
+        run([constant](C v) { return v != constant; });
+    } else if (op == "<") {
+        run([constant](C v) { return v < constant; });
+    } else if (op == "<=") {
+        run([constant](C v) { return v <= constant; });
+    } else if (op == ">") {
+        run([constant](C v) { return v > constant; });
+    } else if (op == ">=") {
+        run([constant](C v) { return v >= constant; });
+    }
+}
+
+/**
+ * @brief Append a column's rows to row groups, kRowGroupRows per group
+ * (the groups must end on a full one); encoded columns stay encoded
+ */
+void append_row_groups(Table::RowGroups& groups, const Column& column) {
+    bool encoded = column.is_dictionary_encoded() || !column.run_ends().empty();
+    for (size_t begin = 0; begin < column.num_values(); begin += Table::kRowGroupRows) {
+        size_t end = std::min(column.num_values(), begin + Table::kRowGroupRows);
+        auto group = std::make_shared<Column>(column.name(), column.type(), end - begin);
+        auto segment = column.serialize_rows(begin, end);
+        group->append_rows(segment.data(), segment.size());
+        if (encoded) {
+            group->encode();
+        }
+        groups.push_back(std::move(group));
+    }
+}
+
+}  // namespace
+
 Table::Table(const std::string& name, const Schema& schema)
-    : name_(name), schema_(schema) {
-    // Initialize columns
-    for (size_t i = 0; i < schema_.num_columns(); ++i) {
-        const auto& col_def = schema_.get_column(i);
-        columns_.push_back(std::make_shared<Column>(col_def.name, col_def.type));
+    : name_(name), schema_(schema), columns_(schema.num_columns()),
+      merged_(new LazyColumn[schema.num_columns()]) {
+}
+
+Table::Table(const std::string& name, const Schema& schema,
+             std::vector<std::shared_ptr<Column>> columns)
+    : name_(name), schema_(schema), columns_(columns.size()),
+      merged_(new LazyColumn[columns.size()]) {
+    if (columns.size() != schema_.num_columns()) {
+        throw std::runtime_error("Column count mismatch for table " + name_);
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (!columns[i] || columns[i]->type() != schema_.get_column(i).type) {
+            throw std::runtime_error("Column type mismatch for " + name_ + "." +
+                                     schema_.get_column(i).name);
+        }
+        if (i > 0 && columns[i]->num_values() != columns[0]->num_values()) {
+            throw std::runtime_error("Column length mismatch in table " + name_);
+        }
+    }
+    row_count_ = columns.empty() ? 0 : columns[0]->num_values();
+    column_rows_ = row_count_;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        // A column of one row group is shared as it is
+        if (row_count_ <= kRowGroupRows) {
+            if (row_count_ > 0) {
+                columns_[i].push_back(std::move(columns[i]));
+            }
+        } else {
+            append_row_groups(columns_[i], *columns[i]);
+        }
     }
 }
 
-std::string Table::convert_to_string(void* value, DataType type) const {
-    if (value == nullptr) return "";
-    
-    std::stringstream ss;
-    switch (type) {
-        case DataType::INT32: {
-            int val = *static_cast<int*>(value);
-            ss << val;
-            break;
+Table::Table(const std::string& name, const Schema& schema, size_t row_count,
+             std::vector<ColumnLoader> loaders,
+             std::vector<std::vector<indexes::ZoneMapIndex>> zone_maps)
+    : name_(name), schema_(schema), columns_(loaders.size()), row_count_(row_count),
+      column_rows_(row_count), lazy_(new LazyColumn[loaders.size()]),
+      merged_(new LazyColumn[loaders.size()]) {
+    if (loaders.size() != schema_.num_columns()) {
+        throw std::runtime_error("Column count mismatch for table " + name_);
+    }
+    for (size_t i = 0; i < loaders.size(); ++i) {
+        lazy_[i].loader = std::move(loaders[i]);
+        // Zone maps that do not cover every row group are left unused
+        if (i < zone_maps.size() && zone_maps[i].size() == stored_group_count()) {
+            lazy_[i].zones = std::move(zone_maps[i]);
         }
-        case DataType::INT64: {
-            int64_t val = *static_cast<int64_t*>(value);
-            ss << val;
-            break;
+    }
+}
+
+bool Table::needs_merge() const {
+    return has_delta() || column_rows_ == 0 || column_rows_ > kRowGroupRows;
+}
+
+const std::shared_ptr<Column>& Table::loaded_column(size_t idx) const {
+    // A single row group without a delta is the column itself
+    if (!needs_merge()) {
+        return stored_groups(idx)[0];
+    }
+    LazyColumn& slot = merged_[idx];
+    if (!slot.loaded.load(std::memory_order_acquire)) {
+        std::call_once(slot.once, [&]() {
+            slot.column = merged_column(idx);
+            slot.loaded.store(true, std::memory_order_release);
+        });
+    }
+    return slot.column;
+}
+
+std::shared_ptr<Column> Table::merged_column(size_t idx) const {
+    // A row group the delta does not change is shared, not copied
+    const RowGroups& groups = stored_groups(idx);
+    if (groups.size() == 1 && row_count_ == column_rows_) {
+        bool unchanged = true;
+        const DeltaUpdates& updates = *updates_.at(0);
+        for (auto it = updates.begin(); unchanged && it != updates.end(); ++it) {
+            unchanged = groups[0]->get_string(it->first) == it->second[idx];
         }
-        case DataType::FLOAT32: {
-            float val = *static_cast<float*>(value);
-            ss << val;
-            break;
+        if (unchanged) {
+            return groups[0];
         }
-        case DataType::FLOAT64: {
-            double val = *static_cast<double*>(value);
-            ss << val;
-            break;
+    }
+    const ColumnDef& def = schema_.get_column(idx);
+    auto column = std::make_shared<Column>(def.name, def.type, row_count_);
+    for (const auto& group : groups) {
+        auto segment = group->serialize_rows(0, group->num_values());
+        column->append_rows(segment.data(), segment.size());
+    }
+    for (const auto& updates : updates_) {
+        for (const auto& [row, values] : updates ? *updates : DeltaUpdates()) {
+            column->set_string(row, values[idx]);
         }
-        case DataType::STRING: {
-            const char* val = static_cast<const char*>(value);
-            ss << val;
-            break;
+    }
+    for (const auto& chunk : inserted_) {
+        for (const Row& values : *chunk) {
+            column->append_string(values[idx]);
         }
-        case DataType::BOOL: {
-            bool val = *static_cast<bool*>(value);
-            ss << (val ? "true" : "false");
-            break;
+    }
+    return column;
+}
+
+const Table::RowGroups& Table::stored_groups(size_t idx) const {
+    if (!lazy_) {
+        return columns_[idx];
+    }
+    LazyColumn& slot = lazy_[idx];
+    if (!slot.loaded.load(std::memory_order_acquire)) {
+        std::call_once(slot.once, [&]() {
+            RowGroups groups = slot.loader();
+            size_t rows = 0;
+            for (size_t g = 0; g < groups.size(); ++g) {
+                if (!groups[g] || groups[g]->type() != schema_.get_column(idx).type) {
+                    throw std::runtime_error("Column type mismatch for " + name_ + "." +
+                                             schema_.get_column(idx).name);
+                }
+                if (g + 1 < groups.size() && groups[g]->num_values() != kRowGroupRows) {
+                    throw std::runtime_error("Row group size mismatch in table " + name_);
+                }
+                rows += groups[g]->num_values();
+            }
+            if (rows != column_rows_ || groups.size() != stored_group_count()) {
+                throw std::runtime_error("Column length mismatch in table " + name_);
+            }
+            slot.groups = std::move(groups);
+            slot.loader = nullptr;   // Release the column file
+            slot.loaded.store(true, std::memory_order_release);
+        });
+    }
+    return slot.groups;
+}
+
+const indexes::ZoneMapIndex& Table::zone_map(size_t idx, size_t group) const {
+    if (lazy_ && !lazy_[idx].loaded.load(std::memory_order_acquire) &&
+        group < lazy_[idx].zones.size()) {
+        return lazy_[idx].zones[group];
+    }
+    return stored(idx, group).zone_map();
+}
+
+bool Table::is_column_loaded(size_t idx) const {
+    return !lazy_ || lazy_[idx].loaded.load(std::memory_order_acquire);
+}
+
+void Table::load_all_columns() {
+    if (!lazy_) {
+        return;
+    }
+    // Writes need every column; the slots stay behind for snapshots
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        columns_[i] = stored_groups(i);
+    }
+    lazy_.reset();
+}
+
+std::shared_ptr<Table> Table::snapshot() const {
+    // Readers of the snapshot merge the columns once, into the shared slots
+    return std::shared_ptr<Table>(new Table(*this));
+}
+
+void Table::restore(const Table& version) {
+    mark_dirty(0, std::max(row_count_, version.row_count_));
+    columns_ = version.columns_;
+    lazy_ = version.lazy_;
+    row_count_ = version.row_count_;
+    column_rows_ = version.column_rows_;
+    inserted_ = version.inserted_;
+    updates_ = version.updates_;
+    updated_count_ = version.updated_count_;
+    merged_ = version.merged_;
+    deletes_ = version.deletes_;
+    deleted_count_ = version.deleted_count_;
+    deletes_dirty_ = true;
+}
+
+Column& Table::writable_group(size_t idx, size_t group) {
+    std::shared_ptr<Column>& col = columns_[idx][group];
+    if (col.use_count() > 1) {
+        // A snapshot still reads this version
+        col = std::make_shared<Column>(*col);
+    } else {
+        // Sole owner: whatever the last snapshot read happens before our writes
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *col;
+}
+
+Column& Table::append_group(size_t idx) {
+    RowGroups& groups = columns_[idx];
+    if (groups.empty() || groups.back()->num_values() == kRowGroupRows) {
+        const ColumnDef& def = schema_.get_column(idx);
+        groups.push_back(std::make_shared<Column>(def.name, def.type));
+        return *groups.back();
+    }
+    return writable_group(idx, groups.size() - 1);
+}
+
+Table::DeltaChunk& Table::writable_chunk(size_t chunk) {
+    std::shared_ptr<DeltaChunk>& rows = inserted_[chunk];
+    if (rows.use_count() > 1) {
+        // A snapshot still reads this version
+        rows = std::make_shared<DeltaChunk>(*rows);
+    } else {
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *rows;
+}
+
+Table::DeltaUpdates& Table::writable_updates(size_t group) {
+    if (updates_.size() <= group) {
+        updates_.resize(group + 1);
+    }
+    std::shared_ptr<DeltaUpdates>& updates = updates_[group];
+    if (!updates) {
+        updates = std::make_shared<DeltaUpdates>();
+    } else if (updates.use_count() > 1) {
+        updates = std::make_shared<DeltaUpdates>(*updates);
+    } else {
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *updates;
+}
+
+const Table::Row* Table::delta_row(size_t row_id) const {
+    if (row_id >= column_rows_) {
+        size_t k = row_id - column_rows_;
+        return &inserted_.at(k / kDeltaChunkRows)->at(k % kDeltaChunkRows);
+    }
+    size_t group = row_id / kRowGroupRows;
+    if (group < updates_.size() && updates_[group]) {
+        auto it = updates_[group]->find(row_id);
+        if (it != updates_[group]->end()) {
+            return &it->second;
         }
-        default:
-            ss << "NULL";
     }
-    return ss.str();
+    return nullptr;
+}
+
+std::vector<std::string> Table::canonical_row(const std::vector<std::string>& values) const {
+    std::vector<std::string> row;
+    row.reserve(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        const ColumnDef& def = schema_.get_column(i);
+        row.push_back(Column::canonical_string(def.type, def.name, values[i]));
+    }
+    return row;
+}
+
+void Table::begin_write() {
+    // Once readers merged every column of this version, the next write
+    // folds the delta into the row groups rather than merging it again
+    bool all_merged = has_delta();
+    for (size_t i = 0; all_merged && i < columns_.size(); ++i) {
+        all_merged = merged_[i].loaded.load(std::memory_order_acquire);
+    }
+    // The new version gets its slots now, not on first read: the writer's
+    // own reads and snapshot() calls from readers run concurrently
+    merged_.reset(new LazyColumn[columns_.size()]);
+    if (all_merged) {
+        fold_delta();
+    }
+}
+
+size_t Table::delta_row_count() const {
+    return row_count_ - column_rows_ + updated_count_;
+}
+
+void Table::merge_if_full() {
+    if (delta_row_count() >= kDeltaRows) {
+        merge_delta();
+    }
+}
+
+void Table::merge_delta() {
+    begin_write();
+    fold_delta();
+}
+
+void Table::fold_delta() {
+    if (!has_delta()) {
+        return;
+    }
+    for (size_t g = 0; g < updates_.size(); ++g) {
+        if (updates_[g]) {
+            fold_updates(g);
+        }
+    }
+    updates_.clear();
+    load_all_columns();
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        for (const auto& chunk : inserted_) {
+            for (const Row& values : *chunk) {
+                append_group(i).append_string(values[i]);
+            }
+        }
+    }
+    inserted_.clear();
+    column_rows_ = row_count_;
+}
+
+void Table::fold_updates(size_t group) {
+    load_all_columns();
+    const DeltaUpdates& updates = *updates_[group];
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        // Only the columns whose values change are copied
+        for (const auto& [row, values] : updates) {
+            if (columns_[i][group]->get_string(row % kRowGroupRows) != values[i]) {
+                writable_group(i, group).set_string(row % kRowGroupRows, values[i]);
+            }
+        }
+    }
+    updated_count_ -= updates.size();
+    updates_[group].reset();
+}
+
+void Table::mark_dirty(size_t first_row, size_t end_row) {
+    if (first_row >= end_row) {
+        return;
+    }
+    size_t last_group = (end_row - 1) / kRowGroupRows;
+    if (dirty_.size() <= last_group) {
+        dirty_.resize(last_group + 1, false);
+    }
+    for (size_t g = first_row / kRowGroupRows; g <= last_group; ++g) {
+        dirty_[g] = true;
+    }
+}
+
+std::vector<size_t> Table::dirty_row_groups() const {
+    std::vector<size_t> groups;
+    size_t count = std::min(dirty_.size(), row_group_count());
+    for (size_t g = 0; g < count; ++g) {
+        if (dirty_[g]) groups.push_back(g);
+    }
+    return groups;
+}
+
+bool Table::is_dirty() const {
+    return deletes_dirty_ || std::find(dirty_.begin(), dirty_.end(), true) != dirty_.end();
 }
 
 void Table::insert_row(const std::vector<void*>& values) {
@@ -64,35 +423,149 @@ void Table::insert_row(const std::vector<void*>& values) {
                                  std::to_string(schema_.num_columns()) + 
                                  ", got " + std::to_string(values.size()));
     }
+    merge_delta();
+    load_all_columns();
     
-    // Convert row to string format and store
-    std::vector<std::string> string_row;
-    for (size_t i = 0; i < values.size(); ++i) {
-        const auto& col_def = schema_.get_column(i);
-        string_row.push_back(convert_to_string(values[i], col_def.type));
-    }
-    rows_.push_back(string_row);
-    
-    // Also append to column-oriented storage
     for (size_t i = 0; i < values.size(); ++i) {
         if (values[i] == nullptr) {
-            columns_[i]->append_null();
+            append_group(i).append_null();
         } else {
-            columns_[i]->append_value(values[i]);
+            append_group(i).append_value(values[i]);
         }
     }
+    row_count_++;
+    column_rows_++;
+    mark_dirty(row_count_ - 1, row_count_);
 }
 
 void Table::insert_row(const std::vector<std::string>& values) {
     if (values.size() != schema_.num_columns()) {
         throw std::runtime_error("Row size mismatch");
     }
-    
-    rows_.push_back(values);
+    // Parsed up front, so a bad value leaves the table unchanged
+    std::vector<std::string> row = canonical_row(values);
+    begin_write();
+    if (inserted_.empty() || inserted_.back()->size() == kDeltaChunkRows) {
+        inserted_.push_back(std::make_shared<DeltaChunk>());
+        inserted_.back()->reserve(kDeltaChunkRows);
+    }
+    writable_chunk(inserted_.size() - 1).push_back(std::move(row));
+    row_count_++;
+    mark_dirty(row_count_ - 1, row_count_);
+    merge_if_full();
+}
+
+std::vector<std::string> Table::get_row(size_t row_id) const {
+    if (const Row* row = delta_row(row_id)) {
+        return *row;
+    }
+    std::vector<std::string> row;
+    row.reserve(columns_.size());
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        row.push_back(stored_groups(i).at(row_id / kRowGroupRows)->get_string(row_id % kRowGroupRows));
+    }
+    return row;
+}
+
+std::string Table::get_value(size_t row_id, size_t col) const {
+    if (const Row* row = delta_row(row_id)) {
+        return row->at(col);
+    }
+    return stored_groups(col).at(row_id / kRowGroupRows)->get_string(row_id % kRowGroupRows);
+}
+
+std::vector<size_t> Table::updated_rows() const {
+    std::vector<size_t> rows;
+    rows.reserve(updated_count_);
+    for (const auto& updates : updates_) {
+        for (const auto& entry : updates ? *updates : DeltaUpdates()) {
+            rows.push_back(entry.first);
+        }
+    }
+    return rows;
+}
+
+bool Table::delta_overlaps(size_t begin, size_t end) const {
+    if (begin >= end) {
+        return false;
+    }
+    if (row_count_ > column_rows_ && end > column_rows_ && begin < row_count_) {
+        return true;
+    }
+    end = std::min(end, column_rows_);
+    for (size_t g = begin / kRowGroupRows; begin < end && g < updates_.size(); ++g) {
+        if (g * kRowGroupRows >= end) {
+            break;
+        }
+        if (updates_[g]) {
+            auto it = updates_[g]->lower_bound(begin);
+            if (it != updates_[g]->end() && it->first < end) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::vector<std::shared_ptr<const Column>> Table::delta_columns(
+    size_t begin, size_t end, const std::vector<bool>* bind) const {
+    end = std::min(end, row_count_);
+    begin = std::min(begin, end);
+    size_t stored_end = std::max(begin, std::min(end, column_rows_));
+    std::vector<std::shared_ptr<const Column>> columns;
+    columns.reserve(columns_.size());
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (bind && !(*bind)[i]) {
+            columns.push_back(nullptr);
+            continue;
+        }
+        const ColumnDef& def = schema_.get_column(i);
+        auto column = std::make_shared<Column>(def.name, def.type, end - begin);
+        for (size_t row = begin; row < stored_end;) {
+            size_t group = row / kRowGroupRows;
+            size_t first = group * kRowGroupRows;
+            size_t group_end = std::min(stored_end, first + kRowGroupRows);
+            auto segment = stored_groups(i)[group]->serialize_rows(row - first, group_end - first);
+            column->append_rows(segment.data(), segment.size());
+            if (group < updates_.size() && updates_[group]) {
+                auto it = updates_[group]->lower_bound(row);
+                for (; it != updates_[group]->end() && it->first < group_end; ++it) {
+                    column->set_string(it->first - begin, it->second[i]);
+                }
+            }
+            row = group_end;
+        }
+        for (size_t row = stored_end; row < end; ++row) {
+            column->append_string(inserted_row(row)[i]);
+        }
+        columns.push_back(std::move(column));
+    }
+    return columns;
+}
+
+std::vector<std::shared_ptr<const Column>> Table::row_group(size_t group) const {
+    size_t begin = group * kRowGroupRows;
+    size_t end = std::min(row_count_, begin + kRowGroupRows);
+    if (delta_overlaps(begin, end)) {
+        return delta_columns(begin, end);
+    }
+    std::vector<std::shared_ptr<const Column>> columns;
+    columns.reserve(columns_.size());
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        columns.push_back(stored_groups(i)[group]);
+    }
+    return columns;
 }
 
 std::vector<std::vector<std::string>> Table::scan_all() const {
-    return rows_;
+    std::vector<std::vector<std::string>> rows;
+    rows.reserve(live_row_count());
+    for (size_t i = 0; i < row_count_; ++i) {
+        if (!is_deleted(i)) {
+            rows.push_back(get_row(i));
+        }
+    }
+    return rows;
 }
 
 bool Table::matches_filter(const std::string& value, 
@@ -141,9 +614,64 @@ std::vector<size_t> Table::scan_with_filter(const std::string& column,
     std::vector<size_t> result;
     
     size_t col_idx = schema_.column_index(column);
+    const Column& col = *loaded_column(col_idx);
+    
+    // Numeric columns compare natively against a constant parsed once
+    if (op != "LIKE" && !value.empty()) {
+        int64_t int_value = 0;
+        bool int_ok = parse_int64(value, int_value);
+        double dbl_value = 0.0;
+        bool dbl_ok = int_ok || parse_double(value, dbl_value);
+        if (int_ok) {
+            dbl_value = static_cast<double>(int_value);
+        }
+        
+        if (dbl_ok) {
+            bool native = true;
+            switch (col.type()) {
+                case DataType::INT32:
+                case DataType::DATE32:
+                    if (int_ok) {
+                        filter_native<int32_t, int64_t>(col, col.data<int32_t>(), row_count_, op, int_value, result);
+                    } else {
+                        filter_native<int32_t, double>(col, col.data<int32_t>(), row_count_, op, dbl_value, result);
+                    }
+                    break;
+                case DataType::INT64:
+                case DataType::TIMESTAMP:
+                    if (int_ok) {
+                        filter_native<int64_t, int64_t>(col, col.data<int64_t>(), row_count_, op, int_value, result);
+                    } else {
+                        filter_native<int64_t, double>(col, col.data<int64_t>(), row_count_, op, dbl_value, result);
+                    }
+                    break;
+                case DataType::FLOAT32:
+                    filter_native<float, double>(col, col.data<float>(), row_count_, op, dbl_value, result);
+                    break;
+                case DataType::FLOAT64:
+                    filter_native<double, double>(col, col.data<double>(), row_count_, op, dbl_value, result);
+                    break;
+                default:
+                    native = false;
+                    break;
+            }
+            if (native) {
+                if (deleted_count_ > 0) {
+                    result.erase(std::remove_if(result.begin(), result.end(),
+                                                [this](size_t row) { return is_deleted(row); }),
+                                 result.end());
+                }
+                return result;
+            }
+        }
+    }
     
-    for (size_t i = 0; i < rows_.size(); ++i) {
-        if (matches_filter(rows_[i][col_idx], op, value)) {
+    for (size_t i = 0; i < row_count_; ++i) {
+        if (col.is_null(i) || is_deleted(i)) {
+            continue;
+        }
+        const std::string& text = col.is_fixed_width() ? col.get_string(i) : col.string_at(i);
+        if (matches_filter(text, op, value)) {
             result.push_back(i);
         }
     }
@@ -153,9 +681,10 @@ std::vector<size_t> Table::scan_with_filter(const std::string& column,
 
 std::vector<std::vector<std::string>> Table::get_rows(const std::vector<size_t>& row_ids) const {
     std::vector<std::vector<std::string>> result;
+    result.reserve(row_ids.size());
     for (size_t id : row_ids) {
-        if (id < rows_.size()) {
-            result.push_back(rows_[id]);
+        if (id < row_count_) {
+            result.push_back(get_row(id));
         }
     }
     return result;
@@ -168,7 +697,7 @@ std::shared_ptr<Column> Table::get_column(const std::string& name) {
     }
     
     size_t col_idx = schema_.column_index(name);
-    return columns_[col_idx];
+    return loaded_column(col_idx);
 }
 
 const Schema& Table::get_schema() const {
@@ -176,7 +705,7 @@ const Schema& Table::get_schema() const {
 }
 
 void Table::update_row(size_t row_index, const std::vector<std::string>& values) {
-    if (row_index >= rows_.size()) {
+    if (row_index >= row_count_) {
         throw std::runtime_error("Row index out of bounds: " + std::to_string(row_index));
     }
     
@@ -186,34 +715,188 @@ void Table::update_row(size_t row_index, const std::vector<std::string>& values)
                                  ", got " + std::to_string(values.size()));
     }
     
-    rows_[row_index] = values;
+    std::vector<std::string> row = canonical_row(values);
+    begin_write();
+    if (row_index >= column_rows_) {
+        size_t k = row_index - column_rows_;
+        writable_chunk(k / kDeltaChunkRows)[k % kDeltaChunkRows] = std::move(row);
+    } else {
+        // A row group's updates are kept at kDeltaChunkRows at most
+        size_t group = row_index / kRowGroupRows;
+        DeltaUpdates& updates = writable_updates(group);
+        updated_count_ += updates.insert_or_assign(row_index, std::move(row)).second;
+        if (updates.size() >= kDeltaChunkRows) {
+            fold_updates(group);
+        }
+    }
+    mark_dirty(row_index, row_index + 1);
+    merge_if_full();
 }
 
-void Table::delete_rows(const std::vector<size_t>& row_indices) {
-    if (row_indices.empty()) {
-        return;
+Table::DeletionVector& Table::writable_deletes(size_t group) {
+    if (deletes_.size() <= group) {
+        deletes_.resize(group + 1);
+    }
+    std::shared_ptr<DeletionVector>& dv = deletes_[group];
+    if (!dv) {
+        dv = std::make_shared<DeletionVector>();
+    } else if (dv.use_count() > 1) {
+        // A snapshot still reads this version
+        dv = std::make_shared<DeletionVector>(*dv);
+    } else {
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *dv;
+}
+
+const uint64_t* Table::deleted_bits(size_t group) const {
+    if (group >= deletes_.size() || !deletes_[group]) {
+        return nullptr;
+    }
+    return deletes_[group]->bits.data();
+}
+
+size_t Table::delete_rows(const std::vector<size_t>& row_indices) {
+    size_t deleted = 0;
+    for (size_t row : row_indices) {
+        if (row >= row_count_ || is_deleted(row)) {
+            continue;
+        }
+        DeletionVector& dv = writable_deletes(row / kRowGroupRows);
+        size_t bit = row % kRowGroupRows;
+        dv.bits[bit / 64] |= uint64_t{1} << (bit % 64);
+        dv.count++;
+        deleted++;
+    }
+    deleted_count_ += deleted;
+    deletes_dirty_ = deletes_dirty_ || deleted > 0;
+    return deleted;
+}
+
+void Table::undelete_rows(const std::vector<size_t>& row_ids) {
+    for (size_t row : row_ids) {
+        if (row >= row_count_ || !is_deleted(row)) {
+            continue;
+        }
+        size_t group = row / kRowGroupRows;
+        DeletionVector& dv = writable_deletes(group);
+        size_t bit = row % kRowGroupRows;
+        dv.bits[bit / 64] &= ~(uint64_t{1} << (bit % 64));
+        if (--dv.count == 0) {
+            deletes_[group].reset();
+        }
+        deleted_count_--;
+        deletes_dirty_ = true;
+    }
+}
+
+void Table::clear_deleted(size_t first_row) {
+    std::vector<size_t> rows;
+    for (size_t row = first_row; row < row_count_; ++row) {
+        if (is_deleted(row)) {
+            rows.push_back(row);
+        }
+    }
+    undelete_rows(rows);
+    deletes_.resize(std::min(deletes_.size(), row_group_count()));
+}
+
+std::vector<size_t> Table::purge_deleted() {
+    std::vector<size_t> remap;
+    if (deleted_count_ == 0) {
+        return remap;
     }
     
-    // Sort indices in descending order to delete from end to start
-    // This prevents index shifting issues
-    std::vector<size_t> sorted_indices = row_indices;
-    std::sort(sorted_indices.rbegin(), sorted_indices.rend());
-    
-    // Remove duplicates
-    sorted_indices.erase(std::unique(sorted_indices.begin(), sorted_indices.end()),
-                         sorted_indices.end());
+    // One pass builds the mapping and the erase list; each column then
+    // compacts its row groups from the first purged row on in a single
+    // linear pass
+    remap.resize(row_count_);
+    std::vector<size_t> purged;
+    purged.reserve(deleted_count_);
+    size_t next = 0;
+    for (size_t row = 0; row < row_count_; ++row) {
+        if (is_deleted(row)) {
+            remap[row] = kPurgedRow;
+            purged.push_back(row);
+        } else {
+            remap[row] = next++;
+        }
+    }
     
-    // Delete rows
-    for (size_t idx : sorted_indices) {
-        if (idx < rows_.size()) {
-            rows_.erase(rows_.begin() + idx);
+    merge_delta();
+    load_all_columns();
+    size_t first_group = purged.front() / kRowGroupRows;
+    size_t first_row = first_group * kRowGroupRows;
+    for (size_t& row : purged) {
+        row -= first_row;
+    }
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        const ColumnDef& def = schema_.get_column(i);
+        Column tail(def.name, def.type, row_count_ - first_row);
+        for (size_t g = first_group; g < columns_[i].size(); ++g) {
+            const Column& group = *columns_[i][g];
+            auto segment = group.serialize_rows(0, group.num_values());
+            tail.append_rows(segment.data(), segment.size());
+        }
+        tail.erase_rows(purged);
+        columns_[i].resize(first_group);
+        append_row_groups(columns_[i], tail);
+    }
+    // Every row from the first purged one on shifted
+    mark_dirty(first_row + purged.front(), row_count_);
+    row_count_ = next;
+    column_rows_ = next;
+    deletes_.clear();
+    deleted_count_ = 0;
+    deletes_dirty_ = true;
+    return remap;
+}
+
+void Table::truncate(size_t row_count) {
+    if (row_count >= row_count_) {
+        return;
+    }
+    clear_deleted(row_count);
+    begin_write();
+    mark_dirty(row_count, row_count_);
+    if (row_count >= column_rows_) {
+        // Only inserted delta rows go
+        size_t kept = row_count - column_rows_;
+        inserted_.resize((kept + kDeltaChunkRows - 1) / kDeltaChunkRows);
+        if (kept % kDeltaChunkRows != 0) {
+            writable_chunk(inserted_.size() - 1).resize(kept % kDeltaChunkRows);
         }
+    } else {
+        // Every inserted row goes, and so do updates of dropped row groups
+        size_t groups = (row_count + kRowGroupRows - 1) / kRowGroupRows;
+        inserted_.clear();
+        row_count_ = column_rows_;
+        for (size_t g = groups; g < updates_.size(); ++g) {
+            updated_count_ -= updates_[g] ? updates_[g]->size() : 0;
+        }
+        updates_.resize(std::min(updates_.size(), groups));
+        fold_delta();
+        load_all_columns();
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            columns_[i].resize(groups);
+            if (row_count % kRowGroupRows != 0) {
+                writable_group(i, groups - 1).truncate(row_count % kRowGroupRows);
+            }
+        }
+        column_rows_ = row_count;
     }
+    row_count_ = row_count;
 }
 
 void Table::finalize() {
-    for (auto& col : columns_) {
-        col->finalize_page();
+    merge_delta();
+    load_all_columns();
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        for (size_t g = 0; g < columns_[i].size(); ++g) {
+            Column& group = writable_group(i, g);
+            group.finalize_page();
+            group.encode();
+        }
     }
 }
 
@@ -1,4 +1,5 @@
 #include "lyradb/table_format.h"
+#include <array>
 #include <cstring>
 #include <stdexcept>
 
@@ -7,32 +8,32 @@ namespace storage {
 namespace format_utils {
 
 // CRC32 calculation (using same implementation as storage_format.cpp)
-static uint32_t crc32_table[256];
-static bool crc32_initialized = false;
-
-static void init_crc32_table() {
-    if (crc32_initialized) return;
-    
-    for (uint32_t i = 0; i < 256; i++) {
-        uint32_t crc = i;
-        for (int j = 0; j < 8; j++) {
-            if (crc & 1) {
-                crc = (crc >> 1) ^ 0xEDB88320;
-            } else {
-                crc >>= 1;
+// The table is built once, thread-safely, on first use
+static const uint32_t* crc32_table() {
+    static const auto table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int j = 0; j < 8; j++) {
+                if (crc & 1) {
+                    crc = (crc >> 1) ^ 0xEDB88320;
+                } else {
+                    crc >>= 1;
+                }
             }
+            t[i] = crc;
         }
-        crc32_table[i] = crc;
-    }
-    crc32_initialized = true;
+        return t;
+    }();
+    return table.data();
 }
 
 static uint32_t compute_crc32(const uint8_t* data, size_t size) {
-    init_crc32_table();
+    const uint32_t* table = crc32_table();
     
     uint32_t crc = 0xFFFFFFFF;
     for (size_t i = 0; i < size; i++) {
-        crc = (crc >> 8) ^ crc32_table[(crc ^ data[i]) & 0xFF];
+        crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
     }
     return crc ^ 0xFFFFFFFF;
 }
@@ -85,7 +86,7 @@ TableFileHeader deserialize_table_header(const uint8_t* data, size_t size) {
         throw std::invalid_argument("Invalid table file magic number");
     }
     
-    if (header.version != LYTA_VERSION) {
+    if (header.version < 2 || header.version > LYTA_VERSION) {
         throw std::invalid_argument("Unsupported table file version");
     }
     
@@ -252,7 +253,7 @@ std::vector<uint8_t> serialize_table_statistics(const TableStatistics& stats) {
     return buffer;
 }
 
-// Deserialize table statistics (stub)
+// Deserialize table statistics
 TableStatistics deserialize_table_statistics(const uint8_t* data, size_t size) {
     if (size < 44) {
         throw std::invalid_argument("Insufficient data for table statistics");
@@ -260,19 +261,49 @@ TableStatistics deserialize_table_statistics(const uint8_t* data, size_t size) {
     
     TableStatistics stats;
     const uint8_t* ptr = data;
-    
-    std::memcpy(&stats.total_rows, ptr, 8);
-    ptr += 8;
-    std::memcpy(&stats.total_columns, ptr, 4);
-    ptr += 4;
-    std::memcpy(&stats.uncompressed_bytes, ptr, 8);
-    ptr += 8;
-    std::memcpy(&stats.compressed_bytes, ptr, 8);
-    ptr += 8;
-    std::memcpy(&stats.overall_compression_ratio, ptr, 8);
-    ptr += 8;
-    std::memcpy(&stats.timestamp_created, ptr, 8);
-    ptr += 8;
+    const uint8_t* end = data + size;
+    auto get = [&](void* out, size_t bytes) {
+        if (static_cast<size_t>(end - ptr) < bytes) {
+            throw std::invalid_argument("Truncated table statistics");
+        }
+        std::memcpy(out, ptr, bytes);
+        ptr += bytes;
+    };
+    auto get_string = [&](std::string& out) {
+        uint32_t len = 0;
+        get(&len, 4);
+        if (static_cast<size_t>(end - ptr) < len) {
+            throw std::invalid_argument("Truncated table statistics");
+        }
+        out.assign(reinterpret_cast<const char*>(ptr), len);
+        ptr += len;
+    };
+    
+    get(&stats.total_rows, 8);
+    get(&stats.total_columns, 4);
+    get(&stats.uncompressed_bytes, 8);
+    get(&stats.compressed_bytes, 8);
+    get(&stats.overall_compression_ratio, 8);
+    get(&stats.timestamp_created, 8);
+    get_string(stats.table_name);
+    get(&stats.table_version, 4);
+    
+    uint32_t col_count = 0;
+    get(&col_count, 4);
+    for (uint32_t i = 0; i < col_count; ++i) {
+        ColumnStatistics col_stat;
+        get(&col_stat.column_id, 4);
+        get(&col_stat.uncompressed_bytes, 8);
+        get(&col_stat.compressed_bytes, 8);
+        get(&col_stat.compression_ratio, 8);
+        get(&col_stat.page_count, 4);
+        get_string(col_stat.compression_algorithm);
+        get(&col_stat.null_count, 4);
+        get(&col_stat.avg_value, 8);
+        get(&col_stat.min_value, 8);
+        get(&col_stat.max_value, 8);
+        stats.column_stats.push_back(std::move(col_stat));
+    }
     
     return stats;
 }
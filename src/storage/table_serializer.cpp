@@ -3,7 +3,13 @@
 #include "lyradb/schema.h"
 #include "lyradb/storage_format.h"
 #include "lyradb/compression.h"
+#include "lyradb/compression_selector.h"
+#include "lyradb/io_throttle.h"
+#include "lyradb/table.h"
+#include "lyradb/task_scheduler.h"
+#include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <chrono>
 #include <algorithm>
@@ -12,6 +18,76 @@
 namespace lyradb {
 namespace storage {
 
+namespace {
+
+/**
+ * @brief Pick the page codec for rows [begin, end) of a column
+ *
+ * Integer columns are judged on their values; PFOR is the integer codec
+ * pages store, as it covers plain bit-packing (no exceptions) and delta
+ * (PFOR-delta). Low-cardinality string columns get dictionary pages and
+ * long, high-cardinality ones (URLs, e-mail addresses, log lines) FSST
+ * pages.
+ * Everything else, and values no typed codec helps, is judged on the raw
+ * segment bytes.
+ */
+compression::CompressionAlgorithm page_algorithm(const Column& column, size_t begin, size_t end,
+                                                 const std::vector<uint8_t>& segment) {
+    using compression::CompressionAlgorithm;
+    using compression::CompressionSelector;
+    if (end > begin && (column.type() == DataType::INT32 || column.type() == DataType::INT64)) {
+        std::vector<int64_t> values(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            values[i - begin] = column.type() == DataType::INT32
+                ? column.data<int32_t>()[i] : column.data<int64_t>()[i];
+        }
+        auto algo = CompressionSelector::select_for_integers(values.data(), values.size());
+        if (algo != CompressionAlgorithm::ZSTD && algo != CompressionAlgorithm::UNCOMPRESSED) {
+            return CompressionAlgorithm::PFOR;
+        }
+    }
+    if (end > begin && column.type() == DataType::STRING) {
+        std::vector<std::string> values;
+        values.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            values.push_back(column.string_at(i));
+        }
+        auto algo = CompressionSelector::select_for_strings(values);
+        if (algo == CompressionAlgorithm::DICTIONARY || algo == CompressionAlgorithm::FSST) {
+            return algo;
+        }
+    }
+    return CompressionSelector::select_for_binary(
+        segment.data(), segment.size() - segment.size() % 8, 8);
+}
+
+/**
+ * @brief Column-wide statistics of a column from the zone maps of its row
+ * groups, as Column::get_stats() gives them for a single column
+ */
+Column::ColumnStats column_stats(const std::vector<indexes::ZoneMapIndex>& zone_maps,
+                                 DataType type) {
+    Column::ColumnStats stats;
+    bool integral = type == DataType::INT32 || type == DataType::INT64 ||
+                    type == DataType::DATE32 || type == DataType::TIMESTAMP ||
+                    type == DataType::BOOL;
+    bool first = true;
+    for (const auto& zone_map : zone_maps) {
+        for (const auto& zone : zone_map.zones()) {
+            stats.null_count += zone.null_count;
+            if (!integral || !zone.has_values) {
+                continue;
+            }
+            stats.min_value = first ? zone.min_int : std::min(stats.min_value, zone.min_int);
+            stats.max_value = first ? zone.max_int : std::max(stats.max_value, zone.max_int);
+            first = false;
+        }
+    }
+    return stats;
+}
+
+} // namespace
+
 // ============================================================================
 // TableWriter Implementation
 // ============================================================================
@@ -29,11 +105,56 @@ TableWriter::TableWriter(const std::string& filepath,
     
     // Initialize statistics
     statistics_.table_name = "default";
+    statistics_.total_rows = 0;
     statistics_.total_columns = schema.num_columns();
+    statistics_.uncompressed_bytes = 0;
+    statistics_.compressed_bytes = 0;
+    statistics_.overall_compression_ratio = 100;
     statistics_.table_version = 1;
     statistics_.timestamp_created = 
         std::chrono::system_clock::now().time_since_epoch().count();
     statistics_.column_stats.resize(schema.num_columns());
+    
+    // Every column gets an entry up front so columns can be written concurrently
+    column_metadata_.resize(schema.num_columns());
+    for (uint32_t i = 0; i < schema.num_columns(); ++i) {
+        record_column(i, 0, 0, 0, 0, 0);
+    }
+}
+
+TableWriter::TableWriter(const std::string& filepath, const TableReader& base)
+    : filepath_(filepath),
+      base_path_(std::filesystem::path(filepath).parent_path().string()),
+      schema_(base.get_schema()),
+      total_rows_(0),
+      finalized_(false) {
+    
+    // Reopen every column file after the base version's footer
+    const TableManifest& manifest = base.get_manifest();
+    base_pages_.resize(schema_.num_columns());
+    for (uint32_t i = 0; i < schema_.num_columns(); ++i) {
+        const ColumnReader& reader = base.column_reader(i);
+        for (uint32_t p = 0; p < reader.page_count(); ++p) {
+            PageMetadata meta = reader.get_page_metadata(p);
+            if (meta.page_id != p) {
+                throw std::runtime_error("Column file is not stored in row groups: " + reader.path());
+            }
+            base_pages_[i].push_back(meta);
+        }
+        writers_.push_back(std::make_unique<ColumnWriter>(
+            get_column_filepath(i), i, static_cast<uint8_t>(schema_.get_column(i).type),
+            manifest.column_metadata[i].column_file_size));
+    }
+    
+    zone_maps_ = manifest.zone_maps;
+    
+    statistics_ = base.get_statistics();
+    statistics_.table_version++;
+    statistics_.column_stats.resize(schema_.num_columns());
+    column_metadata_.resize(schema_.num_columns());
+    for (uint32_t i = 0; i < schema_.num_columns(); ++i) {
+        record_column(i, 0, 0, 0, 0, 0);
+    }
 }
 
 TableWriter::~TableWriter() {
@@ -59,7 +180,7 @@ void TableWriter::initialize_column_writers() {
     }
 }
 
-    std::string TableWriter::get_column_filepath(uint32_t column_id) const {
+std::string TableWriter::get_column_filepath(uint32_t column_id) const {
     std::ostringstream oss;
     oss << base_path_ << "/column_" << column_id << ".lycol";
     return oss.str();
@@ -79,43 +200,199 @@ void TableWriter::write_column_pages(
         throw std::out_of_range("Invalid column ID");
     }
     
-    // Update total row count
-    total_rows_ = std::max(total_rows_, row_count);
-    
     // Write pages using column writer
     // Calculate rows per page (assume equal distribution for now)
     uint32_t rows_per_page = pages.empty() ? 0 : (row_count + pages.size() - 1) / pages.size();
     
+    uint64_t original_bytes = 0;
+    uint64_t compressed_bytes = 0;
     for (const auto& page : pages) {
-        writers_[column_id]->write_page(page.data(), page.size(), 
-                                       rows_per_page, compression_type);
+        auto encoded = ColumnWriter::encode_page(page.data(), page.size(), compression_type);
+        original_bytes += encoded.original_size;
+        compressed_bytes += encoded.payload.size();
+        writers_[column_id]->write_encoded_page(encoded, rows_per_page);
+    }
+    
+    record_column(column_id, row_count, static_cast<uint32_t>(pages.size()),
+                  original_bytes, compressed_bytes, compression_type);
+}
+
+void TableWriter::write_table(const Table& table, TaskScheduler& scheduler) {
+    write_row_groups(table, {}, scheduler);
+}
+
+void TableWriter::write_row_groups(const Table& table, const std::vector<size_t>& row_groups,
+                                   TaskScheduler& scheduler) {
+    if (finalized_) {
+        throw std::runtime_error("Cannot write to finalized table");
+    }
+    if (table.column_count() != writers_.size()) {
+        throw std::runtime_error("Table does not match the writer schema: " + table.name());
+    }
+    statistics_.table_name = table.name();
+    const size_t num_columns = writers_.size();
+    const size_t num_groups = table.row_group_count();
+    const size_t base_groups = base_pages_.empty() ? 0 : base_pages_[0].size();
+    auto group_rows = [&](size_t g) {
+        return std::min(Table::kRowGroupRows, table.row_count() - g * Table::kRowGroupRows);
+    };
+    
+    std::vector<bool> rewrite(num_groups, false);
+    for (size_t g : row_groups) {
+        if (g < num_groups) rewrite[g] = true;
+    }
+    std::vector<size_t> groups;
+    for (size_t g = 0; g < num_groups; ++g) {
+        if (rewrite[g] || g >= base_groups) {
+            groups.push_back(g);
+        } else if (base_pages_[0][g].row_count != group_rows(g)) {
+            throw std::runtime_error("Row group " + std::to_string(g) + " of table " +
+                                     table.name() + " changed but is not being rewritten");
+        }
+    }
+    
+    // Row groups as scans read them: shared with the table unless the
+    // delta store holds rows of them (the table is never merged). Groups
+    // kept from the base keep its zone maps too, so a lazy table loads
+    // only what is rewritten, unless the base has no zone maps stored
+    const bool base_zones = zone_maps_.size() == num_columns;
+    std::vector<size_t> read_groups;
+    for (size_t g = 0; g < num_groups; ++g) {
+        if (rewrite[g] || g >= base_groups || !base_zones) {
+            read_groups.push_back(g);
+        }
+    }
+    std::vector<std::vector<std::shared_ptr<const Column>>> group_columns(num_groups);
+    scheduler.parallel_for(read_groups.size(), 0, [&](size_t k, size_t) {
+        group_columns[read_groups[k]] = table.row_group(read_groups[k]);
+    });
+    zone_maps_.resize(num_columns);
+    for (size_t c = 0; c < num_columns; ++c) {
+        zone_maps_[c].resize(num_groups);
+        for (size_t g : read_groups) {
+            zone_maps_[c][g] = group_columns[g][c]->zone_map();
+        }
+    }
+    
+    // 1. Encode every (column, group) page as one pool of tasks so a
+    //    single wide column still uses every thread
+    std::vector<ColumnWriter::EncodedPage> encoded(num_columns * groups.size());
+    scheduler.parallel_for(encoded.size(), 0, [&](size_t t, size_t) {
+        size_t c = t / groups.size();
+        const Column& column = *group_columns[groups[t % groups.size()]][c];
+        auto segment = column.serialize_rows(0, column.num_values());
+        auto algo = page_algorithm(column, 0, column.num_values(), segment);
+        encoded[t] = ColumnWriter::encode_page(segment.data(), segment.size(), static_cast<uint8_t>(algo));
+    });
+    
+    // 2. One file per column, written concurrently: new pages are
+    //    appended, unchanged groups keep the base's pages
+    scheduler.parallel_for(num_columns, 0, [&](size_t c, size_t) {
+        const ColumnDef& def = schema_.get_column(c);
+        const Column::ColumnStats stats = column_stats(zone_maps_[c], def.type);
+        
+        if (base_pages_.empty()) {
+            TableMetadata metadata;
+            metadata.magic = LYCOL_MAGIC;
+            metadata.version = LYCOL_VERSION;
+            metadata.table_name = table.name();
+            metadata.row_count = table.row_count();
+            metadata.column_count = static_cast<uint32_t>(num_columns);
+            metadata.compression_enabled = true;
+            metadata.checksum = 0;
+            ColumnDefinition col_def;
+            col_def.column_id = static_cast<uint32_t>(c);
+            col_def.data_type = static_cast<uint8_t>(def.type);
+            col_def.name.assign(def.name.begin(), def.name.end());
+            col_def.name_length = static_cast<uint16_t>(def.name.size());
+            col_def.null_count = stats.null_count;
+            col_def.min_value = stats.min_value;
+            col_def.max_value = stats.max_value;
+            col_def.distinct_count = 0;
+            col_def.page_count = static_cast<uint32_t>(num_groups);
+            metadata.columns.push_back(std::move(col_def));
+            writers_[c]->write_table_metadata(metadata);
+        }
+        
+        // Most common page algorithm stands for the column
+        uint64_t original_bytes = 0;
+        uint64_t compressed_bytes = 0;
+        size_t algo_pages[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        size_t k = 0;
+        for (size_t g = 0; g < num_groups; ++g) {
+            uint8_t page_algo = 0;
+            if (k < groups.size() && groups[k] == g) {
+                ColumnWriter::EncodedPage& page = encoded[c * groups.size() + k++];
+                if (throttle_ != nullptr) {
+                    throttle_->acquire(page.payload.size());
+                }
+                writers_[c]->write_encoded_page(page, static_cast<uint32_t>(group_rows(g)), g);
+                original_bytes += page.original_size;
+                compressed_bytes += page.payload.size();
+                page_algo = page.compression_algo;
+                std::vector<uint8_t>().swap(page.payload);
+            } else {
+                const PageMetadata& page = base_pages_[c][g];
+                writers_[c]->add_page(page);
+                original_bytes += page.compression.original_bytes;
+                compressed_bytes += page.page_size;
+                page_algo = page.compression.algorithm;
+            }
+            algo_pages[std::min<size_t>(page_algo, 7)]++;
+        }
+        uint8_t algo = static_cast<uint8_t>(
+            std::max_element(algo_pages, algo_pages + 8) - algo_pages);
+        record_column(static_cast<uint32_t>(c), table.row_count(),
+                      static_cast<uint32_t>(num_groups),
+                      original_bytes, compressed_bytes, algo);
+        
+        auto& col_stat = statistics_.column_stats[c];
+        col_stat.null_count = stats.null_count;
+        col_stat.min_value = static_cast<uint64_t>(stats.min_value);
+        col_stat.max_value = static_cast<uint64_t>(stats.max_value);
+    });
+    
+    // Deletion vectors always come from the table, never the base
+    deletion_vectors_.clear();
+    for (size_t g = 0; g < num_groups; ++g) {
+        if (const uint64_t* bits = table.deleted_bits(g)) {
+            deletion_vectors_.emplace_back(static_cast<uint32_t>(g),
+                std::vector<uint64_t>(bits, bits + Table::kRowGroupRows / 64));
+        }
     }
     
-    // Update column metadata
-    TableColumnMetadata meta;
+    // Empty tables still record their row count
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    total_rows_ = table.row_count();
+}
+
+void TableWriter::record_column(uint32_t column_id, uint64_t row_count, uint32_t page_count,
+                                uint64_t original_bytes, uint64_t compressed_bytes,
+                                uint8_t compression_type) {
+    double ratio = original_bytes == 0 ? 100.0 : 100.0 * compressed_bytes / original_bytes;
+    
+    TableColumnMetadata& meta = column_metadata_[column_id];
     meta.column_id = column_id;
-    meta.column_file_offset = 0;  // Will be computed at finalization
+    meta.column_file_offset = 0;
     meta.column_file_size = 0;    // Will be computed at finalization
     meta.compression_algorithm = compression_type;
-    meta.page_count = pages.size();
-    meta.compression_ratio = 100;  // Placeholder
+    meta.padding1 = 0;
+    meta.padding2 = 0;
+    meta.page_count = page_count;
+    meta.compression_ratio = ratio;
     meta.checksum = 0;
     
-    // Store metadata (resize if needed)
-    if (column_metadata_.size() <= column_id) {
-        column_metadata_.resize(column_id + 1);
-    }
-    column_metadata_[column_id] = meta;
+    auto& col_stat = statistics_.column_stats[column_id];
+    col_stat.column_id = column_id;
+    col_stat.page_count = page_count;
+    col_stat.compression_ratio = ratio;
+    col_stat.uncompressed_bytes = original_bytes;
+    col_stat.compressed_bytes = compressed_bytes;
+    col_stat.compression_algorithm = compression::CompressionSelector::algorithm_name(
+        static_cast<compression::CompressionAlgorithm>(compression_type));
     
-    // Update statistics for this column
-    if (column_id < statistics_.column_stats.size()) {
-        auto& col_stat = statistics_.column_stats[column_id];
-        col_stat.column_id = column_id;
-        col_stat.page_count = pages.size();
-        col_stat.compression_ratio = 100;  // Placeholder
-        col_stat.uncompressed_bytes = row_count * 8;  // Placeholder
-        col_stat.compressed_bytes = 0;  // Placeholder
-    }
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    total_rows_ = std::max(total_rows_, row_count);
 }
 
 void TableWriter::finalize() {
@@ -123,11 +400,10 @@ void TableWriter::finalize() {
         return;
     }
     
-    // Close all column writers
-    for (auto& writer : writers_) {
-        if (writer) {
-            // Finalize each column
-        }
+    // Close all column writers (writes their page indexes)
+    for (size_t i = 0; i < writers_.size(); ++i) {
+        writers_[i]->finalize();
+        column_metadata_[i].column_file_size = writers_[i]->total_bytes_written();
     }
     
     // Calculate final statistics
@@ -135,16 +411,14 @@ void TableWriter::finalize() {
     statistics_.uncompressed_bytes = 0;
     statistics_.compressed_bytes = 0;
     
-    double total_ratio = 0.0;
     for (const auto& col_stat : statistics_.column_stats) {
         statistics_.uncompressed_bytes += col_stat.uncompressed_bytes;
         statistics_.compressed_bytes += col_stat.compressed_bytes;
-        total_ratio += col_stat.compression_ratio;
     }
     
-    if (statistics_.total_columns > 0) {
+    if (statistics_.uncompressed_bytes > 0) {
         statistics_.overall_compression_ratio = 
-            total_ratio / statistics_.total_columns;
+            100.0 * statistics_.compressed_bytes / statistics_.uncompressed_bytes;
     }
     
     // Write table manifest
@@ -183,6 +457,7 @@ void TableWriter::write_table_manifest() {
     
     // Write column metadata
     for (uint32_t i = 0; i < column_metadata_.size(); ++i) {
+        column_metadata_[i].checksum = 0;
         auto meta_bytes = format_utils::serialize_column_metadata(
             column_metadata_[i]);
         
@@ -197,12 +472,73 @@ void TableWriter::write_table_manifest() {
                            meta_bytes.size());
     }
     
+    // Write schema: name, type, nullable, column file relative to the manifest
+    std::filesystem::path manifest_dir = std::filesystem::path(filepath_).parent_path();
+    std::vector<uint8_t> schema_bytes;
+    auto put_string = [&](const std::string& value) {
+        uint16_t len = static_cast<uint16_t>(value.size());
+        schema_bytes.push_back(static_cast<uint8_t>(len & 0xFF));
+        schema_bytes.push_back(static_cast<uint8_t>(len >> 8));
+        schema_bytes.insert(schema_bytes.end(), value.begin(), value.end());
+    };
+    for (uint32_t i = 0; i < schema_.num_columns(); ++i) {
+        const auto& col_def = schema_.get_column(i);
+        put_string(col_def.name);
+        schema_bytes.push_back(static_cast<uint8_t>(col_def.type));
+        schema_bytes.push_back(col_def.nullable ? 1 : 0);
+        put_string(std::filesystem::path(get_column_filepath(i))
+                       .lexically_relative(manifest_dir.empty() ? "." : manifest_dir)
+                       .generic_string());
+    }
+    manifest_file.write(reinterpret_cast<const char*>(schema_bytes.data()),
+                       schema_bytes.size());
+    
+    // Write deletion vectors
+    std::vector<uint8_t> delete_bytes;
+    auto put_u32 = [&](uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            delete_bytes.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    };
+    put_u32(static_cast<uint32_t>(deletion_vectors_.size()));
+    for (const auto& [group, words] : deletion_vectors_) {
+        put_u32(group);
+        for (uint64_t word : words) {
+            put_u32(static_cast<uint32_t>(word));
+            put_u32(static_cast<uint32_t>(word >> 32));
+        }
+    }
+    manifest_file.write(reinterpret_cast<const char*>(delete_bytes.data()),
+                       delete_bytes.size());
+    
+    // Write zone maps
+    std::vector<uint8_t> zone_bytes;
+    auto put_zone_u32 = [&](uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            zone_bytes.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    };
+    for (uint32_t i = 0; i < schema_.num_columns(); ++i) {
+        const auto* zone_maps = i < zone_maps_.size() ? &zone_maps_[i] : nullptr;
+        put_zone_u32(zone_maps ? static_cast<uint32_t>(zone_maps->size()) : 0);
+        for (size_t g = 0; zone_maps && g < zone_maps->size(); ++g) {
+            auto bytes = (*zone_maps)[g].serialize();
+            put_zone_u32(static_cast<uint32_t>(bytes.size()));
+            zone_bytes.insert(zone_bytes.end(), bytes.begin(), bytes.end());
+        }
+    }
+    manifest_file.write(reinterpret_cast<const char*>(zone_bytes.data()),
+                       zone_bytes.size());
+    
     // Write statistics
     auto stats_bytes = format_utils::serialize_table_statistics(statistics_);
     manifest_file.write(reinterpret_cast<const char*>(stats_bytes.data()),
                        stats_bytes.size());
     
     manifest_file.close();
+    if (!manifest_file) {
+        throw std::runtime_error("Failed to write table manifest file");
+    }
 }
 
 const TableStatistics& TableWriter::get_statistics() const {
@@ -233,52 +569,105 @@ void TableReader::load_table_manifest() {
     if (!manifest_file.is_open()) {
         throw std::runtime_error("Failed to open table manifest file");
     }
+    std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(manifest_file)),
+                                std::istreambuf_iterator<char>());
+    size_t pos = 0;
+    auto need = [&](size_t bytes) {
+        if (buffer.size() - pos < bytes) {
+            throw std::runtime_error("Truncated table manifest: " + filepath_);
+        }
+    };
     
     // Read header
-    std::vector<uint8_t> header_buffer(sizeof(TableFileHeader));
-    manifest_file.read(reinterpret_cast<char*>(header_buffer.data()),
-                      header_buffer.size());
-    
-    if (manifest_file.gcount() != static_cast<std::streamsize>(header_buffer.size())) {
-        throw std::runtime_error("Failed to read complete table header");
-    }
-    
-    // Deserialize header
+    need(sizeof(TableFileHeader));
     manifest_.header = format_utils::deserialize_table_header(
-        header_buffer.data(), header_buffer.size());
+        buffer.data(), sizeof(TableFileHeader));
+    pos += sizeof(TableFileHeader);
     
     // Read column metadata
     manifest_.column_metadata.resize(manifest_.header.column_count);
     for (uint32_t i = 0; i < manifest_.header.column_count; ++i) {
-        std::vector<uint8_t> meta_buffer(sizeof(TableColumnMetadata));
-        manifest_file.read(reinterpret_cast<char*>(meta_buffer.data()),
-                          meta_buffer.size());
-        
-        if (manifest_file.gcount() != static_cast<std::streamsize>(meta_buffer.size())) {
-            throw std::runtime_error("Failed to read complete column metadata");
-        }
-        
+        need(sizeof(TableColumnMetadata));
         manifest_.column_metadata[i] = 
             format_utils::deserialize_column_metadata(
-                meta_buffer.data(), meta_buffer.size());
+                buffer.data() + pos, sizeof(TableColumnMetadata));
+        pos += sizeof(TableColumnMetadata);
     }
     
-    // Read statistics
-    std::vector<uint8_t> stats_buffer(4096);  // Initial buffer size
-    manifest_file.read(reinterpret_cast<char*>(stats_buffer.data()),
-                      stats_buffer.size());
+    // Read schema
+    auto get_string = [&]() {
+        need(2);
+        size_t len = buffer[pos] | (buffer[pos + 1] << 8);
+        pos += 2;
+        need(len);
+        std::string value(reinterpret_cast<const char*>(buffer.data() + pos), len);
+        pos += len;
+        return value;
+    };
+    schema_ = Schema();
+    column_files_.clear();
+    for (uint32_t i = 0; i < manifest_.header.column_count; ++i) {
+        std::string name = get_string();
+        need(2);
+        auto type = static_cast<DataType>(buffer[pos]);
+        bool nullable = buffer[pos + 1] != 0;
+        pos += 2;
+        schema_.add_column(ColumnDef(name, type, nullable));
+        column_files_.push_back(get_string());
+    }
     
-    size_t stats_size = manifest_file.gcount();
-    if (stats_size > 0) {
-        stats_buffer.resize(stats_size);
+    auto get_u32 = [&]() {
+        need(4);
+        uint32_t value = buffer[pos] | (buffer[pos + 1] << 8) |
+                         (buffer[pos + 2] << 16) | (static_cast<uint32_t>(buffer[pos + 3]) << 24);
+        pos += 4;
+        return value;
+    };
+    
+    // Read deletion vectors (version 3 on)
+    manifest_.deleted_rows.clear();
+    if (manifest_.header.version >= 3) {
+        uint32_t groups = get_u32();
+        for (uint32_t i = 0; i < groups; ++i) {
+            uint64_t first_row = static_cast<uint64_t>(get_u32()) * Table::kRowGroupRows;
+            for (size_t w = 0; w < Table::kRowGroupRows / 64; ++w) {
+                uint64_t word = get_u32();
+                word |= static_cast<uint64_t>(get_u32()) << 32;
+                for (size_t bit = 0; word != 0; ++bit, word >>= 1) {
+                    uint64_t row = first_row + w * 64 + bit;
+                    if ((word & 1) && row < manifest_.header.row_count) {
+                        manifest_.deleted_rows.push_back(row);
+                    }
+                }
+            }
+        }
+    }
+    
+    // Read zone maps (version 4 on); older tables derive them from the
+    // columns once loaded
+    manifest_.zone_maps.clear();
+    if (manifest_.header.version >= 4) {
+        manifest_.zone_maps.resize(manifest_.header.column_count);
+        for (auto& zone_maps : manifest_.zone_maps) {
+            zone_maps.resize(get_u32());
+            for (auto& zone_map : zone_maps) {
+                uint32_t size = get_u32();
+                need(size);
+                zone_map = indexes::ZoneMapIndex::deserialize(buffer.data() + pos, size);
+                pos += size;
+            }
+        }
+    }
+    
+    // Read statistics (rest of the file)
+    if (pos < buffer.size()) {
         manifest_.statistics = format_utils::deserialize_table_statistics(
-            stats_buffer.data(), stats_buffer.size());
+            buffer.data() + pos, buffer.size() - pos);
         statistics_ = manifest_.statistics;
     }
     
     manifest_.valid = true;
     loaded_ = true;
-    manifest_file.close();
 }
 
 void TableReader::initialize_column_readers() {
@@ -286,12 +675,11 @@ void TableReader::initialize_column_readers() {
     readers_.resize(manifest_.header.column_count);
     
     for (uint32_t i = 0; i < manifest_.header.column_count; ++i) {
-        std::ostringstream oss;
-        oss << "." << "/column_" << i << ".lycol";
-        std::string col_filepath = oss.str();
+        std::string col_filepath = get_column_filepath(i);
         
         try {
-            auto reader = std::make_unique<ColumnReader>(col_filepath);
+            auto reader = std::make_shared<ColumnReader>(
+                col_filepath, manifest_.column_metadata[i].column_file_size);
             readers_[i] = std::move(reader);
         } catch (const std::exception& e) {
             throw std::runtime_error(
@@ -300,6 +688,10 @@ void TableReader::initialize_column_readers() {
     }
 }
 
+std::string TableReader::get_column_filepath(uint32_t column_id) const {
+    return (std::filesystem::path(filepath_).parent_path() / column_files_.at(column_id)).string();
+}
+
 const Schema& TableReader::get_schema() const {
     return schema_;
 }
@@ -327,6 +719,73 @@ std::vector<std::vector<uint8_t>> TableReader::read_column_pages(
     return pages;
 }
 
+Column TableReader::read_column(uint32_t column_id) {
+    if (column_id >= readers_.size()) {
+        throw std::out_of_range("Invalid column ID");
+    }
+    return decode_column(*readers_[column_id], schema_.get_column(column_id));
+}
+
+Column TableReader::decode_column(ColumnReader& reader, const ColumnDef& def) {
+    // One page per row group, in row order
+    Column column(def.name, def.type);
+    for (uint32_t i = 0; i < reader.page_count(); ++i) {
+        auto page = reader.read_page(i);
+        column.append_rows(page.data(), page.size());
+    }
+    // Scans filter dictionary codes and runs without expanding them
+    column.encode();
+    return column;
+}
+
+std::vector<std::shared_ptr<Column>> TableReader::decode_row_groups(ColumnReader& reader,
+                                                                   const ColumnDef& def) {
+    // One page per row group, each decoded into a column of its own
+    Table::RowGroups groups;
+    groups.reserve(reader.page_count());
+    for (uint32_t i = 0; i < reader.page_count(); ++i) {
+        auto page = reader.read_page(i);
+        auto group = std::make_shared<Column>(def.name, def.type, Table::kRowGroupRows);
+        group->append_rows(page.data(), page.size());
+        group->encode();
+        groups.push_back(std::move(group));
+    }
+    return groups;
+}
+
+std::shared_ptr<Table> TableReader::read_table(TaskScheduler& scheduler) {
+    std::vector<std::shared_ptr<Column>> columns(readers_.size());
+    scheduler.parallel_for(readers_.size(), 0, [&](size_t c, size_t) {
+        columns[c] = std::make_shared<Column>(read_column(static_cast<uint32_t>(c)));
+    });
+    auto table = std::make_shared<Table>(statistics_.table_name, schema_, std::move(columns));
+    apply_deletes(*table);
+    return table;
+}
+
+std::shared_ptr<Table> TableReader::open_table() {
+    std::vector<Table::ColumnLoader> loaders;
+    loaders.reserve(readers_.size());
+    for (size_t i = 0; i < readers_.size(); ++i) {
+        // The loader owns the mapped column file until it runs
+        loaders.push_back([reader = readers_[i], def = schema_.get_column(i)]() {
+            return decode_row_groups(*reader, def);
+        });
+    }
+    auto table = std::make_shared<Table>(statistics_.table_name, schema_,
+                                         static_cast<size_t>(manifest_.header.row_count),
+                                         std::move(loaders), manifest_.zone_maps);
+    apply_deletes(*table);
+    return table;
+}
+
+void TableReader::apply_deletes(Table& table) const {
+    // Marking rows deleted needs no column; the table still matches disk
+    table.delete_rows(std::vector<size_t>(manifest_.deleted_rows.begin(),
+                                          manifest_.deleted_rows.end()));
+    table.clear_dirty();
+}
+
 std::shared_ptr<Table> TableReader::read_rows(uint64_t start_row, uint64_t num_rows) {
     // TODO: Implement row range reading from multiple columns
     // For now, return nullptr as placeholder
@@ -0,0 +1,428 @@
+#include "lyradb/write_ahead_log.h"
+#include "lyradb/table_format.h"
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lyradb {
+
+namespace {
+
+constexpr uint32_t WAL_MAGIC = 0x4C41574C;   // "LWAL" in little-endian
+constexpr uint32_t WAL_VERSION = 1;
+constexpr size_t kFileHeaderSize = 8;
+constexpr size_t kFrameHeaderSize = 16;       // length, crc, lsn
+
+// ============================================================================
+// Platform file I/O
+// ============================================================================
+
+#ifdef _WIN32
+int open_log(const std::string& path) {
+    return ::_open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+int open_existing(const std::string& path) { return ::_open(path.c_str(), _O_RDWR | _O_BINARY); }
+int64_t seek_log(int fd, int64_t offset, int whence) { return ::_lseeki64(fd, offset, whence); }
+int64_t read_log(int fd, void* data, size_t size) { return ::_read(fd, data, static_cast<unsigned>(size)); }
+int64_t write_log(int fd, const void* data, size_t size) { return ::_write(fd, data, static_cast<unsigned>(size)); }
+int sync_log(int fd) { return ::_commit(fd); }
+int truncate_log(int fd, int64_t size) { return ::_chsize_s(fd, size); }
+void close_log(int fd) { ::_close(fd); }
+#else
+int open_log(const std::string& path) { return ::open(path.c_str(), O_RDWR | O_CREAT, 0644); }
+int open_existing(const std::string& path) { return ::open(path.c_str(), O_RDONLY); }
+int64_t seek_log(int fd, int64_t offset, int whence) { return ::lseek(fd, offset, whence); }
+int64_t read_log(int fd, void* data, size_t size) { return ::read(fd, data, size); }
+int64_t write_log(int fd, const void* data, size_t size) { return ::write(fd, data, size); }
+#ifdef __APPLE__
+int sync_log(int fd) { return ::fsync(fd); }
+#else
+int sync_log(int fd) { return ::fdatasync(fd); }
+#endif
+int truncate_log(int fd, int64_t size) { return ::ftruncate(fd, size); }
+void close_log(int fd) { ::close(fd); }
+#endif
+
+void write_all(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        int64_t written = write_log(fd, data, size);
+        if (written <= 0) {
+            throw std::runtime_error("Write-ahead log write failed");
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+// ============================================================================
+// Record encoding
+// ============================================================================
+
+template <typename T>
+void put(std::vector<uint8_t>& out, T value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void put_string(std::vector<uint8_t>& out, const std::string& value) {
+    put<uint32_t>(out, static_cast<uint32_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+class FrameReader {
+public:
+    FrameReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        need(sizeof(T));
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    std::string get_string() {
+        uint32_t len = get<uint32_t>();
+        need(len);
+        std::string value(reinterpret_cast<const char*>(data_ + pos_), len);
+        pos_ += len;
+        return value;
+    }
+
+    bool done() const { return pos_ == size_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+
+    void need(size_t bytes) const {
+        if (size_ - pos_ < bytes) {
+            throw std::runtime_error("Corrupt write-ahead log record");
+        }
+    }
+};
+
+void encode_record(std::vector<uint8_t>& out, const WalRecord& record) {
+    put<uint8_t>(out, static_cast<uint8_t>(record.op));
+    put_string(out, record.table);
+    switch (record.op) {
+        case WalOp::CREATE_TABLE:
+            put<uint32_t>(out, static_cast<uint32_t>(record.schema.num_columns()));
+            for (size_t i = 0; i < record.schema.num_columns(); ++i) {
+                const ColumnDef& col = record.schema.get_column(i);
+                put_string(out, col.name);
+                put<uint8_t>(out, static_cast<uint8_t>(col.type));
+                put<uint8_t>(out, col.nullable ? 1 : 0);
+            }
+            break;
+        case WalOp::DROP_TABLE:
+        case WalOp::PURGE:
+            break;
+        case WalOp::INSERT:
+        case WalOp::UPDATE:
+        case WalOp::DELETE:
+            put<uint32_t>(out, static_cast<uint32_t>(record.row_ids.size()));
+            for (uint64_t id : record.row_ids) {
+                put<uint64_t>(out, id);
+            }
+            put<uint32_t>(out, static_cast<uint32_t>(record.values.size()));
+            for (const auto& value : record.values) {
+                put_string(out, value);
+            }
+            break;
+    }
+}
+
+WalRecord decode_record(FrameReader& in) {
+    WalRecord record;
+    uint8_t op = in.get<uint8_t>();
+    if (op < static_cast<uint8_t>(WalOp::CREATE_TABLE) || op > static_cast<uint8_t>(WalOp::PURGE)) {
+        throw std::runtime_error("Unknown write-ahead log operation");
+    }
+    record.op = static_cast<WalOp>(op);
+    record.table = in.get_string();
+    switch (record.op) {
+        case WalOp::CREATE_TABLE: {
+            uint32_t columns = in.get<uint32_t>();
+            for (uint32_t i = 0; i < columns; ++i) {
+                std::string name = in.get_string();
+                DataType type = static_cast<DataType>(in.get<uint8_t>());
+                bool nullable = in.get<uint8_t>() != 0;
+                record.schema.add_column(ColumnDef(name, type, nullable));
+            }
+            break;
+        }
+        case WalOp::DROP_TABLE:
+        case WalOp::PURGE:
+            break;
+        case WalOp::INSERT:
+        case WalOp::UPDATE:
+        case WalOp::DELETE: {
+            uint32_t ids = in.get<uint32_t>();
+            record.row_ids.resize(ids);
+            for (auto& id : record.row_ids) {
+                id = in.get<uint64_t>();
+            }
+            uint32_t values = in.get<uint32_t>();
+            record.values.resize(values);
+            for (auto& value : record.values) {
+                value = in.get_string();
+            }
+            break;
+        }
+    }
+    return record;
+}
+
+uint32_t frame_checksum(uint64_t lsn, const uint8_t* payload, size_t size) {
+    std::vector<uint8_t> bytes(sizeof(lsn) + size);
+    std::memcpy(bytes.data(), &lsn, sizeof(lsn));
+    if (size > 0) {
+        std::memcpy(bytes.data() + sizeof(lsn), payload, size);
+    }
+    return storage::format_utils::calculate_table_checksum(bytes.data(), bytes.size());
+}
+
+}  // namespace
+
+// ============================================================================
+// WriteAheadLog Implementation
+// ============================================================================
+
+WriteAheadLog::WriteAheadLog(const std::string& filepath, std::chrono::microseconds commit_delay,
+                             uint64_t base_lsn)
+    : filepath_(filepath), commit_delay_(commit_delay) {
+    fd_ = open_log(filepath_);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot open write-ahead log: " + filepath_);
+    }
+    try {
+        recover(base_lsn);
+    } catch (...) {
+        close_log(fd_);
+        throw;
+    }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    // Everything appended is synced before the file goes away
+    try {
+        wait_durable(appended_lsn_);
+    } catch (...) {
+    }
+    close_log(fd_);
+}
+
+void WriteAheadLog::recover(uint64_t base_lsn) {
+    appended_lsn_ = base_lsn;
+    durable_lsn_ = base_lsn;
+
+    int64_t file_size = seek_log(fd_, 0, SEEK_END);
+    std::vector<uint8_t> data(static_cast<size_t>(file_size > 0 ? file_size : 0));
+    seek_log(fd_, 0, SEEK_SET);
+    size_t got = 0;
+    while (got < data.size()) {
+        int64_t n = read_log(fd_, data.data() + got, data.size() - got);
+        if (n <= 0) {
+            throw std::runtime_error("Cannot read write-ahead log: " + filepath_);
+        }
+        got += static_cast<size_t>(n);
+    }
+
+    if (data.size() < kFileHeaderSize) {
+        // New (or torn before its header was complete) log
+        std::vector<uint8_t> header;
+        put<uint32_t>(header, WAL_MAGIC);
+        put<uint32_t>(header, WAL_VERSION);
+        if (truncate_log(fd_, 0) != 0) {
+            throw std::runtime_error("Cannot reset write-ahead log: " + filepath_);
+        }
+        seek_log(fd_, 0, SEEK_SET);
+        write_all(fd_, header.data(), header.size());
+        sync_log(fd_);
+        return;
+    }
+
+    FrameReader header(data.data(), kFileHeaderSize);
+    if (header.get<uint32_t>() != WAL_MAGIC || header.get<uint32_t>() != WAL_VERSION) {
+        throw std::runtime_error("Not a write-ahead log: " + filepath_);
+    }
+
+    // Read frames until the end or the first torn/corrupt one. Frames the
+    // checkpoint already covers are stepped over
+    size_t pos = kFileHeaderSize;
+    uint64_t last_lsn = 0;
+    while (data.size() - pos >= kFrameHeaderSize) {
+        FrameReader frame(data.data() + pos, kFrameHeaderSize);
+        uint32_t length = frame.get<uint32_t>();
+        uint32_t crc = frame.get<uint32_t>();
+        uint64_t lsn = frame.get<uint64_t>();
+        if (data.size() - pos - kFrameHeaderSize < length) {
+            break;
+        }
+        const uint8_t* payload = data.data() + pos + kFrameHeaderSize;
+        if (frame_checksum(lsn, payload, length) != crc || lsn <= last_lsn) {
+            break;
+        }
+        last_lsn = lsn;
+        pos += kFrameHeaderSize + length;
+        if (lsn <= base_lsn) {
+            continue;
+        }
+
+        WalTransaction txn;
+        txn.lsn = lsn;
+        FrameReader in(payload, length);
+        uint32_t count = in.get<uint32_t>();
+        for (uint32_t i = 0; i < count; ++i) {
+            txn.records.push_back(decode_record(in));
+        }
+        recovered_.push_back(std::move(txn));
+        appended_lsn_ = lsn;
+    }
+    durable_lsn_ = appended_lsn_;
+
+    if (pos != data.size() && truncate_log(fd_, static_cast<int64_t>(pos)) != 0) {
+        throw std::runtime_error("Cannot truncate write-ahead log: " + filepath_);
+    }
+    seek_log(fd_, static_cast<int64_t>(pos), SEEK_SET);
+}
+
+std::vector<WalTransaction> WriteAheadLog::take_recovered() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::move(recovered_);
+}
+
+uint64_t WriteAheadLog::append(const std::vector<WalRecord>& records) {
+    // Encode outside the lock
+    std::vector<uint8_t> payload;
+    put<uint32_t>(payload, static_cast<uint32_t>(records.size()));
+    for (const auto& record : records) {
+        encode_record(payload, record);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_.empty()) {
+        throw std::runtime_error(error_);
+    }
+    uint64_t lsn = ++appended_lsn_;
+    put<uint32_t>(pending_, static_cast<uint32_t>(payload.size()));
+    put<uint32_t>(pending_, frame_checksum(lsn, payload.data(), payload.size()));
+    put<uint64_t>(pending_, lsn);
+    pending_.insert(pending_.end(), payload.begin(), payload.end());
+    stats_.commits++;
+    return lsn;
+}
+
+void WriteAheadLog::wait_durable(uint64_t lsn) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (durable_lsn_ < lsn) {
+        if (!error_.empty()) {
+            throw std::runtime_error(error_);
+        }
+        if (flushing_) {
+            // Follower: the current leader (or the next one) covers us
+            flushed_cv_.wait(lock);
+            continue;
+        }
+
+        // Leader: optionally let more commits pile up, then sync them all
+        flushing_ = true;
+        if (commit_delay_.count() > 0) {
+            lock.unlock();
+            std::this_thread::sleep_for(commit_delay_);
+            lock.lock();
+        }
+        std::vector<uint8_t> batch;
+        batch.swap(pending_);
+        uint64_t target = appended_lsn_;
+        lock.unlock();
+
+        std::string failure;
+        try {
+            write_and_sync(batch);
+        } catch (const std::exception& e) {
+            failure = e.what();
+        }
+
+        lock.lock();
+        flushing_ = false;
+        if (failure.empty()) {
+            durable_lsn_ = target;
+            stats_.syncs++;
+            stats_.bytes_written += batch.size();
+        } else {
+            // The batch is lost; nothing after it may be acknowledged
+            error_ = failure;
+        }
+        flushed_cv_.notify_all();
+    }
+}
+
+uint64_t WriteAheadLog::commit(const std::vector<WalRecord>& records) {
+    uint64_t lsn = append(records);
+    wait_durable(lsn);
+    return lsn;
+}
+
+void WriteAheadLog::reset(uint64_t checkpoint_lsn) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    flushed_cv_.wait(lock, [this]() { return !flushing_; });
+    if (checkpoint_lsn != appended_lsn_ || durable_lsn_ != appended_lsn_) {
+        throw std::runtime_error("Checkpoint does not cover the write-ahead log: " + filepath_);
+    }
+    if (truncate_log(fd_, kFileHeaderSize) != 0 || sync_log(fd_) != 0) {
+        throw std::runtime_error("Cannot reset write-ahead log: " + filepath_);
+    }
+    seek_log(fd_, kFileHeaderSize, SEEK_SET);
+}
+
+uint64_t WriteAheadLog::durable_lsn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return durable_lsn_;
+}
+
+uint64_t WriteAheadLog::last_lsn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return appended_lsn_;
+}
+
+WalStats WriteAheadLog::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void WriteAheadLog::write_and_sync(const std::vector<uint8_t>& bytes) {
+    if (!bytes.empty()) {
+        write_all(fd_, bytes.data(), bytes.size());
+    }
+    if (sync_log(fd_) != 0) {
+        throw std::runtime_error("Write-ahead log fsync failed: " + filepath_);
+    }
+}
+
+void sync_file(const std::string& path) {
+    int fd = open_existing(path);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file to sync: " + path);
+    }
+    int result = sync_log(fd);
+    close_log(fd);
+    if (result != 0) {
+        throw std::runtime_error("fsync failed: " + path);
+    }
+}
+
+} // namespace lyradb
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "lyradb/bitpacking_compressor.h"
+#include <cstdint>
+#include <random>
+#include <vector>
 
 namespace lyradb {
 namespace compression {
@@ -51,6 +54,69 @@ TEST(BitpackingCompressorTest, EstimateRatio) {
     EXPECT_LT(ratio, 0.5);
 }
 
+TEST(BitpackingCompressorTest, BlockKernelsRoundTripEveryWidth) {
+    std::mt19937_64 rng(7);
+    constexpr size_t kBlock = BitpackingCompressor::kBlockValues;
+    for (uint8_t width = 0; width <= 32; ++width) {
+        uint32_t mask = width == 32 ? ~uint32_t(0) : (uint32_t(1) << width) - 1;
+        std::vector<uint32_t> in(kBlock);
+        for (auto& v : in) {
+            v = static_cast<uint32_t>(rng()) & mask;
+        }
+        // Eight lanes of 32 values: 8 * width words per block
+        std::vector<uint32_t> packed(8 * width + 1, 0xDEADBEEF);
+        BitpackingCompressor::pack_block(in.data(), width, packed.data());
+        EXPECT_EQ(packed.back(), 0xDEADBEEF) << "width " << int(width);
+        
+        std::vector<uint32_t> out(kBlock);
+        BitpackingCompressor::unpack_block(packed.data(), width, out.data());
+        EXPECT_EQ(out, in) << "width " << int(width);
+        
+        std::vector<int64_t> wide(kBlock);
+        BitpackingCompressor::unpack_block(packed.data(), width, int64_t(-5000000000), wide.data());
+        for (size_t i = 0; i < kBlock; ++i) {
+            ASSERT_EQ(wide[i], -5000000000 + static_cast<int64_t>(in[i])) << "width " << int(width);
+        }
+    }
+    EXPECT_THROW(BitpackingCompressor::pack_block(nullptr, 33, nullptr), std::runtime_error);
+}
+
+TEST(BitpackingCompressorTest, RoundTripAcrossBlocksAndWidths) {
+    std::mt19937_64 rng(11);
+    // Counts cover whole blocks, a tail, and fewer values than a block
+    for (size_t count : {size_t(1), size_t(255), size_t(256), size_t(1000)}) {
+        for (uint8_t width : {0, 1, 7, 13, 31, 32, 33, 47, 64}) {
+            std::vector<int64_t> values(count);
+            for (auto& v : values) {
+                uint64_t bits = width == 64 ? rng() : rng() & ((uint64_t(1) << width) - 1);
+                v = static_cast<int64_t>(bits - (uint64_t(1) << 40));
+            }
+            auto compressed = BitpackingCompressor::compress(values.data(), count);
+            EXPECT_EQ(BitpackingCompressor::value_count(compressed.data(), compressed.size()), count);
+            EXPECT_LE(compressed[0], width);
+            EXPECT_EQ(BitpackingCompressor::decompress(compressed.data(), compressed.size()), values)
+                << "count " << count << " width " << int(width);
+        }
+    }
+    
+    // Narrow values decode straight into int32
+    std::vector<int64_t> values(777);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = -1000 + static_cast<int64_t>((i * 37) % 5000);
+    }
+    auto compressed = BitpackingCompressor::compress(values.data(), values.size());
+    std::vector<int32_t> narrow(values.size());
+    ASSERT_EQ(BitpackingCompressor::decompress_into(compressed.data(), compressed.size(), narrow.data()),
+              values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(narrow[i], values[i]);
+    }
+    
+    compressed.resize(compressed.size() - 1);
+    EXPECT_THROW(BitpackingCompressor::decompress(compressed.data(), compressed.size()),
+                 std::runtime_error);
+}
+
 } // namespace test
 } // namespace compression
 } // namespace lyradb
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "lyradb/buffer_manager.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class BufferManagerTest : public ::testing::Test {
+protected:
+    static constexpr size_t kPageSize = 4096;
+
+    void SetUp() override {
+        path_ = (std::filesystem::temp_directory_path() / "lyradb_buffer_test.lycol").string();
+        std::filesystem::remove(path_);
+        // 10 pages, each filled with its page number
+        std::ofstream out(path_, std::ios::binary);
+        for (int p = 0; p < 10; ++p) {
+            std::vector<char> page(kPageSize, static_cast<char>(p));
+            out.write(page.data(), page.size());
+        }
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path_);
+    }
+
+    std::string path_;
+};
+
+TEST_F(BufferManagerTest, LoadsPagesFromFile) {
+    BufferManager buffers(4 * kPageSize, kPageSize);
+    uint32_t file = buffers.open_file(path_);
+    EXPECT_EQ(buffers.open_file(path_), file);
+    EXPECT_EQ(buffers.page_count(file), 10u);
+
+    for (uint32_t p = 0; p < 10; ++p) {
+        PageHandle page = buffers.get_page(BufferManager::make_page_id(file, p));
+        EXPECT_EQ(page.data()[0], p);
+        EXPECT_EQ(page.data()[kPageSize - 1], p);
+    }
+    // Memory stays bounded: 10 pages went through 4 frames
+    EXPECT_EQ(buffers.num_pages(), 4u);
+    BufferStats stats = buffers.stats();
+    EXPECT_EQ(stats.misses, 10u);
+    EXPECT_EQ(stats.evictions, 6u);
+
+    { PageHandle again = buffers.get_page(BufferManager::make_page_id(file, 9)); }
+    EXPECT_EQ(buffers.stats().hits, 1u);
+    EXPECT_THROW(buffers.get_page(BufferManager::make_page_id(file, 10)), std::runtime_error);
+}
+
+TEST_F(BufferManagerTest, PinnedPagesAreNotEvicted) {
+    BufferManager buffers(2 * kPageSize, kPageSize);
+    uint32_t file = buffers.open_file(path_);
+    PageId first = BufferManager::make_page_id(file, 0);
+    buffers.pin_page(first);
+    EXPECT_TRUE(buffers.is_pinned(first));
+
+    for (uint32_t p = 1; p < 10; ++p) {
+        PageHandle page = buffers.get_page(BufferManager::make_page_id(file, p));
+        EXPECT_EQ(page.data()[0], p);
+    }
+    uint64_t misses = buffers.stats().misses;
+    { PageHandle page = buffers.get_page(first); }
+    EXPECT_EQ(buffers.stats().misses, misses);
+
+    // Both frames pinned: nothing can be loaded
+    PageHandle held = buffers.get_page(BufferManager::make_page_id(file, 5));
+    EXPECT_THROW(buffers.get_page(BufferManager::make_page_id(file, 6)), std::runtime_error);
+    held.release();
+    buffers.unpin_page(first);
+    EXPECT_FALSE(buffers.is_pinned(first));
+    EXPECT_NO_THROW(buffers.get_page(BufferManager::make_page_id(file, 6)));
+}
+
+TEST_F(BufferManagerTest, DirtyPagesAreWrittenBack) {
+    {
+        BufferManager buffers(2 * kPageSize, kPageSize);
+        uint32_t file = buffers.open_file(path_);
+        {
+            PageHandle page = buffers.get_page(BufferManager::make_page_id(file, 3));
+            std::memset(page.data(), 0xAB, 16);
+            page.mark_dirty();
+        }
+        // Evicting page 3 writes it back
+        for (uint32_t p = 4; p < 8; ++p) {
+            buffers.get_page(BufferManager::make_page_id(file, p));
+        }
+        EXPECT_EQ(buffers.stats().writebacks, 1u);
+        PageHandle page = buffers.get_page(BufferManager::make_page_id(file, 3));
+        EXPECT_EQ(page.data()[0], 0xAB);
+        EXPECT_EQ(page.data()[16], 3);
+
+        PageHandle added = buffers.allocate_page(file);
+        EXPECT_EQ(BufferManager::page_of(added.page_id()), 10u);
+        std::memcpy(added.data(), "appended", 8);
+        added.release();
+        page.release();
+        buffers.flush_all();
+        EXPECT_EQ(buffers.stats().writebacks, 2u);
+    }
+
+    EXPECT_EQ(std::filesystem::file_size(path_), 11 * kPageSize);
+    BufferManager reopened(2 * kPageSize, kPageSize);
+    uint32_t file = reopened.open_file(path_);
+    EXPECT_EQ(reopened.page_count(file), 11u);
+    PageHandle added = reopened.get_page(BufferManager::make_page_id(file, 10));
+    EXPECT_EQ(std::memcmp(added.data(), "appended", 8), 0);
+}
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include "lyradb/compiled_expression.h"
+#include "lyradb/database.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/table.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class CompiledExpressionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        schema_ = Schema({
+            ColumnDef("id", DataType::INT64),
+            ColumnDef("price", DataType::FLOAT64),
+            ColumnDef("name", DataType::STRING),
+            ColumnDef("active", DataType::BOOL)
+        });
+        table_ = std::make_unique<Table>("items", schema_);
+        table_->insert_row(std::vector<std::string>{"1", "9.5", "apple", "true"});
+        table_->insert_row(std::vector<std::string>{"2", "20", "banana", "false"});
+        table_->insert_row(std::vector<std::string>{"3", "", "cherry", "true"});
+    }
+
+    // Parse "SELECT * FROM items WHERE <expr>" and return the WHERE tree
+    std::unique_ptr<CompiledExpression> compile_where(const std::string& where) {
+        stmt_ = parser_.parse_select_statement("SELECT * FROM items WHERE " + where);
+        if (!stmt_ || !stmt_->where_clause) {
+            return nullptr;
+        }
+        return compiler_.compile(stmt_->where_clause.get(), schema_);
+    }
+
+    std::vector<size_t> matching_rows(const CompiledExpression& program) {
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < table_->row_count(); ++i) {
+            if (program.matches(*table_, i)) {
+                rows.push_back(i);
+            }
+        }
+        return rows;
+    }
+
+    Schema schema_;
+    std::unique_ptr<Table> table_;
+    query::SqlParser parser_;
+    std::unique_ptr<query::SelectStatement> stmt_;
+    ExpressionCompiler compiler_;
+};
+
+TEST_F(CompiledExpressionTest, IntegerComparison) {
+    auto program = compile_where("id > 1");
+    ASSERT_NE(program, nullptr);
+    EXPECT_EQ(matching_rows(*program), (std::vector<size_t>{1, 2}));
+}
+
+TEST_F(CompiledExpressionTest, MixedNumericComparison) {
+    auto program = compile_where("price >= 10");
+    ASSERT_NE(program, nullptr);
+    EXPECT_EQ(matching_rows(*program), (std::vector<size_t>{1}));
+}
+
+TEST_F(CompiledExpressionTest, NullNeverMatches) {
+    auto program = compile_where("price < 100");
+    ASSERT_NE(program, nullptr);
+    EXPECT_EQ(matching_rows(*program), (std::vector<size_t>{0, 1}));
+}
+
+TEST_F(CompiledExpressionTest, StringAndLogic) {
+    auto program = compile_where("name = 'banana' OR id = 3 AND active = 1");
+    ASSERT_NE(program, nullptr);
+    EXPECT_EQ(matching_rows(*program), (std::vector<size_t>{1, 2}));
+}
+
+TEST_F(CompiledExpressionTest, LikeWildcards) {
+    auto program = compile_where("name LIKE '%an%'");
+    ASSERT_NE(program, nullptr);
+    EXPECT_EQ(matching_rows(*program), (std::vector<size_t>{1}));
+}
+
+TEST_F(CompiledExpressionTest, ArithmeticValue) {
+    auto program = compile_where("id + 20 - 1");
+    ASSERT_NE(program, nullptr);
+    EXPECT_EQ(program->result_kind(), ValueKind::INT);
+    auto value = program->evaluate(*table_, 1);
+    ASSERT_TRUE(std::holds_alternative<int64_t>(value));
+    EXPECT_EQ(std::get<int64_t>(value), 21);
+}
+
+TEST_F(CompiledExpressionTest, StringRowInput) {
+    auto program = compile_where("id = 2 AND price > 15");
+    ASSERT_NE(program, nullptr);
+    EXPECT_TRUE(program->matches(std::vector<std::string>{"2", "20", "banana", "false"}));
+    EXPECT_FALSE(program->matches(std::vector<std::string>{"2", "", "banana", "false"}));
+}
+
+TEST_F(CompiledExpressionTest, UnknownColumnIsRejected) {
+    EXPECT_EQ(compile_where("missing = 1"), nullptr);
+    EXPECT_FALSE(compiler_.get_last_error().empty());
+}
+
+TEST_F(CompiledExpressionTest, ReferencedColumns) {
+    auto program = compile_where("id > 1 AND name = 'x' AND id < 5");
+    ASSERT_NE(program, nullptr);
+    EXPECT_EQ(program->referenced_columns(), (std::vector<size_t>{0, 2}));
+}
+
+TEST(CompiledExpressionDatabaseTest, WhereUsesCompiledProgram) {
+    Database db(":memory:");
+    db.execute("CREATE TABLE t (id INT, amount DOUBLE)");
+    for (int i = 0; i < 100; ++i) {
+        db.execute("INSERT INTO t VALUES (" + std::to_string(i) + ", " + std::to_string(i) + ".5)");
+    }
+
+    auto result = db.execute("SELECT * FROM t WHERE id >= 90 AND amount < 95");
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->row_count(), 5u);
+
+    auto updated = db.execute("UPDATE t SET amount = amount + 100 WHERE id < 10");
+    auto* update_result = dynamic_cast<EngineQueryResult*>(updated.get());
+    ASSERT_NE(update_result, nullptr);
+    EXPECT_EQ(update_result->get_affected_rows(), 10);
+
+    auto deleted = db.execute("DELETE FROM t WHERE amount > 50");
+    auto* delete_result = dynamic_cast<EngineQueryResult*>(deleted.get());
+    ASSERT_NE(delete_result, nullptr);
+    EXPECT_EQ(delete_result->get_affected_rows(), 60);
+}
+
+TEST(CompiledExpressionDatabaseTest, AssignmentsReadThePreUpdateRow) {
+    // The first UPDATE is compiled; ROUND is not, so the second goes
+    // through the interpreter. Both must see the old id.
+    Database db(":memory:");
+    db.execute("CREATE TABLE t (id INT, b INT)");
+    db.execute("INSERT INTO t VALUES (1, 0)");
+    db.execute("INSERT INTO t VALUES (2, 0)");
+
+    db.execute("UPDATE t SET id = id + 100, b = id WHERE id = 1");
+    db.execute("UPDATE t SET id = id + 100, b = ROUND(id) WHERE id = 2");
+
+    auto table = db.get_table_snapshot("t");
+    EXPECT_EQ(table->get_row(0), (std::vector<std::string>{"101", "1"}));
+    EXPECT_EQ(table->get_row(1), (std::vector<std::string>{"102", "2"}));
+}
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "lyradb/compiled_expression.h"
+#include "lyradb/simd_kernels.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/table.h"
+#include "lyradb/vector_batch.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class CompressedExecutionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        schema_ = Schema({
+            ColumnDef("id", DataType::INT32),
+            ColumnDef("city", DataType::STRING)
+        });
+        plain_ = std::make_unique<Table>("t", schema_);
+        encoded_ = std::make_unique<Table>("t", schema_);
+        const char* cities[] = {"paris", "rome", "oslo", "lima"};
+        for (int i = 0; i < 2000; ++i) {
+            // Runs of 100 equal ids; every 7th city is NULL
+            std::vector<std::string> row = {std::to_string(i / 100), i % 7 == 0 ? "" : cities[i % 4]};
+            plain_->insert_row(row);
+            encoded_->insert_row(row);
+        }
+        encoded_->finalize();
+    }
+
+    std::vector<uint32_t> filter(const Table& table, const std::string& where,
+                                 simd::InstructionSet isa, bool sparse) {
+        auto stmt = parser_.parse_select_statement("SELECT * FROM t WHERE " + where);
+        auto program = compiler_.compile(stmt->where_clause.get(), schema_);
+        VectorBatch batch = VectorBatch::from_table(table, 300, 1000);
+        SelectionVector selection;
+        select_all(selection, batch.size);
+        if (sparse) {
+            SelectionVector every_third;
+            for (size_t k = 0; k < selection.size(); k += 3) {
+                every_third.push_back(selection[k]);
+            }
+            selection = every_third;
+        }
+        program->filter_batch(batch, selection, isa);
+        return std::vector<uint32_t>(selection.begin(), selection.end());
+    }
+
+    Schema schema_;
+    std::unique_ptr<Table> plain_;
+    std::unique_ptr<Table> encoded_;
+    query::SqlParser parser_;
+    ExpressionCompiler compiler_;
+};
+
+TEST_F(CompressedExecutionTest, FinalizeEncodesColumns) {
+    EXPECT_FALSE(plain_->column(1).is_dictionary_encoded());
+    EXPECT_TRUE(plain_->column(0).run_ends().empty());
+
+    const Column& city = encoded_->column(1);
+    ASSERT_TRUE(city.is_dictionary_encoded());
+    EXPECT_EQ(city.dictionary(), (std::vector<std::string>{"", "lima", "oslo", "paris", "rome"}));
+    EXPECT_EQ(encoded_->column(0).run_ends().size(), 20u);
+    for (size_t row = 0; row < 2000; ++row) {
+        ASSERT_EQ(city.string_at(row), plain_->column(1).string_at(row));
+        ASSERT_EQ(city.get_string(row), plain_->column(1).get_string(row));
+    }
+    EXPECT_EQ(city.serialize_rows(10, 1500), plain_->column(1).serialize_rows(10, 1500));
+}
+
+TEST_F(CompressedExecutionTest, PredicatesMatchPlainColumns) {
+    const char* predicates[] = {
+        "city = 'rome'", "city <> 'rome'", "city = 'berlin'", "city <> 'berlin'",
+        "city < 'paris'", "city <= 'paris'", "city > 'oslo'", "city >= 'p'", "city < 'a'",
+        "id = 7", "id <> 5", "id > 12", "id <= 3", "5 < id", "id BETWEEN 4 AND 6"
+    };
+    for (const char* where : predicates) {
+        for (auto isa : {simd::InstructionSet::SCALAR, simd::detect_instruction_set()}) {
+            for (bool sparse : {false, true}) {
+                auto expected = filter(*plain_, where, isa, sparse);
+                EXPECT_EQ(filter(*encoded_, where, isa, sparse), expected) << where;
+            }
+        }
+    }
+    // Sanity: NULL cities never match, even for a missing constant
+    EXPECT_EQ(filter(*encoded_, "city <> 'berlin'", simd::InstructionSet::SCALAR, false).size(),
+              1000u - 143u);
+}
+
+TEST(CompressedColumnTest, AppendsKeepEncodingUntilModified) {
+    Column strings("s", DataType::STRING);
+    for (int i = 0; i < 100; ++i) {
+        strings.append_string(i % 2 ? "b" : "a");
+    }
+    strings.encode();
+    ASSERT_TRUE(strings.is_dictionary_encoded());
+
+    strings.append_string("b");
+    EXPECT_TRUE(strings.is_dictionary_encoded());
+    EXPECT_EQ(strings.string_at(100), "b");
+
+    // A value outside the dictionary reverts to plain strings
+    strings.append_string("c");
+    EXPECT_FALSE(strings.is_dictionary_encoded());
+    EXPECT_EQ(strings.num_values(), 102u);
+    EXPECT_EQ(strings.string_at(99), "b");
+    EXPECT_EQ(strings.string_at(101), "c");
+
+    Column ints("i", DataType::INT64);
+    for (int64_t i = 0; i < 64; ++i) {
+        int64_t v = i / 32;
+        ints.append_value(&v);
+    }
+    ints.encode();
+    EXPECT_EQ(ints.run_ends(), (std::vector<uint32_t>{32, 64}));
+    int64_t v = 1;
+    ints.append_value(&v);
+    ints.append_null();
+    EXPECT_EQ(ints.run_ends(), (std::vector<uint32_t>{32, 65, 66}));
+
+    ints.set_string(0, "5");
+    EXPECT_TRUE(ints.run_ends().empty());
+    EXPECT_EQ(ints.data<int64_t>()[0], 5);
+}
+
+} // namespace test
+} // namespace lyradb
@@ -3,17 +3,22 @@
 #include "lyradb/delta_compressor.h"
 #include "lyradb/bitpacking_compressor.h"
 #include "lyradb/dict_compressor.h"
+#include <cstdint>
+#include <vector>
 
 namespace lyradb {
 namespace compression {
 namespace test {
 
 TEST(CompressionSelectorTest, SelectForIntegers_SortedData) {
-    // Sorted data should select DELTA
-    int64_t values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    // Sorted IDs over a wide range should select PFOR (delta mode)
+    std::vector<int64_t> values(1000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = 5000000000LL + 3 * static_cast<int64_t>(i);
+    }
     
-    auto algo = CompressionSelector::select_for_integers(values, 10);
-    EXPECT_EQ(algo, CompressionAlgorithm::DELTA);
+    auto algo = CompressionSelector::select_for_integers(values.data(), values.size());
+    EXPECT_EQ(algo, CompressionAlgorithm::PFOR);
 }
 
 TEST(CompressionSelectorTest, SelectForIntegers_SmallRange) {
@@ -25,8 +30,8 @@ TEST(CompressionSelectorTest, SelectForIntegers_SmallRange) {
 }
 
 TEST(CompressionSelectorTest, SelectForIntegers_RandomData) {
-    // Random large values should select ZSTD or UNCOMPRESSED
-    int64_t values[] = {1000000, 2000000, 3000000, 4000000};
+    // Random values over the full 64-bit range should select ZSTD or UNCOMPRESSED
+    int64_t values[] = {INT64_MIN + 7, 4000000, INT64_MAX - 3, -1000000};
     
     auto algo = CompressionSelector::select_for_integers(values, 4, 0.99);
     // Should be UNCOMPRESSED or ZSTD for poor compression data
@@ -52,6 +57,14 @@ TEST(CompressionSelectorTest, AlgorithmNameConversion) {
     EXPECT_STREQ(
         CompressionSelector::algorithm_name(CompressionAlgorithm::DICTIONARY),
         "Dictionary Encoding");
+    
+    EXPECT_STREQ(
+        CompressionSelector::algorithm_name(CompressionAlgorithm::PFOR),
+        "Patched Frame of Reference");
+    
+    EXPECT_STREQ(
+        CompressionSelector::algorithm_name(CompressionAlgorithm::FSST),
+        "FSST");
 }
 
 TEST(CompressionSelectorTest, EstimateRatioForBitpacking) {
@@ -0,0 +1,532 @@
+#include <gtest/gtest.h>
+#include "lyradb/column_serializer.h"
+#include "lyradb/database_file.h"
+#include "lyradb/io_throttle.h"
+#include "lyradb/table.h"
+#include "lyradb/table_serializer.h"
+#include "lyradb/task_scheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class DatabaseFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() / "lyradb_database_file_test";
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir_);
+    }
+
+    std::string path(const std::string& name) const {
+        return (dir_ / name).string();
+    }
+
+    // Grows t's tail row group by a batch per save, so every save
+    // re-appends the tail pages and leaves the previous ones dead
+    static void trickle(DatabaseFile& dbf, size_t batches, size_t batch_rows) {
+        Table& t = *dbf.get_database().get_table("t");
+        for (size_t b = 0; b < batches; ++b) {
+            for (size_t i = 0; i < batch_rows; ++i) {
+                size_t id = t.row_count();
+                t.insert_row(std::vector<std::string>{std::to_string(id), "tag" + std::to_string(id % 10)});
+            }
+            dbf.save();
+        }
+    }
+
+    std::filesystem::path dir_;
+};
+
+TEST_F(DatabaseFileTest, SaveAndReopenRoundTrip) {
+    const std::string db_path = path("shop.db");
+    {
+        DatabaseFile dbf(db_path);
+        dbf.get_database().create_table("items", Schema({
+            ColumnDef("id", DataType::INT64),
+            ColumnDef("price", DataType::FLOAT64),
+            ColumnDef("name", DataType::STRING),
+            ColumnDef("active", DataType::BOOL)
+        }));
+        dbf.get_database().create_table("empty", Schema({ColumnDef("id", DataType::INT32)}));
+        Table& items = *dbf.get_database().get_table("items");
+        // Large enough to span several 64KB pages per column
+        for (int i = 0; i < 20000; ++i) {
+            items.insert_row(std::vector<std::string>{
+                std::to_string(i),
+                i % 7 == 0 ? "" : std::to_string(i * 0.25),
+                "item_" + std::to_string(i % 100),
+                i % 2 ? "true" : "false"});
+        }
+        dbf.save();
+    }
+    EXPECT_TRUE(std::filesystem::exists(DatabaseFile::data_dir(db_path)));
+
+    DatabaseFile reopened = DatabaseFile::open(db_path);
+    EXPECT_EQ(reopened.get_table_count(), 2u);
+    EXPECT_EQ(reopened.get_total_rows(), 20000u);
+
+    auto items = reopened.get_database().get_table("items");
+    ASSERT_NE(items, nullptr);
+    EXPECT_EQ(items->get_schema().get_column(2).name, "name");
+    EXPECT_EQ(items->column(0).data<int64_t>()[19999], 19999);
+    EXPECT_TRUE(items->column(1).is_null(7));
+    EXPECT_DOUBLE_EQ(items->column(1).data<double>()[9], 2.25);
+    EXPECT_EQ(items->column(2).string_at(12345), "item_45");
+    EXPECT_EQ(items->get_row(3), (std::vector<std::string>{"3", "0.75", "item_3", "true"}));
+    EXPECT_EQ(reopened.get_database().get_table("empty")->row_count(), 0u);
+
+    auto result = reopened.execute("SELECT id FROM items WHERE id >= 19990");
+    EXPECT_EQ(result->row_count(), 10u);
+}
+
+TEST_F(DatabaseFileTest, OpenLoadsColumnsOnFirstAccess) {
+    const std::string db_path = path("lazy.db");
+    {
+        DatabaseFile dbf(db_path);
+        dbf.get_database().create_table("t", Schema({
+            ColumnDef("a", DataType::INT32),
+            ColumnDef("b", DataType::STRING)
+        }));
+        Table& t = *dbf.get_database().get_table("t");
+        for (int i = 0; i < 5000; ++i) {
+            t.insert_row(std::vector<std::string>{std::to_string(i), "v" + std::to_string(i)});
+        }
+        dbf.save();
+    }
+
+    DatabaseFile reopened = DatabaseFile::open(db_path);
+    auto t = reopened.get_database().get_table("t");
+    EXPECT_EQ(t->row_count(), 5000u);
+    EXPECT_FALSE(t->is_column_loaded(0));
+    EXPECT_FALSE(t->is_column_loaded(1));
+
+    EXPECT_EQ(t->column(0).data<int32_t>()[4321], 4321);
+    EXPECT_TRUE(t->is_column_loaded(0));
+    EXPECT_FALSE(t->is_column_loaded(1));
+
+    // Writes go to the delta store; merging it pulls in the remaining columns
+    t->insert_row(std::vector<std::string>{"-1", "last"});
+    EXPECT_FALSE(t->is_column_loaded(1));
+    EXPECT_EQ(t->get_row(5000), (std::vector<std::string>{"-1", "last"}));
+    t->merge_delta();
+    EXPECT_TRUE(t->is_column_loaded(1));
+    EXPECT_EQ(t->column(1).get_string(5000), "last");
+}
+
+TEST_F(DatabaseFileTest, QueriesLoadOnlyTheColumnsTheyRead) {
+    const std::string db_path = path("narrow.db");
+    const size_t rows = 3 * Table::kRowGroupRows;
+    {
+        DatabaseFile dbf(db_path);
+        dbf.get_database().create_table("t", Schema({
+            ColumnDef("a", DataType::INT32),
+            ColumnDef("b", DataType::INT32),
+            ColumnDef("c", DataType::STRING)
+        }));
+        Table& t = *dbf.get_database().get_table("t");
+        for (size_t i = 0; i < rows; ++i) {
+            t.insert_row(std::vector<std::string>{std::to_string(i), std::to_string(i % 128),
+                                                  "wide_" + std::to_string(i)});
+        }
+        dbf.save();
+    }
+
+    // A filter binds only the columns it and the projection read
+    {
+        DatabaseFile reopened = DatabaseFile::open(db_path);
+        auto t = reopened.get_database().get_table("t");
+        auto result = reopened.execute("SELECT a FROM t WHERE b < 5");
+        EXPECT_EQ(result->row_count(), rows / 128 * 5);
+        EXPECT_TRUE(t->is_column_loaded(1));
+        EXPECT_FALSE(t->is_column_loaded(2));
+
+        // Delta rows are copied for the bound columns only
+        reopened.execute("INSERT INTO t VALUES (-1, 1, 'new')");
+        result = reopened.execute("SELECT a FROM t WHERE b = 1");
+        EXPECT_EQ(result->row_count(), rows / 128 + 1);
+        EXPECT_FALSE(t->is_column_loaded(2));
+    }
+
+    // So does a scan cut short by LIMIT
+    {
+        DatabaseFile reopened = DatabaseFile::open(db_path);
+        auto t = reopened.get_database().get_table("t");
+        auto result = reopened.execute("SELECT a FROM t WHERE b < 5 LIMIT 10");
+        EXPECT_EQ(result->row_count(), 10u);
+        EXPECT_FALSE(t->is_column_loaded(2));
+    }
+}
+
+TEST_F(DatabaseFileTest, ZoneMapsPruneBeforeColumnsLoad) {
+    const std::string db_path = path("zones.db");
+    const size_t rows = 4 * Table::kRowGroupRows;
+    {
+        DatabaseFile dbf(db_path);
+        dbf.execute("CREATE TABLE t (id BIGINT, tag VARCHAR)");
+        Table& t = *dbf.get_database().get_table("t");
+        for (size_t i = 0; i < rows; ++i) {
+            t.insert_row(std::vector<std::string>{std::to_string(i), "tag" + std::to_string(i % 10)});
+        }
+        dbf.save();
+    }
+
+    {
+        DatabaseFile reopened = DatabaseFile::open(db_path);
+        auto t = reopened.get_database().get_table("t");
+        const auto& zones = t->zone_map(0, 2).zones();
+        ASSERT_FALSE(zones.empty());
+        EXPECT_EQ(zones.front().min_int, static_cast<int64_t>(2 * Table::kRowGroupRows));
+        EXPECT_EQ(zones.back().max_int, static_cast<int64_t>(3 * Table::kRowGroupRows - 1));
+        EXPECT_FALSE(t->is_column_loaded(0));
+
+        // Every row group is ruled out by its stored zones alone
+        auto result = reopened.execute("SELECT tag FROM t WHERE id < 0");
+        EXPECT_EQ(result->row_count(), 0u);
+        EXPECT_FALSE(t->is_column_loaded(0));
+
+        result = reopened.execute("SELECT tag FROM t WHERE id >= " + std::to_string(rows - 10));
+        EXPECT_EQ(result->row_count(), 10u);
+        EXPECT_TRUE(t->is_column_loaded(0));
+
+        // A checkpoint keeps the zones of groups it does not rewrite
+        reopened.execute("UPDATE t SET id = -5 WHERE id = " + std::to_string(Table::kRowGroupRows + 1));
+        reopened.save();
+    }
+
+    DatabaseFile reopened = DatabaseFile::open(db_path);
+    auto t = reopened.get_database().get_table("t");
+    EXPECT_EQ(t->zone_map(0, 1).zones().front().min_int, -5);
+    EXPECT_EQ(t->zone_map(0, 3).zones().front().min_int, static_cast<int64_t>(3 * Table::kRowGroupRows));
+    EXPECT_EQ(reopened.execute("SELECT tag FROM t WHERE id < 0")->row_count(), 1u);
+}
+
+TEST_F(DatabaseFileTest, ColumnPagesRoundTripAndDetectCorruption) {
+    const std::string col_path = path("c.lycol");
+    std::vector<uint8_t> runs(8 * 4096, 0);
+    std::vector<uint8_t> noise(5000);
+    for (size_t i = 0; i < noise.size(); ++i) {
+        noise[i] = static_cast<uint8_t>(i * 131 + 7);
+    }
+    {
+        storage::ColumnWriter writer(col_path, 3, 1);
+        writer.write_page(runs.data(), runs.size(), 4096, 1);    // RLE
+        writer.write_page(noise.data(), noise.size(), 5000, 0);  // Raw
+        writer.finalize();
+    }
+
+    storage::ColumnReader reader(col_path);
+    EXPECT_EQ(reader.column_id(), 3u);
+    ASSERT_EQ(reader.page_count(), 2u);
+    EXPECT_EQ(reader.get_page_metadata(0).compression.algorithm, 1u);
+    EXPECT_LT(reader.get_page_metadata(0).page_size, runs.size());
+    EXPECT_EQ(reader.read_page(0), runs);
+    EXPECT_EQ(reader.read_page(1), noise);
+
+    // Flip one payload byte of the second page
+    uint64_t offset = reader.get_page_metadata(1).file_offset + sizeof(storage::PageHeader) + 10;
+    {
+        std::fstream file(col_path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(offset);
+        char byte = static_cast<char>(noise[10] ^ 0xFF);
+        file.write(&byte, 1);
+    }
+    storage::ColumnReader corrupted(col_path);
+    EXPECT_EQ(corrupted.read_page(0), runs);
+    EXPECT_THROW(corrupted.read_page(1), std::runtime_error);
+}
+
+TEST_F(DatabaseFileTest, TableManifestCarriesSchemaAndStatistics) {
+    Schema schema({ColumnDef("id", DataType::INT32, false), ColumnDef("tag", DataType::STRING)});
+    Table table("tags", schema);
+    for (int i = 0; i < 1000; ++i) {
+        table.insert_row(std::vector<std::string>{std::to_string(i), i % 3 ? "x" : ""});
+    }
+
+    TaskScheduler scheduler(3);
+    const std::string manifest = path("tags.lyta");
+    {
+        storage::TableWriter writer(manifest, schema, dir_.string());
+        writer.write_table(table, scheduler);
+        writer.finalize();
+    }
+
+    storage::TableReader reader(manifest);
+    EXPECT_EQ(reader.table_name(), "tags");
+    EXPECT_EQ(reader.get_row_count(), 1000u);
+    ASSERT_EQ(reader.get_schema().num_columns(), 2u);
+    EXPECT_EQ(reader.get_schema().get_column(1).name, "tag");
+    EXPECT_FALSE(reader.get_schema().get_column(0).nullable);
+
+    auto loaded = reader.read_table(scheduler);
+    EXPECT_EQ(loaded->row_count(), 1000u);
+    EXPECT_EQ(loaded->column(1).null_count(), table.column(1).null_count());
+    EXPECT_EQ(loaded->get_row(999), table.get_row(999));
+}
+
+TEST_F(DatabaseFileTest, CheckpointRewritesOnlyDirtyRowGroups) {
+    const std::string db_path = path("incr.db");
+    const size_t rows = 5 * Table::kRowGroupRows;
+    DatabaseFile dbf(db_path);
+    dbf.execute("CREATE TABLE t (id BIGINT, tag VARCHAR)");
+    Table& t = *dbf.get_database().get_table("t");
+    for (size_t i = 0; i < rows; ++i) {
+        t.insert_row(std::vector<std::string>{std::to_string(i), "tag" + std::to_string(i % 10)});
+    }
+    dbf.save();
+
+    const std::string id_file = DatabaseFile::data_dir(db_path) + "/t0/column_0.lycol";
+    storage::ColumnReader before(id_file);
+    ASSERT_EQ(before.page_count(), 5u);
+    auto size_before = std::filesystem::file_size(id_file);
+
+    // One row in group 2 changes: only that group's pages are appended
+    dbf.execute("UPDATE t SET tag = 'changed' WHERE id = " + std::to_string(2 * Table::kRowGroupRows + 7));
+    EXPECT_EQ(t.dirty_row_groups(), (std::vector<size_t>{2}));
+    dbf.save();
+    EXPECT_FALSE(t.is_dirty());
+    EXPECT_FALSE(std::filesystem::exists(DatabaseFile::data_dir(db_path) + "/t0/table.1.lyta"));
+
+    storage::ColumnReader after(id_file);
+    ASSERT_EQ(after.page_count(), 5u);
+    for (uint32_t g = 0; g < 5; ++g) {
+        if (g == 2) {
+            EXPECT_GE(after.get_page_metadata(g).file_offset, size_before);
+        } else {
+            EXPECT_EQ(after.get_page_metadata(g).file_offset, before.get_page_metadata(g).file_offset);
+        }
+    }
+    // Sequential ids pack to a few bytes per page, so bound the growth by
+    // what rewriting every group would append rather than by file size
+    size_t page_bytes = sizeof(storage::PageHeader) + after.get_page_metadata(2).page_size;
+    EXPECT_LT(std::filesystem::file_size(id_file) - size_before, 5 * page_bytes);
+    // The reader opened before the checkpoint still sees its own version
+    EXPECT_EQ(before.read_page(1), after.read_page(1));
+
+    // A delete only changes the deletion vectors in the manifest
+    dbf.execute("DELETE FROM t WHERE id = " + std::to_string(3 * Table::kRowGroupRows));
+    EXPECT_TRUE(t.dirty_row_groups().empty());
+    EXPECT_TRUE(t.is_dirty());
+    dbf.save();
+    EXPECT_FALSE(t.is_dirty());
+    storage::ColumnReader deleted(id_file);
+    for (uint32_t g = 0; g < 5; ++g) {
+        EXPECT_EQ(deleted.get_page_metadata(g).file_offset, after.get_page_metadata(g).file_offset);
+    }
+
+    {
+        DatabaseFile reopened = DatabaseFile::open(db_path);
+        auto loaded = reopened.get_database().get_table("t");
+        ASSERT_EQ(loaded->row_count(), rows);
+        EXPECT_EQ(loaded->live_row_count(), rows - 1);
+        EXPECT_TRUE(loaded->is_deleted(3 * Table::kRowGroupRows));
+        EXPECT_FALSE(loaded->is_dirty());
+        EXPECT_EQ(reopened.get_total_rows(), rows - 1);
+    }
+
+    // Purging shifts every row from group 3 on, so those groups are rewritten
+    EXPECT_EQ(dbf.get_database().purge_deleted("t"), 1u);
+    EXPECT_EQ(t.dirty_row_groups(), (std::vector<size_t>{3, 4}));
+    dbf.save();
+
+    DatabaseFile reopened = DatabaseFile::open(db_path);
+    auto loaded = reopened.get_database().get_table("t");
+    ASSERT_EQ(loaded->row_count(), rows - 1);
+    EXPECT_EQ(loaded->deleted_count(), 0u);
+    EXPECT_EQ(loaded->get_row(2 * Table::kRowGroupRows + 7)[1], "changed");
+    EXPECT_EQ(loaded->get_row(3 * Table::kRowGroupRows)[0], std::to_string(3 * Table::kRowGroupRows + 1));
+    EXPECT_EQ(loaded->get_row(rows - 2), t.get_row(rows - 2));
+
+    // Compaction starts over in a fresh directory
+    reopened.compact();
+    EXPECT_FALSE(std::filesystem::exists(DatabaseFile::data_dir(db_path) + "/t0"));
+    EXPECT_EQ(DatabaseFile::open(db_path).get_database().get_table("t")->get_row(100), t.get_row(100));
+}
+
+TEST_F(DatabaseFileTest, RecoveryReplaysLogTailOnCheckpoint) {
+    const std::string db_path = path("crash.db");
+    const std::string copy_path = path("recovered.db");
+    DatabaseFile dbf(db_path);
+    dbf.execute("CREATE TABLE a (id INT, name VARCHAR)");
+    dbf.execute("CREATE TABLE b (x DOUBLE)");
+    dbf.execute("INSERT INTO a VALUES (1, 'one'), (2, 'two'), (3, 'three')");
+    dbf.execute("INSERT INTO b VALUES (0.5), (1.5)");
+    dbf.save();
+    EXPECT_EQ(std::filesystem::file_size(DatabaseFile::wal_path(db_path)), 8u);
+
+    // Committed after the checkpoint: only in the log
+    dbf.execute("INSERT INTO a VALUES (4, 'four')");
+    dbf.execute("UPDATE a SET name = 'TWO' WHERE id = 2");
+    dbf.execute("DELETE FROM b WHERE x < 1");
+    dbf.execute("CREATE TABLE c (n INT)");
+    dbf.execute("INSERT INTO c VALUES (7)");
+    dbf.execute("DROP TABLE b");
+    dbf.execute("CREATE TABLE b (y INT)");
+    dbf.execute("INSERT INTO b VALUES (9)");
+
+    // Crash: the files as they are on disk right now
+    std::filesystem::copy_file(db_path, copy_path);
+    std::filesystem::copy(DatabaseFile::data_dir(db_path), DatabaseFile::data_dir(copy_path),
+                          std::filesystem::copy_options::recursive);
+    std::filesystem::copy_file(DatabaseFile::wal_path(db_path), DatabaseFile::wal_path(copy_path));
+
+    {
+        DatabaseFile recovered = DatabaseFile::open(copy_path);
+        Database& db = recovered.get_database();
+        EXPECT_EQ(db.list_tables(), (std::vector<std::string>{"a", "b", "c"}));
+        auto a = db.get_table("a");
+        ASSERT_EQ(a->row_count(), 4u);
+        EXPECT_EQ(a->get_row(1), (std::vector<std::string>{"2", "TWO"}));
+        EXPECT_EQ(a->get_row(3), (std::vector<std::string>{"4", "four"}));
+        EXPECT_EQ(db.get_table("b")->get_row(0), (std::vector<std::string>{"9"}));
+        EXPECT_EQ(db.get_table("c")->row_count(), 1u);
+
+        // Checkpoint the recovered state; the log is emptied
+        recovered.execute("INSERT INTO a VALUES (5, 'five')");
+        recovered.save();
+        EXPECT_EQ(std::filesystem::file_size(DatabaseFile::wal_path(copy_path)), 8u);
+    }
+
+    DatabaseFile reopened = DatabaseFile::open(copy_path);
+    EXPECT_EQ(reopened.get_database().get_table("a")->row_count(), 5u);
+    EXPECT_EQ(reopened.get_database().get_table("b")->get_row(0), (std::vector<std::string>{"9"}));
+    EXPECT_EQ(reopened.get_total_rows(), 7u);
+}
+
+TEST_F(DatabaseFileTest, UnreadableCatalogIsNotOverwritten) {
+    const std::string db_path = path("old.db");
+    {
+        DatabaseFile dbf(db_path);
+        dbf.execute("CREATE TABLE important (id INT)");
+        dbf.execute("INSERT INTO important VALUES (1), (2)");
+        dbf.save();
+        dbf.execute("INSERT INTO important VALUES (3)");
+    }
+    {
+        // A catalog version this build does not read
+        std::fstream file(db_path, std::ios::binary | std::ios::in | std::ios::out);
+        uint32_t version = 2;
+        file.seekp(sizeof(uint32_t));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    }
+    auto listing = [&]() {
+        std::vector<std::string> files;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dir_)) {
+            files.push_back(entry.path().string() + " " +
+                            std::to_string(entry.is_regular_file() ? entry.file_size() : 0));
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    };
+    auto before = listing();
+
+    // Opening fails instead of starting empty, so nothing is overwritten
+    EXPECT_THROW(DatabaseFile dbf(db_path), std::runtime_error);
+    EXPECT_THROW(DatabaseFile::open(db_path), std::runtime_error);
+    EXPECT_EQ(listing(), before);
+}
+
+TEST_F(DatabaseFileTest, CompactionMergesTrickleInsertsOnline) {
+    const std::string db_path = path("compact.db");
+    const std::string data = DatabaseFile::data_dir(db_path);
+    DatabaseFile dbf(db_path);
+    dbf.execute("CREATE TABLE t (id BIGINT, tag VARCHAR)");
+    trickle(dbf, 1, 2 * Table::kRowGroupRows);
+    trickle(dbf, 20, 400);
+    const size_t rows = 2 * Table::kRowGroupRows + 20 * 400;
+    auto trickled_size = std::filesystem::file_size(data + "/t0/column_0.lycol");
+    dbf.execute("DELETE FROM t WHERE id < 3000");
+
+    CompactionOptions options;
+    options.min_dead_bytes = 1024;
+    options.bytes_per_second = 0;
+    CompactionStats pass = dbf.compact_step(options);
+    EXPECT_EQ(pass.tables_purged, 1u);
+    EXPECT_EQ(pass.rows_purged, 3000u);
+    EXPECT_EQ(pass.tables_rewritten, 1u);
+    EXPECT_GT(pass.bytes_written, 0u);
+
+    // The table moved to a fresh directory with one page per row group
+    EXPECT_FALSE(std::filesystem::exists(data + "/t0"));
+    EXPECT_FALSE(std::filesystem::exists(data + "/t1/compact.lyta"));
+    storage::ColumnReader ids(data + "/t1/column_0.lycol");
+    EXPECT_EQ(ids.page_count(), 3u);
+    EXPECT_LT(std::filesystem::file_size(data + "/t1/column_0.lycol"), trickled_size / 2);
+
+    // Nothing left to do
+    pass = dbf.compact_step(options);
+    EXPECT_EQ(pass.tables_purged + pass.tables_rewritten, 0u);
+    EXPECT_EQ(dbf.compaction_stats().passes, 2u);
+    EXPECT_EQ(dbf.compaction_stats().tables_rewritten, 1u);
+
+    DatabaseFile reopened = DatabaseFile::open(db_path);
+    auto loaded = reopened.get_database().get_table("t");
+    ASSERT_EQ(loaded->row_count(), rows - 3000);
+    EXPECT_EQ(loaded->deleted_count(), 0u);
+    EXPECT_EQ(loaded->get_row(0), (std::vector<std::string>{"3000", "tag0"}));
+    EXPECT_EQ(loaded->get_row(rows - 3001)[0], std::to_string(rows - 1));
+}
+
+TEST_F(DatabaseFileTest, BackgroundCompactionKeepsConcurrentWrites) {
+    const std::string db_path = path("background.db");
+    DatabaseFile dbf(db_path);
+    dbf.execute("CREATE TABLE t (id BIGINT, tag VARCHAR)");
+    trickle(dbf, 1, 2 * Table::kRowGroupRows);
+    trickle(dbf, 10, 500);
+    size_t rows = 2 * Table::kRowGroupRows + 10 * 500;
+
+    // Slow enough that the inserts below land while a rewrite runs
+    CompactionOptions options;
+    options.interval = std::chrono::milliseconds(5);
+    options.min_dead_bytes = 1024;
+    options.bytes_per_second = 1 << 20;
+    dbf.start_compaction(options);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (dbf.compaction_stats().tables_rewritten == 0 &&
+           std::chrono::steady_clock::now() < deadline) {
+        dbf.execute("INSERT INTO t VALUES (" + std::to_string(rows) + ", 'late')");
+        rows++;
+    }
+    dbf.stop_compaction();
+    EXPECT_EQ(dbf.compaction_stats().tables_rewritten, 1u);
+    dbf.save();
+
+    DatabaseFile reopened = DatabaseFile::open(db_path);
+    auto loaded = reopened.get_database().get_table("t");
+    ASSERT_EQ(loaded->row_count(), rows);
+    for (size_t row : {size_t(0), Table::kRowGroupRows + 1, rows - 2, rows - 1}) {
+        EXPECT_EQ(loaded->get_row(row)[0], std::to_string(row));
+    }
+}
+
+TEST_F(DatabaseFileTest, IoThrottlePacesWrites) {
+    IoThrottle unlimited;
+    unlimited.acquire(1 << 30);
+    EXPECT_EQ(unlimited.bytes_acquired(), 1u << 30);
+
+    // Four 64 KiB writes at 1 MiB/s: the last may start after 3/16 s
+    IoThrottle throttle(1 << 20);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 4; ++i) {
+        throttle.acquire(64 << 10);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(180));
+    EXPECT_EQ(throttle.bytes_acquired(), 4u << 16);
+}
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "lyradb/database.h"
+#include "lyradb/hash_index_impl.h"
+#include "lyradb/query_result.h"
+#include "lyradb/table.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class DeletionVectorTest : public ::testing::Test {
+protected:
+    std::string scalar(const std::string& sql) {
+        auto result = db_.query(sql);
+        return dynamic_cast<const EngineQueryResult&>(*result).get_value(0, 0);
+    }
+
+    int affected(const std::string& sql) {
+        auto result = db_.execute(sql);
+        return dynamic_cast<const EngineQueryResult&>(*result).get_affected_rows();
+    }
+
+    // Rows inserted directly: ids 0..rows-1 at the same row ids
+    void fill(const std::string& table, size_t rows) {
+        auto t = db_.get_table(table);
+        for (size_t i = 0; i < rows; ++i) {
+            t->insert_row(std::vector<std::string>{std::to_string(i), "v" + std::to_string(i % 7)});
+        }
+    }
+
+    Database db_{"dv_test"};
+};
+
+TEST_F(DeletionVectorTest, DeletesKeepRowIdsAndIndexes) {
+    db_.set_purge_threshold(0);
+    db_.execute("CREATE TABLE t (id INT, tag VARCHAR)");
+    db_.execute("CREATE TABLE u (id INT, tag VARCHAR)");
+    fill("t", 3 * Table::kRowGroupRows);
+    fill("u", 100);
+    db_.execute("CREATE INDEX dv_id ON t (id)");
+    auto t = db_.get_table("t");
+
+    // A bulk delete marks rows in place
+    EXPECT_EQ(affected("DELETE FROM t WHERE id >= 100"), 3 * static_cast<int>(Table::kRowGroupRows) - 100);
+    EXPECT_EQ(t->row_count(), 3 * Table::kRowGroupRows);
+    EXPECT_EQ(t->live_row_count(), 100u);
+    EXPECT_EQ(index::lookup_hash_index("dv_id", "42"), (std::vector<size_t>{42}));
+    EXPECT_TRUE(index::lookup_hash_index("dv_id", "5000").empty());
+
+    // Every scan path skips deleted rows
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM t"), "100");
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM t WHERE tag = 'v3'"), "14");
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM u JOIN t ON u.id = t.id"), "100");
+    EXPECT_EQ(affected("UPDATE t SET tag = 'x'"), 100);
+    EXPECT_EQ(affected("DELETE FROM t WHERE id >= 100"), 0);
+
+    // Rolling a delete back restores the rows and their index entries
+    db_.begin_transaction();
+    db_.execute("DELETE FROM t WHERE id < 10");
+    EXPECT_TRUE(index::lookup_hash_index("dv_id", "7").empty());
+    db_.rollback();
+    EXPECT_EQ(t->live_row_count(), 100u);
+    EXPECT_EQ(index::lookup_hash_index("dv_id", "7"), (std::vector<size_t>{7}));
+
+    // Purging renumbers rows and the index with them
+    db_.execute("DELETE FROM t WHERE id < 50");
+    EXPECT_EQ(db_.purge_deleted("t"), 3 * Table::kRowGroupRows - 50);
+    EXPECT_EQ(t->row_count(), 50u);
+    EXPECT_EQ(index::lookup_hash_index("dv_id", "60"), (std::vector<size_t>{10}));
+    EXPECT_EQ(t->get_row(10)[0], "60");
+    EXPECT_TRUE(index::lookup_hash_index("dv_id", "20").empty());
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM t"), "50");
+    EXPECT_EQ(db_.purge_deleted("t"), 0u);
+}
+
+TEST_F(DeletionVectorTest, LargeDeletesArePurgedInTheBackground) {
+    db_.set_purge_threshold(0.5);
+    db_.execute("CREATE TABLE t (id INT, tag VARCHAR)");
+    fill("t", 4 * Table::kRowGroupRows);
+    auto t = db_.get_table("t");
+
+    // Below the threshold the deleted rows stay
+    db_.execute("DELETE FROM t WHERE id < " + std::to_string(Table::kRowGroupRows));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(db_.get_table_snapshot("t")->row_count(), 4 * Table::kRowGroupRows);
+
+    db_.execute("DELETE FROM t WHERE id < " + std::to_string(3 * Table::kRowGroupRows));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (db_.get_table_snapshot("t")->row_count() != Table::kRowGroupRows &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto purged = db_.get_table_snapshot("t");
+    ASSERT_EQ(purged->row_count(), Table::kRowGroupRows);
+    EXPECT_EQ(purged->deleted_count(), 0u);
+    EXPECT_EQ(purged->get_row(0)[0], std::to_string(3 * Table::kRowGroupRows));
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM t"), std::to_string(Table::kRowGroupRows));
+}
+
+} // namespace test
+} // namespace lyradb
@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 #include "lyradb/dict_compressor.h"
+#include "lyradb/column_serializer.h"
+#include "lyradb/compression_selector.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
 
 namespace lyradb {
 namespace compression {
@@ -50,6 +57,79 @@ TEST(DictionaryCompressorTest, IsSuitable) {
     EXPECT_TRUE(DictionaryCompressor::is_suitable(repeated_values, 0.1));
 }
 
+TEST(DictionaryCompressorTest, LargeDictionaryPacksCodes) {
+    // 200K values over 50K distinct strings: 16-bit codes, hash-built
+    std::vector<std::string> values;
+    for (size_t i = 0; i < 200000; ++i) {
+        values.push_back("customer-" + std::to_string((i * 7919) % 50000));
+    }
+
+    auto compressed = DictionaryCompressor::compress(values);
+    size_t dictionary_bytes = 5;
+    for (size_t k = 0; k < 50000; ++k) {
+        dictionary_bytes += 4 + ("customer-" + std::to_string(k)).size();
+    }
+    EXPECT_LE(compressed.size(), dictionary_bytes + values.size() * 2 + 13);
+    EXPECT_EQ(DictionaryCompressor::decompress(compressed.data(), compressed.size()), values);
+
+    auto decoded = DictionaryCompressor::decode(compressed.data(), compressed.size());
+    EXPECT_EQ(decoded.dictionary.size(), 50000u);
+    EXPECT_FALSE(decoded.sorted);
+
+    compressed.resize(compressed.size() / 2);
+    EXPECT_THROW(DictionaryCompressor::decode(compressed.data(), compressed.size()),
+                 std::runtime_error);
+}
+
+TEST(DictionaryCompressorTest, OrderPreservingCodesCompareLikeStrings) {
+    std::vector<std::string> values = {"pear", "apple", "fig", "", "pear", "banana", "fig"};
+    auto compressed = DictionaryCompressor::compress(values, true);
+    auto decoded = DictionaryCompressor::decode(compressed.data(), compressed.size());
+
+    EXPECT_TRUE(decoded.sorted);
+    EXPECT_EQ(decoded.dictionary, (std::vector<std::string>{"", "apple", "banana", "fig", "pear"}));
+    ASSERT_EQ(decoded.codes.size(), values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(decoded.dictionary[decoded.codes[i]], values[i]);
+        for (size_t j = 0; j < values.size(); ++j) {
+            EXPECT_EQ(decoded.codes[i] < decoded.codes[j], values[i] < values[j]);
+        }
+    }
+}
+
+TEST(DictionaryCompressorTest, StringPagesRoundTripThroughColumnFiles) {
+    // A serialized row segment: [count][nulls][length-prefixed strings]
+    const uint32_t count = 2000;
+    const uint32_t nulls = 0;
+    std::vector<uint8_t> segment(8);
+    std::memcpy(segment.data(), &count, 4);
+    std::memcpy(segment.data() + 4, &nulls, 4);
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string value = "country-" + std::to_string(i % 12);
+        uint32_t len = static_cast<uint32_t>(value.size());
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&len);
+        segment.insert(segment.end(), bytes, bytes + 4);
+        segment.insert(segment.end(), value.begin(), value.end());
+    }
+
+    const auto dict = static_cast<uint8_t>(CompressionAlgorithm::DICTIONARY);
+    auto page = storage::ColumnWriter::encode_page(segment.data(), segment.size(), dict);
+    EXPECT_EQ(page.compression_algo, dict);
+    EXPECT_LT(page.payload.size(), segment.size() / 10);
+
+    const std::string path = "test_dictionary_page.lycol";
+    {
+        storage::ColumnWriter writer(path, 0, 4);
+        writer.write_page(segment.data(), segment.size(), count, dict);
+        writer.finalize();
+    }
+    {
+        storage::ColumnReader reader(path);
+        EXPECT_EQ(reader.read_page(0), segment);
+    }
+    std::filesystem::remove(path);
+}
+
 } // namespace test
 } // namespace compression
 } // namespace lyradb
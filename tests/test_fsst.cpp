@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "lyradb/fsst_compressor.h"
+#include "lyradb/column_serializer.h"
+#include "lyradb/compression_selector.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace compression {
+namespace test {
+
+namespace {
+
+// Distinct URLs built from a handful of hosts and path words
+std::vector<std::string> make_urls(size_t count) {
+    const char* hosts[] = {"www.example.com", "shop.example.org", "api.lyradb.io", "docs.lyradb.io"};
+    const char* words[] = {"products", "category", "search", "user", "profile", "orders", "items"};
+    std::mt19937 gen(3);
+    std::vector<std::string> urls;
+    for (size_t i = 0; i < count; ++i) {
+        urls.push_back(std::string("https://") + hosts[gen() % 4] + "/" + words[gen() % 7] + "/" +
+                       words[gen() % 7] + "?id=" + std::to_string(gen() % 1000000));
+    }
+    return urls;
+}
+
+size_t total_length(const std::vector<std::string>& values) {
+    size_t total = 0;
+    for (const auto& value : values) {
+        total += value.size();
+    }
+    return total;
+}
+
+} // namespace
+
+TEST(FsstCompressorTest, UrlsCompressWithPointAccess) {
+    auto urls = make_urls(5000);
+    auto compressed = FsstCompressor::compress(urls);
+    EXPECT_LT(compressed.size() * 2, total_length(urls));
+    EXPECT_EQ(FsstCompressor::decompress(compressed.data(), compressed.size()), urls);
+
+    FsstCompressor::Decoder decoder(compressed.data(), compressed.size());
+    ASSERT_EQ(decoder.size(), urls.size());
+    for (size_t i : {size_t(0), size_t(1234), urls.size() - 1}) {
+        EXPECT_EQ(decoder.value(i), urls[i]);
+    }
+    EXPECT_THROW(decoder.value(urls.size()), std::out_of_range);
+
+    double estimate = FsstCompressor::estimate_compression_ratio(urls);
+    EXPECT_NEAR(estimate, static_cast<double>(compressed.size()) / total_length(urls), 0.05);
+    EXPECT_EQ(CompressionSelector::select_for_strings(urls), CompressionAlgorithm::FSST);
+
+    // Low cardinality stays with the dictionary, short codes with neither
+    std::vector<std::string> repeated(urls.begin(), urls.begin() + 10);
+    repeated.resize(1000, urls[0]);
+    EXPECT_EQ(CompressionSelector::select_for_strings(repeated), CompressionAlgorithm::DICTIONARY);
+    std::vector<std::string> short_codes;
+    for (int i = 0; i < 1000; ++i) {
+        short_codes.push_back(std::to_string(i));
+    }
+    EXPECT_NE(CompressionSelector::select_for_strings(short_codes), CompressionAlgorithm::FSST);
+}
+
+TEST(FsstCompressorTest, RoundTripsEdgeCases) {
+    EXPECT_TRUE(FsstCompressor::compress({}).empty());
+
+    // Empty values, embedded zero bytes, every byte value, long values
+    std::vector<std::string> values = {"", "a", std::string("x\0y\0", 4), ""};
+    std::string all_bytes;
+    for (int b = 0; b < 256; ++b) {
+        all_bytes.push_back(static_cast<char>(b));
+    }
+    values.push_back(all_bytes);
+    values.push_back(std::string(10000, 'z'));
+    values.push_back("user@example.com");
+    auto compressed = FsstCompressor::compress(values);
+    EXPECT_EQ(FsstCompressor::decompress(compressed.data(), compressed.size()), values);
+
+    compressed.resize(compressed.size() - 1);
+    EXPECT_THROW(FsstCompressor::decompress(compressed.data(), compressed.size()), std::runtime_error);
+}
+
+TEST(FsstCompressorTest, StringPagesRoundTripThroughColumnFiles) {
+    // A serialized row segment: [count][nulls][null bitmap][len, bytes]...
+    auto urls = make_urls(2000);
+    urls[5].clear();
+    const uint32_t count = static_cast<uint32_t>(urls.size());
+    const uint32_t nulls = 1;
+    std::vector<uint8_t> segment(8 + (count + 7) / 8);
+    std::memcpy(segment.data(), &count, 4);
+    std::memcpy(segment.data() + 4, &nulls, 4);
+    segment[8] = 0x20;
+    for (const auto& url : urls) {
+        uint32_t len = static_cast<uint32_t>(url.size());
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&len);
+        segment.insert(segment.end(), bytes, bytes + 4);
+        segment.insert(segment.end(), url.begin(), url.end());
+    }
+
+    const auto fsst = static_cast<uint8_t>(CompressionAlgorithm::FSST);
+    auto page = storage::ColumnWriter::encode_page(segment.data(), segment.size(), fsst);
+    EXPECT_EQ(page.compression_algo, fsst);
+    EXPECT_LT(page.payload.size() * 2, segment.size());
+
+    const std::string path = "test_fsst_page.lycol";
+    {
+        storage::ColumnWriter writer(path, 0, 0);
+        writer.write_page(segment.data(), segment.size(), count, fsst);
+        writer.finalize();
+    }
+    {
+        storage::ColumnReader reader(path);
+        EXPECT_EQ(reader.read_page(0), segment);
+    }
+    std::filesystem::remove(path);
+}
+
+} // namespace test
+} // namespace compression
+} // namespace lyradb
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include "lyradb/hash_aggregator.h"
+#include "lyradb/database.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/query_result.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/table.h"
+#include "lyradb/task_scheduler.h"
+#include <map>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class HashAggregatorTest : public ::testing::Test {
+protected:
+    static constexpr size_t kRows = 50000;
+
+    void SetUp() override {
+        Schema schema({
+            ColumnDef("region", DataType::STRING),
+            ColumnDef("store", DataType::INT32),
+            ColumnDef("amount", DataType::FLOAT64),
+            ColumnDef("qty", DataType::INT64)
+        });
+        table_ = std::make_unique<Table>("sales", schema);
+        const char* regions[] = {"north", "south", "east", "west", ""};
+        for (size_t i = 0; i < kRows; ++i) {
+            // Every 7th amount is NULL; region is NULL for one group in five
+            std::string amount = i % 7 == 0 ? "" : std::to_string(i % 100) + ".25";
+            table_->insert_row(std::vector<std::string>{
+                regions[(i / 3) % 5], std::to_string(i % 13), amount, std::to_string(i)});
+        }
+        row_ids_.resize(kRows);
+        std::iota(row_ids_.begin(), row_ids_.end(), size_t{0});
+    }
+
+    const query::Expression* expr(const std::string& text) {
+        stmts_.push_back(parser_.parse_select_statement("SELECT " + text + " FROM t"));
+        return stmts_.back()->select_list[0].get();
+    }
+
+    std::unique_ptr<Table> table_;
+    std::vector<size_t> row_ids_;
+    query::SqlParser parser_;
+    std::vector<std::unique_ptr<query::SelectStatement>> stmts_;
+};
+
+TEST_F(HashAggregatorTest, ComputesAggregatesPerGroup) {
+    HashAggregator aggregator(*table_, {expr("region")}, {
+        {AggregationFunction::COUNT, nullptr},
+        {AggregationFunction::COUNT, expr("amount")},
+        {AggregationFunction::SUM, expr("qty")},
+        {AggregationFunction::AVG, expr("amount")},
+        {AggregationFunction::MIN, expr("amount")},
+        {AggregationFunction::MAX, expr("store")}
+    });
+    QueryExecutor executor;
+    executor.set_parallelism(1);
+    aggregator.consume(row_ids_, executor);
+
+    // Reference: per-region totals computed directly
+    struct Expected { int64_t rows = 0, amounts = 0, qty = 0, max_store = 0; double sum = 0, min = 1e9; };
+    std::map<std::string, Expected> expected;
+    for (size_t i = 0; i < kRows; ++i) {
+        auto& e = expected[table_->column(0).string_at(i)];
+        e.rows++;
+        e.qty += static_cast<int64_t>(i);
+        e.max_store = std::max<int64_t>(e.max_store, table_->column(1).data<int32_t>()[i]);
+        if (!table_->column(2).is_null(i)) {
+            double amount = table_->column(2).data<double>()[i];
+            e.amounts++;
+            e.sum += amount;
+            e.min = std::min(e.min, amount);
+        }
+    }
+
+    // Groups appear in order of first occurrence; NULL regions form one group
+    ASSERT_EQ(aggregator.group_count(), 5u);
+    EXPECT_EQ(std::get<std::string>(aggregator.key_value(0, 0)), "north");
+    EXPECT_EQ(std::get<std::string>(aggregator.key_value(3, 0)), "west");
+    EXPECT_TRUE(std::holds_alternative<std::nullptr_t>(aggregator.key_value(4, 0)));
+
+    for (size_t g = 0; g < 4; ++g) {
+        const auto& e = expected[std::get<std::string>(aggregator.key_value(g, 0))];
+        EXPECT_EQ(std::get<int64_t>(aggregator.aggregate_value(g, 0)), e.rows);
+        EXPECT_EQ(std::get<int64_t>(aggregator.aggregate_value(g, 1)), e.amounts);
+        EXPECT_EQ(std::get<int64_t>(aggregator.aggregate_value(g, 2)), e.qty);
+        EXPECT_DOUBLE_EQ(std::get<double>(aggregator.aggregate_value(g, 3)), e.sum / e.amounts);
+        EXPECT_DOUBLE_EQ(std::get<double>(aggregator.aggregate_value(g, 4)), e.min);
+        EXPECT_EQ(std::get<int64_t>(aggregator.aggregate_value(g, 5)), e.max_store);
+    }
+}
+
+TEST_F(HashAggregatorTest, ParallelMatchesSerial) {
+    auto run = [&](QueryExecutor& executor) {
+        auto aggregator = std::make_unique<HashAggregator>(
+            *table_, std::vector<const query::Expression*>{expr("store"), expr("qty % 4")},
+            std::vector<AggregateSpec>{
+                {AggregationFunction::SUM, expr("amount")},
+                {AggregationFunction::COUNT_DISTINCT, expr("region")},
+                {AggregationFunction::MAX, expr("region")}
+            });
+        aggregator->consume(row_ids_, executor);
+        return aggregator;
+    };
+
+    QueryExecutor serial;
+    serial.set_parallelism(1);
+    auto expected = run(serial);
+
+    TaskScheduler scheduler(3);
+    QueryExecutor parallel;
+    parallel.set_scheduler(&scheduler);
+    parallel.set_morsel_size(1000);
+    auto actual = run(parallel);
+
+    ASSERT_EQ(expected->group_count(), 13u * 4u);
+    ASSERT_EQ(actual->group_count(), expected->group_count());
+    for (size_t g = 0; g < expected->group_count(); ++g) {
+        EXPECT_EQ(actual->key_value(g, 0), expected->key_value(g, 0));
+        EXPECT_EQ(actual->key_value(g, 1), expected->key_value(g, 1));
+        EXPECT_NEAR(std::get<double>(actual->aggregate_value(g, 0)),
+                    std::get<double>(expected->aggregate_value(g, 0)), 1e-6);
+        EXPECT_EQ(actual->aggregate_value(g, 1), expected->aggregate_value(g, 1));
+        EXPECT_EQ(actual->aggregate_value(g, 2), expected->aggregate_value(g, 2));
+    }
+    EXPECT_EQ(std::get<int64_t>(expected->aggregate_value(0, 1)), 4);
+}
+
+TEST_F(HashAggregatorTest, GlobalAggregateOverNoRows) {
+    HashAggregator aggregator(*table_, {}, {
+        {AggregationFunction::COUNT, nullptr},
+        {AggregationFunction::SUM, expr("qty")},
+        {AggregationFunction::MIN, expr("region")}
+    });
+    QueryExecutor executor;
+    aggregator.consume({}, executor);
+    ASSERT_EQ(aggregator.group_count(), 1u);
+    EXPECT_EQ(std::get<int64_t>(aggregator.aggregate_value(0, 0)), 0);
+    EXPECT_TRUE(std::holds_alternative<std::nullptr_t>(aggregator.aggregate_value(0, 1)));
+    EXPECT_TRUE(std::holds_alternative<std::nullptr_t>(aggregator.aggregate_value(0, 2)));
+}
+
+TEST_F(HashAggregatorTest, SumOverflowFallsBackToDouble) {
+    Table big("big", Schema({ColumnDef("v", DataType::INT64)}));
+    big.insert_row(std::vector<std::string>{"9223372036854775000"});
+    big.insert_row(std::vector<std::string>{"9223372036854775000"});
+    HashAggregator sum(big, {}, {{AggregationFunction::SUM, expr("v")}});
+    QueryExecutor executor;
+    sum.consume({0, 1}, executor);
+    EXPECT_DOUBLE_EQ(std::get<double>(sum.aggregate_value(0, 0)), 2 * 9223372036854775000.0);
+}
+
+class GroupBySqlTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        db_.execute("CREATE TABLE emp (name VARCHAR, dept VARCHAR, salary INT, bonus DOUBLE)");
+        const char* rows[] = {
+            "('ann', 'eng', 100, 1.5)",
+            "('bob', 'eng', 120, NULL)",
+            "('cid', 'ops', 90, 2.0)",
+            "('dee', 'eng', 100, 0.5)",
+            "('eve', 'hr', 70, NULL)",
+            "('fay', 'ops', 95, 1.0)"
+        };
+        for (const char* row : rows) {
+            db_.execute(std::string("INSERT INTO emp VALUES ") + row);
+        }
+    }
+
+    std::unique_ptr<EngineQueryResult> query(const std::string& sql) {
+        auto result = db_.execute(sql);
+        return std::unique_ptr<EngineQueryResult>(
+            dynamic_cast<EngineQueryResult*>(result.release()));
+    }
+
+    Database db_{":memory:"};
+};
+
+TEST_F(GroupBySqlTest, ProjectsKeysAndAggregates) {
+    auto result = query(
+        "SELECT dept, COUNT(*), SUM(salary), AVG(bonus), MIN(name), COUNT(DISTINCT salary) "
+        "FROM emp GROUP BY dept");
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result->row_count(), 3u);
+    EXPECT_EQ(result->column_names(), (std::vector<std::string>{
+        "dept", "COUNT(*)", "SUM(salary)", "AVG(bonus)", "MIN(name)", "COUNT(DISTINCT salary)"}));
+
+    EXPECT_EQ(result->get_value(0, 0), "eng");
+    EXPECT_EQ(result->get_value(0, 1), "3");
+    EXPECT_EQ(result->get_value(0, 2), "320");
+    EXPECT_EQ(result->get_value(0, 3), "1");      // NULL bonus is skipped
+    EXPECT_EQ(result->get_value(0, 4), "ann");
+    EXPECT_EQ(result->get_value(0, 5), "2");
+
+    EXPECT_EQ(result->get_value(2, 0), "hr");
+    EXPECT_EQ(result->get_value(2, 3), "");       // AVG over only NULLs
+}
+
+TEST_F(GroupBySqlTest, HavingFiltersOnAggregates) {
+    auto result = query("SELECT dept, SUM(salary) FROM emp GROUP BY dept HAVING COUNT(*) > 1");
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result->row_count(), 2u);
+    EXPECT_EQ(result->get_value(0, 0), "eng");
+    EXPECT_EQ(result->get_value(1, 0), "ops");
+    EXPECT_EQ(result->get_value(1, 1), "185");
+
+    result = query("SELECT dept FROM emp WHERE salary > 90 GROUP BY dept HAVING MAX(salary) >= 100");
+    ASSERT_EQ(result->row_count(), 1u);
+    EXPECT_EQ(result->get_value(0, 0), "eng");
+}
+
+TEST_F(GroupBySqlTest, AggregatesWithoutGroupBy) {
+    auto result = query("SELECT COUNT(*), MAX(salary) - MIN(salary) FROM emp");
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result->row_count(), 1u);
+    EXPECT_EQ(result->get_value(0, 0), "6");
+    EXPECT_EQ(result->get_value(0, 1), "50");
+
+    result = query("SELECT COUNT(*) FROM emp WHERE salary > 1000");
+    ASSERT_EQ(result->row_count(), 1u);
+    EXPECT_EQ(result->get_value(0, 0), "0");
+}
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include "lyradb/hash_join.h"
+#include "lyradb/database.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/query_result.h"
+#include "lyradb/table.h"
+#include "lyradb/task_scheduler.h"
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class HashJoinTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // orders.customer (INT64) references customers.id (INT32); some
+        // customers have no orders, some orders have unknown or NULL customers
+        customers_ = std::make_unique<Table>("customers", Schema({
+            ColumnDef("id", DataType::INT32),
+            ColumnDef("region", DataType::STRING)
+        }));
+        for (int i = 0; i < 600; ++i) {
+            customers_->insert_row(std::vector<std::string>{
+                std::to_string(i), "r" + std::to_string(i % 7)});
+        }
+        orders_ = std::make_unique<Table>("orders", Schema({
+            ColumnDef("customer", DataType::INT64),
+            ColumnDef("region", DataType::STRING),
+            ColumnDef("amount", DataType::FLOAT64)
+        }));
+        for (int i = 0; i < 4000; ++i) {
+            std::string customer = i % 97 == 0 ? "" : std::to_string((i * 7919) % 800);
+            orders_->insert_row(std::vector<std::string>{
+                customer, "r" + std::to_string(i % 5), std::to_string(i) + ".5"});
+        }
+    }
+
+    static std::vector<size_t> all_rows(const Table& table) {
+        std::vector<size_t> rows(table.row_count());
+        std::iota(rows.begin(), rows.end(), size_t{0});
+        return rows;
+    }
+
+    // Nested loop reference over positions, in left-then-right order
+    std::vector<std::pair<size_t, size_t>> reference(
+        const Table& left, const std::vector<size_t>& left_keys,
+        const Table& right, const std::vector<size_t>& right_keys, JoinKind kind) {
+        std::vector<std::pair<size_t, size_t>> result;
+        for (size_t l = 0; l < left.row_count(); ++l) {
+            bool found = false;
+            for (size_t r = 0; r < right.row_count(); ++r) {
+                bool equal = true;
+                for (size_t k = 0; k < left_keys.size() && equal; ++k) {
+                    const Column& a = left.column(left_keys[k]);
+                    const Column& b = right.column(right_keys[k]);
+                    equal = !a.is_null(l) && !b.is_null(r) && a.get_string(l) == b.get_string(r);
+                }
+                if (equal) {
+                    found = true;
+                    if (kind == JoinKind::INNER || kind == JoinKind::LEFT) {
+                        result.emplace_back(l, r);
+                    }
+                }
+            }
+            if ((kind == JoinKind::LEFT && !found) || (kind == JoinKind::ANTI && !found) ||
+                (kind == JoinKind::SEMI && found)) {
+                result.emplace_back(l, HashJoin::kNoMatch);
+            }
+        }
+        return result;
+    }
+
+    static std::vector<std::pair<size_t, size_t>> pairs(const JoinOutput& output) {
+        std::vector<std::pair<size_t, size_t>> result;
+        for (size_t i = 0; i < output.left.size(); ++i) {
+            result.emplace_back(output.left[i],
+                                output.right.empty() ? HashJoin::kNoMatch : output.right[i]);
+        }
+        return result;
+    }
+
+    std::unique_ptr<Table> customers_;
+    std::unique_ptr<Table> orders_;
+};
+
+TEST_F(HashJoinTest, AllKindsMatchNestedLoop) {
+    QueryExecutor executor;
+    auto order_rows = all_rows(*orders_);
+    auto customer_rows = all_rows(*customers_);
+    for (JoinKind kind : {JoinKind::INNER, JoinKind::LEFT, JoinKind::SEMI, JoinKind::ANTI}) {
+        // Left side larger: builds on the right
+        HashJoin probe_left(*orders_, {0}, *customers_, {0}, kind);
+        JoinOutput output;
+        probe_left.execute(order_rows, customer_rows, executor, output);
+        EXPECT_FALSE(probe_left.built_on_left());
+        EXPECT_EQ(pairs(output), reference(*orders_, {0}, *customers_, {0}, kind));
+
+        // Left side smaller: builds on the left and tracks matches there
+        HashJoin build_left(*customers_, {0}, *orders_, {0}, kind);
+        build_left.execute(customer_rows, order_rows, executor, output);
+        EXPECT_TRUE(build_left.built_on_left());
+        EXPECT_EQ(pairs(output), reference(*customers_, {0}, *orders_, {0}, kind));
+    }
+}
+
+TEST_F(HashJoinTest, MultiColumnStringKeys) {
+    QueryExecutor executor;
+    HashJoin join(*orders_, {0, 1}, *customers_, {0, 1});
+    JoinOutput output;
+    size_t count = join.execute(all_rows(*orders_), all_rows(*customers_), executor, output);
+    auto expected = reference(*orders_, {0, 1}, *customers_, {0, 1}, JoinKind::INNER);
+    EXPECT_EQ(count, expected.size());
+    EXPECT_EQ(pairs(output), expected);
+}
+
+TEST_F(HashJoinTest, PartitionedParallelMatchesSerial) {
+    // Enough build rows for several partitions
+    Table big("big", Schema({ColumnDef("k", DataType::INT64)}));
+    for (int i = 0; i < 60000; ++i) {
+        big.insert_row(std::vector<std::string>{std::to_string(i % 45000)});
+    }
+    Table probe("probe", Schema({ColumnDef("k", DataType::INT32)}));
+    for (int i = 0; i < 120000; ++i) {
+        probe.insert_row(std::vector<std::string>{std::to_string((i * 31) % 50000)});
+    }
+
+    QueryExecutor serial;
+    serial.set_parallelism(1);
+    HashJoin join(probe, {0}, big, {0}, JoinKind::LEFT);
+    JoinOutput expected;
+    join.execute(all_rows(probe), all_rows(big), serial, expected);
+    EXPECT_GT(join.partition_count(), 1u);
+
+    TaskScheduler scheduler(3);
+    QueryExecutor parallel;
+    parallel.set_scheduler(&scheduler);
+    parallel.set_morsel_size(5000);
+    JoinOutput actual;
+    join.execute(all_rows(probe), all_rows(big), parallel, actual);
+    EXPECT_EQ(actual.left, expected.left);
+    EXPECT_EQ(actual.right, expected.right);
+
+    // Keys below 15000 appear twice on the build side, keys >= 45000 never
+    size_t expected_rows = 0;
+    size_t expected_unmatched = 0;
+    for (int i = 0; i < 120000; ++i) {
+        int key = (i * 31) % 50000;
+        size_t matches = key < 15000 ? 2 : (key < 45000 ? 1 : 0);
+        expected_rows += matches == 0 ? 1 : matches;
+        expected_unmatched += matches == 0;
+    }
+    size_t unmatched = 0;
+    for (size_t i = 0; i < expected.left.size(); ++i) {
+        unmatched += expected.right[i] == HashJoin::kNoMatch;
+    }
+    EXPECT_EQ(unmatched, expected_unmatched);
+    EXPECT_EQ(expected.left.size(), expected_rows);
+}
+
+TEST_F(HashJoinTest, NoMatchPositionsAreNullKeys) {
+    QueryExecutor executor;
+    HashJoin join(*customers_, {0}, *orders_, {0}, JoinKind::LEFT);
+    std::vector<size_t> left_rows = {5, HashJoin::kNoMatch, 599};
+    JoinOutput output;
+    join.execute(left_rows, all_rows(*orders_), executor, output);
+    ASSERT_FALSE(output.left.empty());
+    // The padded row stays unmatched and in position order
+    size_t padded = 0;
+    for (size_t i = 0; i < output.left.size(); ++i) {
+        if (output.left[i] == 1) {
+            ++padded;
+            EXPECT_EQ(output.right[i], HashJoin::kNoMatch);
+        }
+        if (i > 0) {
+            EXPECT_LE(output.left[i - 1], output.left[i]);
+        }
+    }
+    EXPECT_EQ(padded, 1u);
+}
+
+TEST(HashJoinSqlTest, ChainedAndReversedConditions) {
+    Database db(":memory:");
+    db.execute("CREATE TABLE a (id INT, x INT)");
+    db.execute("CREATE TABLE b (aid INT, y INT)");
+    db.execute("CREATE TABLE c (bid INT, z VARCHAR)");
+    for (int i = 0; i < 10; ++i) {
+        db.execute("INSERT INTO a VALUES (" + std::to_string(i) + ", " + std::to_string(i * 2) + ")");
+    }
+    for (int i = 0; i < 5; ++i) {
+        db.execute("INSERT INTO b VALUES (" + std::to_string(i) + ", " + std::to_string(i * 3) + ")");
+        db.execute("INSERT INTO c VALUES (" + std::to_string(i * 3) + ", 'z" + std::to_string(i) + "')");
+    }
+
+    auto result = db.execute("SELECT * FROM a JOIN b ON b.aid = a.id JOIN c ON c.bid = b.y WHERE x > 2");
+    auto rows = dynamic_cast<EngineQueryResult*>(result.get());
+    ASSERT_NE(rows, nullptr);
+    ASSERT_EQ(rows->row_count(), 3u);
+    EXPECT_EQ(rows->column_count(), 6u);
+    EXPECT_EQ(rows->get_value(0, 0), "2");
+    EXPECT_EQ(rows->get_value(0, 5), "z2");
+
+    result = db.execute("SELECT * FROM a LEFT JOIN b ON a.id = b.aid");
+    rows = dynamic_cast<EngineQueryResult*>(result.get());
+    ASSERT_EQ(rows->row_count(), 10u);
+    EXPECT_EQ(rows->get_value(9, 0), "9");
+    EXPECT_EQ(rows->get_value(9, 2), "");   // NULL padding
+
+    // Non-equi conditions still go through the nested loop
+    result = db.execute("SELECT * FROM a JOIN b ON a.id < b.aid");
+    rows = dynamic_cast<EngineQueryResult*>(result.get());
+    EXPECT_EQ(rows->row_count(), 10u);
+}
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "lyradb/database.h"
+#include "lyradb/query_result.h"
+#include "lyradb/table.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class LateMaterializationTest : public ::testing::Test {
+protected:
+    static constexpr int kColumns = 80;
+    static constexpr int kRows = 3000;
+
+    void SetUp() override {
+        // Wide table: c0 is the id, every other column a derived value
+        std::string ddl = "CREATE TABLE wide (";
+        for (int c = 0; c < kColumns; ++c) {
+            ddl += (c ? ", c" : "c") + std::to_string(c) + " INT";
+        }
+        db_.execute(ddl + ")");
+        auto wide = db_.get_table("wide");
+        for (int r = 0; r < kRows; ++r) {
+            std::vector<std::string> row;
+            for (int c = 0; c < kColumns; ++c) {
+                row.push_back(std::to_string(c == 0 ? r : r * 100 + c));
+            }
+            wide->insert_row(row);
+        }
+        wide->merge_delta();
+
+        db_.execute("CREATE TABLE tags (id INT, tag VARCHAR)");
+        for (int r = 0; r < kRows; r += 3) {
+            db_.execute("INSERT INTO tags VALUES (" + std::to_string(r) + ", 't" +
+                        std::to_string(r % 4) + "')");
+        }
+    }
+
+    const EngineQueryResult& run(const std::string& sql) {
+        result_ = db_.query(sql);
+        return dynamic_cast<const EngineQueryResult&>(*result_);
+    }
+
+    Database db_{"late_test"};
+    std::unique_ptr<QueryResult> result_;
+};
+
+TEST_F(LateMaterializationTest, ProjectsOnlySelectedColumns) {
+    const auto& rows = run("SELECT c79, c0 FROM wide WHERE c1 >= 100 ORDER BY c2 DESC LIMIT 3");
+    ASSERT_EQ(rows.row_count(), 3u);
+    ASSERT_EQ(rows.column_count(), 2u);
+    EXPECT_EQ(rows.get_value(0, 0), std::to_string((kRows - 1) * 100 + 79));
+    EXPECT_EQ(rows.get_value(0, 1), std::to_string(kRows - 1));
+    EXPECT_EQ(rows.get_value(2, 1), std::to_string(kRows - 3));
+
+    // Computed expressions read their columns; OFFSET applies to row ids
+    const auto& computed = run("SELECT c0 + 1, c5 FROM wide ORDER BY c0 LIMIT 2 OFFSET 10");
+    ASSERT_EQ(computed.row_count(), 2u);
+    EXPECT_EQ(computed.get_value(0, 0), "11");
+    EXPECT_EQ(computed.get_value(1, 1), "1105");
+
+    EXPECT_EQ(run("SELECT * FROM wide LIMIT 1").column_count(), static_cast<size_t>(kColumns));
+    EXPECT_THROW(db_.query("SELECT nope FROM wide"), std::runtime_error);
+}
+
+TEST_F(LateMaterializationTest, JoinsCarryRowIdsToTheProjection) {
+    // Hash join plus a residual WHERE over both tables
+    const auto& rows = run(
+        "SELECT tags.tag, wide.c0, c40 FROM wide JOIN tags ON wide.c0 = tags.id "
+        "WHERE c3 > 150000 OR tag = 't1' ORDER BY c0 LIMIT 2");
+    ASSERT_EQ(rows.row_count(), 2u);
+    ASSERT_EQ(rows.column_count(), 3u);
+    EXPECT_EQ(rows.get_value(0, 0), "t1");
+    EXPECT_EQ(rows.get_value(0, 1), "9");
+    EXPECT_EQ(rows.get_value(0, 2), "940");
+    EXPECT_EQ(rows.get_value(1, 1), "21");
+
+    // Aggregates over a join read only the columns they need
+    const auto& groups = run(
+        "SELECT tag, COUNT(*), MAX(c7) FROM wide JOIN tags ON c0 = id GROUP BY tag ORDER BY tag");
+    ASSERT_EQ(groups.row_count(), 4u);
+    EXPECT_EQ(groups.get_value(0, 0), "t0");
+    EXPECT_EQ(groups.get_value(0, 1), std::to_string(kRows / 12));
+    EXPECT_EQ(groups.get_value(3, 2), std::to_string((kRows - 9) * 100 + 7));
+}
+
+} // namespace test
+} // namespace lyradb
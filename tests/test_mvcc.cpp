@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include "lyradb/database.h"
+#include "lyradb/hash_index_impl.h"
+#include "lyradb/query_result.h"
+#include "lyradb/table.h"
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class MvccTest : public ::testing::Test {
+protected:
+    // Runs fn on another thread, which has no transaction of its own
+    template <typename Fn>
+    void as_reader(Fn fn) {
+        std::thread reader(fn);
+        reader.join();
+    }
+
+    static std::string value(const std::unique_ptr<QueryResult>& result, size_t col) {
+        return dynamic_cast<const EngineQueryResult&>(*result).get_value(0, col);
+    }
+
+    std::string scalar(const std::string& sql) {
+        return value(db_.query(sql), 0);
+    }
+
+    Database db_{"mvcc_test"};
+};
+
+TEST_F(MvccTest, ReadersSeeTheCommittedSnapshot) {
+    db_.execute("CREATE TABLE t (id INT, name VARCHAR)");
+    db_.execute("INSERT INTO t VALUES (1, 'a'), (2, 'b'), (3, 'c')");
+    auto before = db_.get_table_snapshot("t");
+    std::weak_ptr<const Table> old_version = before;
+
+    db_.begin_transaction();
+    db_.execute("INSERT INTO t VALUES (4, 'd')");
+    db_.execute("UPDATE t SET name = 'x' WHERE id = 2");
+    db_.execute("DELETE FROM t WHERE id = 1");
+    db_.execute("CREATE TABLE scratch (x INT)");
+
+    // The writer reads its own changes...
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM t WHERE name = 'x'"), "1");
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM t WHERE id = 1"), "0");
+
+    // ...everyone else the last commit, without waiting for the writer
+    as_reader([&]() {
+        EXPECT_EQ(scalar("SELECT COUNT(*) FROM t WHERE name = 'x'"), "0");
+        EXPECT_EQ(scalar("SELECT COUNT(*) FROM t WHERE id = 1"), "1");
+        EXPECT_EQ(scalar("SELECT COUNT(*) FROM t"), "3");
+        EXPECT_THROW(db_.query("SELECT * FROM scratch"), std::runtime_error);
+        EXPECT_EQ(db_.get_table_snapshot("t")->row_count(), 3u);
+    });
+    db_.commit();
+
+    // Cached results of the old version are gone with the commit
+    as_reader([&]() {
+        EXPECT_EQ(scalar("SELECT COUNT(*) FROM t WHERE name = 'x'"), "1");
+        EXPECT_EQ(scalar("SELECT COUNT(*) FROM t WHERE id = 1"), "0");
+        EXPECT_EQ(scalar("SELECT COUNT(*) FROM scratch"), "0");
+    });
+
+    // A snapshot never changes, and its version is freed with it
+    ASSERT_EQ(before->row_count(), 3u);
+    EXPECT_EQ(before->get_row(0), (std::vector<std::string>{"1", "a"}));
+    EXPECT_EQ(before->get_row(1), (std::vector<std::string>{"2", "b"}));
+    before.reset();
+    EXPECT_TRUE(old_version.expired());
+
+    // Rolled back work never becomes visible
+    db_.begin_transaction();
+    db_.execute("DROP TABLE scratch");
+    db_.execute("INSERT INTO t VALUES (5, 'e')");
+    as_reader([&]() {
+        EXPECT_EQ(scalar("SELECT COUNT(*) FROM scratch"), "0");
+    });
+    db_.rollback();
+    as_reader([&]() {
+        EXPECT_EQ(scalar("SELECT COUNT(*) FROM t"), "3");
+        EXPECT_EQ(scalar("SELECT COUNT(*) FROM scratch"), "0");
+    });
+}
+
+TEST_F(MvccTest, RolledBackDropKeepsIndexes) {
+    db_.execute("CREATE TABLE d (id INT, city VARCHAR)");
+    db_.execute("INSERT INTO d VALUES (1, 'x'), (2, 'y'), (3, 'x')");
+    db_.execute("CREATE INDEX mvcc_d_id ON d (id)");
+    db_.execute("CREATE INDEX mvcc_d_pair ON d (id, city)");
+
+    db_.begin_transaction();
+    db_.execute("DROP TABLE d");
+    EXPECT_TRUE(index::lookup_hash_index("mvcc_d_id", "2").empty());
+    db_.rollback();
+
+    // The table comes back with the indexes it had, and they stay maintained
+    EXPECT_EQ(index::lookup_hash_index("mvcc_d_id", "2"), (std::vector<size_t>{1}));
+    EXPECT_EQ(index::lookup_composite_hash_index("mvcc_d_pair", {"3", "x"}), (std::vector<size_t>{2}));
+    db_.execute("INSERT INTO d VALUES (4, 'z')");
+    EXPECT_EQ(index::lookup_hash_index("mvcc_d_id", "4"), (std::vector<size_t>{3}));
+
+    // A committed drop still takes them away
+    db_.execute("DROP TABLE d");
+    EXPECT_TRUE(index::lookup_hash_index("mvcc_d_id", "2").empty());
+    EXPECT_TRUE(index::lookup_composite_hash_index("mvcc_d_pair", {"3", "x"}).empty());
+}
+
+TEST_F(MvccTest, ConcurrentReadersSeeConsistentTotals) {
+    constexpr int kAccounts = 10;
+    constexpr int kTransfers = 150;
+    db_.execute("CREATE TABLE accounts (id INT, balance BIGINT)");
+    std::string values;
+    for (int i = 0; i < kAccounts; ++i) {
+        values += (i ? ", (" : "(") + std::to_string(i) + ", 100)";
+    }
+    db_.execute("INSERT INTO accounts VALUES " + values);
+
+    // Every transaction moves money and adds a pair of empty accounts, so
+    // any committed state sums to the same total with an even row count
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (int i = 0; i < kTransfers; ++i) {
+            std::string from = std::to_string(i % kAccounts);
+            std::string to = std::to_string((i * 7 + 3) % kAccounts);
+            db_.begin_transaction();
+            db_.execute("UPDATE accounts SET balance = balance - 7 WHERE id = " + from);
+            db_.execute("UPDATE accounts SET balance = balance + 7 WHERE id = " + to);
+            db_.execute("INSERT INTO accounts VALUES (" + std::to_string(1000 + i) + ", 0), (" +
+                        std::to_string(2000 + i) + ", 0)");
+            db_.commit();
+        }
+        done = true;
+    });
+
+    std::atomic<int> reads{0};
+    std::atomic<int> inconsistent{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&]() {
+            do {
+                auto result = db_.query("SELECT SUM(balance), COUNT(*) FROM accounts");
+                int64_t rows = std::stoll(value(result, 1));
+                if (value(result, 0) != "1000" || rows % 2 != 0) {
+                    inconsistent++;
+                }
+                reads++;
+            } while (!done);
+        });
+    }
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_GT(reads.load(), 0);
+    EXPECT_EQ(inconsistent.load(), 0);
+    EXPECT_EQ(scalar("SELECT SUM(balance) FROM accounts"), "1000");
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM accounts"), std::to_string(kAccounts + 2 * kTransfers));
+}
+
+TEST_F(MvccTest, WriterGroupsWhileReadersQueryTheSameTable) {
+    constexpr int kRounds = 60;
+    db_.execute("CREATE TABLE g (k INT, v BIGINT)");
+    db_.execute("CREATE TABLE log (x INT)");
+    auto g = db_.get_table("g");
+    for (size_t i = 0; i < Table::kRowGroupRows + 100; ++i) {
+        g->insert_row(std::vector<std::string>{std::to_string(i % 4), "1"});
+    }
+
+    // Each round commits a row to g, then aggregates g inside a transaction
+    // that writes only to log. The writer reads the live table while the
+    // readers take snapshots of it, both merging the new version's columns
+    std::atomic<bool> done{false};
+    std::atomic<int> wrong{0};
+    std::thread writer([&]() {
+        for (int i = 0; i < kRounds; ++i) {
+            db_.execute("INSERT INTO g VALUES (" + std::to_string(i % 4) + ", 1)");
+            db_.begin_transaction();
+            db_.execute("INSERT INTO log VALUES (" + std::to_string(i) + ")");
+            auto result = db_.query("SELECT k, SUM(v) FROM g GROUP BY k");
+            int64_t total = 0;
+            auto& rows = dynamic_cast<const EngineQueryResult&>(*result);
+            for (size_t r = 0; r < rows.row_count(); ++r) {
+                total += std::stoll(rows.get_value(r, 1));
+            }
+            if (total != static_cast<int64_t>(Table::kRowGroupRows) + 101 + i) {
+                wrong++;
+            }
+            db_.commit();
+        }
+        done = true;
+    });
+
+    std::atomic<int> reads{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&, r]() {
+            do {
+                db_.query("SELECT k, COUNT(*) FROM g WHERE v = " + std::to_string(1 + r % 2) +
+                          " GROUP BY k");
+                reads++;
+            } while (!done);
+        });
+    }
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_GT(reads.load(), 0);
+    EXPECT_EQ(wrong.load(), 0);
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM g"), std::to_string(Table::kRowGroupRows + 100 + kRounds));
+}
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "lyradb/pfor_compressor.h"
+#include "lyradb/bitpacking_compressor.h"
+#include "lyradb/column_serializer.h"
+#include "lyradb/compression_selector.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace lyradb {
+namespace compression {
+namespace test {
+
+namespace {
+
+std::vector<int64_t> round_trip(const std::vector<int64_t>& values) {
+    auto compressed = PforCompressor::compress(values.data(), values.size());
+    return PforCompressor::decompress(compressed.data(), compressed.size());
+}
+
+} // namespace
+
+TEST(PforCompressorTest, OutliersDoNotWidenThePage) {
+    // Amounts below 1000 with one large value every 500 rows
+    std::mt19937_64 gen(7);
+    std::vector<int64_t> values(10000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = i % 500 == 17 ? int64_t(1) << 40 : static_cast<int64_t>(gen() % 1000);
+    }
+
+    auto pfor = PforCompressor::compress(values.data(), values.size());
+    auto bitpacked = BitpackingCompressor::compress(values.data(), values.size());
+    EXPECT_LT(pfor.size(), bitpacked.size() / 3);
+    EXPECT_LT(pfor.size(), values.size() * 10 / 8 + 256);
+    EXPECT_EQ(PforCompressor::decompress(pfor.data(), pfor.size()), values);
+    EXPECT_NEAR(PforCompressor::estimate_compression_ratio(values.data(), values.size()),
+                static_cast<double>(pfor.size()) / (values.size() * 8), 0.01);
+
+    EXPECT_EQ(CompressionSelector::select_for_integers(values.data(), values.size()),
+              CompressionAlgorithm::PFOR);
+}
+
+TEST(PforCompressorTest, RoundTripsEdgeCases) {
+    EXPECT_TRUE(PforCompressor::compress(nullptr, 0).empty());
+    EXPECT_EQ(round_trip({42}), (std::vector<int64_t>{42}));
+
+    const int64_t lo = std::numeric_limits<int64_t>::min();
+    const int64_t hi = std::numeric_limits<int64_t>::max();
+    std::vector<int64_t> extremes = {lo, hi, 0, -1, hi, lo, 5};
+    EXPECT_EQ(round_trip(extremes), extremes);
+
+    // Block boundaries, with exceptions in the tail and in full blocks
+    std::mt19937_64 gen(11);
+    for (size_t count : {255u, 256u, 257u, 511u, 1024u, 1300u}) {
+        std::vector<int64_t> values(count);
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = -50 + static_cast<int64_t>(gen() % 100);
+            if (gen() % 64 == 0) {
+                values[i] = static_cast<int64_t>(gen());
+            }
+        }
+        values[count - 1] = hi;
+        EXPECT_EQ(round_trip(values), values) << count;
+    }
+
+    auto compressed = PforCompressor::compress(extremes.data(), extremes.size());
+    compressed.resize(compressed.size() - 3);
+    EXPECT_THROW(PforCompressor::decompress(compressed.data(), compressed.size()), std::runtime_error);
+}
+
+TEST(PforCompressorTest, DeltaModeForSortedIds) {
+    // Ascending IDs with gaps and an occasional large jump
+    std::vector<int64_t> ids(5000);
+    int64_t id = 1000000000;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        id += i % 1000 == 999 ? 1000000 : 1 + static_cast<int64_t>(i % 3);
+        ids[i] = id;
+    }
+    auto compressed = PforCompressor::compress(ids.data(), ids.size());
+    EXPECT_EQ(compressed[1] & 0x01, 0x01);
+    EXPECT_LT(compressed.size(), ids.size() / 3);
+    EXPECT_EQ(PforCompressor::decompress(compressed.data(), compressed.size()), ids);
+}
+
+TEST(PforCompressorTest, IntegerPagesRoundTripThroughColumnFiles) {
+    // A serialized row segment: [count][nulls][null bitmap][int32 values]
+    const uint32_t count = 3000;
+    const uint32_t nulls = 1;
+    std::vector<uint8_t> segment(8 + (count + 7) / 8);
+    std::memcpy(segment.data(), &count, 4);
+    std::memcpy(segment.data() + 4, &nulls, 4);
+    segment[8] = 0x04;
+    for (uint32_t i = 0; i < count; ++i) {
+        int32_t v = i % 700 == 0 ? -2000000000 : static_cast<int32_t>(i % 50);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&v);
+        segment.insert(segment.end(), bytes, bytes + 4);
+    }
+
+    const auto pfor = static_cast<uint8_t>(CompressionAlgorithm::PFOR);
+    auto page = storage::ColumnWriter::encode_page(segment.data(), segment.size(), pfor);
+    EXPECT_EQ(page.compression_algo, pfor);
+    EXPECT_LT(page.payload.size(), segment.size() / 4);
+
+    // Bytes that are not an integer segment fall back to ZSTD
+    std::vector<uint8_t> text(100, 'x');
+    EXPECT_NE(storage::ColumnWriter::encode_page(text.data(), text.size(), pfor).compression_algo, pfor);
+
+    const std::string path = "test_pfor_page.lycol";
+    {
+        storage::ColumnWriter writer(path, 0, 0);
+        writer.write_page(segment.data(), segment.size(), count, pfor);
+        writer.finalize();
+    }
+    {
+        storage::ColumnReader reader(path);
+        EXPECT_EQ(reader.read_page(0), segment);
+    }
+    std::filesystem::remove(path);
+}
+
+} // namespace test
+} // namespace compression
+} // namespace lyradb
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include "lyradb/simd_kernels.h"
+#include "lyradb/compiled_expression.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/table.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+using simd::CompareOp;
+using simd::InstructionSet;
+
+namespace {
+
+const CompareOp kOps[] = {
+    CompareOp::EQ, CompareOp::NE, CompareOp::LT, CompareOp::LE,
+    CompareOp::GT, CompareOp::GE, CompareOp::BETWEEN
+};
+
+template <typename T>
+bool reference(T v, CompareOp op, T lo, T hi) {
+    switch (op) {
+        case CompareOp::EQ: return v == lo;
+        case CompareOp::NE: return v != lo;
+        case CompareOp::LT: return v < lo;
+        case CompareOp::LE: return v <= lo;
+        case CompareOp::GT: return v > lo;
+        case CompareOp::GE: return v >= lo;
+        case CompareOp::BETWEEN: return lo <= v && v <= hi;
+    }
+    return false;
+}
+
+std::vector<InstructionSet> supported_isas() {
+    std::vector<InstructionSet> isas{InstructionSet::SCALAR};
+    if (simd::detect_instruction_set() >= InstructionSet::AVX2) {
+        isas.push_back(InstructionSet::AVX2);
+    }
+    if (simd::detect_instruction_set() >= InstructionSet::AVX512) {
+        isas.push_back(InstructionSet::AVX512);
+    }
+    return isas;
+}
+
+bool bit(const std::vector<uint64_t>& mask, size_t i) {
+    return (mask[i / 64] >> (i % 64)) & 1;
+}
+
+// Sizes around every vector width and mask word boundary
+const size_t kSizes[] = {0, 1, 7, 8, 15, 16, 17, 63, 64, 65, 200, 1000};
+
+template <typename T>
+void check_constant_kernels(const std::vector<T>& values, T lo, T hi) {
+    for (InstructionSet isa : supported_isas()) {
+        for (size_t n : kSizes) {
+            for (CompareOp op : kOps) {
+                // Poison the mask so stale bits past n would be noticed
+                std::vector<uint64_t> mask(simd::mask_words(n) + 1, ~0ULL);
+                simd::compare(values.data(), n, op, lo, hi, mask.data(), isa);
+                for (size_t i = 0; i < simd::mask_words(n) * 64; ++i) {
+                    bool expected = i < n && reference(values[i], op, lo, hi);
+                    ASSERT_EQ(bit(mask, i), expected)
+                        << simd::instruction_set_name(isa) << " n=" << n
+                        << " op=" << static_cast<int>(op) << " i=" << i;
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+std::vector<T> random_values(T low, T high) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int64_t> dist(static_cast<int64_t>(low), static_cast<int64_t>(high));
+    std::vector<T> values(1000);
+    for (auto& v : values) {
+        v = static_cast<T>(dist(rng));
+    }
+    return values;
+}
+
+}  // namespace
+
+TEST(SimdKernelsTest, Int32MatchesReference) {
+    check_constant_kernels<int32_t>(random_values<int32_t>(-20, 20), -3, 11);
+}
+
+TEST(SimdKernelsTest, Int64MatchesReference) {
+    auto values = random_values<int64_t>(-20, 20);
+    values[5] = std::numeric_limits<int64_t>::min();
+    values[70] = std::numeric_limits<int64_t>::max();
+    check_constant_kernels<int64_t>(values, 0, 5000000000LL);
+}
+
+TEST(SimdKernelsTest, FloatMatchesReference) {
+    auto values = random_values<float>(-20, 20);
+    values[3] = std::nanf("");
+    values[66] = -0.0f;
+    check_constant_kernels<float>(values, 0.0f, 12.5f);
+}
+
+TEST(SimdKernelsTest, DoubleMatchesReference) {
+    auto values = random_values<double>(-20, 20);
+    values[9] = std::nan("");
+    values[130] = std::numeric_limits<double>::infinity();
+    check_constant_kernels<double>(values, -4.0, 4.0);
+}
+
+TEST(SimdKernelsTest, CompareColumns) {
+    auto left = random_values<int32_t>(0, 5);
+    auto right = random_values<int32_t>(0, 5);
+    std::reverse(right.begin(), right.end());
+
+    for (InstructionSet isa : supported_isas()) {
+        for (CompareOp op : kOps) {
+            if (op == CompareOp::BETWEEN) {
+                continue;
+            }
+            std::vector<uint64_t> mask(simd::mask_words(left.size()));
+            simd::compare_columns(left.data(), right.data(), left.size(), op, mask.data(), isa);
+            for (size_t i = 0; i < left.size(); ++i) {
+                ASSERT_EQ(bit(mask, i), reference(left[i], op, right[i], 0))
+                    << simd::instruction_set_name(isa) << " i=" << i;
+            }
+        }
+    }
+
+    std::vector<uint64_t> mask(1);
+    EXPECT_THROW(simd::compare_columns(left.data(), right.data(), 10, CompareOp::BETWEEN,
+                                       mask.data(), InstructionSet::SCALAR),
+                 std::invalid_argument);
+}
+
+TEST(SimdKernelsTest, MaskToSelection) {
+    std::vector<uint64_t> mask{0x8000000000000001ULL, 0x5ULL};
+    std::vector<uint32_t> out(70);
+    size_t count = simd::mask_to_selection(mask.data(), 67, out.data());
+    out.resize(count);
+    EXPECT_EQ(out, (std::vector<uint32_t>{0, 63, 64, 66}));
+}
+
+class SimdFilterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        schema_ = Schema({
+            ColumnDef("a", DataType::INT32),
+            ColumnDef("b", DataType::INT64),
+            ColumnDef("x", DataType::FLOAT64),
+            ColumnDef("y", DataType::FLOAT32),
+            ColumnDef("c", DataType::INT32)
+        });
+        table_ = std::make_unique<Table>("t", schema_);
+        for (int i = 0; i < 3000; ++i) {
+            // Every 7th row has NULL a and x
+            std::string a = (i % 7 == 0) ? "" : std::to_string(i % 50);
+            std::string x = (i % 7 == 0) ? "" : std::to_string(i % 40) + ".25";
+            table_->insert_row(std::vector<std::string>{
+                a, std::to_string(i * 3), x, std::to_string(i % 13) + ".5", std::to_string(i % 45)});
+        }
+    }
+
+    size_t count(const std::string& where, bool simd_enabled) {
+        stmts_.push_back(parser_.parse_select_statement("SELECT * FROM t WHERE " + where));
+        QueryExecutor executor;
+        executor.set_simd_enabled(simd_enabled);
+        std::vector<size_t> row_ids;
+        return executor.filter_table(*table_, stmts_.back()->where_clause.get(), row_ids);
+    }
+
+    Schema schema_;
+    std::unique_ptr<Table> table_;
+    query::SqlParser parser_;
+    std::vector<std::unique_ptr<query::SelectStatement>> stmts_;
+};
+
+TEST_F(SimdFilterTest, SimdMatchesScalar) {
+    const char* predicates[] = {
+        "a < 10",
+        "a = 0",
+        "a <> 3",
+        "b >= 4500",
+        "x > 12",
+        "y <= 6.5",
+        "y < 6.3",
+        "a >= 10 AND a <= 20",
+        "a > 10 AND a < 20",
+        "x >= 5 AND x <= 30",
+        "a < c",
+        "a = c",
+        "a < 25 AND b > 3000"
+    };
+    for (const char* where : predicates) {
+        EXPECT_EQ(count(where, true), count(where, false)) << where;
+    }
+}
+
+TEST_F(SimdFilterTest, RangeCountsAreExact) {
+    // Rows with NULL a never match
+    size_t expected = 0;
+    for (int i = 0; i < 3000; ++i) {
+        expected += (i % 7 != 0) && (i % 50) >= 10 && (i % 50) <= 20;
+    }
+    EXPECT_EQ(count("a >= 10 AND a <= 20", true), expected);
+    EXPECT_EQ(count("a > 9 AND a < 21", true), expected);
+}
+
+TEST_F(SimdFilterTest, RangePairCompilesToOnePredicate) {
+    ExpressionCompiler compiler;
+    stmts_.push_back(parser_.parse_select_statement("SELECT * FROM t WHERE a >= 1 AND a <= 9"));
+    auto range = compiler.compile(stmts_.back()->where_clause.get(), schema_);
+    ASSERT_NE(range, nullptr);
+    EXPECT_TRUE(range->is_column_predicate());
+
+    stmts_.push_back(parser_.parse_select_statement("SELECT * FROM t WHERE a < c"));
+    auto columns = compiler.compile(stmts_.back()->where_clause.get(), schema_);
+    ASSERT_NE(columns, nullptr);
+    EXPECT_TRUE(columns->is_column_predicate());
+}
+
+} // namespace test
+} // namespace lyradb
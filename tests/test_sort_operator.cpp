@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include "lyradb/sort_operator.h"
+#include "lyradb/database.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/query_result.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/task_scheduler.h"
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+namespace {
+
+std::string int_key(int64_t value, bool desc = false) {
+    std::string out;
+    SortKeyEncoder::encode_int(value, desc, out);
+    return out;
+}
+
+std::string double_key(double value, bool desc = false) {
+    std::string out;
+    SortKeyEncoder::encode_double(value, desc, out);
+    return out;
+}
+
+std::string string_key(const std::string& value, bool desc = false) {
+    std::string out;
+    SortKeyEncoder::encode_string(value, desc, out);
+    return out;
+}
+
+std::string null_key(bool desc = false) {
+    std::string out;
+    SortKeyEncoder::encode_null(desc, out);
+    return out;
+}
+
+// std::string compares as unsigned char, which is memcmp order
+bool before(const std::string& a, const std::string& b) {
+    return a < b;
+}
+
+} // namespace
+
+TEST(SortKeyEncoderTest, KeysCompareLikeValues) {
+    std::vector<int64_t> ints = {INT64_MIN, -1000, -1, 0, 1, 255, 256, 1000000, INT64_MAX};
+    for (size_t i = 1; i < ints.size(); ++i) {
+        EXPECT_TRUE(before(int_key(ints[i - 1]), int_key(ints[i])));
+        EXPECT_TRUE(before(int_key(ints[i], true), int_key(ints[i - 1], true)));
+    }
+
+    std::vector<double> doubles = {-1e300, -2.5, -1.0, -1e-300, 0.0, 1e-300, 0.5, 2.0, 1e300};
+    for (size_t i = 1; i < doubles.size(); ++i) {
+        EXPECT_TRUE(before(double_key(doubles[i - 1]), double_key(doubles[i])));
+        EXPECT_TRUE(before(double_key(doubles[i], true), double_key(doubles[i - 1], true)));
+    }
+    EXPECT_EQ(double_key(-0.0), double_key(0.0));
+
+    // Prefixes and embedded NULs keep their order
+    std::vector<std::string> strings = {"", std::string("a\0", 2), std::string("a\0b", 3),
+                                        "a", "ab", "b", "\xff"};
+    std::sort(strings.begin(), strings.end());
+    for (size_t i = 1; i < strings.size(); ++i) {
+        EXPECT_TRUE(before(string_key(strings[i - 1]), string_key(strings[i])));
+        EXPECT_TRUE(before(string_key(strings[i], true), string_key(strings[i - 1], true)));
+    }
+
+    // Concatenated keys: the first column decides before the second is read
+    EXPECT_TRUE(before(string_key("a") + int_key(9), string_key("ab") + int_key(1)));
+
+    // NULLs sort last ascending and first descending
+    EXPECT_TRUE(before(string_key("zzz"), null_key()));
+    EXPECT_TRUE(before(int_key(INT64_MAX), null_key()));
+    EXPECT_TRUE(before(null_key(true), int_key(INT64_MIN, true)));
+    EXPECT_TRUE(before(null_key(true), string_key("", true)));
+}
+
+class SortOperatorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        col_names_ = {"id", "name", "score", "grp"};
+        col_types_ = {DataType::INT64, DataType::STRING, DataType::FLOAT64, DataType::INT32};
+        for (int i = 0; i < 50000; ++i) {
+            int score = (i * 7919) % 1000 - 500;
+            rows_.push_back({
+                std::to_string(i),
+                i % 101 == 0 ? "" : "n" + std::to_string((i * 31) % 977),
+                std::to_string(score) + ".25",
+                std::to_string(i % 13)});
+        }
+    }
+
+    // Typed reference comparator: NULL last ASC, first DESC
+    std::vector<size_t> reference(const std::vector<std::pair<size_t, bool>>& keys) const {
+        std::vector<size_t> order(rows_.size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            for (const auto& [col, desc] : keys) {
+                const std::string& x = rows_[a][col];
+                const std::string& y = rows_[b][col];
+                int cmp;
+                if (x.empty() || y.empty()) {
+                    cmp = x.empty() == y.empty() ? 0 : (x.empty() ? 1 : -1);
+                } else if (col_types_[col] == DataType::STRING) {
+                    cmp = x.compare(y);
+                } else {
+                    double dx = std::stod(x);
+                    double dy = std::stod(y);
+                    cmp = dx < dy ? -1 : (dx > dy ? 1 : 0);
+                }
+                if (cmp != 0) {
+                    return desc ? cmp > 0 : cmp < 0;
+                }
+            }
+            return false;
+        });
+        return order;
+    }
+
+    std::vector<std::string> col_names_;
+    std::vector<DataType> col_types_;
+    std::vector<std::vector<std::string>> rows_;
+};
+
+TEST_F(SortOperatorTest, MultiKeySortMatchesReference) {
+    query::ColumnRefExpr grp("grp");
+    query::ColumnRefExpr name("name");
+    query::ColumnRefExpr score("score");
+    QueryExecutor executor;
+
+    SortOperator by_group_name({{&grp, false}, {&name, true}});
+    EXPECT_EQ(by_group_name.sort(rows_, col_names_, col_types_, 0, executor),
+              reference({{3, false}, {1, true}}));
+
+    SortOperator by_score({{&score, false}, {&name, false}});
+    EXPECT_EQ(by_score.sort(rows_, col_names_, col_types_, 0, executor),
+              reference({{2, false}, {1, false}}));
+}
+
+TEST_F(SortOperatorTest, TopNIsPrefixOfFullSort) {
+    query::ColumnRefExpr score("score");
+    query::ColumnRefExpr id("id");
+    QueryExecutor executor;
+    SortOperator sorter({{&score, true}, {&id, false}});
+    auto full = sorter.sort(rows_, col_names_, col_types_, 0, executor);
+    for (size_t limit : {1, 10, 777}) {
+        auto top = sorter.sort(rows_, col_names_, col_types_, limit, executor);
+        ASSERT_EQ(top.size(), limit);
+        EXPECT_TRUE(std::equal(top.begin(), top.end(), full.begin()));
+    }
+    EXPECT_EQ(sorter.sort(rows_, col_names_, col_types_, rows_.size() + 5, executor), full);
+}
+
+TEST_F(SortOperatorTest, ParallelMatchesSerial) {
+    query::ColumnRefExpr name("name");
+    // score * -1 is not an output column: evaluated once per row
+    query::BinaryExpr negated(std::make_unique<query::ColumnRefExpr>("score"),
+                              query::BinaryOp::MULTIPLY,
+                              std::make_unique<query::LiteralExpr>(
+                                  query::Token(query::TokenType::INTEGER, "-1")));
+    SortOperator sorter({{&name, false}, {&negated, false}});
+
+    QueryExecutor serial;
+    serial.set_parallelism(1);
+    auto expected = sorter.sort(rows_, col_names_, col_types_, 0, serial);
+    EXPECT_EQ(expected, reference({{1, false}, {2, true}}));
+
+    TaskScheduler scheduler(3);
+    QueryExecutor parallel;
+    parallel.set_scheduler(&scheduler);
+    parallel.set_morsel_size(4096);
+    EXPECT_EQ(sorter.sort(rows_, col_names_, col_types_, 0, parallel), expected);
+    auto top = sorter.sort(rows_, col_names_, col_types_, 100, parallel);
+    EXPECT_TRUE(std::equal(top.begin(), top.end(), expected.begin()));
+}
+
+TEST(SortOperatorSqlTest, OrderByTypedColumnsAndAggregates) {
+    Database db(":memory:");
+    db.execute("CREATE TABLE t (id INT, name VARCHAR, grp INT)");
+    for (int i = 0; i < 12; ++i) {
+        db.execute("INSERT INTO t VALUES (" + std::to_string(i) + ", 'n" +
+                   std::to_string(i % 4) + "', " + std::to_string(i % 3) + ")");
+    }
+
+    // Numeric, not lexicographic: 11 and 10 come before 9 descending
+    auto result = db.execute("SELECT * FROM t ORDER BY id DESC LIMIT 3");
+    auto rows = dynamic_cast<EngineQueryResult*>(result.get());
+    ASSERT_NE(rows, nullptr);
+    ASSERT_EQ(rows->row_count(), 3u);
+    EXPECT_EQ(rows->get_value(0, 0), "11");
+    EXPECT_EQ(rows->get_value(2, 0), "9");
+
+    result = db.execute("SELECT * FROM t ORDER BY name, id DESC LIMIT 2 OFFSET 2");
+    rows = dynamic_cast<EngineQueryResult*>(result.get());
+    ASSERT_EQ(rows->row_count(), 2u);
+    EXPECT_EQ(rows->get_value(0, 0), "0");    // n0: 8, 4, 0
+    EXPECT_EQ(rows->get_value(1, 0), "9");    // n1: 9, 5, 1
+
+    result = db.execute("SELECT grp, SUM(id) FROM t GROUP BY grp ORDER BY SUM(id) DESC");
+    rows = dynamic_cast<EngineQueryResult*>(result.get());
+    ASSERT_EQ(rows->row_count(), 3u);
+    EXPECT_EQ(rows->get_value(0, 0), "2");    // 2+5+8+11 = 26
+    EXPECT_EQ(rows->get_value(2, 0), "0");    // 0+3+6+9 = 18
+}
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,288 @@
+#include <gtest/gtest.h>
+#include "lyradb/table.h"
+#include "lyradb/schema.h"
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class TableColumnarTest : public ::testing::Test {
+protected:
+    Schema make_schema() {
+        return Schema({
+            ColumnDef("id", DataType::INT32),
+            ColumnDef("amount", DataType::FLOAT64),
+            ColumnDef("active", DataType::BOOL),
+            ColumnDef("name", DataType::STRING)
+        });
+    }
+};
+
+TEST_F(TableColumnarTest, ValuesStoredNatively) {
+    Table table("t", make_schema());
+    table.insert_row(std::vector<std::string>{"7", "1.5", "true", "alice"});
+    table.insert_row(std::vector<std::string>{"8", "2.25", "false", "bob"});
+
+    EXPECT_EQ(table.row_count(), 2u);
+    EXPECT_EQ(table.column(0).data<int32_t>()[1], 8);
+    EXPECT_DOUBLE_EQ(table.column(1).data<double>()[0], 1.5);
+    EXPECT_EQ(table.column(2).data<uint8_t>()[0], 1);
+    EXPECT_EQ(table.column(3).string_at(1), "bob");
+}
+
+TEST_F(TableColumnarTest, NullsUseBitmap) {
+    Table table("t", make_schema());
+    table.insert_row(std::vector<std::string>{"", "", "", ""});
+
+    EXPECT_TRUE(table.column(0).is_null(0));
+    EXPECT_EQ(table.column(0).null_count(), 1u);
+    EXPECT_EQ(table.column(0).data<int32_t>()[0], 0);
+    EXPECT_EQ(table.get_row(0), (std::vector<std::string>{"", "", "", ""}));
+}
+
+TEST_F(TableColumnarTest, ScanAllMaterializesRows) {
+    Table table("t", make_schema());
+    table.insert_row(std::vector<std::string>{"1", "0.5", "true", "a"});
+
+    auto rows = table.scan_all();
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0], (std::vector<std::string>{"1", "0.5", "true", "a"}));
+}
+
+TEST_F(TableColumnarTest, TypedFilter) {
+    Table table("t", make_schema());
+    for (int i = 0; i < 1000; ++i) {
+        table.insert_row(std::vector<std::string>{
+            std::to_string(i), std::to_string(i * 0.5), i % 2 ? "true" : "false", "n" + std::to_string(i)});
+    }
+
+    EXPECT_EQ(table.scan_with_filter("id", ">=", "990").size(), 10u);
+    EXPECT_EQ(table.scan_with_filter("amount", "<", "1").size(), 2u);
+    EXPECT_EQ(table.scan_with_filter("name", "=", "n42").size(), 1u);
+    EXPECT_EQ(table.scan_with_filter("active", "=", "true").size(), 500u);
+}
+
+TEST_F(TableColumnarTest, InvalidValueRollsBack) {
+    Table table("t", make_schema());
+    table.insert_row(std::vector<std::string>{"1", "1", "true", "a"});
+
+    EXPECT_THROW(table.insert_row(std::vector<std::string>{"x", "1", "true", "b"}), std::runtime_error);
+    EXPECT_THROW(table.insert_row(std::vector<std::string>{"2", "1", "maybe", "b"}), std::runtime_error);
+    EXPECT_EQ(table.row_count(), 1u);
+    EXPECT_EQ(table.column(0).num_values(), 1u);
+    EXPECT_EQ(table.column(1).num_values(), 1u);
+}
+
+TEST_F(TableColumnarTest, IntegersRejectFractionsAndOverflow) {
+    Table table("t", make_schema());
+    table.insert_row(std::vector<std::string>{"31.000000", "1", "true", "a"});
+    table.insert_row(std::vector<std::string>{"-2147483648", "1", "true", "a"});
+    table.insert_row(std::vector<std::string>{"2147483647.0", "1", "true", "a"});
+    EXPECT_EQ(table.column(0).data<int32_t>()[0], 31);
+    EXPECT_EQ(table.column(0).data<int32_t>()[1], -2147483647 - 1);
+    EXPECT_EQ(table.column(0).data<int32_t>()[2], 2147483647);
+
+    EXPECT_THROW(table.insert_row(std::vector<std::string>{"31.7", "1", "true", "b"}), std::runtime_error);
+    EXPECT_THROW(table.insert_row(std::vector<std::string>{"3000000000", "1", "true", "b"}),
+                 std::runtime_error);
+    EXPECT_THROW(table.insert_row(std::vector<std::string>{"-2147483649", "1", "true", "b"}),
+                 std::runtime_error);
+    EXPECT_THROW(table.insert_row(std::vector<std::string>{"1e300", "1", "true", "b"}), std::runtime_error);
+    EXPECT_EQ(table.row_count(), 3u);
+
+    Column wide("w", DataType::INT64);
+    EXPECT_THROW(wide.append_string("9223372036854775808.0"), std::runtime_error);
+    EXPECT_THROW(wide.append_string("0.5"), std::runtime_error);
+    wide.append_string("-9223372036854775808");
+    EXPECT_EQ(wide.data<int64_t>()[0], std::numeric_limits<int64_t>::min());
+}
+
+TEST_F(TableColumnarTest, UpdateAndDelete) {
+    Table table("t", make_schema());
+    for (int i = 0; i < 10; ++i) {
+        table.insert_row(std::vector<std::string>{std::to_string(i), "0", "false", "r"});
+    }
+
+    table.update_row(3, {"30", "3.5", "true", "updated"});
+    EXPECT_EQ(table.get_row(3), (std::vector<std::string>{"30", "3.5", "true", "updated"}));
+
+    // Deletes only mark rows: ids stay put and scans skip them
+    EXPECT_EQ(table.delete_rows({0, 2, 2, 9, 42}), 3u);
+    EXPECT_EQ(table.delete_rows({2}), 0u);
+    EXPECT_EQ(table.row_count(), 10u);
+    EXPECT_EQ(table.live_row_count(), 7u);
+    EXPECT_TRUE(table.is_deleted(2));
+    EXPECT_EQ(table.get_row(3)[0], "30");
+    EXPECT_EQ(table.scan_all().size(), 7u);
+    EXPECT_EQ(table.scan_all()[0][0], "1");
+    EXPECT_EQ(table.scan_with_filter("id", "<", "5"), (std::vector<size_t>{1, 4}));
+    EXPECT_EQ(table.scan_with_filter("name", "=", "r").size(), 6u);
+    
+    table.undelete_rows({2});
+    EXPECT_EQ(table.live_row_count(), 8u);
+    table.delete_rows({2});
+
+    // Purging removes them and reports where the survivors went
+    auto remap = table.purge_deleted();
+    ASSERT_EQ(remap.size(), 10u);
+    EXPECT_EQ(remap[0], Table::kPurgedRow);
+    EXPECT_EQ(remap[3], 1u);
+    EXPECT_EQ(remap[8], 6u);
+    EXPECT_EQ(table.row_count(), 7u);
+    EXPECT_EQ(table.deleted_count(), 0u);
+    EXPECT_EQ(table.get_row(0)[0], "1");
+    EXPECT_EQ(table.get_row(1)[0], "30");
+    EXPECT_TRUE(table.purge_deleted().empty());
+}
+
+TEST_F(TableColumnarTest, DeletesAreCopyOnWrite) {
+    Table table("t", make_schema());
+    for (int i = 0; i < 10; ++i) {
+        table.insert_row(std::vector<std::string>{std::to_string(i), "0", "false", "r"});
+    }
+    table.delete_rows({1});
+    auto before = table.snapshot();
+
+    table.delete_rows({2, 3});
+    table.truncate(3);
+    EXPECT_EQ(table.deleted_count(), 2u);
+    EXPECT_EQ(before->deleted_count(), 1u);
+    EXPECT_FALSE(before->is_deleted(2));
+    EXPECT_EQ(before->scan_all().size(), 9u);
+
+    table.purge_deleted();
+    EXPECT_EQ(table.row_count(), 1u);
+    EXPECT_EQ(before->row_count(), 10u);
+    EXPECT_EQ(before->get_row(1)[0], "1");
+}
+
+TEST_F(TableColumnarTest, DeltaStoreAbsorbsWrites) {
+    Table table("t", make_schema());
+    for (int i = 0; i < 100; ++i) {
+        table.insert_row(std::vector<std::string>{std::to_string(i), "1.5", "TRUE", "r"});
+    }
+    table.merge_delta();
+    EXPECT_EQ(table.delta_row_count(), 0u);
+    const Column* merged = &table.column(0);
+    auto before = table.snapshot();
+
+    // Point writes touch only the delta; the snapshot still shares the columns
+    table.insert_row(std::vector<std::string>{"007", "", "0", "new"});
+    table.update_row(3, std::vector<std::string>{"3", "2.25", "false", "changed"});
+    table.update_row(100, std::vector<std::string>{"100", "NULL", "1", "newer"});
+    EXPECT_EQ(table.delta_row_count(), 2u);
+    EXPECT_EQ(&before->column(0), merged);
+    EXPECT_EQ(before->get_row(3), (std::vector<std::string>{"3", "1.5", "true", "r"}));
+    EXPECT_EQ(before->row_count(), 100u);
+
+    // Row reads see the union, in the columns' own formatting
+    EXPECT_EQ(table.get_row(3), (std::vector<std::string>{"3", "2.25", "false", "changed"}));
+    EXPECT_EQ(table.get_row(100), (std::vector<std::string>{"100", "", "true", "newer"}));
+    EXPECT_EQ(table.scan_all().size(), 101u);
+    EXPECT_THROW(table.update_row(4, std::vector<std::string>{"4", "x", "true", "r"}), std::runtime_error);
+    EXPECT_EQ(table.get_row(4)[1], "1.5");
+
+    // Column reads see a merged column, which the next write takes over
+    EXPECT_EQ(table.scan_with_filter("name", "=", "changed"), (std::vector<size_t>{3}));
+    EXPECT_TRUE(table.column(1).is_null(100));
+    for (size_t c = 0; c < table.column_count(); ++c) {
+        EXPECT_EQ(table.column(c).num_values(), 101u);
+    }
+    table.insert_row(std::vector<std::string>{"101", "1", "true", "x"});
+    EXPECT_EQ(table.delta_row_count(), 1u);
+
+    // Rolling inserts back only trims the delta
+    table.truncate(101);
+    EXPECT_EQ(table.delta_row_count(), 0u);
+    EXPECT_EQ(table.column(0).num_values(), 101u);
+
+    // A full delta is merged by the write that fills it
+    for (size_t i = 0; i < Table::kDeltaRows; ++i) {
+        table.insert_row(std::vector<std::string>{"1", "1", "true", "x"});
+    }
+    EXPECT_EQ(table.delta_row_count(), 0u);
+    EXPECT_EQ(table.row_count(), 101u + Table::kDeltaRows);
+    EXPECT_EQ(before->row_count(), 100u);
+}
+
+TEST_F(TableColumnarTest, WritesCopyOnlyTheirRowGroups) {
+    Table table("t", make_schema());
+    for (size_t i = 0; i < 2 * Table::kRowGroupRows + 10; ++i) {
+        table.insert_row(std::vector<std::string>{std::to_string(i), "1.5", "true", "r"});
+    }
+    table.merge_delta();
+    ASSERT_EQ(table.stored_group_count(), 3u);
+    auto before = table.snapshot();
+
+    // Merging an update copies the row group it hit, of the columns it changes
+    size_t row = Table::kRowGroupRows + 1;
+    table.update_row(row, std::vector<std::string>{std::to_string(row), "1.5", "true", "changed"});
+    table.merge_delta();
+    for (size_t g = 0; g < 3; ++g) {
+        EXPECT_EQ(&table.stored(0, g), &before->stored(0, g));
+        EXPECT_EQ(&table.stored(3, g) == &before->stored(3, g), g != 1);
+    }
+    EXPECT_EQ(table.get_value(row, 3), "changed");
+    EXPECT_EQ(before->get_value(row, 3), "r");
+
+    // Merging inserts copies only the last row group
+    table.insert_row(std::vector<std::string>{"-1", "2", "false", "new"});
+    table.merge_delta();
+    EXPECT_EQ(&table.stored(0, 0), &before->stored(0, 0));
+    EXPECT_NE(&table.stored(0, 2), &before->stored(0, 2));
+    EXPECT_EQ(table.stored(0, 2).num_values(), 11u);
+    EXPECT_EQ(before->stored(0, 2).num_values(), 10u);
+    EXPECT_EQ(before->row_count(), 2 * Table::kRowGroupRows + 10);
+}
+
+TEST_F(TableColumnarTest, RowGroupUpdatesFoldOnceTheyFillAChunk) {
+    Table table("t", make_schema());
+    for (size_t i = 0; i < 2 * Table::kRowGroupRows + 10; ++i) {
+        table.insert_row(std::vector<std::string>{std::to_string(i), "1.5", "true", "r"});
+    }
+    table.merge_delta();
+    auto before = table.snapshot();
+
+    // Updates of one row group wait in the delta store up to a chunk's worth
+    size_t first = Table::kRowGroupRows;
+    for (size_t k = 0; k + 1 < Table::kDeltaChunkRows; ++k) {
+        table.update_row(first + k, std::vector<std::string>{"1", "1.5", "true", "u"});
+    }
+    table.update_row(5, std::vector<std::string>{"5", "1.5", "true", "other"});
+    EXPECT_EQ(table.delta_row_count(), Table::kDeltaChunkRows);
+    EXPECT_EQ(&table.stored(3, 1), &before->stored(3, 1));
+
+    // The write filling it folds them into that row group alone
+    table.update_row(first + Table::kDeltaChunkRows, std::vector<std::string>{"1", "1.5", "true", "u"});
+    EXPECT_EQ(table.delta_row_count(), 1u);
+    EXPECT_EQ(table.updated_rows(), (std::vector<size_t>{5}));
+    EXPECT_NE(&table.stored(3, 1), &before->stored(3, 1));
+    EXPECT_EQ(&table.stored(3, 0), &before->stored(3, 0));
+    EXPECT_EQ(table.stored(3, 1).get_string(Table::kDeltaChunkRows), "u");
+    EXPECT_EQ(table.get_value(5, 3), "other");
+    EXPECT_EQ(before->get_value(first, 3), "r");
+}
+
+TEST_F(TableColumnarTest, PagesSealAutomatically) {
+    Table table("t", make_schema());
+    for (int i = 0; i < 20000; ++i) {
+        table.insert_row(std::vector<std::string>{std::to_string(i), "1", "true", "x"});
+    }
+
+    table.merge_delta();
+    ASSERT_EQ(table.stored_group_count(), 3u);
+
+    // String pages hold 4096 values, so two seal in every full row
+    // group; 64 KB pages hold 16384 int32 values, more than a group
+    EXPECT_EQ(table.stored(3, 0).num_pages(), 2u);
+    EXPECT_EQ(table.stored(0, 0).num_pages(), 0u);
+    table.finalize();
+    EXPECT_EQ(table.stored(0, 0).num_pages(), 1u);
+    EXPECT_EQ(table.stored(0, 2).num_pages(), 1u);
+    EXPECT_EQ(table.stored(3, 2).num_pages(), 1u);
+}
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "lyradb/database.h"
+#include "lyradb/query_result.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/table.h"
+#include "lyradb/table_scan.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class TableScanTest : public ::testing::Test {
+protected:
+    static constexpr size_t kRows = 5 * Table::kRowGroupRows;
+
+    void SetUp() override {
+        db_.execute("CREATE TABLE t (id INT, tag VARCHAR)");
+        table_ = db_.get_table("t");
+        for (size_t i = 0; i < kRows; ++i) {
+            table_->insert_row(std::vector<std::string>{std::to_string(i), "v" + std::to_string(i % 7)});
+        }
+        table_->merge_delta();
+    }
+
+    const query::Expression* where(const std::string& text) {
+        stmts_.push_back(parser_.parse_select_statement("SELECT * FROM t WHERE " + text));
+        return stmts_.back()->where_clause.get();
+    }
+
+    std::vector<std::string> ids(const std::string& sql) {
+        auto result = db_.query(sql);
+        const auto& rows = dynamic_cast<const EngineQueryResult&>(*result);
+        std::vector<std::string> out;
+        for (size_t r = 0; r < rows.row_count(); ++r) {
+            out.push_back(rows.get_value(r, 0));
+        }
+        return out;
+    }
+
+    Database db_{"scan_test"};
+    std::shared_ptr<Table> table_;
+    query::SqlParser parser_;
+    std::vector<std::unique_ptr<query::SelectStatement>> stmts_;
+};
+
+TEST_F(TableScanTest, YieldsLiveMatchingRowsLazily) {
+    db_.execute("DELETE FROM t WHERE id < 10");
+
+    // Selections point into the batch; deleted and filtered rows are gone
+    TableScan scan(*table_, where("tag = 'v3'"), 256);
+    VectorBatch batch;
+    SelectionVector selection;
+    ASSERT_TRUE(scan.next(batch, selection));
+    EXPECT_EQ(batch.offset, 0u);
+    EXPECT_EQ(batch.size, 256u);
+    ASSERT_FALSE(selection.empty());
+    EXPECT_EQ(selection[0], 10u);
+    for (uint32_t r : selection) {
+        EXPECT_EQ(batch.columns[1]->get_string(batch.offset + r), "v3");
+    }
+    // Nothing beyond the first batch has been read
+    EXPECT_EQ(scan.rows_scanned(), 256u);
+
+    size_t matches = selection.size();
+    while (scan.next(batch, selection)) {
+        matches += selection.size();
+    }
+    EXPECT_EQ(scan.rows_scanned(), kRows);
+    EXPECT_EQ(matches, (kRows + 3) / 7 - 1);
+
+    // Zone maps skip pages the predicate rules out
+    TableScan tail(*table_, where("id >= " + std::to_string(kRows - 100)));
+    size_t tail_rows = 0;
+    while (tail.next(batch, selection)) {
+        tail_rows += selection.size();
+    }
+    EXPECT_EQ(tail_rows, 100u);
+    EXPECT_LT(tail.rows_scanned(), kRows);
+}
+
+TEST_F(TableScanTest, LimitStopsScanInRowOrder) {
+    db_.execute("DELETE FROM t WHERE id = 2");
+    EXPECT_EQ(ids("SELECT * FROM t LIMIT 3"), (std::vector<std::string>{"0", "1", "3"}));
+    EXPECT_EQ(ids("SELECT * FROM t LIMIT 2 OFFSET 2"), (std::vector<std::string>{"3", "4"}));
+    EXPECT_EQ(ids("SELECT * FROM t WHERE tag = 'v1' LIMIT 2 OFFSET 1"),
+              (std::vector<std::string>{"8", "15"}));
+    EXPECT_TRUE(ids("SELECT * FROM t WHERE id < 5 LIMIT 3 OFFSET 10").empty());
+    EXPECT_EQ(ids("SELECT * FROM t ORDER BY id DESC LIMIT 1"),
+              (std::vector<std::string>{std::to_string(kRows - 1)}));
+
+    // Non-equi joins stream the inner table and keep outer-row order
+    db_.execute("CREATE TABLE u (lo INT)");
+    db_.execute("INSERT INTO u VALUES (3), (0), (1)");
+    auto result = db_.query("SELECT * FROM u LEFT JOIN t ON t.id < u.lo");
+    const auto& rows = dynamic_cast<const EngineQueryResult&>(*result);
+    ASSERT_EQ(rows.row_count(), 4u);
+    EXPECT_EQ(rows.get_value(0, 0), "3");
+    EXPECT_EQ(rows.get_value(0, 1), "0");
+    EXPECT_EQ(rows.get_value(1, 1), "1");
+    EXPECT_EQ(rows.get_value(2, 0), "0");
+    EXPECT_EQ(rows.get_value(2, 1), "");
+    EXPECT_EQ(rows.get_value(3, 0), "1");
+    EXPECT_EQ(rows.get_value(3, 1), "0");
+}
+
+TEST_F(TableScanTest, DeltaRowsLeaveColumnsShared) {
+    std::vector<const Column*> id_groups;
+    for (size_t g = 0; g < table_->stored_group_count(); ++g) {
+        id_groups.push_back(&table_->stored(0, g));
+    }
+    db_.execute("INSERT INTO t VALUES (" + std::to_string(kRows) + ", 'new')");
+    db_.execute("UPDATE t SET tag = 'changed' WHERE id = 5");
+    ASSERT_EQ(table_->delta_row_count(), 2u);
+
+    // The snapshot shares the stored row groups; the writes stay in the delta
+    auto snapshot = db_.get_table_snapshot("t");
+    ASSERT_EQ(snapshot->stored_group_count(), id_groups.size());
+    for (size_t g = 0; g < id_groups.size(); ++g) {
+        EXPECT_EQ(&snapshot->stored(0, g), id_groups[g]);
+    }
+    EXPECT_EQ(snapshot->stored_row_count(), kRows);
+
+    // Only batches holding a delta row read a copy, of just their rows
+    TableScan scan(*snapshot, nullptr, 256);
+    VectorBatch batch;
+    SelectionVector selection;
+    size_t rows = 0;
+    size_t copied = 0;
+    while (scan.next(batch, selection)) {
+        rows += selection.size();
+        if (batch.owned.empty()) {
+            EXPECT_EQ(batch.columns[0], id_groups[batch.offset / Table::kRowGroupRows]);
+            continue;
+        }
+        copied += batch.size;
+        ASSERT_EQ(batch.columns[1]->num_values(), batch.size);
+        size_t last = batch.position() + batch.size - 1;
+        EXPECT_EQ(batch.columns[1]->get_string(batch.offset == 0 ? 5 : last),
+                  batch.offset == 0 ? "changed" : "new");
+    }
+    EXPECT_EQ(rows, kRows + 1);
+    EXPECT_EQ(copied, 256u + 1u);
+
+    // Zone maps of the stored columns cannot rule the delta rows out
+    EXPECT_EQ(ids("SELECT * FROM t WHERE tag = 'new'"),
+              (std::vector<std::string>{std::to_string(kRows)}));
+    EXPECT_EQ(ids("SELECT * FROM t WHERE tag = 'changed'"), (std::vector<std::string>{"5"}));
+    EXPECT_EQ(ids("SELECT * FROM t WHERE id >= " + std::to_string(kRows - 1)),
+              (std::vector<std::string>{std::to_string(kRows - 1), std::to_string(kRows)}));
+    EXPECT_TRUE(ids("SELECT * FROM t WHERE id = 5 AND tag = 'v5'").empty());
+    for (size_t g = 0; g < id_groups.size(); ++g) {
+        EXPECT_EQ(&table_->stored(0, g), id_groups[g]);
+    }
+}
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "lyradb/task_scheduler.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/vector_batch.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/table.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+TEST(TaskSchedulerTest, RunsEveryTaskOnce) {
+    TaskScheduler scheduler(3);
+    EXPECT_EQ(scheduler.max_parallelism(), 4u);
+
+    std::vector<std::atomic<int>> runs(1000);
+    std::vector<std::atomic<int>> busy(4);
+    std::atomic<bool> shared_slot{false};
+    size_t slots = scheduler.parallel_for(runs.size(), 0, [&](size_t task, size_t slot) {
+        // A slot is never used by two tasks at once
+        if (busy[slot].fetch_add(1) != 0) {
+            shared_slot = true;
+        }
+        runs[task]++;
+        busy[slot]--;
+    });
+
+    EXPECT_EQ(slots, 4u);
+    EXPECT_FALSE(shared_slot);
+    for (const auto& count : runs) {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+TEST(TaskSchedulerTest, RespectsDegreeOfParallelism) {
+    TaskScheduler scheduler(3);
+    std::atomic<size_t> max_slot{0};
+    size_t slots = scheduler.parallel_for(100, 2, [&](size_t, size_t slot) {
+        size_t seen = max_slot.load();
+        while (slot > seen && !max_slot.compare_exchange_weak(seen, slot)) {}
+    });
+    EXPECT_EQ(slots, 2u);
+    EXPECT_LT(max_slot.load(), 2u);
+
+    // dop 1 runs inline on the caller
+    auto caller = std::this_thread::get_id();
+    bool inline_only = true;
+    scheduler.parallel_for(10, 1, [&](size_t, size_t) {
+        inline_only = inline_only && std::this_thread::get_id() == caller;
+    });
+    EXPECT_TRUE(inline_only);
+}
+
+TEST(TaskSchedulerTest, IdleParticipantsStealSlowBlocks) {
+    TaskScheduler scheduler(3);
+    std::atomic<int> done{0};
+    // Slot 0 is dealt tasks 0..7, which are the only slow ones
+    scheduler.parallel_for(32, 4, [&](size_t task, size_t) {
+        if (task < 8) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        done++;
+    });
+    EXPECT_EQ(done.load(), 32);
+    EXPECT_GT(scheduler.steal_count(), 0u);
+}
+
+TEST(TaskSchedulerTest, PropagatesExceptions) {
+    TaskScheduler scheduler(2);
+    EXPECT_THROW(scheduler.parallel_for(50, 0, [](size_t task, size_t) {
+        if (task == 17) {
+            throw std::runtime_error("boom");
+        }
+    }), std::runtime_error);
+
+    // The pool stays usable afterwards
+    std::atomic<int> count{0};
+    scheduler.parallel_for(10, 0, [&](size_t, size_t) { count++; });
+    EXPECT_EQ(count.load(), 10);
+}
+
+TEST(TaskSchedulerTest, NestedCallsDoNotDeadlock) {
+    TaskScheduler scheduler(2);
+    std::atomic<int> count{0};
+    scheduler.parallel_for(8, 0, [&](size_t, size_t) {
+        scheduler.parallel_for(8, 0, [&](size_t, size_t) { count++; });
+    });
+    EXPECT_EQ(count.load(), 64);
+}
+
+TEST(TaskSchedulerTest, SplitMorsels) {
+    auto morsels = split_morsels({RowRange{0, 250}, RowRange{400, 500}}, 100);
+    ASSERT_EQ(morsels.size(), 4u);
+    EXPECT_EQ(morsels[2].begin, 200u);
+    EXPECT_EQ(morsels[2].end, 250u);
+    EXPECT_EQ(morsels[3].begin, 400u);
+    EXPECT_EQ(morsels[3].end, 500u);
+}
+
+TEST(ParallelExecutorTest, ParallelFilterMatchesSerial) {
+    Schema schema({
+        ColumnDef("id", DataType::INT32),
+        ColumnDef("name", DataType::STRING)
+    });
+    Table table("t", schema);
+    for (int i = 0; i < 20000; ++i) {
+        table.insert_row(std::vector<std::string>{std::to_string(i), "n" + std::to_string(i % 37)});
+    }
+
+    query::SqlParser parser;
+    auto stmt = parser.parse_select_statement(
+        "SELECT * FROM t WHERE id > 1234 AND name = 'n5' OR id < 10");
+    ASSERT_NE(stmt, nullptr);
+
+    QueryExecutor serial;
+    serial.set_parallelism(1);
+    std::vector<size_t> expected;
+    serial.filter_table(table, stmt->where_clause.get(), expected);
+
+    TaskScheduler scheduler(3);
+    QueryExecutor parallel;
+    parallel.set_scheduler(&scheduler);
+    parallel.set_morsel_size(700);
+    EXPECT_EQ(parallel.parallelism(), 4u);
+    std::vector<size_t> actual;
+    parallel.filter_table(table, stmt->where_clause.get(), actual);
+    EXPECT_EQ(actual, expected);
+    EXPECT_FALSE(expected.empty());
+
+    std::vector<std::vector<std::string>> rows;
+    parallel.materialize_rows(table, actual, rows);
+    ASSERT_EQ(rows.size(), actual.size());
+    EXPECT_EQ(rows.back(), table.get_row(actual.back()));
+}
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "lyradb/expression_evaluator.h"
+#include "lyradb/compiled_expression.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/vector_batch.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/table.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+class VectorizedEvaluationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        schema_ = Schema({
+            ColumnDef("id", DataType::INT32),
+            ColumnDef("score", DataType::FLOAT64),
+            ColumnDef("city", DataType::STRING)
+        });
+        table_ = std::make_unique<Table>("t", schema_);
+        const char* cities[] = {"paris", "rome", "oslo", "lima"};
+        for (int i = 0; i < 1000; ++i) {
+            // Every 10th score is NULL
+            std::string score = (i % 10 == 0) ? "" : std::to_string(i % 100) + ".5";
+            table_->insert_row(std::vector<std::string>{std::to_string(i), score, cities[i % 4]});
+        }
+    }
+
+    const query::Expression* where(const std::string& text) {
+        stmts_.push_back(parser_.parse_select_statement("SELECT * FROM t WHERE " + text));
+        return stmts_.back()->where_clause.get();
+    }
+
+    size_t count_matches(const std::string& text) {
+        QueryExecutor executor;
+        executor.set_batch_size(64);
+        std::vector<size_t> row_ids;
+        return executor.filter_table(*table_, where(text), row_ids);
+    }
+
+    Schema schema_;
+    std::unique_ptr<Table> table_;
+    query::SqlParser parser_;
+    std::vector<std::unique_ptr<query::SelectStatement>> stmts_;
+};
+
+TEST_F(VectorizedEvaluationTest, ConjunctsNarrowSelection) {
+    VectorBatch batch = VectorBatch::from_table(*table_, 0, 100);
+    SelectionVector selection;
+    select_all(selection, batch.size);
+
+    ExpressionEvaluator evaluator;
+    size_t kept = evaluator.filter_batch(where("id >= 20 AND id < 30 AND city = 'rome'"), batch, selection);
+    EXPECT_EQ(kept, 3u);
+    EXPECT_EQ(selection, (SelectionVector{21, 25, 29}));
+}
+
+TEST_F(VectorizedEvaluationTest, BatchOffsetIsRespected) {
+    VectorBatch batch = VectorBatch::from_table(*table_, 500, 100);
+    SelectionVector selection;
+    select_all(selection, batch.size);
+
+    ExpressionEvaluator evaluator;
+    evaluator.filter_batch(where("id = 512"), batch, selection);
+    EXPECT_EQ(selection, (SelectionVector{12}));
+}
+
+TEST_F(VectorizedEvaluationTest, NullsAreFilteredOut) {
+    // 100 scores are NULL; the remaining 900 have score < 100
+    EXPECT_EQ(count_matches("score < 100"), 900u);
+    EXPECT_EQ(count_matches("score >= 0 OR id < 0"), 900u);
+}
+
+TEST_F(VectorizedEvaluationTest, MatchesScalarEvaluation) {
+    const char* predicates[] = {
+        "id > 990",
+        "5 > id",
+        "score > 50 AND city LIKE 'o'",
+        "id + 1 = 100",
+        "city = 'oslo' OR id < 2",
+        "NOT (id < 995)",
+        "ROUND(score) > 10 AND id < 500"
+    };
+
+    ExpressionEvaluator scalar;
+    for (const char* text : predicates) {
+        const query::Expression* expr = where(text);
+        size_t expected = 0;
+        for (size_t row = 0; row < table_->row_count(); ++row) {
+            RowData data;
+            data["id"] = static_cast<int64_t>(table_->column(0).data<int32_t>()[row]);
+            data["score"] = table_->column(1).is_null(row)
+                ? ExpressionValue(nullptr)
+                : ExpressionValue(table_->column(1).data<double>()[row]);
+            data["city"] = table_->column(2).string_at(row);
+            auto value = scalar.evaluate(expr, data);
+            if (std::holds_alternative<bool>(value) && std::get<bool>(value)) {
+                ++expected;
+            }
+        }
+        EXPECT_EQ(count_matches(text), expected) << text;
+    }
+}
+
+TEST_F(VectorizedEvaluationTest, ColumnPredicateFastPath) {
+    ExpressionCompiler compiler;
+    EXPECT_TRUE(compiler.compile(where("id > 3"), schema_)->is_column_predicate());
+    EXPECT_TRUE(compiler.compile(where("3 < id"), schema_)->is_column_predicate());
+    EXPECT_TRUE(compiler.compile(where("score <= 7"), schema_)->is_column_predicate());
+    EXPECT_FALSE(compiler.compile(where("id + 1 > 3"), schema_)->is_column_predicate());
+}
+
+TEST_F(VectorizedEvaluationTest, EvaluateBatchReturnsValues) {
+    VectorBatch batch = VectorBatch::from_table(*table_, 0, 20);
+    SelectionVector selection{1, 10, 11};
+
+    ExpressionEvaluator evaluator;
+    auto values = evaluator.evaluate_batch(where("score + id"), batch, selection);
+    ASSERT_EQ(values.size(), 3u);
+    EXPECT_DOUBLE_EQ(std::get<double>(values[0]), 2.5);
+    EXPECT_TRUE(std::holds_alternative<std::nullptr_t>(values[1]));
+    EXPECT_DOUBLE_EQ(std::get<double>(values[2]), 22.5);
+}
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include "lyradb/database.h"
+#include "lyradb/table.h"
+#include "lyradb/write_ahead_log.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+namespace lyradb {
+namespace test {
+
+class WriteAheadLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = (std::filesystem::temp_directory_path() / "lyradb_wal_test.wal").string();
+        std::filesystem::remove(path_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path_);
+    }
+
+    std::string path_;
+};
+
+TEST_F(WriteAheadLogTest, CommittedStatementsAreReplayed) {
+    {
+        Database db("wal_test");
+        db.open_wal(path_);
+        db.execute("CREATE TABLE t (id INT, name VARCHAR)");
+        db.execute("INSERT INTO t VALUES (1, 'a'), (2, 'b'), (3, 'c')");
+        db.execute("UPDATE t SET name = 'bb' WHERE id = 2");
+        db.execute("DELETE FROM t WHERE id = 1");
+        // Row ids after the purge are renumbered; replay must agree
+        EXPECT_EQ(db.purge_deleted("t"), 1u);
+        db.execute("UPDATE t SET name = 'cc' WHERE id = 3");
+        db.execute("CREATE TABLE gone (x INT)");
+        db.execute("DROP TABLE gone");
+        EXPECT_EQ(db.wal()->stats().commits, 8u);
+    }
+
+    Database db("wal_test");
+    db.open_wal(path_);
+    auto t = db.get_table("t");
+    ASSERT_EQ(t->row_count(), 2u);
+    EXPECT_EQ(t->deleted_count(), 0u);
+    EXPECT_EQ(t->get_row(0), (std::vector<std::string>{"2", "bb"}));
+    EXPECT_EQ(t->get_row(1), (std::vector<std::string>{"3", "cc"}));
+    EXPECT_EQ(db.list_tables(), (std::vector<std::string>{"t"}));
+}
+
+TEST_F(WriteAheadLogTest, RollbackUndoesTransaction) {
+    Database db("wal_test");
+    db.open_wal(path_);
+    db.execute("CREATE TABLE t (id INT, name VARCHAR)");
+    db.execute("INSERT INTO t VALUES (1, 'a'), (2, 'b'), (3, 'c')");
+
+    db.begin_transaction();
+    EXPECT_TRUE(db.in_transaction());
+    EXPECT_THROW(db.begin_transaction(), std::runtime_error);
+    db.execute("INSERT INTO t VALUES (4, 'd')");
+    db.execute("UPDATE t SET name = 'x' WHERE id >= 2");
+    db.execute("DELETE FROM t WHERE id = 1 OR id = 3");
+    db.execute("CREATE TABLE scratch (x INT)");
+    EXPECT_EQ(db.get_table("t")->live_row_count(), 2u);
+    db.rollback();
+    EXPECT_FALSE(db.in_transaction());
+    EXPECT_THROW(db.commit(), std::runtime_error);
+
+    auto t = db.get_table("t");
+    ASSERT_EQ(t->row_count(), 3u);
+    EXPECT_EQ(t->deleted_count(), 0u);
+    EXPECT_EQ(t->get_row(0), (std::vector<std::string>{"1", "a"}));
+    EXPECT_EQ(t->get_row(1), (std::vector<std::string>{"2", "b"}));
+    EXPECT_EQ(t->get_row(2), (std::vector<std::string>{"3", "c"}));
+    EXPECT_THROW(db.get_table("scratch"), std::runtime_error);
+
+    // A failing statement inside a transaction leaves no partial rows
+    db.begin_transaction();
+    db.execute("INSERT INTO t VALUES (5, 'e')");
+    EXPECT_THROW(db.execute("INSERT INTO t VALUES (6, 'f'), ('bad', 'g')"), std::exception);
+    EXPECT_EQ(t->row_count(), 4u);
+    db.commit();
+
+    // Only committed work reaches the log
+    Database reopened("wal_test");
+    reopened.open_wal(path_);
+    EXPECT_EQ(reopened.get_table("t")->row_count(), 4u);
+    EXPECT_THROW(reopened.get_table("scratch"), std::runtime_error);
+}
+
+TEST_F(WriteAheadLogTest, TornTailIsDiscarded) {
+    {
+        WriteAheadLog wal(path_);
+        WalRecord create;
+        create.op = WalOp::CREATE_TABLE;
+        create.table = "t";
+        create.schema.add_column(ColumnDef("id", DataType::INT64));
+        wal.commit({create});
+        WalRecord insert;
+        insert.op = WalOp::INSERT;
+        insert.table = "t";
+        insert.values = {"42"};
+        wal.commit({insert});
+    }
+    auto intact = std::filesystem::file_size(path_);
+    {
+        // Half-written frame from a crash
+        std::ofstream out(path_, std::ios::binary | std::ios::app);
+        out.write("\x40\x00\x00\x00\x01\x02", 6);
+    }
+
+    {
+        WriteAheadLog wal(path_);
+        auto txns = wal.take_recovered();
+        ASSERT_EQ(txns.size(), 2u);
+        EXPECT_EQ(txns[1].lsn, 2u);
+        EXPECT_EQ(txns[1].records[0].values[0], "42");
+        EXPECT_EQ(std::filesystem::file_size(path_), intact);
+        EXPECT_EQ(wal.durable_lsn(), 2u);
+    }
+
+    Database db("wal_test");
+    db.open_wal(path_);
+    EXPECT_EQ(db.get_table("t")->get_row(0), (std::vector<std::string>{"42"}));
+}
+
+TEST_F(WriteAheadLogTest, ConcurrentCommitsShareSyncs) {
+    constexpr int kThreads = 8;
+    constexpr int kCommits = 20;
+    {
+        Database db("wal_test");
+        db.open_wal(path_, std::chrono::microseconds(2000));
+        db.execute("CREATE TABLE t (worker INT, seq INT)");
+
+        std::vector<std::thread> workers;
+        for (int w = 0; w < kThreads; ++w) {
+            workers.emplace_back([&db, w]() {
+                for (int i = 0; i < kCommits; ++i) {
+                    db.begin_transaction();
+                    db.execute("INSERT INTO t VALUES (" + std::to_string(w) + ", " +
+                               std::to_string(i) + ")");
+                    db.commit();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        WalStats stats = db.wal()->stats();
+        EXPECT_EQ(stats.commits, 1u + kThreads * kCommits);
+        EXPECT_LT(stats.syncs, stats.commits);
+        EXPECT_EQ(db.wal()->durable_lsn(), stats.commits);
+    }
+
+    Database db("wal_test");
+    db.open_wal(path_);
+    EXPECT_EQ(db.get_table("t")->row_count(), static_cast<size_t>(kThreads * kCommits));
+}
+
+#ifndef _WIN32
+TEST_F(WriteAheadLogTest, FailedLogWriteRollsBackCommit) {
+    Database db("wal_test");
+    db.open_wal(path_);
+    db.execute("CREATE TABLE t (id INT, name VARCHAR)");
+    db.execute("INSERT INTO t VALUES (1, 'a')");
+
+    // Writes past the file size limit fail (EFBIG)
+    rlimit saved{};
+    getrlimit(RLIMIT_FSIZE, &saved);
+    auto saved_handler = std::signal(SIGXFSZ, SIG_IGN);
+    rlimit limit = saved;
+    limit.rlim_cur = std::filesystem::file_size(path_);
+    setrlimit(RLIMIT_FSIZE, &limit);
+    EXPECT_THROW(db.execute("INSERT INTO t VALUES (2, 'b')"), std::runtime_error);
+    setrlimit(RLIMIT_FSIZE, &saved);
+    std::signal(SIGXFSZ, saved_handler);
+
+    // Neither the live table nor readers keep the lost commit, and the
+    // failed log refuses later ones
+    EXPECT_EQ(db.get_table("t")->row_count(), 1u);
+    EXPECT_EQ(db.get_table_snapshot("t")->row_count(), 1u);
+    EXPECT_THROW(db.execute("INSERT INTO t VALUES (3, 'c')"), std::runtime_error);
+    EXPECT_EQ(db.get_table("t")->row_count(), 1u);
+    EXPECT_FALSE(db.in_transaction());
+}
+#endif
+
+} // namespace test
+} // namespace lyradb
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include "lyradb/zone_map.h"
+#include "lyradb/column.h"
+#include "lyradb/expression_evaluator.h"
+#include "lyradb/query_executor.h"
+#include "lyradb/vector_batch.h"
+#include "lyradb/sql_parser.h"
+#include "lyradb/table.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lyradb {
+namespace test {
+
+using indexes::ZoneMapIndex;
+
+class ZoneMapTest : public ::testing::Test {
+protected:
+    // INT64 pages hold 8192 rows
+    static constexpr size_t kPageRows = 65536 / sizeof(int64_t);
+    static constexpr size_t kRows = 10 * kPageRows + 100;
+
+    void SetUp() override {
+        schema_ = Schema({
+            ColumnDef("ts", DataType::INT64),
+            ColumnDef("level", DataType::STRING),
+            ColumnDef("latency", DataType::FLOAT64)
+        });
+        table_ = std::make_unique<Table>("events", schema_);
+        const char* levels[] = {"debug", "info", "warn"};
+        for (size_t i = 0; i < kRows; ++i) {
+            // Time-ordered events; latency is NULL in the third page only
+            int64_t ts = 1000000 + static_cast<int64_t>(i) * 10;
+            std::string latency = (i / kPageRows == 2) ? "" : std::to_string(i % 500) + ".5";
+            table_->insert_row(std::vector<std::string>{
+                std::to_string(ts), levels[i % 3], latency});
+        }
+    }
+
+    const query::Expression* where(const std::string& text) {
+        stmts_.push_back(parser_.parse_select_statement("SELECT * FROM events WHERE " + text));
+        return stmts_.back()->where_clause.get();
+    }
+
+    size_t candidate_rows(const std::string& text) {
+        ExpressionEvaluator evaluator;
+        std::vector<RowRange> ranges;
+        evaluator.candidate_ranges(where(text), VectorBatch::from_table(*table_, 0, kRows), ranges);
+        size_t rows = 0;
+        for (const auto& range : ranges) {
+            rows += range.end - range.begin;
+        }
+        return rows;
+    }
+
+    size_t count(const std::string& text) {
+        QueryExecutor executor;
+        std::vector<size_t> row_ids;
+        return executor.filter_table(*table_, where(text), row_ids);
+    }
+
+    Schema schema_;
+    std::unique_ptr<Table> table_;
+    query::SqlParser parser_;
+    std::vector<std::unique_ptr<query::SelectStatement>> stmts_;
+};
+
+TEST_F(ZoneMapTest, OneZonePerPage) {
+    const ZoneMapIndex& zones = table_->column(0).zone_map();
+    ASSERT_EQ(zones.zone_count(), 11u);  // 10 sealed pages + open tail
+
+    const auto& first = zones.zone(0);
+    EXPECT_EQ(first.first_row, 0u);
+    EXPECT_EQ(first.row_count, kPageRows);
+    EXPECT_EQ(first.min_int, 1000000);
+    EXPECT_EQ(first.max_int, 1000000 + static_cast<int64_t>(kPageRows - 1) * 10);
+
+    const auto& tail = zones.zone(10);
+    EXPECT_EQ(tail.first_row, 10 * kPageRows);
+    EXPECT_EQ(tail.row_count, 100u);
+    EXPECT_EQ(zones.find_zone(kRows - 1), 10u);
+
+    const ZoneMapIndex& latency = table_->column(2).zone_map();
+    EXPECT_EQ(latency.zone(2).null_count, kPageRows);
+    EXPECT_FALSE(latency.zone(2).has_values);
+    EXPECT_EQ(latency.zone(3).null_count, 0u);
+}
+
+TEST_F(ZoneMapTest, RecentRangeSkipsOldPages) {
+    // "Last hour": only the final page and the tail can match
+    int64_t cutoff = 1000000 + static_cast<int64_t>(9 * kPageRows + 50) * 10;
+    std::string predicate = "ts >= " + std::to_string(cutoff);
+    EXPECT_EQ(candidate_rows(predicate), kPageRows + 100);
+    EXPECT_EQ(count(predicate), kRows - (9 * kPageRows + 50));
+}
+
+TEST_F(ZoneMapTest, PruningKeepsResultsExact) {
+    const char* predicates[] = {
+        "ts = 1000010",
+        "ts < 1000000",
+        "ts > 1000000 AND ts < 1000100",
+        "ts >= 1100000 AND ts <= 1200000",
+        "latency > 100",
+        "level = 'warn' AND ts <= 1000050"
+    };
+    for (const char* text : predicates) {
+        size_t expected = 0;
+        ExpressionEvaluator scalar;
+        const query::Expression* expr = where(text);
+        for (size_t row = 0; row < kRows; ++row) {
+            RowData data;
+            data["ts"] = table_->column(0).data<int64_t>()[row];
+            data["level"] = table_->column(1).string_at(row);
+            data["latency"] = table_->column(2).is_null(row)
+                ? ExpressionValue(nullptr)
+                : ExpressionValue(table_->column(2).data<double>()[row]);
+            auto value = scalar.evaluate(expr, data);
+            expected += std::holds_alternative<bool>(value) && std::get<bool>(value);
+        }
+        EXPECT_EQ(count(text), expected) << text;
+    }
+}
+
+TEST_F(ZoneMapTest, AllNullPageIsSkipped) {
+    EXPECT_EQ(candidate_rows("latency >= 0"), kRows - kPageRows);
+    EXPECT_EQ(candidate_rows("ts < 0"), 0u);
+    EXPECT_EQ(candidate_rows("level = 'zzz'"), 0u);
+    EXPECT_EQ(candidate_rows("level = 'info'"), kRows);
+}
+
+TEST(ZoneMapColumnTest, UpdatesWidenZones) {
+    Column column("v", DataType::INT32);
+    for (int i = 0; i < 10; ++i) {
+        column.append_value(&i);
+    }
+    column.set_string(3, "500");
+    column.set_string(4, "");
+    const auto& zone = column.zone_map().zone(0);
+    EXPECT_EQ(zone.min_int, 0);
+    EXPECT_EQ(zone.max_int, 500);
+    EXPECT_EQ(zone.null_count, 1u);
+
+    column.erase_rows({3});
+    EXPECT_EQ(column.zone_map().zone(0).max_int, 9);
+    EXPECT_EQ(column.zone_map().zone(0).row_count, 9u);
+    EXPECT_EQ(column.get_stats().max_value, 9);
+}
+
+TEST(ZoneMapColumnTest, SerializedWithColumn) {
+    Column column("price", DataType::FLOAT64);
+    for (int i = 0; i < 20000; ++i) {
+        if (i % 100 == 0) {
+            column.append_null();
+        } else {
+            double v = i * 0.5;
+            column.append_value(&v);
+        }
+    }
+    column.finalize_page();
+
+    Column loaded = Column::deserialize(column.serialize());
+    EXPECT_EQ(loaded.name(), "price");
+    EXPECT_EQ(loaded.num_values(), 20000u);
+    EXPECT_EQ(loaded.num_pages(), column.num_pages());
+    EXPECT_EQ(loaded.null_count(), 200u);
+    EXPECT_TRUE(loaded.is_null(100));
+    EXPECT_DOUBLE_EQ(loaded.data<double>()[101], 50.5);
+
+    ASSERT_EQ(loaded.zone_map().zone_count(), column.zone_map().zone_count());
+    for (size_t z = 0; z < column.zone_map().zone_count(); ++z) {
+        const auto& a = column.zone_map().zone(z);
+        const auto& b = loaded.zone_map().zone(z);
+        EXPECT_EQ(a.first_row, b.first_row);
+        EXPECT_EQ(a.row_count, b.row_count);
+        EXPECT_EQ(a.null_count, b.null_count);
+        EXPECT_DOUBLE_EQ(a.min_double, b.min_double);
+        EXPECT_DOUBLE_EQ(a.max_double, b.max_double);
+    }
+}
+
+} // namespace test
+} // namespace lyradb